@@ -0,0 +1,56 @@
+// Hold-model comparison of the identifier event queues: each popped node is rescheduled one period later.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "lib/component/identifier.hpp"
+
+#define EVENTS 5000000
+
+using namespace std;
+using namespace fcpp;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer(string s) : beginning(clock_t::now()) {
+        cout << s << ": ";
+    }
+    ~timer() {
+        cout << elapsed() << " seconds" << endl;
+    }
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+template <typename Q>
+void hold(string name, size_t n, bool sync) {
+    mt19937 rnd(42);
+    uniform_real_distribution<double> jitter(0.9, 1.1);
+    Q q;
+    for (size_t i=0; i<n; ++i) q.push(sync ? 1 : jitter(rnd), device_t(i));
+    timer t(name + " " + to_string(n));
+    size_t events = 0;
+    while (events < EVENTS) {
+        times_t now = q.next();
+        vector<device_t> v = q.pop(now);
+        events += v.size();
+        for (device_t d : v) q.push(now + (sync ? 1 : jitter(rnd)), d);
+    }
+}
+
+int main() {
+    for (size_t n : {100, 10000, 1000000}) {
+        hold<component::details::times_queue<false>>("priority queue", n, false);
+        hold<component::details::calendar_queue<false>>("calendar queue", n, false);
+        hold<component::details::times_queue<true>>("synchronised map", n, true);
+        hold<component::details::calendar_queue<true>>("synchronised calendar", n, true);
+    }
+}
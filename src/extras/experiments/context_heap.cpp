@@ -0,0 +1,132 @@
+// Per-round bookkeeping comparison between online-drop contexts: the former design with two hash maps and a lazily
+// cleaned priority queue rebuilt at every round, and the current indexed heap. Exports from more neighbours than the
+// hood size arrive with metrics changing at every round, the context is frozen and then unfrozen, as in a round.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/common/multitype_map.hpp"
+#include "lib/internal/context.hpp"
+
+#define ROUNDS 2000
+#define NBRS 1000
+#define HOOD 500
+
+using namespace std;
+using namespace fcpp;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer(string s) : beginning(clock_t::now()) {
+        cout << s << ": ";
+    }
+    ~timer() {
+        cout << elapsed() << " seconds" << endl;
+    }
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+using map_type = common::multitype_map<trace_t, real_t>;
+using export_type = internal::flat_ptr<map_type, false>;
+
+// Metric ageing exports by a small amount at every round.
+struct metric {
+    template <typename... Ts>
+    double update(double const& r, Ts const&...) const {
+        return r + 0.001;
+    }
+};
+
+// The bookkeeping of online-drop contexts before the indexed heap.
+class queue_context {
+  public:
+    void insert(device_t d, export_type e, double m, double threshold, device_t hoodsize) {
+        if (m <= threshold) {
+            if (m_metrics.count(d) == 0 or m_metrics[d] != m)
+                m_queue.emplace(m, d);
+            m_metrics[d] = m;
+            m_data[d] = std::move(e);
+            if (m_data.size() > hoodsize) pop();
+            else clean();
+        }
+    }
+    void pop() {
+        clean();
+        m_data.erase(m_queue.top().second);
+        m_metrics.erase(m_queue.top().second);
+        m_queue.pop();
+    }
+    void freeze(device_t, device_t) {
+        for (auto const& x : m_data)
+            m_sorted_data.emplace_back(x.first, &x.second);
+        std::sort(m_sorted_data.begin(), m_sorted_data.end());
+        for (auto const& x : m_sorted_data)
+            m_index.insert(x.first, **x.second);
+    }
+    void unfreeze(int, metric const& m, double threshold) {
+        m_sorted_data.clear();
+        m_index.clear();
+        m_queue = {};
+        for (auto it = m_metrics.begin(); it != m_metrics.end(); ) {
+            it->second = m.update(it->second);
+            if (it->second > threshold) {
+                m_data.erase(it->first);
+                it = m_metrics.erase(it);
+            } else {
+                m_queue.emplace(it->second, it->first);
+                ++it;
+            }
+        }
+    }
+    size_t size(device_t self) const {
+        return m_data.size() + 1-m_data.count(self);
+    }
+
+  private:
+    void clean() {
+        while (m_metrics.count(m_queue.top().second) == 0 or m_metrics.at(m_queue.top().second) != m_queue.top().first)
+            m_queue.pop();
+    }
+
+    std::unordered_map<device_t, export_type> m_data;
+    std::unordered_map<device_t, double> m_metrics;
+    std::priority_queue<std::pair<double, device_t>> m_queue;
+    std::vector<std::pair<device_t, export_type const*>> m_sorted_data;
+    internal::context<true, true, double, real_t>::index_type m_index;
+};
+
+template <typename C>
+void bench(string name) {
+    vector<export_type> exports(NBRS);
+    C ctx;
+    size_t sum = 0;
+    {
+        timer t(name);
+        for (int r=0; r<ROUNDS; ++r) {
+            for (device_t d=0; d<NBRS; d += 1 + r % 3)
+                ctx.insert(d, exports[d], ((d * 7919 + r * 104729) % 1000) / 1000.0, 1, HOOD);
+            ctx.freeze(HOOD, 0);
+            sum += ctx.size(0);
+            ctx.unfreeze(0, metric{}, 1);
+        }
+    }
+    if (sum == 0) cout << "unexpected" << endl;
+}
+
+int main() {
+    bench<queue_context>("hash maps and priority queue");
+    bench<internal::context<true, true, double, real_t>>("indexed heap");
+}
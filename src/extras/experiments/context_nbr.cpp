@@ -0,0 +1,93 @@
+// Per-round cost of neighbour lookups in a context: exports from a number of neighbours are inserted, the context is
+// frozen, a number of traces are gathered into fields through nbr calls, and the context is unfrozen, as in a round.
+// The time spent freezing and calling nbr is also reported on its own.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/common/flat_multitype_map.hpp"
+#include "lib/common/multitype_map.hpp"
+#include "lib/data/field.hpp"
+#include "lib/internal/context.hpp"
+
+#define ROUNDS 2000
+#define NBRS 200
+#define TRACES 40
+
+using namespace std;
+using namespace fcpp;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer(string s) : beginning(clock_t::now()) {
+        cout << s << ": ";
+    }
+    ~timer() {
+        cout << elapsed() << " seconds" << endl;
+    }
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+// Metric never discarding exports.
+struct metric {
+    template <typename... Ts>
+    double update(double const& r, Ts const&...) const {
+        return r;
+    }
+};
+
+// Builds the export of a device, with half of the traces holding reals and half holding fields.
+template <typename M>
+M build(device_t d) {
+    M m;
+    for (trace_t t=0; t<TRACES; ++t) {
+        trace_t h = t * 0x9E3779B97F4A7C15ULL;
+        if (t % 2) m.insert(h, real_t(d + t));
+        else m.insert(h, field<real_t>(real_t(d)));
+    }
+    return m;
+}
+
+template <bool online, typename M, typename... Ts>
+void bench(string name) {
+    vector<M> exports;
+    for (device_t d=0; d<NBRS; ++d) exports.push_back(build<M>(d));
+    internal::context<online, true, double, Ts...> ctx;
+    double sum = 0, lookup = 0;
+    {
+        timer t(name + " round");
+        for (int r=0; r<ROUNDS; ++r) {
+            for (device_t d=0; d<NBRS; ++d) ctx.insert(d, exports[d], 0, 1, NBRS);
+            auto start = std::chrono::high_resolution_clock::now();
+            ctx.freeze(NBRS, 0);
+            for (trace_t t=0; t<TRACES; ++t) {
+                trace_t h = t * 0x9E3779B97F4A7C15ULL;
+                if (t % 2) sum += details::get_vals(ctx.nbr(h, real_t(0), 0)).back();
+                else sum += details::get_vals(ctx.nbr(h, field<real_t>(0), 0)).back();
+            }
+            lookup += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            ctx.unfreeze(0, metric{}, 1);
+        }
+    }
+    cout << name << " freeze and nbr: " << lookup << " seconds" << endl;
+    if (sum == 0) cout << "unexpected" << endl;
+}
+
+int main() {
+    using multi_map = common::multitype_map<trace_t, real_t, field<real_t>>;
+    using flat_map = common::flat_multitype_map<trace_t, real_t, field<real_t>>;
+    bench<true, multi_map, real_t, field<real_t>>("online multitype map");
+    bench<false, multi_map, real_t, field<real_t>>("offline multitype map");
+    bench<true, flat_map, internal::flat_exports<real_t, field<real_t>>>("online flat multitype map");
+    bench<false, flat_map, internal::flat_exports<real_t, field<real_t>>>("offline flat multitype map");
+}
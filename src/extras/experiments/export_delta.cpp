@@ -0,0 +1,97 @@
+// Per-round cost of exchanging exports with and without delta encoding: every device writes a number of traces, of
+// which only a few change from round to round, and sends its export to all the others, as in a dense network in
+// steady state. Every message received is also measured as the message_size tag of simulated_connector does.
+// The average message size and the time spent are reported.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lib/common/serialize.hpp"
+#include "lib/component/base.hpp"
+#include "lib/component/calculus.hpp"
+
+#define ROUNDS 200
+#define DEVICES 50
+#define TRACES 40
+#define CHANGES 2
+
+using namespace std;
+using namespace fcpp;
+using namespace component::tags;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer(string s) : beginning(clock_t::now()) {
+        cout << s << ": ";
+    }
+    ~timer() {
+        cout << elapsed() << " seconds" << endl;
+    }
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+template <intmax_t delta, bool pointer>
+using combo = component::combine_spec<
+    component::calculus<
+        exports<common::export_list<real_t, field<real_t>>>,
+        export_pointer<pointer>,
+        export_delta<delta>
+    >,
+    component::base<>
+>;
+
+template <intmax_t delta, bool pointer>
+void bench(string name) {
+    using net_t = typename combo<delta, pointer>::net;
+    using node_t = typename combo<delta, pointer>::node;
+    net_t network{common::make_tagged_tuple<>()};
+    vector<unique_ptr<node_t>> nodes;
+    for (device_t d=0; d<DEVICES; ++d) nodes.emplace_back(new node_t(network, common::make_tagged_tuple<uid>(d)));
+    size_t bytes = 0;
+    real_t sum = 0;
+    {
+        timer t(name);
+        for (int r=0; r<ROUNDS; ++r) {
+            for (auto& p : nodes) {
+                node_t& n = *p;
+                n.round_start(0);
+                for (trace_t k=0; k<TRACES; ++k) {
+                    real_t v = k < CHANGES ? r : k;
+                    if (k % 2) n.template nbr_context<real_t>(k).insert(v);
+                    else n.template nbr_context<field<real_t>>(k).insert(field<real_t>(v));
+                }
+                sum += details::get_vals(n.template nbr_context<real_t>(1).nbr(0)).back();
+                n.round_end(0);
+            }
+            for (auto& p : nodes) {
+                typename node_t::message_t m;
+                p->send(0, m);
+                for (auto& o : nodes) {
+                    o->receive(0, p->uid, m);
+                    common::osstream os;
+                    os << m;
+                    bytes += os.size();
+                }
+            }
+        }
+    }
+    cout << name << " bytes per message: " << bytes / (ROUNDS * DEVICES * DEVICES) << endl;
+    if (sum == 0) cout << "unexpected" << endl;
+}
+
+int main() {
+    bench<0, true>("full exports in pointers");
+    bench<16, true>("delta exports in pointers");
+    bench<0, false>("full exports");
+    bench<16, false>("delta exports");
+}
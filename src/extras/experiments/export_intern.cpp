@@ -0,0 +1,90 @@
+// Per-receive cost of interning the values of exports received through a network: every device writes a number of
+// traces, half of which hold the same values in every device (as broadcasts) and half device-specific values, and its
+// serialised export reaches all the others, as in a dense network in steady state. The time spent per message received
+// and the memory statistics of the values shared are reported.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lib/common/serialize.hpp"
+#include "lib/component/base.hpp"
+#include "lib/component/calculus.hpp"
+
+#define ROUNDS 200
+#define DEVICES 50
+#define TRACES 40
+
+using namespace std;
+using namespace fcpp;
+using namespace component::tags;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer() : beginning(clock_t::now()) {}
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+template <bool intern>
+using combo = component::combine_spec<
+    component::calculus<
+        exports<common::export_list<real_t, field<real_t>>>,
+        export_intern<intern>
+    >,
+    component::base<>
+>;
+
+template <bool intern>
+void bench(string name) {
+    using net_t = typename combo<intern>::net;
+    using node_t = typename combo<intern>::node;
+    net_t network{common::make_tagged_tuple<>()};
+    vector<unique_ptr<node_t>> nodes;
+    for (device_t d=0; d<DEVICES; ++d) nodes.emplace_back(new node_t(network, common::make_tagged_tuple<uid>(d)));
+    real_t sum = 0;
+    double receiving = 0;
+    for (int r=0; r<ROUNDS; ++r) {
+        for (auto& p : nodes) {
+            node_t& n = *p;
+            n.round_start(0);
+            for (trace_t k=0; k<TRACES; ++k) {
+                real_t v = k % 4 < 2 ? r : r + n.uid;
+                if (k % 2) n.template nbr_context<real_t>(k).insert(v);
+                else n.template nbr_context<field<real_t>>(k).insert(field<real_t>(v));
+            }
+            sum += details::get_vals(n.template nbr_context<real_t>(1).nbr(0)).back();
+            n.round_end(0);
+        }
+        for (auto& p : nodes) {
+            typename node_t::message_t m;
+            common::osstream os;
+            os << p->send(0, m);
+            timer t;
+            for (auto& o : nodes) {
+                typename node_t::message_t r;
+                common::isstream is(os);
+                is >> r;
+                o->receive(0, p->uid, r);
+            }
+            receiving += t.elapsed();
+        }
+    }
+    cout << name << ": " << receiving * 1e9 / (ROUNDS * DEVICES * DEVICES) << " ns per message received" << endl;
+    internal::intern_stats s = nodes[0]->intern_stats();
+    if (intern) cout << name << ": " << s.lookups << " lookups, " << s.hits << " hits, " << s.bytes_saved << " bytes saved" << endl;
+    if (sum == 0) cout << "unexpected" << endl;
+}
+
+int main() {
+    bench<false>("without interning");
+    bench<true>("with interning");
+}
@@ -0,0 +1,74 @@
+// Eager and fused evaluation of pointwise chains of operators on fields: each round combines fields over the same
+// neighbourhood as gradients do (a distance plus a metric, compared with a threshold and masked), either through the
+// plain field operators, which build a field for every intermediate result, or through a single fused expression.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/data/field.hpp"
+#include "lib/data/field_expr.hpp"
+
+#define ROUNDS  200000
+#define NBRS    30
+
+using namespace std;
+using namespace fcpp;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer(string s) : beginning(clock_t::now()) {
+        cout << s << ": ";
+    }
+    ~timer() {
+        cout << elapsed() << " seconds" << endl;
+    }
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+// A field of random reals over the neighbourhood.
+field<real_t> build(mt19937& gen) {
+    uniform_real_distribution<real_t> dist(0, 100);
+    fcpp::details::field_vector<device_t> ids;
+    fcpp::details::field_vector<real_t> vals;
+    vals.push_back(dist(gen));
+    for (device_t i = 0; i < NBRS; ++i) {
+        ids.push_back(i);
+        vals.push_back(dist(gen));
+    }
+    return fcpp::details::make_field(std::move(ids), std::move(vals));
+}
+
+int main() {
+    mt19937 gen(42);
+    field<real_t> d = build(gen), m = build(gen), w = build(gen);
+    real_t check = 0;
+    {
+        timer t("eager");
+        for (int r = 0; r < ROUNDS; ++r) {
+            field<real_t> x = (d + m) * real_t(0.5) + (w - d) * (d + m < 100);
+            check += fcpp::details::other(x) + fcpp::details::self(x, r % NBRS);
+        }
+    }
+    cout << "    checksum " << check << endl;
+    check = 0;
+    {
+        timer t("fused");
+        for (int r = 0; r < ROUNDS; ++r) {
+            field<real_t> x = (lazy(d) + m) * real_t(0.5) + (lazy(w) - d) * (lazy(d) + m < 100);
+            check += fcpp::details::other(x) + fcpp::details::self(x, r % NBRS);
+        }
+    }
+    cout << "    checksum " << check << endl;
+    return 0;
+}
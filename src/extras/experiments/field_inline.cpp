@@ -0,0 +1,41 @@
+// Building, combining and copying fields with few neighbours, as most fields are in sparse networks: the time
+// is compared between fields holding up to FCPP_FIELD_INLINE neighbours inline and fields always allocating.
+// and then again adding -DFCPP_FIELD_INLINE=0 (which keeps only constant fields inline).
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/data/field.hpp"
+
+#define ROUNDS 2000000
+
+using namespace std;
+using namespace fcpp;
+
+// Times a function over a number of repetitions.
+template <typename F>
+double measure(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < ROUNDS; ++r) f(r);
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main() {
+    cout << "inline neighbours: " << FCPP_FIELD_INLINE << endl;
+    real_t sink = 0;
+    for (device_t n : {0, 2, 4, 8}) {
+        vector<field<real_t>> store(64);
+        double t = measure([&](int r){
+            field<real_t> x = real_t(r);
+            for (device_t i = 0; i < n; ++i) fcpp::details::self(x, i) = real_t(i);
+            field<real_t> y = x * 2 + 1;
+            store[r % 64] = y;
+            sink += fcpp::details::other(max(x, y));
+        });
+        cout << n << " neighbours: " << t << "s" << endl;
+    }
+    cout << "checksum " << sink << endl;
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Pointwise operations and reductions on fields of reals over large neighbourhoods sharing a domain, as fields from
+// nbr do within a round: each operation is run through the generic merge of field domains and through the SIMD
+// kernels dispatched by field operators, mux, isfinite and the hood reductions, reporting times and speedups.
+// Sums are vectorised only with -DFCPP_SIMD_SUM=true, being otherwise folded sequentially as fold_hood does.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/coordination/utils.hpp"
+#include "lib/data/field.hpp"
+
+#define ELEMENTS 20000000
+
+using namespace std;
+using namespace fcpp;
+
+// Times a function over a number of repetitions.
+template <typename F>
+double measure(int reps, F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < reps; ++r) f();
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// A field of random reals over a neighbourhood.
+field<real_t> build(mt19937& gen, size_t n) {
+    uniform_real_distribution<real_t> dist(0, 100);
+    fcpp::details::field_vector<device_t> ids;
+    fcpp::details::field_vector<real_t> vals;
+    vals.push_back(dist(gen));
+    for (size_t i = 0; i < n; ++i) {
+        ids.push_back(device_t(i));
+        vals.push_back(dist(gen));
+    }
+    return fcpp::details::make_field(std::move(ids), std::move(vals));
+}
+
+real_t sink = 0;
+
+// Reports the time of a generic and a kernel version of an operation.
+template <typename G, typename K>
+void report(string name, int reps, G&& generic, K&& kernel) {
+    double g = measure(reps, generic), k = measure(reps, kernel);
+    cout << "    " << name << ": " << g << "s generic, " << k << "s kernel (" << g / k << "x)" << endl;
+}
+
+int main() {
+    mt19937 gen(42);
+    cout << "vector width: " << common::simd::width << " bytes" << endl;
+    for (size_t n : {100, 300, 1000}) {
+        field<real_t> x = build(gen, n), y = build(gen, n);
+        field<bool> b = x < y;
+        fcpp::details::field_vector<device_t> dom = fcpp::details::get_ids(x);
+        int reps = ELEMENTS / n;
+        cout << n << " neighbours:" << endl;
+        report("x + y", reps, [&](){
+            sink += fcpp::details::other(map_hood([](real_t a, real_t c){ return a + c; }, x, y));
+        }, [&](){
+            sink += fcpp::details::other(x + y);
+        });
+        report("x * 2", reps, [&](){
+            sink += fcpp::details::other(map_hood([](real_t a, real_t c){ return a * c; }, x, real_t(2)));
+        }, [&](){
+            sink += fcpp::details::other(x * 2);
+        });
+        report("x < y", reps, [&](){
+            sink += fcpp::details::other(map_hood([](real_t a, real_t c){ return a < c; }, x, y));
+        }, [&](){
+            sink += fcpp::details::other(x < y);
+        });
+        report("mux", reps, [&](){
+            sink += fcpp::details::other(map_hood([](bool c, real_t a, real_t d){ return c ? a : d; }, b, x, y));
+        }, [&](){
+            sink += fcpp::details::other(mux(b, x, y));
+        });
+        report("isfinite", reps, [&](){
+            sink += fcpp::details::other(map_hood([](real_t a){ return std::isfinite(a); }, x));
+        }, [&](){
+            sink += fcpp::details::other(isfinite(x));
+        });
+        report("min_hood", reps, [&](){
+            sink += fcpp::details::fold_hood([](real_t a, real_t c){ return std::min(a, c); }, x, real_t(50), dom, 7);
+        }, [&](){
+            sink += fcpp::details::kernel_fold_hood<common::simd::min>([](real_t a, real_t c){ return std::min(a, c); }, x, real_t(50), dom, 7);
+        });
+        report("sum_hood", reps, [&](){
+            sink += fcpp::details::fold_hood([](real_t a, real_t c){ return a + c; }, x, real_t(0), dom, 7);
+        }, [&](){
+            sink += fcpp::details::kernel_fold_hood<common::simd::add>([](real_t a, real_t c){ return a + c; }, x, real_t(0), dom, 7);
+        });
+    }
+    cout << "checksum " << sink << endl;
+    return 0;
+}
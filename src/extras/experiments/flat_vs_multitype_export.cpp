@@ -0,0 +1,108 @@
+// Per-round export comparison between the multitype map and the flat multitype map: an export with a few tens of
+// trace entries is built from scratch, copied into a neighbour context and looked up entry by entry, as in a round.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/common/flat_multitype_map.hpp"
+#include "lib/common/multitype_map.hpp"
+#include "lib/data/field.hpp"
+
+#define ROUNDS 100000
+
+using namespace std;
+using namespace fcpp;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer(string s) : beginning(clock_t::now()) {
+        cout << s << ": ";
+    }
+    ~timer() {
+        cout << elapsed() << " seconds" << endl;
+    }
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+// Builds an export with a given number of traces, cycling through value types.
+template <typename M>
+M build(vector<trace_t> const& traces) {
+    M m;
+    for (size_t i=0; i<traces.size(); ++i) switch (i % 4) {
+        case 0:
+            m.insert(traces[i], real_t(i));
+            break;
+        case 1:
+            m.insert(traces[i], int(i));
+            break;
+        case 2:
+            m.insert(traces[i], field<real_t>(real_t(i)));
+            break;
+        default:
+            m.insert(traces[i]);
+    }
+    return m;
+}
+
+// Looks up every trace of an export.
+template <typename M>
+double lookup(M const& m, vector<trace_t> const& traces) {
+    double sum = 0;
+    for (size_t i=0; i<traces.size(); ++i) switch (i % 4) {
+        case 0:
+            if (m.template count<real_t>(traces[i])) sum += m.template at<real_t>(traces[i]);
+            break;
+        case 1:
+            if (m.template count<int>(traces[i])) sum += m.template at<int>(traces[i]);
+            break;
+        case 2:
+            if (m.template count<field<real_t>>(traces[i])) sum += 1;
+            break;
+        default:
+            sum += m.contains(traces[i]);
+    }
+    return sum;
+}
+
+template <typename M>
+void bench(string name, size_t num) {
+    vector<trace_t> traces(num);
+    mt19937_64 rnd(42);
+    for (trace_t& t : traces) t = rnd();
+    double sum = 0;
+    {
+        timer t(name + " build " + to_string(num));
+        for (int r=0; r<ROUNDS; ++r) sum += build<M>(traces).template count<int>(traces[1]);
+    }
+    M m = build<M>(traces);
+    {
+        timer t(name + " copy " + to_string(num));
+        for (int r=0; r<ROUNDS; ++r) {
+            M c(m);
+            sum += c.contains(traces[3 % num]);
+        }
+    }
+    {
+        timer t(name + " lookup " + to_string(num));
+        for (int r=0; r<ROUNDS; ++r) sum += lookup(m, traces);
+    }
+    if (sum == 0) cout << "unexpected" << endl;
+}
+
+int main() {
+    for (size_t num : {10, 30, 100}) {
+        bench<common::multitype_map<trace_t, real_t, int, field<real_t>>>("multitype map", num);
+        bench<common::flat_multitype_map<trace_t, real_t, int, field<real_t>>>("flat multitype map", num);
+    }
+}
@@ -0,0 +1,51 @@
+// Receiving one message per neighbour per round in random order, as positioners and connectors do in dense crowds:
+// the time is compared between inserting each value into the field as it arrives and buffering the values to merge
+// them into the field once per round.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/data/field.hpp"
+#include "lib/internal/nbr_sensor.hpp"
+
+#define MESSAGES 20000000
+
+using namespace fcpp;
+
+// Times a function over a number of repetitions.
+template <typename F>
+double measure(int reps, F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < reps; ++r) f(r);
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main() {
+    std::mt19937 gen(42);
+    real_t sink = 0;
+    for (device_t n : {10, 100, 1000, 10000}) {
+        int reps = MESSAGES / n;
+        std::vector<device_t> order(n);
+        for (device_t i = 0; i < n; ++i) order[i] = i;
+        std::shuffle(order.begin(), order.end(), gen);
+        field<real_t> f(INF);
+        double inserted = measure(reps, [&](int r){
+            f = INF;
+            for (device_t d : order) fcpp::details::self(f, d) = real_t(d + r);
+            sink += fcpp::details::self(f, order[0]);
+        });
+        internal::nbr_sensor<real_t> s(INF);
+        double buffered = measure(reps, [&](int r){
+            s.get() = INF;
+            for (device_t d : order) s.set(d, real_t(d + r));
+            sink += fcpp::details::self(s.get(), order[0]);
+        });
+        std::cout << n << " neighbours: inserted " << inserted << "s, buffered " << buffered << "s" << std::endl;
+    }
+    std::cout << "checksum " << sink << std::endl;
+    return 0;
+}
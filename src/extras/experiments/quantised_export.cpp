@@ -0,0 +1,108 @@
+// Size and precision of exports of real fields on the wire, with and without quantisation: an export holds a number
+// of traces with fields of real values over a neighbourhood, as exchanged by gradients and collections in a dense
+// network. Each export is serialised and read back through the encodings available, reporting the average message
+// size, the maximum absolute and relative error, and the time spent.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/common/multitype_map.hpp"
+#include "lib/common/serialize.hpp"
+#include "lib/data/field.hpp"
+#include "lib/internal/flat_ptr.hpp"
+#include "lib/internal/quantised.hpp"
+
+#define EXPORTS 2000
+#define TRACES  20
+#define NBRS    30
+
+using namespace std;
+using namespace fcpp;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer(string s) : beginning(clock_t::now()) {
+        cout << s << ": ";
+    }
+    ~timer() {
+        cout << elapsed() << " seconds" << endl;
+    }
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+using map_type = common::multitype_map<trace_t, real_t, field<real_t>, int>;
+using export_type = internal::flat_ptr<map_type, false>;
+
+// Builds an export with fields of distances in [0, 100) and a few integer entries.
+map_type build(mt19937& gen) {
+    uniform_real_distribution<real_t> dist(0, 100);
+    map_type m;
+    for (trace_t t = 0; t < TRACES; ++t) {
+        if (t % 5 == 4) {
+            m.insert(t, int(t));
+            continue;
+        }
+        fcpp::details::field_vector<device_t> ids;
+        fcpp::details::field_vector<real_t> vals;
+        vals.push_back(dist(gen));
+        for (device_t i = 0; i < NBRS; ++i) {
+            ids.push_back(i);
+            vals.push_back(dist(gen));
+        }
+        m.insert(t, fcpp::details::make_field(std::move(ids), std::move(vals)));
+    }
+    return m;
+}
+
+// Serialises exports and reads them back, measuring sizes and errors.
+template <typename Q>
+void test(string name, vector<map_type> const& data) {
+    using message_type = internal::quantised_t<export_type, Q>;
+    size_t bytes = 0;
+    real_t abs_err = 0, rel_err = 0;
+    {
+        timer t(name);
+        for (map_type const& m : data) {
+            message_type x{export_type(m)}, y;
+            common::osstream os;
+            os << x;
+            bytes += os.size();
+            common::isstream is(os);
+            is >> y;
+            for (trace_t t = 0; t < TRACES; ++t) if (t % 5 != 4) {
+                auto const& a = fcpp::details::get_vals(m.at<field<real_t>>(t));
+                auto const& b = fcpp::details::get_vals(y->template at<field<real_t>>(t));
+                for (size_t i = 0; i < a.size(); ++i) {
+                    abs_err = max(abs_err, abs(a[i] - b[i]));
+                    rel_err = max(rel_err, abs(a[i] - b[i]) / max(abs(a[i]), real_t(1e-9)));
+                }
+            }
+        }
+    }
+    cout << "    " << bytes / data.size() << " bytes per message, max error " << abs_err << " (relative " << rel_err << ")" << endl;
+}
+
+int main() {
+    mt19937 gen(42);
+    vector<map_type> data;
+    for (int i = 0; i < EXPORTS; ++i) data.push_back(build(gen));
+    test<common::type_sequence<>>("plain", data);
+    test<common::type_sequence<common::quantise<common::fp16, field<real_t>>>>("fp16", data);
+    test<common::type_sequence<common::quantise<common::bfloat16, field<real_t>>>>("bfloat16", data);
+    test<common::type_sequence<common::quantise<common::fixed<1, 100>, field<real_t>>>>("fixed 0.01", data);
+    test<common::type_sequence<common::quantise<common::fixed<1, 1, int8_t>, field<real_t>>>>("fixed 1 (8 bit)", data);
+    return 0;
+}
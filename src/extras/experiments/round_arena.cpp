@@ -0,0 +1,108 @@
+// Per-round allocation comparison between the global allocator and the round arena: several threads run rounds
+// building and combining short-lived id and value vectors, as field operators do in a round.
+// The worst-case memory retained by values escaping rounds is also measured, with every round filling a chunk and a
+// small value escaping it, with and without copying the value out of the arena.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/common/arena.hpp"
+
+#define ROUNDS 200000
+#define OPS 20
+#define KEPT 1000
+
+using namespace std;
+using namespace fcpp;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer(string s) : beginning(clock_t::now()) {
+        cout << s << ": ";
+    }
+    ~timer() {
+        cout << elapsed() << " seconds" << endl;
+    }
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+// Runs rounds of field-like operations with a given allocator.
+template <typename A, bool open>
+double rounds(size_t nbrs) {
+    using ids_t = vector<device_t, typename std::allocator_traits<A>::template rebind_alloc<device_t>>;
+    using vals_t = vector<real_t, typename std::allocator_traits<A>::template rebind_alloc<real_t>>;
+    double sum = 0;
+    for (int r=0; r<ROUNDS; ++r) {
+        if (open) common::arena::open();
+        {
+            vals_t acc(nbrs+1, 0);
+            for (int o=0; o<OPS; ++o) {
+                ids_t ids(nbrs);
+                vals_t vals(nbrs+1);
+                for (size_t i=0; i<nbrs; ++i) {
+                    ids[i] = i;
+                    vals[i+1] = acc[i+1] + o;
+                }
+                acc = std::move(vals);
+            }
+            sum += acc.back();
+        }
+        if (open) common::arena::close();
+    }
+    return sum;
+}
+
+template <typename A, bool open>
+void bench(string name, size_t threads, size_t nbrs) {
+    vector<double> sums(threads);
+    timer t(name + " " + to_string(threads) + " threads " + to_string(nbrs) + " neighbours");
+    vector<thread> pool;
+    for (size_t i=0; i<threads; ++i)
+        pool.emplace_back([&sums,i,nbrs](){
+            sums[i] = rounds<A, open>(nbrs);
+        });
+    for (thread& th : pool) th.join();
+    for (double s : sums) if (s == 0) cout << "unexpected" << endl;
+}
+
+// Measures the chunks held by small values escaping rounds, each kept for the following KEPT rounds.
+template <bool copy>
+void retention() {
+    using vals_t = vector<real_t, common::arena_allocator<real_t>>;
+    vector<vals_t> kept(KEPT);
+    size_t most = 0;
+    for (int r=0; r<10*KEPT; ++r) {
+        common::arena::open();
+        {
+            vector<vals_t> temps(8, vals_t(1000, r));
+            vals_t v(2, r);
+            kept[r % KEPT] = copy ? common::arena::escape(v) : std::move(v);
+        }
+        common::arena::close();
+        most = std::max(most, common::arena::chunks());
+    }
+    cout << (copy ? "escaped" : "kept in arena") << ": " << KEPT << " values of " << 2*sizeof(real_t) << " bytes hold up to ";
+    cout << most * common::arena::chunk_size / 1024 << " KB of chunks" << endl;
+}
+
+int main() {
+    retention<false>();
+    retention<true>();
+    size_t n = std::max(thread::hardware_concurrency(), 1u);
+    for (size_t threads : {size_t(1), n})
+        for (size_t nbrs : {5, 20, 100}) {
+            bench<std::allocator<char>, false>("global allocator", threads, nbrs);
+            bench<common::arena_allocator<char>, true>("round arena", threads, nbrs);
+        }
+}
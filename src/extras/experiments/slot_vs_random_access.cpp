@@ -0,0 +1,104 @@
+// Update-loop comparison of the identifier node stores: every node is looked up by identifier, checked and updated
+// once per round, in the shuffled order in which an event queue would pop them.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/common/random_access_map.hpp"
+#include "lib/common/slot_map.hpp"
+
+#define ROUNDS 10
+
+using namespace std;
+using namespace fcpp;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer(string s) : beginning(clock_t::now()) {
+        cout << s << ": ";
+    }
+    ~timer() {
+        cout << elapsed() << " seconds" << endl;
+    }
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+// A non-movable node with some state, as nodes in a composition.
+struct node {
+    node(device_t uid) : uid(uid), value(uid) {}
+    node(node const&) = delete;
+    void update() {
+        value = value * 0.5 + 1;
+        ++rounds;
+    }
+    device_t uid;
+    double value;
+    size_t rounds = 0;
+    std::mutex mutex;
+    char state[200];
+};
+
+// The update loop before the slot map: a count followed by an access.
+template <typename M>
+double counted_loop(M& m, vector<device_t> const& order) {
+    double sum = 0;
+    for (int r=0; r<ROUNDS; ++r)
+        for (device_t uid : order) if (m.count(uid) > 0) {
+            node& n = m.at(uid);
+            std::lock_guard<std::mutex> l(n.mutex);
+            n.update();
+            sum += n.value;
+        }
+    return sum;
+}
+
+// The update loop with the slot map: a single lookup.
+template <typename M>
+double found_loop(M& m, vector<device_t> const& order) {
+    double sum = 0;
+    for (int r=0; r<ROUNDS; ++r)
+        for (device_t uid : order) {
+            node* p = m.find_ptr(uid);
+            if (p == nullptr) continue;
+            node& n = *p;
+            std::lock_guard<std::mutex> l(n.mutex);
+            n.update();
+            sum += n.value;
+        }
+    return sum;
+}
+
+template <typename M, typename L>
+void bench(string name, size_t num, L loop) {
+    M m;
+    for (size_t i=0; i<num; ++i) m.emplace(std::piecewise_construct, std::make_tuple(device_t(i)), std::make_tuple(device_t(i)));
+    vector<device_t> order(num);
+    for (size_t i=0; i<num; ++i) order[i] = device_t(i);
+    shuffle(order.begin(), order.end(), mt19937(42));
+    double sum;
+    {
+        timer t(name + " " + to_string(num));
+        sum = loop(m, order);
+    }
+    if (sum == 0) cout << "unexpected" << endl;
+}
+
+int main() {
+    for (size_t num : {1000, 100000, 1000000}) {
+        bench<common::random_access_map<device_t, node>>("random access map", num, counted_loop<common::random_access_map<device_t, node>>);
+        bench<common::slot_map<device_t, node>>("slot map", num, found_loop<common::slot_map<device_t, node>>);
+    }
+}
@@ -0,0 +1,61 @@
+// Compares the dispatch overhead of a parallel for spawning threads on every call
+// against the persistent work-stealing pool behind common::parallel_for.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/common/algorithm.hpp"
+
+#define CALLS 2000
+
+using namespace std;
+using namespace fcpp;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer() : beginning(clock_t::now()) {}
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+// The parallel for before the thread pool, creating and joining threads on every call.
+template <typename F>
+void spawning_for(size_t num, size_t len, F&& f) {
+    std::vector<std::thread> pool;
+    pool.reserve(num);
+    for (size_t t=0; t<std::min(num,len); ++t)
+        pool.emplace_back([=,&f] () {
+            for (size_t i=t; i<len; i+=num) f(i,t);
+        });
+    for (std::thread& t : pool) t.join();
+}
+
+int main() {
+    size_t num = std::max(2U, std::thread::hardware_concurrency());
+    std::vector<double> data(1<<16, 1.0);
+    auto work = [&data](size_t i, size_t) {
+        data[i] = data[i] * 0.5 + 1;
+    };
+    cout << "threads: " << num << endl;
+    for (size_t len : {16, 256, 4096, 65536}) {
+        timer ts;
+        for (int k=0; k<CALLS; ++k) spawning_for(num, len, work);
+        double spawn = ts.elapsed() / CALLS * 1e6;
+        timer tp;
+        for (int k=0; k<CALLS; ++k) common::parallel_for(common::tags::parallel_execution(num), len, work);
+        double pool = tp.elapsed() / CALLS * 1e6;
+        timer td;
+        for (int k=0; k<CALLS; ++k) common::parallel_for(common::tags::dynamic_execution(num, 16), len, work);
+        double dyn = td.elapsed() / CALLS * 1e6;
+        cout << "bucket " << len << ": spawn " << spawn << "us, pool " << pool << "us, pool dynamic " << dyn << "us per call" << endl;
+    }
+}
@@ -0,0 +1,98 @@
+// Cost of the stack trace in rounds of coordination routines: every device runs a program calling a few routines of
+// the coordination library (including a split, which pushes a key) below a number of nested aggregate functions, and
+// its export reaches all the others. The time per round is reported for nestings within FCPP_TRACE_DEPTH (held inline)
+// and beyond it (spilling to the heap). Building with -DFCPP_TRACE_DEPTH=1 shows the cost of spilling at every nesting.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lib/component/base.hpp"
+#include "lib/component/calculus.hpp"
+#include "lib/coordination/collection.hpp"
+#include "lib/coordination/election.hpp"
+#include "lib/coordination/spreading.hpp"
+
+#define ROUNDS 500
+#define DEVICES 20
+
+using namespace std;
+using namespace fcpp;
+using namespace component::tags;
+
+class timer {
+    typedef std::chrono::high_resolution_clock clock_t;
+    typedef std::chrono::duration<double, std::ratio<1>> second_t;
+
+    std::chrono::time_point<clock_t, second_t> beginning;
+
+  public:
+    timer() : beginning(clock_t::now()) {}
+    double elapsed() const {
+        return std::chrono::duration_cast<second_t>(clock_t::now() - beginning).count();
+    }
+};
+
+using combo = component::combine_spec<
+    component::calculus<
+        exports<
+            coordination::abf_hops_t,
+            coordination::broadcast_t<hops_t, int>,
+            coordination::sp_collection_t<hops_t, int>,
+            coordination::wave_election_t<>
+        >
+    >,
+    component::base<>
+>;
+
+// Calls some coordination routines below a given number of nested aggregate functions.
+template <typename node_t>
+int nested(node_t& node, trace_t call_point, int nesting) {
+    internal::trace_call trace_caller(node.stack_trace, call_point);
+
+    if (nesting > 0) return nested(node, 0, nesting - 1);
+    hops_t d = coordination::abf_hops(node, 1, node.uid == 0);
+    int b = coordination::broadcast(node, 2, d, int(node.uid));
+    int c = coordination::sp_collection(node, 3, d, 1, 0, [](int x, int y){
+        return x + y;
+    });
+    device_t l = coordination::wave_election(node, 4);
+    hops_t s = coordination::split(node, 5, node.uid % 2, [&](){
+        return coordination::abf_hops(node, 0, node.uid < 2);
+    });
+    return b + c + int(l) + int(s);
+}
+
+void bench(int nesting) {
+    using net_t = typename combo::net;
+    using node_t = typename combo::node;
+    net_t network{common::make_tagged_tuple<>()};
+    vector<unique_ptr<node_t>> nodes;
+    for (device_t d=0; d<DEVICES; ++d) nodes.emplace_back(new node_t(network, common::make_tagged_tuple<uid>(d)));
+    long long sum = 0;
+    double running = 0;
+    for (int r=0; r<ROUNDS; ++r) {
+        timer t;
+        for (auto& p : nodes) {
+            node_t& n = *p;
+            n.round_start(r);
+            sum += nested(n, 0, nesting);
+            n.round_end(r);
+        }
+        running += t.elapsed();
+        for (auto& p : nodes) {
+            typename node_t::message_t m;
+            p->send(r, m);
+            for (auto& o : nodes) o->receive(r, p->uid, m);
+        }
+    }
+    cout << "nesting " << nesting << ": " << running * 1e9 / (ROUNDS * DEVICES) << " ns per round" << endl;
+    if (sum == 0) cout << "unexpected" << endl;
+}
+
+int main() {
+    cout << "inline depth " << FCPP_TRACE_DEPTH << endl;
+    for (int nesting : {0, 4, 8, 32}) bench(nesting);
+}
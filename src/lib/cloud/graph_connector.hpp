@@ -187,7 +187,7 @@ struct graph_connector {
                         typename F::node *n = p.second;
                         if (n != this) {
                             common::lock_guard<parallel> l(n->mutex);
-                            n->receive(t, P::node::uid, m);
+                            n->deliver(t, P::node::uid, m);
                         }
                     }
                 } else P::node::update();
@@ -212,6 +212,12 @@ struct graph_connector {
                 receive_size(common::number_sequence<message_size>{}, d, m);
             }
 
+            //! @brief Serialises the state of the node from/to a given input/output stream.
+            template <typename S>
+            S& serialize(S& s) {
+                return P::node::serialize(s) & m_delay & m_send & m_nbr_msg_size;
+            }
+
           private: // implementation details
             //! @brief Stores the list of neighbours in the graph.
             using neighbour_list = std::unordered_map<device_t, typename F::node*>;
@@ -264,6 +270,11 @@ struct graph_connector {
                 maybe_clear(has_identifier<P>{}, *this);
             }
 
+            //! @brief A lower bound on the delay between a round and the sending of its message.
+            constexpr static times_t delay_lookahead() {
+                return distribution::lower_bound<delay_type>::value > 0 ? times_t(distribution::lower_bound<delay_type>::value) : 0;
+            }
+
           private: // implementation details
             //! @brief Returns the `randomizer` generator if available.
             template <typename N>
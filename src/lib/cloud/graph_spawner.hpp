@@ -13,6 +13,7 @@
 #include <utility>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #include "lib/component/base.hpp"
 #include "lib/component/storage.hpp"
@@ -138,11 +139,11 @@ struct graph_spawner {
 
             inline void read_nodes() {
                 attributes_tuple_type row;
+                std::vector<std::decay_t<decltype(push_time(row, typename attributes_tuple_type::tags::template intersect<tags::start>()))>> rows;
 
-                while (read_row(*m_nodesstream, row, typename attributes_tuple_type::tags{})) {
-                    auto trow = push_time(row, typename attributes_tuple_type::tags::template intersect<tags::start>());
-                    P::net::node_emplace(trow);
-                }
+                while (read_row(*m_nodesstream, row, typename attributes_tuple_type::tags{}))
+                    rows.push_back(push_time(row, typename attributes_tuple_type::tags::template intersect<tags::start>()));
+                P::net::node_emplace_bulk(rows);
             }
 
 
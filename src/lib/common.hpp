@@ -9,12 +9,20 @@
 #define FCPP_COMMON_H_
 
 #include "lib/common/algorithm.hpp"
+#include "lib/common/arena.hpp"
+#include "lib/common/flat_multitype_map.hpp"
+#include "lib/common/layout_multitype_map.hpp"
 #include "lib/common/multitype_map.hpp"
 #include "lib/common/mutex.hpp"
 #include "lib/common/ostream.hpp"
 #include "lib/common/option.hpp"
 #include "lib/common/profiler.hpp"
+#include "lib/common/quantise.hpp"
 #include "lib/common/random_access_map.hpp"
+#include "lib/common/shared_multitype_map.hpp"
+#include "lib/common/simd.hpp"
+#include "lib/common/slot_map.hpp"
+#include "lib/common/small_vector.hpp"
 #include "lib/common/tagged_tuple.hpp"
 #include "lib/common/traits.hpp"
 
@@ -10,13 +10,23 @@
 
 #include <algorithm>
 #include <iterator>
+#include <memory>
 #include <set>
 #include <type_traits>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #ifndef FCPP_DISABLE_THREADS
+#include <condition_variable>
+#include <fstream>
 #include <mutex>
+#include <sstream>
+#include <string>
 #include <thread>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 #else
 //! @cond INTERNAL
 namespace std {
@@ -96,6 +106,26 @@ namespace tags {
         size_t size;
     };
 
+    //! @brief Tag for parallel execution policy on NUMA machines, where thread `t` runs on NUMA node `t * bounds.size() / num` and first executes the tasks assigned to that node (with a given number of threads and start of the tasks of each node).
+    struct numa_execution {
+        //! @brief Constructor.
+        explicit numa_execution(size_t n, std::vector<size_t> b) : num(n), bounds(std::move(b)) {}
+        //! @brief Parallel threads number.
+        size_t num;
+        //! @brief The index of the first task assigned to each NUMA node.
+        std::vector<size_t> bounds;
+    };
+
+    //! @brief Tag for parallel execution policy where thread `t` first executes the tasks from `bounds[t]` to `bounds[t+1]` (with a given number of threads and start of the tasks of each thread).
+    struct chunked_execution {
+        //! @brief Constructor.
+        explicit chunked_execution(size_t n, std::vector<size_t> b) : num(n), bounds(std::move(b)) {}
+        //! @brief Parallel threads number.
+        size_t num;
+        //! @brief The index of the first task assigned to each thread.
+        std::vector<size_t> bounds;
+    };
+
     //! @brief Tag for distributed execution policy, assigning tasks dynamically across and within nodes through MPI (with a given number of threads per node, chunk size, static-dynamic percentage, and whether tasks should be shuffled).
     struct distributed_execution {
         //! @brief Constructor.
@@ -253,6 +283,322 @@ inline void nth_elements(E efirst, E elast, I ifirst, I ilast) {
 }
 
 
+#ifndef FCPP_DISABLE_THREADS
+/**
+ * @brief Persistent pool of worker threads, shared by the whole process.
+ *
+ * Workers are created lazily (as many as ever requested at once) and sleep between tasks
+ * until program termination, so that parallel executions do not create threads on every call.
+ * The pool runs one task at a time: nested calls are executed sequentially by the caller,
+ * while calls concurrent to a running task from unrelated threads fall back to temporary threads.
+ */
+class thread_pool {
+  public:
+    //! @brief Access to the process-wide pool.
+    static thread_pool& instance() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    //! @brief Deleted copy constructor.
+    thread_pool(thread_pool const&) = delete;
+
+    //! @brief Deleted copy assignment.
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    //! @brief Destructor joining all workers.
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> l(m_mutex);
+            m_quit = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& t : m_workers) t.join();
+    }
+
+    //! @brief Number of worker threads currently alive.
+    size_t size() {
+        std::lock_guard<std::mutex> l(m_mutex);
+        return m_workers.size();
+    }
+
+    //! @brief Whether the current thread is executing a pool task.
+    static bool inside() {
+        return active();
+    }
+
+    /**
+     * @brief Executes `f(t)` for every `t < n` on `n` distinct threads (the caller acting as thread zero).
+     *
+     * @param n The number of threads executing the function.
+     * @param f The function `void(size_t)` to be executed.
+     */
+    template <typename F>
+    void run(size_t n, F&& f) {
+        if (n <= 1 or active()) {
+            for (size_t t=0; t<n; ++t) f(t);
+            return;
+        }
+        std::unique_lock<std::mutex> busy(m_busy, std::try_to_lock);
+        if (not busy.owns_lock()) {
+            std::vector<std::thread> pool;
+            pool.reserve(n-1);
+            for (size_t t=1; t<n; ++t)
+                pool.emplace_back([t,&f] () {
+                    active() = true;
+                    f(t);
+                });
+            f(0);
+            for (std::thread& t : pool) t.join();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> l(m_mutex);
+            while (m_workers.size()+1 < n)
+                m_workers.emplace_back(&thread_pool::work, this, m_workers.size()+1, m_generation);
+            m_task = &invoke<std::remove_reference_t<F>>;
+            m_data = &f;
+            m_size = n;
+            m_pending = n-1;
+            ++m_generation;
+        }
+        m_wake.notify_all();
+        active() = true;
+        f(0);
+        active() = false;
+        std::unique_lock<std::mutex> l(m_mutex);
+        m_done.wait(l, [this](){
+            return m_pending == 0;
+        });
+    }
+
+  private:
+    //! @brief Private constructor.
+    thread_pool() = default;
+
+    //! @brief Whether the current thread is executing a pool task.
+    static bool& active() {
+        thread_local bool b = false;
+        return b;
+    }
+
+    //! @brief Type-erased call of the current task.
+    template <typename F>
+    static void invoke(void* f, size_t t) {
+        (*static_cast<F*>(f))(t);
+    }
+
+    //! @brief Main loop of worker threads.
+    void work(size_t id, size_t generation) {
+        active() = true;
+        std::unique_lock<std::mutex> l(m_mutex);
+        while (true) {
+            m_wake.wait(l, [&](){
+                return m_quit or m_generation != generation;
+            });
+            if (m_quit) return;
+            generation = m_generation;
+            if (id >= m_size) continue;
+            void (*task)(void*, size_t) = m_task;
+            void* data = m_data;
+            l.unlock();
+            task(data, id);
+            l.lock();
+            if (--m_pending == 0) m_done.notify_one();
+        }
+    }
+
+    //! @brief Mutex held while a task is running.
+    std::mutex m_busy;
+    //! @brief Mutex regulating access to the task data.
+    std::mutex m_mutex;
+    //! @brief Condition notifying workers of a new task.
+    std::condition_variable m_wake;
+    //! @brief Condition notifying the caller of task completion.
+    std::condition_variable m_done;
+    //! @brief The worker threads.
+    std::vector<std::thread> m_workers;
+    //! @brief The current task function.
+    void (*m_task)(void*, size_t) = nullptr;
+    //! @brief The current task data.
+    void* m_data = nullptr;
+    //! @brief The number of threads involved in the current task.
+    size_t m_size = 0;
+    //! @brief The number of workers which did not complete the current task.
+    size_t m_pending = 0;
+    //! @brief Counter of the tasks issued.
+    size_t m_generation = 0;
+    //! @brief Whether workers should terminate.
+    bool m_quit = false;
+};
+
+
+//! @cond INTERNAL
+namespace details {
+    //! @brief A range of indices owned by a thread, consumed from the front by the owner and from the back by thieves.
+    struct range_deque {
+        //! @brief Mutex regulating access to the range.
+        std::mutex mutex;
+        //! @brief First index in the range.
+        size_t begin;
+        //! @brief Index after the last in the range.
+        size_t end;
+        //! @brief Padding avoiding false sharing between neighbour ranges.
+        char padding[64];
+    };
+
+    //! @brief Pops up to `grain` indices from the front of a range.
+    inline bool range_pop(range_deque& r, size_t grain, size_t& b, size_t& e) {
+        std::lock_guard<std::mutex> l(r.mutex);
+        if (r.begin == r.end) return false;
+        b = r.begin;
+        e = r.begin = std::min(r.begin + grain, r.end);
+        return true;
+    }
+
+    //! @brief Moves the back half of range `v` into range `r`.
+    inline bool range_take(range_deque& v, range_deque& r) {
+        size_t b, e;
+        {
+            std::lock_guard<std::mutex> l(v.mutex);
+            if (v.begin == v.end) return false;
+            e = v.end;
+            b = v.end = v.begin + (v.end - v.begin)/2;
+        }
+        std::lock_guard<std::mutex> l(r.mutex);
+        r.begin = b;
+        r.end = e;
+        return true;
+    }
+
+    //! @brief Moves the back half of the range of another thread into the range of thread `t`.
+    inline bool range_steal(range_deque* rs, size_t n, size_t t) {
+        for (size_t k=1; k<n; ++k)
+            if (range_take(rs[(t+k)%n], rs[t])) return true;
+        return false;
+    }
+
+    //! @brief Work-stealing parallel for on the persistent thread pool.
+    template <typename F>
+    void stealing_for(size_t n, size_t len, size_t grain, F& f) {
+        std::unique_ptr<range_deque[]> rs(new range_deque[n]);
+        for (size_t t=0; t<n; ++t) {
+            rs[t].begin = len*t/n;
+            rs[t].end = len*(t+1)/n;
+        }
+        thread_pool::instance().run(n, [&] (size_t t) {
+            size_t b, e;
+            while (range_pop(rs[t], grain, b, e) or (range_steal(rs.get(), n, t) and range_pop(rs[t], grain, b, e)))
+                for (size_t i=b; i<e; ++i) f(i,t);
+        });
+    }
+
+    //! @brief Parses a list of ranges of indices as reported by the system (empty if the file is missing).
+    inline std::vector<size_t> numa_list(std::string const& path) {
+        std::vector<size_t> v;
+        std::ifstream in(path);
+        std::string item;
+        while (std::getline(in, item, ',')) {
+            size_t b, e;
+            char dash;
+            std::istringstream is(item);
+            if (not (is >> b)) continue;
+            e = (is >> dash >> e) ? e : b;
+            for (size_t c = b; c <= e; ++c) v.push_back(c);
+        }
+        return v;
+    }
+
+    //! @brief The CPUs of NUMA node `g`, as listed by the system when first needed (empty if the system reports no such node).
+    inline std::vector<size_t> const& numa_cpus(size_t g) {
+        static std::vector<std::vector<size_t>> const nodes = [](){
+            std::vector<std::vector<size_t>> v;
+            for (size_t n : numa_list("/sys/devices/system/node/possible")) {
+                if (n >= v.size()) v.resize(n+1);
+                v[n] = numa_list("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist");
+            }
+            return v;
+        }();
+        static std::vector<size_t> const none;
+        return g < nodes.size() ? nodes[g] : none;
+    }
+
+    //! @brief The NUMA node the current thread is pinned to (`size_t(-1)` if not pinned).
+    inline size_t& numa_pinned() {
+        thread_local size_t g = -1;
+        return g;
+    }
+
+#if defined(__linux__)
+    //! @brief The affinity of the current thread before it was pinned.
+    inline cpu_set_t& numa_original() {
+        thread_local cpu_set_t set;
+        return set;
+    }
+#endif
+
+    //! @brief Pins the current thread to the CPUs of NUMA node `g` within its current affinity (where supported).
+    inline void numa_pin(size_t g) {
+#if defined(__linux__)
+        cpu_set_t& original = numa_original();
+        if (pthread_getaffinity_np(pthread_self(), sizeof(original), &original) != 0) return;
+        numa_pinned() = g;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (size_t c : numa_cpus(g)) if (c < CPU_SETSIZE and CPU_ISSET(c, &original)) CPU_SET(c, &set);
+        if (CPU_COUNT(&set) > 0 and not CPU_EQUAL(&set, &original))
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        numa_pinned() = g;
+#endif
+    }
+
+    //! @brief Restores the affinity the current thread had before it was pinned (where supported).
+    inline void numa_unpin() {
+        if (numa_pinned() == size_t(-1)) return;
+        numa_pinned() = -1;
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0 and CPU_EQUAL(&set, &numa_original())) return;
+        pthread_setaffinity_np(pthread_self(), sizeof(numa_original()), &numa_original());
+#endif
+    }
+
+    //! @brief Work-stealing parallel for on the persistent thread pool, with threads split in groups (possibly pinned to NUMA nodes) stealing first within their group.
+    template <typename F>
+    void grouped_for(size_t n, std::vector<size_t> const& bounds, size_t len, size_t grain, bool pin, F& f) {
+        size_t groups = bounds.size();
+        std::unique_ptr<range_deque[]> rs(new range_deque[n]);
+        std::vector<size_t> first(groups+1, n);
+        for (size_t t=n; t>0; --t) first[(t-1)*groups/n] = t-1;
+        for (size_t g=0; g<groups; ++g) {
+            size_t b = bounds[g], e = g+1 < groups ? bounds[g+1] : len;
+            size_t k = first[g+1] - first[g];
+            for (size_t t=first[g]; t<first[g+1]; ++t) {
+                rs[t].begin = b + (e-b)*(t-first[g])/k;
+                rs[t].end = b + (e-b)*(t+1-first[g])/k;
+            }
+        }
+        thread_pool::instance().run(n, [&] (size_t t) {
+            size_t g = t*groups/n;
+            if (pin and t > 0) numa_pin(g);
+            auto steal = [&] () {
+                for (size_t u=first[g]; u<first[g+1]; ++u)
+                    if (u != t and range_take(rs[u], rs[t])) return true;
+                return range_steal(rs.get(), n, t);
+            };
+            size_t b, e;
+            while (range_pop(rs[t], grain, b, e) or (steal() and range_pop(rs[t], grain, b, e)))
+                for (size_t i=b; i<e; ++i) f(i,t);
+            if (pin and t > 0) numa_unpin();
+        });
+    }
+}
+//! @endcond
+#endif
+
+
 /**
  * @brief Bypassable parallel for (sequential version).
  *
@@ -289,7 +635,8 @@ void parallel_for(tags::parallel_execution e, size_t len, F&& f) {
  * @brief Bypassable parallel for (standard parallel version).
  *
  * Executes a function (with index and thread number as arguments) for indices up to `len`.
- * The thread numbers range from zero to `n-1`.
+ * The thread numbers range from zero to `n-1`. Indices are split in contiguous ranges among
+ * the threads of the persistent \ref thread_pool, with idle threads stealing from busy ones.
  *
  * @param e   The policy determining the number of threads to be spawned.
  * @param len The maximum index fed to the function.
@@ -297,17 +644,17 @@ void parallel_for(tags::parallel_execution e, size_t len, F&& f) {
  */
 template <typename F>
 void parallel_for(tags::parallel_execution e, size_t len, F&& f) {
-    if (e.num == 1) {
+    if (e.num == 1 or len <= 1) {
         parallel_for(tags::sequential_execution{}, len, f);
         return;
     }
-    std::vector<std::thread> pool;
-    pool.reserve(e.num);
+#ifdef FCPP_DISABLE_THREADS
     for (size_t t=0; t<std::min(e.num,len); ++t)
-        pool.emplace_back([=,&f] () {
-            for (size_t i=t; i<len; i+=e.num) f(i,t);
-        });
-    for (std::thread& t : pool) t.join();
+        for (size_t i=t; i<len; i+=e.num) f(i,t);
+#else
+    size_t n = std::min(e.num,len);
+    details::stealing_for(n, len, std::max<size_t>(len/(16*n), 1), f);
+#endif
 }
 #endif
 
@@ -333,7 +680,8 @@ void parallel_for(tags::dynamic_execution e, size_t len, F&& f) {
  * @brief Bypassable parallel for (standard parallel version with dynamic scheduling).
  *
  * Executes a function (with index and thread number as arguments) for indices up to `len`.
- * The thread numbers range from zero to `n-1`.
+ * The thread numbers range from zero to `n-1`. Threads of the persistent \ref thread_pool consume
+ * chunks of the given size from their own range, stealing half of a busy range when idle.
  *
  * @param e   The policy determining the number of threads to be spawned and chunk size.
  * @param len The maximum index fed to the function.
@@ -341,29 +689,72 @@ void parallel_for(tags::dynamic_execution e, size_t len, F&& f) {
  */
 template <typename F>
 void parallel_for(tags::dynamic_execution e, size_t len, F&& f) {
-    if (e.num == 1) {
+    if (e.num == 1 or len <= 1) {
         parallel_for(tags::sequential_execution{}, len, f);
         return;
     }
-    std::vector<std::thread> pool;
-    pool.reserve(e.num);
-    std::mutex m;
-    size_t i=0;
-    for (size_t t=0; t<std::min(e.num,len); ++t)
-        pool.emplace_back([=,&i,&f,&m] () {
-            size_t j;
-            while (true) {
-                m.lock();
-                j = i;
-                i += e.size;
-                m.unlock();
-                if (j >= len) break;
-                for (size_t k=j; k<j+e.size and k<len; ++k) f(k,t);
-            }
-        });
-    for (std::thread& t : pool) t.join();
+#ifdef FCPP_DISABLE_THREADS
+    for (size_t i=0; i<len; ++i) f(i,0);
+#else
+    details::stealing_for(std::min(e.num,len), len, std::max<size_t>(e.size, 1), f);
+#endif
+}
+#endif
+
+
+/**
+ * @brief Bypassable parallel for (NUMA-aware version).
+ *
+ * Executes a function (with index and thread number as arguments) for indices up to `len`.
+ * The thread numbers range from zero to `n-1`. Threads of the persistent \ref thread_pool (except
+ * the caller) are pinned to NUMA nodes (on Linux) for the duration of the loop, thread `t` to node `t * bounds.size() / n`,
+ * within their current affinity (which is kept if the system reports no such node), and restored to it after the loop,
+ * so that later loops run on unpinned threads. The CPUs of NUMA nodes are read from the system only once.
+ * Threads execute first the indices assigned to their node, stealing from threads of the same node and then from the others when idle.
+ *
+ * @param e   The policy determining the number of threads and the indices assigned to each NUMA node.
+ * @param len The maximum index fed to the function.
+ * @param f   The function `void(size_t,size_t)` to be executed.
+ */
+template <typename F>
+void parallel_for(tags::numa_execution const& e, size_t len, F&& f) {
+    if (e.bounds.size() <= 1 or e.num < e.bounds.size() or len <= 1) {
+        parallel_for(tags::parallel_execution(e.num), len, f);
+        return;
+    }
+#ifdef FCPP_DISABLE_THREADS
+    for (size_t i=0; i<len; ++i) f(i,0);
+#else
+    std::vector<size_t> bounds = e.bounds;
+    for (size_t& b : bounds) b = std::min(b, len);
+    details::grouped_for(e.num, bounds, len, std::max<size_t>(len/(16*e.num), 1), true, f);
+#endif
 }
+
+
+/**
+ * @brief Bypassable parallel for (chunked version).
+ *
+ * Executes a function (with index and thread number as arguments) for indices up to `len`.
+ * The thread numbers range from zero to `n-1`. Threads of the persistent \ref thread_pool execute
+ * first the contiguous chunk of indices assigned to them, stealing half of a busy range when idle.
+ *
+ * @param e   The policy determining the number of threads and the indices assigned to each thread.
+ * @param len The maximum index fed to the function.
+ * @param f   The function `void(size_t,size_t)` to be executed.
+ */
+template <typename F>
+void parallel_for(tags::chunked_execution const& e, size_t len, F&& f) {
+    if (e.num <= 1 or e.bounds.size() != e.num or len <= 1) {
+        parallel_for(tags::parallel_execution(e.num), len, f);
+        return;
+    }
+#ifdef FCPP_DISABLE_THREADS
+    for (size_t i=0; i<len; ++i) f(i,0);
+#else
+    details::grouped_for(e.num, e.bounds, len, std::max<size_t>(len/(16*e.num), 1), false, f);
 #endif
+}
 
 
 /**
@@ -411,13 +802,14 @@ void parallel_while(tags::parallel_execution e, F&& f) {
         parallel_while(tags::sequential_execution{}, f);
         return;
     }
-    std::vector<std::thread> pool;
-    pool.reserve(e.num);
+#ifdef FCPP_DISABLE_THREADS
     for (size_t t=0; t<e.num; ++t)
-        pool.emplace_back([=,&f] () {
-            for (size_t i=t; f(i,t); i+=e.num);
-        });
-    for (std::thread& t : pool) t.join();
+        for (size_t i=t; f(i,t); i+=e.num);
+#else
+    thread_pool::instance().run(e.num, [=,&f] (size_t t) {
+        for (size_t i=t; f(i,t); i+=e.num);
+    });
+#endif
 }
 #endif
 
@@ -453,23 +845,23 @@ void parallel_while(tags::dynamic_execution e, F&& f) {
         parallel_while(tags::sequential_execution{}, f);
         return;
     }
-    std::vector<std::thread> pool;
-    pool.reserve(e.num);
+#ifdef FCPP_DISABLE_THREADS
+    for (size_t i=0; f(i,0); ++i);
+#else
     std::mutex m;
     size_t i=0;
-    for (size_t t=0; t<e.num; ++t)
-        pool.emplace_back([=,&i,&f,&m] () {
-            size_t j;
-            while (true) {
-                m.lock();
-                j = i;
-                i += e.size;
-                m.unlock();
-                for (size_t k=j; k<j+e.size; ++k)
-                    if (not f(k,t)) return;
-            }
-        });
-    for (std::thread& t : pool) t.join();
+    thread_pool::instance().run(e.num, [=,&i,&f,&m] (size_t t) {
+        size_t j;
+        while (true) {
+            m.lock();
+            j = i;
+            i += e.size;
+            m.unlock();
+            for (size_t k=j; k<j+e.size; ++k)
+                if (not f(k,t)) return;
+        }
+    });
+#endif
 }
 #endif
 
@@ -0,0 +1,254 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file arena.hpp
+ * @brief Implementation of the `arena` class and the `arena_allocator<T>` class template, providing thread-local bump allocation during rounds.
+ */
+
+#ifndef FCPP_COMMON_ARENA_H_
+#define FCPP_COMMON_ARENA_H_
+
+#include <cassert>
+#include <cstddef>
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "lib/settings.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+/**
+ * @brief Namespace containing objects of common use.
+ */
+namespace common {
+
+
+/**
+ * @brief Thread-local bump arena for short-lived allocations.
+ *
+ * While the arena of a thread is \ref open "open", small allocations are served by bumping a pointer
+ * into a memory chunk owned by the thread, otherwise they are forwarded to the global allocator.
+ * Every chunk counts its live allocations, so that values escaping the arena keep it alive until they
+ * are freed, possibly by a different thread.
+ * When the arena is closed and no allocation from the current chunk is alive, the chunk is rewound.
+ *
+ * A single live allocation keeps its whole chunk (\ref chunk_size bytes), thus values outliving a round
+ * should be copied out of the arena through \ref escape before it is closed (as exports and node storage
+ * are), or built while the arena is suspended through a \ref suspend_guard (as fields sensed from
+ * neighbours are): otherwise, every value escaping may retain up to a chunk.
+ */
+class arena {
+  public:
+    //! @brief Size in bytes of a memory chunk.
+    constexpr static size_t chunk_size = size_t(1) << 16;
+
+    //! @brief Maximum size in bytes of an allocation served from a chunk.
+    constexpr static size_t max_size = chunk_size / 8;
+
+    //! @brief Opens the arena of the current thread (calls may be nested).
+    static void open() {
+        ++state().depth;
+    }
+
+    //! @brief Closes the arena of the current thread, rewinding it if no allocation is still alive.
+    static void close() {
+        thread_state& s = state();
+        assert(s.depth > 0);
+        if (--s.depth == 0 and s.current != nullptr and s.current->refs.load(std::memory_order_acquire) == 1)
+            s.offset = header_size;
+    }
+
+    //! @brief Whether the arena of the current thread is open.
+    static bool active() {
+        return state().depth > 0;
+    }
+
+    //! @brief Copies a value into memory from the global allocator, even if the arena of the current thread is open.
+    template <typename T>
+    static T escape(T const& x) {
+        suspend_guard g;
+        return T(x);
+    }
+
+    //! @brief Allocates a number of bytes, from the arena of the current thread if open.
+    static void* allocate(size_t bytes) {
+        size_t size = prefix_size + aligned(bytes);
+        thread_state& s = state();
+        char* p;
+        if (s.depth > 0 and size <= max_size) {
+            if (s.current == nullptr or s.offset + size > chunk_size) s.renew();
+            p = reinterpret_cast<char*>(s.current) + s.offset;
+            s.offset += size;
+            s.current->refs.fetch_add(1, std::memory_order_relaxed);
+            *reinterpret_cast<chunk**>(p) = s.current;
+        } else {
+            p = static_cast<char*>(::operator new(size));
+            *reinterpret_cast<chunk**>(p) = nullptr;
+        }
+        return p + prefix_size;
+    }
+
+    //! @brief Frees memory obtained through \ref allocate (from any thread).
+    static void deallocate(void* q) {
+        char* p = static_cast<char*>(q) - prefix_size;
+        chunk* c = *reinterpret_cast<chunk**>(p);
+        if (c == nullptr) ::operator delete(p);
+        else release(c);
+    }
+
+    //! @brief Number of chunks currently allocated by all threads.
+    static size_t chunks() {
+        return counter().load(std::memory_order_relaxed);
+    }
+
+    //! @brief Suspends the arena of the current thread until destruction.
+    struct suspend_guard {
+        //! @brief Constructor, suspending the arena.
+        suspend_guard() : depth(state().depth) {
+            state().depth = 0;
+        }
+
+        //! @brief Destructor, resuming the arena.
+        ~suspend_guard() {
+            state().depth = depth;
+        }
+
+        //! @brief Number of nested openings suspended.
+        size_t depth;
+    };
+
+  private:
+    //! @brief Header of a memory chunk.
+    struct chunk {
+        //! @brief Number of live allocations (plus one while the chunk is in use by its thread).
+        std::atomic<size_t> refs;
+    };
+
+    //! @brief Size of the prefix of every allocation, pointing to its chunk.
+    constexpr static size_t prefix_size = alignof(std::max_align_t);
+
+    //! @brief Size of the chunk header.
+    constexpr static size_t header_size = alignof(std::max_align_t);
+
+    //! @brief Rounds a number of bytes to the maximum alignment.
+    static size_t aligned(size_t bytes) {
+        return (bytes + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+    }
+
+    //! @brief Drops a reference to a chunk, freeing it if it was the last one.
+    static void release(chunk* c) {
+        if (c->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            c->~chunk();
+            ::operator delete(c);
+            counter().fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    //! @brief The arena state of a thread.
+    struct thread_state {
+        //! @brief Destructor, releasing the current chunk.
+        ~thread_state() {
+            if (current != nullptr) release(current);
+        }
+
+        //! @brief Replaces the current chunk with a new one.
+        void renew() {
+            if (current != nullptr) release(current);
+            current = new (::operator new(chunk_size)) chunk{};
+            current->refs.store(1, std::memory_order_relaxed);
+            offset = header_size;
+            counter().fetch_add(1, std::memory_order_relaxed);
+        }
+
+        //! @brief Number of nested openings.
+        size_t depth = 0;
+        //! @brief The chunk from which memory is currently allocated.
+        chunk* current = nullptr;
+        //! @brief The first free offset in the current chunk.
+        size_t offset = 0;
+    };
+
+    //! @brief The arena state of the current thread.
+    static thread_state& state() {
+        static thread_local thread_state s;
+        return s;
+    }
+
+    //! @brief The global counter of allocated chunks.
+    static std::atomic<size_t>& counter() {
+        static std::atomic<size_t> c{0};
+        return c;
+    }
+};
+
+
+/**
+ * @brief Allocator drawing memory from the \ref arena of the allocating thread.
+ *
+ * Memory is drawn from the arena only while it is open, and from the global allocator otherwise.
+ * It can be safely freed at any time by any thread.
+ *
+ * @param T The type of the allocated values.
+ */
+template <typename T>
+struct arena_allocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported by arena allocators");
+
+    //! @brief The type of the allocated values.
+    using value_type = T;
+
+    //! @brief Default constructor.
+    arena_allocator() = default;
+
+    //! @brief Conversion from allocators of other types.
+    template <typename U>
+    arena_allocator(arena_allocator<U> const&) {}
+
+    //! @brief Allocates memory for a number of values.
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena::allocate(n * sizeof(T)));
+    }
+
+    //! @brief Frees memory for a number of values.
+    void deallocate(T* p, size_t) {
+        arena::deallocate(p);
+    }
+
+    //! @brief Equality operator (all arena allocators are equivalent).
+    template <typename U>
+    bool operator==(arena_allocator<U> const&) const {
+        return true;
+    }
+
+    //! @brief Inequality operator (all arena allocators are equivalent).
+    template <typename U>
+    bool operator!=(arena_allocator<U> const&) const {
+        return false;
+    }
+};
+
+
+//! @brief Allocator drawing memory from the \ref arena if \ref FCPP_ROUND_ARENA is set, and from the global allocator otherwise.
+template <typename T>
+using round_allocator = std::conditional_t<FCPP_ROUND_ARENA, arena_allocator<T>, std::allocator<T>>;
+
+//! @brief Vector type drawing memory as a \ref round_allocator.
+template <typename T>
+using round_vector = std::vector<T, round_allocator<T>>;
+
+
+}
+
+
+}
+
+#endif // FCPP_COMMON_ARENA_H_
@@ -0,0 +1,572 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file flat_multitype_map.hpp
+ * @brief Implementation of the `flat_multitype_map<T, Ts...>` class template for handling heterogeneous indexed data in contiguous memory.
+ */
+
+#ifndef FCPP_COMMON_FLAT_MULTITYPE_MAP_H_
+#define FCPP_COMMON_FLAT_MULTITYPE_MAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lib/common/arena.hpp"
+#include "lib/common/tagged_tuple.hpp"
+#include "lib/common/traits.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+/**
+ * @brief Namespace containing objects of common use.
+ */
+namespace common {
+
+
+//! @cond INTERNAL
+//! @brief Stream-like object for input or output serialization (depending on `io`).
+template <bool io>
+class sstream;
+//! @endcond
+
+
+/**
+ * @brief Class for handling heterogeneous indexed data in contiguous memory.
+ *
+ * Provides the same interface as \ref multitype_map, but stores the keys in a single vector of
+ * entries sorted by key and type, and the values in a single byte buffer. Building and copying
+ * a few tens of elements is thus cheaper than with a hash map for every type. Integral keys (as
+ * trace hashes) are looked up by interpolation search, other keys by binary search.
+ * The space of erased values is reclaimed only on copy.
+ *
+ * @param T Key type.
+ * @param Ts Admissible value types.
+ */
+template <typename T, typename... Ts>
+class flat_multitype_map {
+    //! @brief Checks whether a type is supported by the map.
+    template <typename A>
+    constexpr static bool type_supported = type_count<std::remove_reference_t<A>, Ts...> != 0;
+
+  public:
+    //! @brief The type of the keys.
+    typedef T key_type;
+
+    //! @brief List of admissible types (without repetitions).
+    using value_types = type_uniq<Ts...>;
+
+    //! @brief List of map types (without repetitions).
+    using map_types = type_uniq<std::unordered_map<T, Ts>...>;
+
+    //! @name constructors
+    //! @{
+    /**
+     * @brief Default constructor (creates an empty structure).
+     */
+    flat_multitype_map() = default;
+
+    //! @brief Copy constructor.
+    flat_multitype_map(flat_multitype_map const& m) : m_index(m.m_index), m_size(0), m_scale(m.m_scale) {
+        m_data.resize(blocks(m.m_size));
+        for (entry& e : m_index) if (e.type < void_type)
+            visit(e.type, [&](auto t){
+                using A = typename decltype(t)::front;
+                size_t offset = align<A>(m_size);
+                new (ptr(offset)) A(*reinterpret_cast<A const*>(m.ptr(e.offset)));
+                e.offset = offset;
+                m_size = offset + sizeof(A);
+            });
+    }
+
+    //! @brief Move constructor.
+    flat_multitype_map(flat_multitype_map&& m) : m_index(std::move(m.m_index)), m_data(std::move(m.m_data)), m_size(m.m_size), m_scale(m.m_scale) {
+        m.m_index.clear();
+        m.m_data.clear();
+        m.m_size = 0;
+        m.m_scale = 0;
+    }
+    //! @}
+
+    //! @brief Destructor.
+    ~flat_multitype_map() {
+        destroy();
+    }
+
+    //! @name assignment operators
+    //! @{
+
+    //! @brief Copy assignment.
+    flat_multitype_map& operator=(flat_multitype_map const& m) {
+        if (this != &m) {
+            flat_multitype_map c(m);
+            swap(c);
+        }
+        return *this;
+    }
+
+    //! @brief Move assignment.
+    flat_multitype_map& operator=(flat_multitype_map&& m) {
+        if (this != &m) {
+            destroy();
+            m_index = std::move(m.m_index);
+            m_data = std::move(m.m_data);
+            m_size = m.m_size;
+            m_scale = m.m_scale;
+            m.m_index.clear();
+            m.m_data.clear();
+            m.m_size = 0;
+            m.m_scale = 0;
+        }
+        return *this;
+    }
+    //! @}
+
+    //! @brief Exchanges contents of multitype maps.
+    void swap(flat_multitype_map& m) {
+        m_index.swap(m.m_index);
+        m_data.swap(m.m_data);
+        std::swap(m_size, m.m_size);
+        std::swap(m_scale, m.m_scale);
+    }
+
+    //! @brief Equality operator.
+    bool operator==(flat_multitype_map const& o) const {
+        if (m_index.size() != o.m_index.size()) return false;
+        for (size_t i=0; i<m_index.size(); ++i) {
+            entry const& x = m_index[i];
+            entry const& y = o.m_index[i];
+            if (x.key != y.key or x.type != y.type) return false;
+            if (x.type == void_type) continue;
+            bool eq = true;
+            visit(x.type, [&](auto t){
+                using A = typename decltype(t)::front;
+                if (*reinterpret_cast<A const*>(ptr(x.offset)) != *reinterpret_cast<A const*>(o.ptr(y.offset))) eq = false;
+            });
+            if (not eq) return false;
+        }
+        return true;
+    }
+
+    //! @cond INTERNAL
+    #define MISSING_TYPE_MESSAGE "unsupported type access (add type A to exports type list)"
+    //! @endcond
+
+    //! @brief Inserts value at corresponding key.
+    template<typename A>
+    void insert(T key, A const& value) {
+        static_assert(type_supported<A>, MISSING_TYPE_MESSAGE);
+        emplace<A>(key, value);
+    }
+
+    //! @brief Inserts value at corresponding key by moving.
+    template<typename A, typename = std::enable_if_t<not std::is_reference<A>::value>>
+    void insert(T key, A&& value) {
+        static_assert(type_supported<A>, MISSING_TYPE_MESSAGE);
+        emplace<A>(key, std::move(value));
+    }
+
+    #undef MISSING_TYPE_MESSAGE
+
+    //! @brief Inserts void value at corresponding key.
+    void insert(T key) {
+        auto it = lower_bound(key, void_type);
+        if (it == m_index.end() or it->key != key or it->type != void_type) {
+            index_insert(it - m_index.begin(), entry{key, void_type, 0});
+        }
+    }
+
+    //! @brief Inserts the contents of another multitype map (without overwriting existing values).
+    void insert(flat_multitype_map const& m) {
+        for (entry const& e : m.m_index) {
+            auto it = lower_bound(e.key, e.type);
+            if (it != m_index.end() and it->key == e.key and it->type == e.type) continue;
+            size_t i = it - m_index.begin();
+            if (e.type == void_type) {
+                index_insert(i, e);
+                continue;
+            }
+            visit(e.type, [&](auto t){
+                using A = typename decltype(t)::front;
+                size_t offset = allocate<A>();
+                new (ptr(offset)) A(*reinterpret_cast<A const*>(m.ptr(e.offset)));
+                index_insert(i, entry{e.key, e.type, offset});
+            });
+        }
+    }
+
+    //! @brief Deletes value at corresponding key.
+    template<typename A>
+    void erase(T key) {
+        erase_impl<A>(key, number_sequence<type_supported<A>>{});
+    }
+
+    //! @brief Deletes void value at corresponding key.
+    void remove(T key) {
+        auto it = lower_bound(key, void_type);
+        if (it != m_index.end() and it->key == key and it->type == void_type) {
+            m_index.erase(it);
+            rescale();
+        }
+    }
+
+    //! @brief Immutable reference to the value of a certain type at a given key.
+    template<typename A>
+    A const& at(T key) const {
+        return get_value<A>(key, number_sequence<type_supported<A>>{});
+    }
+
+    //! @brief Mutable reference to the value of a certain type at a given key.
+    template<typename A>
+    A& at(T key) {
+        return const_cast<A&>(get_value<A>(key, number_sequence<type_supported<A>>{}));
+    }
+
+    //! @brief Whether the key is present in the value map or not for a certain type.
+    template<typename A>
+    bool count(T key) const {
+        return count_impl<A>(key, number_sequence<type_supported<A>>{});
+    }
+
+    //! @brief Whether the key is present in the value map or not for the void type.
+    bool contains(T key) const {
+        auto it = lower_bound(key, void_type);
+        return it != m_index.end() and it->key == key and it->type == void_type;
+    }
+
+    /**
+     * @brief Calls a function `f(key, type, ptr)` on every entry, in key order.
+     *
+     * The `type` is the index of the value type in `value_types` (or `value_types::size` for void values),
+     * and `ptr` points to the value (or is null for void values).
+     */
+    template <typename F>
+    void for_each(F&& f) const {
+        for (entry const& e : m_index)
+            f(e.key, e.type, e.type < void_type ? ptr(e.offset) : nullptr);
+    }
+
+    //! @brief Prints the content of the multitype map.
+    template <typename O, typename... Ss>
+    void print(O& o, Ss... xs) const {
+        tagged_tuple<value_types, map_types> data;
+        for (entry const& e : m_index) if (e.type < void_type)
+            visit(e.type, [&](auto t){
+                using A = typename decltype(t)::front;
+                get<A>(data)[e.key] = *reinterpret_cast<A const*>(ptr(e.offset));
+            });
+        data.print(o, xs...);
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream.
+    template <typename S>
+    S& serialize(S& s) {
+        return serialize_impl(s, number_sequence<std::is_same<S, sstream<false>>::value>{});
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream (const overload).
+    template <typename S>
+    S& serialize(S& s) const {
+        s << m_index.size();
+        for (entry const& e : m_index) {
+            s << e.key << e.type;
+            if (e.type < void_type)
+                visit(e.type, [&](auto t){
+                    using A = typename decltype(t)::front;
+                    s << *reinterpret_cast<A const*>(ptr(e.offset));
+                });
+        }
+        return s;
+    }
+
+  private:
+    //! @brief Memory block used for the value buffer.
+    using block_type = std::max_align_t;
+
+    //! @brief Number of entries allocated at the first growth of the index.
+    constexpr static size_t initial_entries = 16;
+
+    //! @brief Number of blocks allocated at the first growth of the buffer.
+    constexpr static size_t initial_blocks = 16;
+
+    //! @brief The type index used for void values.
+    constexpr static size_t void_type = value_types::size;
+
+    //! @brief An entry of the sorted index.
+    struct entry {
+        //! @brief The key.
+        T key;
+        //! @brief The index of the value type in `value_types` (`void_type` for void values).
+        size_t type;
+        //! @brief The offset of the value in the buffer.
+        size_t offset;
+    };
+
+    //! @brief Number of blocks needed to store a number of bytes.
+    static size_t blocks(size_t bytes) {
+        return (bytes + sizeof(block_type) - 1) / sizeof(block_type);
+    }
+
+    //! @brief First offset after a given one which is aligned for a type.
+    template <typename A>
+    static size_t align(size_t offset) {
+        static_assert(alignof(A) <= alignof(block_type), "over-aligned types are not supported in flat multitype maps");
+        return (offset + alignof(A) - 1) / alignof(A) * alignof(A);
+    }
+
+    //! @brief Calls a function on a type tag corresponding to a type index (no types left).
+    template <typename F>
+    static void visit(size_t, F&&, type_sequence<>) {
+        assert(false);
+    }
+
+    //! @brief Calls a function on a type tag corresponding to a type index (some types left).
+    template <typename F, typename S, typename... Ss>
+    static void visit(size_t type, F&& f, type_sequence<S, Ss...>) {
+        if (type == 0) f(type_sequence<S>{});
+        else visit(type-1, std::forward<F>(f), type_sequence<Ss...>{});
+    }
+
+    //! @brief Calls a function on a type tag corresponding to a type index.
+    template <typename F>
+    static void visit(size_t type, F&& f) {
+        visit(type, std::forward<F>(f), value_types{});
+    }
+
+    //! @brief Pointer to a given offset in the buffer.
+    void* ptr(size_t offset) {
+        return reinterpret_cast<char*>(m_data.data()) + offset;
+    }
+
+    //! @brief Const pointer to a given offset in the buffer.
+    void const* ptr(size_t offset) const {
+        return reinterpret_cast<char const*>(m_data.data()) + offset;
+    }
+
+    //! @brief Whether an entry precedes a given key and type index.
+    static bool precedes(entry const& e, T key, size_t type) {
+        return e.key < key or (e.key == key and e.type < type);
+    }
+
+    //! @brief Index of the first entry not preceding a given key and type index (integral keys).
+    size_t lower_index(T key, size_t type, std::true_type) const {
+        // interpolation guess: trace keys are hashes, thus roughly uniformly spread
+        size_t n = m_index.size();
+        if (n == 0 or not precedes(m_index[0], key, type)) return 0;
+        if (precedes(m_index[n-1], key, type)) return n;
+        size_t i = std::min(size_t((double(key) - double(m_index[0].key)) * m_scale), n-1);
+        while (i > 0 and not precedes(m_index[i], key, type)) --i;
+        while (precedes(m_index[i+1], key, type)) ++i;
+        return i+1;
+    }
+
+    //! @brief Updates the interpolation scale after changes in the index (integral keys).
+    void rescale(std::true_type) {
+        double span = m_index.empty() ? 0 : double(m_index.back().key) - double(m_index.front().key);
+        m_scale = span > 0 ? (m_index.size() - 1) / span : 0;
+    }
+
+    //! @brief Updates the interpolation scale after changes in the index (generic keys).
+    void rescale(std::false_type) {}
+
+    //! @brief Updates the interpolation scale after changes in the index.
+    void rescale() {
+        rescale(std::is_integral<T>{});
+    }
+
+    //! @brief Index of the first entry not preceding a given key and type index (generic keys).
+    size_t lower_index(T key, size_t type, std::false_type) const {
+        return std::lower_bound(m_index.begin(), m_index.end(), key, [type](entry const& e, T k){
+            return precedes(e, k, type);
+        }) - m_index.begin();
+    }
+
+    //! @brief Index of the first entry not preceding a given key and type index.
+    size_t lower_index(T key, size_t type) const {
+        return lower_index(key, type, std::is_integral<T>{});
+    }
+
+    //! @brief First entry not preceding a given key and type index.
+    typename round_vector<entry>::iterator lower_bound(T key, size_t type) {
+        return m_index.begin() + lower_index(key, type);
+    }
+
+    //! @brief First entry not preceding a given key and type index (const overload).
+    typename round_vector<entry>::const_iterator lower_bound(T key, size_t type) const {
+        return m_index.begin() + lower_index(key, type);
+    }
+
+    //! @brief Finds the entry for a key and type index, returning null if missing.
+    entry const* find(T key, size_t type) const {
+        auto it = lower_bound(key, type);
+        if (it == m_index.end() or it->key != key or it->type != type) return nullptr;
+        return &*it;
+    }
+
+    //! @brief Inserts an entry in the index at a given position.
+    void index_insert(size_t i, entry e) {
+        if (m_index.capacity() == 0) m_index.reserve(initial_entries);
+        m_index.insert(m_index.begin() + i, e);
+        rescale();
+    }
+
+    //! @brief Reserves space for a value of a type at the end of the buffer, returning its offset.
+    template <typename A>
+    size_t allocate() {
+        size_t offset = align<A>(m_size);
+        size_t size = offset + sizeof(A);
+        if (blocks(size) > m_data.size()) {
+            round_vector<block_type> data(std::max(std::max(blocks(size), 2*m_data.size()), size_t(initial_blocks)));
+            for (entry& e : m_index) if (e.type < void_type)
+                visit(e.type, [&](auto t){
+                    using B = typename decltype(t)::front;
+                    B* p = reinterpret_cast<B*>(ptr(e.offset));
+                    new (reinterpret_cast<char*>(data.data()) + e.offset) B(std::move(*p));
+                    p->~B();
+                });
+            m_data.swap(data);
+        }
+        m_size = size;
+        return offset;
+    }
+
+    //! @brief Inserts or assigns a value at corresponding key.
+    template <typename A, typename V>
+    void emplace(T key, V&& value) {
+        constexpr size_t type = value_types::template find<A>;
+        auto it = lower_bound(key, type);
+        if (it != m_index.end() and it->key == key and it->type == type) {
+            *reinterpret_cast<A*>(ptr(it->offset)) = std::forward<V>(value);
+            return;
+        }
+        size_t i = it - m_index.begin();
+        size_t offset;
+        if (blocks(align<A>(m_size) + sizeof(A)) > m_data.size()) {
+            // the value may live in the buffer being reallocated
+            A x(std::forward<V>(value));
+            offset = allocate<A>();
+            new (ptr(offset)) A(std::move(x));
+        } else {
+            offset = allocate<A>();
+            new (ptr(offset)) A(std::forward<V>(value));
+        }
+        index_insert(i, entry{key, type, offset});
+    }
+
+    //! @brief Deletes value at corresponding key (supported type).
+    template <typename A>
+    void erase_impl(T key, number_sequence<true>) {
+        auto it = lower_bound(key, value_types::template find<A>);
+        if (it == m_index.end() or it->key != key or it->type != value_types::template find<A>) return;
+        reinterpret_cast<A*>(ptr(it->offset))->~A();
+        m_index.erase(it);
+        rescale();
+    }
+
+    //! @brief Deletes value at corresponding key (unsupported type).
+    template <typename A>
+    void erase_impl(T, number_sequence<false>) {}
+
+    //! @brief Whether the key is present for a supported type.
+    template <typename A>
+    bool count_impl(T key, number_sequence<true>) const {
+        return find(key, value_types::template find<A>) != nullptr;
+    }
+
+    //! @brief Whether the key is present for an unsupported type.
+    template <typename A>
+    bool count_impl(T, number_sequence<false>) const {
+        return false;
+    }
+
+    //! @brief Access to the value of a supported type.
+    template <typename A>
+    A const& get_value(T key, number_sequence<true>) const {
+        entry const* e = find(key, value_types::template find<A>);
+        if (e == nullptr) throw std::out_of_range("flat_multitype_map::at");
+        return *reinterpret_cast<A const*>(ptr(e->offset));
+    }
+
+    //! @brief Access to the value of an unsupported type.
+    template <typename A>
+    A const& get_value(T, number_sequence<false>) const {
+        assert(false);
+        return common::declare_reference<A>();
+    }
+
+    //! @brief Serialises the content to a given output stream.
+    template <typename S>
+    S& serialize_impl(S& s, number_sequence<false>) {
+        return static_cast<flat_multitype_map const*>(this)->serialize(s);
+    }
+
+    //! @brief Serialises the content from a given input stream.
+    template <typename S>
+    S& serialize_impl(S& s, number_sequence<true>) {
+        flat_multitype_map m;
+        size_t n;
+        s >> n;
+        for (size_t i=0; i<n; ++i) {
+            T key;
+            size_t type;
+            s >> key >> type;
+            if (type == void_type) m.insert(key);
+            else visit(type, [&](auto t){
+                using A = typename decltype(t)::front;
+                A x;
+                s >> x;
+                m.template emplace<A>(key, std::move(x));
+            });
+        }
+        swap(m);
+        return s;
+    }
+
+    //! @brief Destroys all values in the buffer.
+    void destroy() {
+        for (entry const& e : m_index) if (e.type < void_type)
+            visit(e.type, [&](auto t){
+                using A = typename decltype(t)::front;
+                reinterpret_cast<A*>(ptr(e.offset))->~A();
+            });
+        m_index.clear();
+        m_size = 0;
+        m_scale = 0;
+    }
+
+    //! @brief Entries sorted by key and type index.
+    round_vector<entry> m_index;
+    //! @brief Buffer containing the values.
+    round_vector<block_type> m_data;
+    //! @brief Number of bytes used in the buffer.
+    size_t m_size = 0;
+    //! @brief Ratio between the number of entries and the span of keys, for interpolation search.
+    double m_scale = 0;
+};
+
+
+//! @brief Exchanges contents of flat multitype maps.
+template <typename T, typename... Ts>
+void swap(flat_multitype_map<T, Ts...>& x, flat_multitype_map<T, Ts...>& y) {
+    x.swap(y);
+}
+
+
+}
+
+
+}
+
+#endif // FCPP_COMMON_FLAT_MULTITYPE_MAP_H_
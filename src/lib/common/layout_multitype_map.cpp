@@ -0,0 +1,3 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include "lib/common/layout_multitype_map.hpp"
@@ -0,0 +1,609 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file layout_multitype_map.hpp
+ * @brief Implementation of the `layout_multitype_map<T, Ts...>` class template for handling heterogeneous indexed data in slots of a shared layout.
+ */
+
+#ifndef FCPP_COMMON_LAYOUT_MULTITYPE_MAP_H_
+#define FCPP_COMMON_LAYOUT_MULTITYPE_MAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lib/common/arena.hpp"
+#include "lib/common/tagged_tuple.hpp"
+#include "lib/common/traits.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+/**
+ * @brief Namespace containing objects of common use.
+ */
+namespace common {
+
+
+//! @cond INTERNAL
+//! @brief Stream-like object for input or output serialization (depending on `io`).
+template <bool io>
+class sstream;
+//! @endcond
+
+
+/**
+ * @brief Class for handling heterogeneous indexed data in slots of a layout shared between maps.
+ *
+ * Provides the same interface as \ref multitype_map. A layout lists keys and value types in the order
+ * in which they were first inserted, assigning each of them a fixed slot in a byte buffer, together
+ * with an index sorted by key and type. Maps obtained through `same_layout()` share the layout, so that
+ * inserting the same keys in the same order (as the exports of a program without recursion or
+ * spawning do in every round) writes every value directly into its slot, and copies only the values.
+ * An insertion departing from the layout makes the map switch to a layout of its own, built as
+ * insertions happen, which is then shared in turn.
+ *
+ * Slots are not computed at compile time: keys of exports are run-time hashes of the stack of call points,
+ * so that layouts can only be learned from the insertions of a round. For the same reason, serialisation
+ * writes keys and types as \ref multitype_map does, so that receivers need not share the layout.
+ *
+ * @param T Key type.
+ * @param Ts Admissible value types.
+ */
+template <typename T, typename... Ts>
+class layout_multitype_map {
+    //! @brief Checks whether a type is supported by the map.
+    template <typename A>
+    constexpr static bool type_supported = type_count<std::remove_reference_t<A>, Ts...> != 0;
+
+  public:
+    //! @brief The type of the keys.
+    typedef T key_type;
+
+    //! @brief List of admissible types (without repetitions).
+    using value_types = type_uniq<Ts...>;
+
+    //! @brief List of map types (without repetitions).
+    using map_types = type_uniq<std::unordered_map<T, Ts>...>;
+
+    //! @name constructors
+    //! @{
+    /**
+     * @brief Default constructor (creates an empty structure).
+     */
+    layout_multitype_map() = default;
+
+    //! @brief Copy constructor.
+    layout_multitype_map(layout_multitype_map const& m) : m_layout(m.m_layout) {
+        if (m.m_count == 0) return;
+        m_data.resize(blocks(m_layout->size));
+        for (; m_count < m.m_count; ++m_count) {
+            entry const& e = m_layout->order[m_count];
+            if (e.type < void_type)
+                visit(e.type, [&](auto t){
+                    using A = typename decltype(t)::front;
+                    new (ptr(e.offset)) A(*reinterpret_cast<A const*>(m.ptr(e.offset)));
+                });
+        }
+    }
+
+    //! @brief Move constructor.
+    layout_multitype_map(layout_multitype_map&& m) : m_layout(std::move(m.m_layout)), m_data(std::move(m.m_data)), m_count(m.m_count) {
+        m.m_data.clear();
+        m.m_count = 0;
+    }
+    //! @}
+
+    //! @brief Destructor.
+    ~layout_multitype_map() {
+        destroy();
+    }
+
+    //! @name assignment operators
+    //! @{
+
+    //! @brief Copy assignment.
+    layout_multitype_map& operator=(layout_multitype_map const& m) {
+        if (this != &m) {
+            layout_multitype_map c(m);
+            swap(c);
+        }
+        return *this;
+    }
+
+    //! @brief Move assignment.
+    layout_multitype_map& operator=(layout_multitype_map&& m) {
+        if (this != &m) {
+            destroy();
+            m_layout = std::move(m.m_layout);
+            m_data = std::move(m.m_data);
+            m_count = m.m_count;
+            m.m_data.clear();
+            m.m_count = 0;
+        }
+        return *this;
+    }
+    //! @}
+
+    //! @brief Exchanges contents of multitype maps.
+    void swap(layout_multitype_map& m) {
+        m_layout.swap(m.m_layout);
+        m_data.swap(m.m_data);
+        std::swap(m_count, m.m_count);
+    }
+
+    //! @brief An empty map sharing the layout of this map.
+    layout_multitype_map same_layout() const {
+        layout_multitype_map m;
+        m.m_layout = m_layout;
+        return m;
+    }
+
+    //! @brief Equality operator.
+    bool operator==(layout_multitype_map const& o) const {
+        if (m_count != o.m_count) return false;
+        for (size_t i=0; i<m_count; ++i) {
+            entry const& x = m_layout->order[i];
+            size_t j = m_layout == o.m_layout ? i : o.find(x.key, x.type);
+            if (j == npos) return false;
+            if (x.type == void_type) continue;
+            entry const& y = o.m_layout->order[j];
+            bool eq = true;
+            visit(x.type, [&](auto t){
+                using A = typename decltype(t)::front;
+                if (*reinterpret_cast<A const*>(ptr(x.offset)) != *reinterpret_cast<A const*>(o.ptr(y.offset))) eq = false;
+            });
+            if (not eq) return false;
+        }
+        return true;
+    }
+
+    //! @cond INTERNAL
+    #define MISSING_TYPE_MESSAGE "unsupported type access (add type A to exports type list)"
+    //! @endcond
+
+    //! @brief Inserts value at corresponding key.
+    template<typename A>
+    void insert(T key, A const& value) {
+        static_assert(type_supported<A>, MISSING_TYPE_MESSAGE);
+        emplace<A>(key, value);
+    }
+
+    //! @brief Inserts value at corresponding key by moving.
+    template<typename A, typename = std::enable_if_t<not std::is_reference<A>::value>>
+    void insert(T key, A&& value) {
+        static_assert(type_supported<A>, MISSING_TYPE_MESSAGE);
+        emplace<A>(key, std::move(value));
+    }
+
+    #undef MISSING_TYPE_MESSAGE
+
+    //! @brief Inserts void value at corresponding key.
+    void insert(T key) {
+        if (next_slot(key, void_type)) {
+            ++m_count;
+            return;
+        }
+        if (find(key, void_type) != npos) return;
+        diverge();
+        append(entry{key, void_type, 0}, 0);
+        ++m_count;
+    }
+
+    //! @brief Inserts the contents of another multitype map (without overwriting existing values).
+    void insert(layout_multitype_map const& m) {
+        for (size_t i=0; i<m.m_count; ++i) {
+            entry const& e = m.m_layout->order[i];
+            if (e.type == void_type) insert(e.key);
+            else if (find(e.key, e.type) == npos)
+                visit(e.type, [&](auto t){
+                    using A = typename decltype(t)::front;
+                    emplace<A>(e.key, *reinterpret_cast<A const*>(m.ptr(e.offset)));
+                });
+        }
+    }
+
+    //! @brief Deletes value at corresponding key.
+    template<typename A>
+    void erase(T key) {
+        erase_impl<A>(key, number_sequence<type_supported<A>>{});
+    }
+
+    //! @brief Deletes void value at corresponding key.
+    void remove(T key) {
+        drop(find(key, void_type));
+    }
+
+    //! @brief Immutable reference to the value of a certain type at a given key.
+    template<typename A>
+    A const& at(T key) const {
+        return get_value<A>(key, number_sequence<type_supported<A>>{});
+    }
+
+    //! @brief Mutable reference to the value of a certain type at a given key.
+    template<typename A>
+    A& at(T key) {
+        return const_cast<A&>(get_value<A>(key, number_sequence<type_supported<A>>{}));
+    }
+
+    //! @brief Whether the key is present in the value map or not for a certain type.
+    template<typename A>
+    bool count(T key) const {
+        return count_impl<A>(key, number_sequence<type_supported<A>>{});
+    }
+
+    //! @brief Whether the key is present in the value map or not for the void type.
+    bool contains(T key) const {
+        return find(key, void_type) != npos;
+    }
+
+    /**
+     * @brief Calls a function `f(key, type, ptr)` on every entry, in insertion order.
+     *
+     * The `type` is the index of the value type in `value_types` (or `value_types::size` for void values),
+     * and `ptr` points to the value (or is null for void values).
+     */
+    template <typename F>
+    void for_each(F&& f) const {
+        for (size_t i=0; i<m_count; ++i) {
+            entry const& e = m_layout->order[i];
+            f(e.key, e.type, e.type < void_type ? ptr(e.offset) : nullptr);
+        }
+    }
+
+    //! @brief Prints the content of the multitype map.
+    template <typename O, typename... Ss>
+    void print(O& o, Ss... xs) const {
+        tagged_tuple<value_types, map_types> data;
+        for (size_t i=0; i<m_count; ++i) {
+            entry const& e = m_layout->order[i];
+            if (e.type < void_type)
+                visit(e.type, [&](auto t){
+                    using A = typename decltype(t)::front;
+                    get<A>(data)[e.key] = *reinterpret_cast<A const*>(ptr(e.offset));
+                });
+        }
+        data.print(o, xs...);
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream.
+    template <typename S>
+    S& serialize(S& s) {
+        return serialize_impl(s, number_sequence<std::is_same<S, sstream<false>>::value>{});
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream (const overload).
+    template <typename S>
+    S& serialize(S& s) const {
+        s << m_count;
+        for (size_t i=0; i<m_count; ++i) {
+            entry const& e = m_layout->order[i];
+            s << e.key << e.type;
+            if (e.type < void_type)
+                visit(e.type, [&](auto t){
+                    using A = typename decltype(t)::front;
+                    s << *reinterpret_cast<A const*>(ptr(e.offset));
+                });
+        }
+        return s;
+    }
+
+  private:
+    //! @brief Memory block used for the value buffer.
+    using block_type = std::max_align_t;
+
+    //! @brief The type index used for void values.
+    constexpr static size_t void_type = value_types::size;
+
+    //! @brief Position used for missing entries.
+    constexpr static size_t npos = std::numeric_limits<size_t>::max();
+
+    //! @brief An entry of the layout.
+    struct entry {
+        //! @brief The key.
+        T key;
+        //! @brief The index of the value type in `value_types` (`void_type` for void values).
+        size_t type;
+        //! @brief The offset of the value in the buffer.
+        size_t offset;
+    };
+
+    //! @brief A layout of entries, shared between maps.
+    struct layout {
+        //! @brief Entries in insertion order.
+        std::vector<entry> order;
+        //! @brief Positions of entries in `order`, sorted by key and type index.
+        std::vector<size_t> sorted;
+        //! @brief Number of bytes needed by the buffer.
+        size_t size = 0;
+        //! @brief Ratio between the number of entries and the span of keys, for interpolation search.
+        double scale = 0;
+    };
+
+    //! @brief Number of blocks needed to store a number of bytes.
+    static size_t blocks(size_t bytes) {
+        return (bytes + sizeof(block_type) - 1) / sizeof(block_type);
+    }
+
+    //! @brief First offset after a given one which is aligned for a type.
+    template <typename A>
+    static size_t align(size_t offset) {
+        static_assert(alignof(A) <= alignof(block_type), "over-aligned types are not supported in layout multitype maps");
+        return (offset + alignof(A) - 1) / alignof(A) * alignof(A);
+    }
+
+    //! @brief Calls a function on a type tag corresponding to a type index (no types left).
+    template <typename F>
+    static void visit(size_t, F&&, type_sequence<>) {
+        assert(false);
+    }
+
+    //! @brief Calls a function on a type tag corresponding to a type index (some types left).
+    template <typename F, typename S, typename... Ss>
+    static void visit(size_t type, F&& f, type_sequence<S, Ss...>) {
+        if (type == 0) f(type_sequence<S>{});
+        else visit(type-1, std::forward<F>(f), type_sequence<Ss...>{});
+    }
+
+    //! @brief Calls a function on a type tag corresponding to a type index.
+    template <typename F>
+    static void visit(size_t type, F&& f) {
+        visit(type, std::forward<F>(f), value_types{});
+    }
+
+    //! @brief Pointer to a given offset in the buffer.
+    void* ptr(size_t offset) {
+        return reinterpret_cast<char*>(m_data.data()) + offset;
+    }
+
+    //! @brief Const pointer to a given offset in the buffer.
+    void const* ptr(size_t offset) const {
+        return reinterpret_cast<char const*>(m_data.data()) + offset;
+    }
+
+    //! @brief Whether an entry precedes a given key and type index.
+    static bool precedes(entry const& e, T key, size_t type) {
+        return e.key < key or (e.key == key and e.type < type);
+    }
+
+    //! @brief Index in `sorted` of the first entry not preceding a given key and type index (integral keys).
+    size_t lower_index(T key, size_t type, std::true_type) const {
+        // interpolation guess: trace keys are hashes, thus roughly uniformly spread
+        std::vector<entry> const& o = m_layout->order;
+        std::vector<size_t> const& s = m_layout->sorted;
+        size_t n = s.size();
+        if (n == 0 or not precedes(o[s[0]], key, type)) return 0;
+        if (precedes(o[s[n-1]], key, type)) return n;
+        size_t i = std::min(size_t((double(key) - double(o[s[0]].key)) * m_layout->scale), n-1);
+        while (i > 0 and not precedes(o[s[i]], key, type)) --i;
+        while (precedes(o[s[i+1]], key, type)) ++i;
+        return i+1;
+    }
+
+    //! @brief Index in `sorted` of the first entry not preceding a given key and type index (generic keys).
+    size_t lower_index(T key, size_t type, std::false_type) const {
+        std::vector<entry> const& o = m_layout->order;
+        return std::lower_bound(m_layout->sorted.begin(), m_layout->sorted.end(), key, [&o,type](size_t i, T k){
+            return precedes(o[i], k, type);
+        }) - m_layout->sorted.begin();
+    }
+
+    //! @brief Updates the interpolation scale of the layout (integral keys).
+    void rescale(std::true_type) {
+        std::vector<entry> const& o = m_layout->order;
+        std::vector<size_t> const& s = m_layout->sorted;
+        double span = s.empty() ? 0 : double(o[s.back()].key) - double(o[s.front()].key);
+        m_layout->scale = span > 0 ? (s.size() - 1) / span : 0;
+    }
+
+    //! @brief Updates the interpolation scale of the layout (generic keys).
+    void rescale(std::false_type) {}
+
+    //! @brief Position in insertion order of the entry for a key and type index, or `npos` if missing.
+    size_t find(T key, size_t type) const {
+        if (m_count == 0) return npos;
+        size_t i = lower_index(key, type, std::is_integral<T>{});
+        if (i == m_layout->sorted.size()) return npos;
+        size_t p = m_layout->sorted[i];
+        entry const& e = m_layout->order[p];
+        if (e.key != key or e.type != type or p >= m_count) return npos;
+        return p;
+    }
+
+    //! @brief Whether the next slot of the layout is for a given key and type index (making room for it if so).
+    bool next_slot(T key, size_t type) {
+        if (m_layout == nullptr or m_count == m_layout->order.size()) return false;
+        entry const& e = m_layout->order[m_count];
+        if (e.key != key or e.type != type) return false;
+        if (m_count == 0 and m_data.size() < blocks(m_layout->size))
+            m_data = round_vector<block_type>(blocks(m_layout->size));
+        return true;
+    }
+
+    //! @brief Makes the layout owned by this map only, and limited to the entries present.
+    void diverge() {
+        if (m_layout != nullptr and m_layout.use_count() == 1 and m_count == m_layout->order.size()) return;
+        std::shared_ptr<layout> l = std::make_shared<layout>();
+        if (m_count > 0) {
+            l->order.assign(m_layout->order.begin(), m_layout->order.begin() + m_count);
+            for (size_t p : m_layout->sorted) if (p < m_count) l->sorted.push_back(p);
+            l->size = m_layout->size;
+        }
+        m_layout = std::move(l);
+        rescale(std::is_integral<T>{});
+    }
+
+    //! @brief Appends an entry to an owned layout, growing the buffer to a given size.
+    void append(entry e, size_t size) {
+        if (blocks(size) > m_data.size()) {
+            round_vector<block_type> data(std::max(blocks(size), 2*m_data.size()));
+            for (size_t i=0; i<m_count; ++i) {
+                entry const& f = m_layout->order[i];
+                if (f.type < void_type)
+                    visit(f.type, [&](auto t){
+                        using B = typename decltype(t)::front;
+                        B* p = reinterpret_cast<B*>(ptr(f.offset));
+                        new (reinterpret_cast<char*>(data.data()) + f.offset) B(std::move(*p));
+                        p->~B();
+                    });
+            }
+            m_data.swap(data);
+        }
+        m_layout->size = std::max(m_layout->size, size);
+        size_t i = lower_index(e.key, e.type, std::is_integral<T>{});
+        m_layout->sorted.insert(m_layout->sorted.begin() + i, m_layout->order.size());
+        m_layout->order.push_back(e);
+        rescale(std::is_integral<T>{});
+    }
+
+    //! @brief Inserts or assigns a value at corresponding key.
+    template <typename A, typename V>
+    void emplace(T key, V&& value) {
+        constexpr size_t type = value_types::template find<A>;
+        if (next_slot(key, type)) {
+            new (ptr(m_layout->order[m_count].offset)) A(std::forward<V>(value));
+            ++m_count;
+            return;
+        }
+        size_t p = find(key, type);
+        if (p != npos) {
+            *reinterpret_cast<A*>(ptr(m_layout->order[p].offset)) = std::forward<V>(value);
+            return;
+        }
+        // the value may live in the buffer being reallocated
+        A x(std::forward<V>(value));
+        diverge();
+        size_t offset = align<A>(m_layout->size);
+        append(entry{key, type, offset}, offset + sizeof(A));
+        new (ptr(offset)) A(std::move(x));
+        ++m_count;
+    }
+
+    //! @brief Deletes the entry at a given position in insertion order (if not `npos`), moving the following ones to a new layout.
+    void drop(size_t p) {
+        if (p == npos) return;
+        layout_multitype_map m;
+        for (size_t i=0; i<m_count; ++i) if (i != p) {
+            entry const& e = m_layout->order[i];
+            if (e.type == void_type) m.insert(e.key);
+            else visit(e.type, [&](auto t){
+                using A = typename decltype(t)::front;
+                m.template emplace<A>(e.key, std::move(*reinterpret_cast<A*>(ptr(e.offset))));
+            });
+        }
+        swap(m);
+    }
+
+    //! @brief Deletes value at corresponding key (supported type).
+    template <typename A>
+    void erase_impl(T key, number_sequence<true>) {
+        drop(find(key, value_types::template find<A>));
+    }
+
+    //! @brief Deletes value at corresponding key (unsupported type).
+    template <typename A>
+    void erase_impl(T, number_sequence<false>) {}
+
+    //! @brief Whether the key is present for a supported type.
+    template <typename A>
+    bool count_impl(T key, number_sequence<true>) const {
+        return find(key, value_types::template find<A>) != npos;
+    }
+
+    //! @brief Whether the key is present for an unsupported type.
+    template <typename A>
+    bool count_impl(T, number_sequence<false>) const {
+        return false;
+    }
+
+    //! @brief Access to the value of a supported type.
+    template <typename A>
+    A const& get_value(T key, number_sequence<true>) const {
+        size_t p = find(key, value_types::template find<A>);
+        if (p == npos) throw std::out_of_range("layout_multitype_map::at");
+        return *reinterpret_cast<A const*>(ptr(m_layout->order[p].offset));
+    }
+
+    //! @brief Access to the value of an unsupported type.
+    template <typename A>
+    A const& get_value(T, number_sequence<false>) const {
+        assert(false);
+        return common::declare_reference<A>();
+    }
+
+    //! @brief Serialises the content to a given output stream.
+    template <typename S>
+    S& serialize_impl(S& s, number_sequence<false>) {
+        return static_cast<layout_multitype_map const*>(this)->serialize(s);
+    }
+
+    //! @brief Serialises the content from a given input stream.
+    template <typename S>
+    S& serialize_impl(S& s, number_sequence<true>) {
+        layout_multitype_map m = same_layout();
+        size_t n;
+        s >> n;
+        for (size_t i=0; i<n; ++i) {
+            T key;
+            size_t type;
+            s >> key >> type;
+            if (type == void_type) m.insert(key);
+            else visit(type, [&](auto t){
+                using A = typename decltype(t)::front;
+                A x;
+                s >> x;
+                m.template emplace<A>(key, std::move(x));
+            });
+        }
+        swap(m);
+        return s;
+    }
+
+    //! @brief Destroys all values in the buffer.
+    void destroy() {
+        for (size_t i=0; i<m_count; ++i) {
+            entry const& e = m_layout->order[i];
+            if (e.type < void_type)
+                visit(e.type, [&](auto t){
+                    using A = typename decltype(t)::front;
+                    reinterpret_cast<A*>(ptr(e.offset))->~A();
+                });
+        }
+        m_count = 0;
+    }
+
+    //! @brief The layout of the entries.
+    std::shared_ptr<layout> m_layout;
+    //! @brief Buffer containing the values.
+    round_vector<block_type> m_data;
+    //! @brief Number of entries present (the first ones of the layout).
+    size_t m_count = 0;
+};
+
+
+//! @brief Exchanges contents of layout multitype maps.
+template <typename T, typename... Ts>
+void swap(layout_multitype_map<T, Ts...>& x, layout_multitype_map<T, Ts...>& y) {
+    x.swap(y);
+}
+
+
+}
+
+
+}
+
+#endif // FCPP_COMMON_LAYOUT_MULTITYPE_MAP_H_
@@ -155,6 +155,18 @@ class multitype_map {
         return m_keys.count(key);
     }
 
+    /**
+     * @brief Calls a function `f(key, type, ptr)` on every entry.
+     *
+     * The `type` is the index of the value type in `value_types` (or `value_types::size` for void values),
+     * and `ptr` points to the value (or is null for void values).
+     */
+    template <typename F>
+    void for_each(F&& f) const {
+        for (T const& k : m_keys) f(k, size_t(value_types::size), static_cast<void const*>(nullptr));
+        multi_for_each(f, value_types{});
+    }
+
     //! @brief Prints the content of the multitype map.
     template <typename O, typename... Ss>
     void print(O& o, Ss... xs) const {
@@ -227,6 +239,18 @@ class multitype_map {
         multi_insert(m, common::type_sequence<Ss...>{});
     }
 
+    //! @brief Calls a function on every entry (empty form).
+    template <typename F>
+    inline void multi_for_each(F&, common::type_sequence<>) const {}
+
+    //! @brief Calls a function on every entry (active form).
+    template <typename F, typename S, typename... Ss>
+    inline void multi_for_each(F& f, common::type_sequence<S, Ss...>) const {
+        for (auto const& x : get<S>(m_data))
+            f(x.first, size_t(value_types::template find<S>), static_cast<void const*>(&x.second));
+        multi_for_each(f, common::type_sequence<Ss...>{});
+    }
+
     //! @brief Map associating keys to data.
     tagged_tuple<value_types, map_types> m_data;
     //! @brief Set of keys (for void data).
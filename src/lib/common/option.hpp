@@ -205,6 +205,18 @@ class option<T, true> {
         return m_data;
     }
 
+    //! @brief Serialises the content from/to a given input/output stream.
+    template <typename S>
+    S& serialize(S& s) {
+        return s & m_data;
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream (const overload).
+    template <typename S>
+    S& serialize(S& s) const {
+        return s << m_data;
+    }
+
   private:
     //! @brief The actual data stored.
     T m_data;
@@ -320,6 +332,18 @@ class option<T, 2> {
         return m_data;
     }
 
+    //! @brief Serialises the content from/to a given input/output stream.
+    template <typename S>
+    S& serialize(S& s) {
+        return s & m_data & m_some;
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream (const overload).
+    template <typename S>
+    S& serialize(S& s) const {
+        return s << m_data << m_some;
+    }
+
   private:
     //! @brief The actual data stored.
     T m_data;
@@ -20,6 +20,8 @@
 #include <vector>
 
 #include "lib/settings.hpp"
+#include "lib/common/arena.hpp"
+#include "lib/common/small_vector.hpp"
 #include "lib/common/traits.hpp"
 
 
@@ -130,14 +132,20 @@ auto const& get(tuple<Ts...> const&) noexcept;
 
 namespace details {
     template <typename T>
-    std::vector<device_t> const& get_ids(field<T> const&);
+    common::small_vector<device_t, FCPP_FIELD_INLINE + 1, common::round_allocator<device_t>> const& get_ids(field<T> const&);
     template <typename T>
-    std::vector<T> const& get_vals(field<T> const&);
+    common::small_vector<T, FCPP_FIELD_INLINE + 1, common::round_allocator<T>> const& get_vals(field<T> const&);
 }
 
 namespace common {
+    template <typename T, typename... Ts>
+    class flat_multitype_map;
+    template <typename T, typename... Ts>
+    class layout_multitype_map;
     template <typename T, typename... Ts>
     class multitype_map;
+    template <typename T, typename... Ts>
+    class shared_multitype_map;
     template <typename K, typename T, typename H, typename P, typename A>
     class random_access_map;
     template<typename S, typename T>
@@ -469,6 +477,30 @@ namespace fcpp {
 
     //! @brief Namespace containing objects of common use.
     namespace common {
+        //! @brief Printing flat multitype maps in arrowhead format.
+        template <typename O, typename T, typename... Ts, typename = if_ostream<O>>
+        O& operator<<(O& o, flat_multitype_map<T, Ts...> const& m) {
+            return fcpp::details::printable_print(o, "()", m);
+        }
+
+        //! @brief Converting flat multitype maps to strings.
+        template <typename T, typename... Ts, typename = fcpp::details::if_stringable<T, Ts...>>
+        std::string to_string(flat_multitype_map<T, Ts...> const& m) {
+            return fcpp::details::printable_stringify("()", m);
+        }
+
+        //! @brief Printing layout multitype maps in arrowhead format.
+        template <typename O, typename T, typename... Ts, typename = if_ostream<O>>
+        O& operator<<(O& o, layout_multitype_map<T, Ts...> const& m) {
+            return fcpp::details::printable_print(o, "()", m);
+        }
+
+        //! @brief Converting layout multitype maps to strings.
+        template <typename T, typename... Ts, typename = fcpp::details::if_stringable<T, Ts...>>
+        std::string to_string(layout_multitype_map<T, Ts...> const& m) {
+            return fcpp::details::printable_stringify("()", m);
+        }
+
         //! @brief Printing multitype maps in arrowhead format.
         template <typename O, typename T, typename... Ts, typename = if_ostream<O>>
         O& operator<<(O& o, multitype_map<T, Ts...> const& m) {
@@ -481,6 +513,18 @@ namespace fcpp {
             return fcpp::details::printable_stringify("()", m);
         }
 
+        //! @brief Printing shared multitype maps in arrowhead format.
+        template <typename O, typename T, typename... Ts, typename = if_ostream<O>>
+        O& operator<<(O& o, shared_multitype_map<T, Ts...> const& m) {
+            return fcpp::details::printable_print(o, "()", m);
+        }
+
+        //! @brief Converting shared multitype maps to strings.
+        template <typename T, typename... Ts, typename = fcpp::details::if_stringable<T, Ts...>>
+        std::string to_string(shared_multitype_map<T, Ts...> const& m) {
+            return fcpp::details::printable_stringify("()", m);
+        }
+
         //! @brief Printing random access maps.
         template <typename O, typename K, typename T, typename H, typename P, typename A, typename = if_ostream<O>>
         O& operator<<(O& o, random_access_map<K,T,H,P,A> const& m) {
@@ -0,0 +1,212 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file quantise.hpp
+ * @brief Implementation of reduced-precision encodings of real numbers, and of the `quantise<E, Ts...>` declaration of export types to be encoded with them.
+ */
+
+#ifndef FCPP_COMMON_QUANTISE_H_
+#define FCPP_COMMON_QUANTISE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "lib/common/traits.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+/**
+ * @brief Namespace containing objects of common use.
+ */
+namespace common {
+
+
+/**
+ * @brief Encoding of real numbers as IEEE 754 half-precision floats.
+ *
+ * Finite values are rounded to nearest with a relative error of at most 2^-11 (about 0.05%) within ±65504.
+ * Values below 6.1e-5 in absolute value lose relative precision (absolute error at most 2^-25), and values
+ * beyond ±65504 become infinite. Infinities and NaNs are preserved.
+ */
+struct fp16 {
+    //! @brief The type of encoded values.
+    typedef uint16_t wire_type;
+
+    //! @brief Encodes a real number.
+    static wire_type encode(double x) {
+        float f = float(x);
+        uint32_t b;
+        std::memcpy(&b, &f, sizeof(b));
+        uint16_t sign = (b >> 16) & 0x8000;
+        uint32_t mag = b & 0x7fffffff;
+        if (mag > 0x7f800000) return sign | 0x7e00;
+        if (mag >= 0x47800000) return sign | 0x7c00;
+        if (mag < 0x38800000) {
+            if (mag < 0x33000000) return sign;
+            uint32_t shift = 126 - (mag >> 23);
+            uint32_t m = (mag & 0x7fffff) | 0x800000;
+            uint32_t h = m >> shift, rem = m & ((uint32_t(1) << shift) - 1), half = uint32_t(1) << (shift - 1);
+            if (rem > half or (rem == half and (h & 1))) ++h;
+            return sign | h;
+        }
+        uint32_t h = (mag - 0x38000000) >> 13, rem = mag & 0x1fff;
+        if (rem > 0x1000 or (rem == 0x1000 and (h & 1))) ++h;
+        return sign | h;
+    }
+
+    //! @brief Decodes a real number.
+    static double decode(wire_type h) {
+        uint32_t sign = uint32_t(h & 0x8000) << 16, e = (h >> 10) & 0x1f, m = h & 0x3ff;
+        if (e == 0) {
+            float f = std::ldexp(float(m), -24);
+            return sign ? -f : f;
+        }
+        uint32_t b = sign | (e == 31 ? 0x7f800000 | (m << 13) : ((e + 112) << 23) | (m << 13));
+        float f;
+        std::memcpy(&f, &b, sizeof(f));
+        return f;
+    }
+};
+
+
+/**
+ * @brief Encoding of real numbers as brain floats (the upper half of an IEEE 754 single-precision float).
+ *
+ * Values are rounded to nearest with a relative error of at most 2^-8 (about 0.4%), over the whole range of
+ * single-precision floats. Infinities and NaNs are preserved.
+ */
+struct bfloat16 {
+    //! @brief The type of encoded values.
+    typedef uint16_t wire_type;
+
+    //! @brief Encodes a real number.
+    static wire_type encode(double x) {
+        float f = float(x);
+        uint32_t b;
+        std::memcpy(&b, &f, sizeof(b));
+        if ((b & 0x7fffffff) > 0x7f800000) return (b >> 16) | 0x40;
+        b += 0x7fff + ((b >> 16) & 1);
+        return b >> 16;
+    }
+
+    //! @brief Decodes a real number.
+    static double decode(wire_type h) {
+        uint32_t b = uint32_t(h) << 16;
+        float f;
+        std::memcpy(&f, &b, sizeof(f));
+        return f;
+    }
+};
+
+
+/**
+ * @brief Encoding of real numbers as integer multiples of a fixed step `num / den`.
+ *
+ * Values are rounded to the nearest multiple, with an absolute error of at most half a step, and clamped to the
+ * range of the integer type `I` (excluding its extremes). The extremes of `I` encode infinities, while NaNs are
+ * not representable and are encoded as zero.
+ *
+ * @param num The numerator of the step.
+ * @param den The denominator of the step.
+ * @param I The integer type of encoded values.
+ */
+template <intmax_t num, intmax_t den = 1, typename I = int16_t>
+struct fixed {
+    static_assert(num > 0 and den > 0, "the step of a fixed-point encoding must be positive");
+    static_assert(std::is_integral<I>::value and std::is_signed<I>::value, "fixed-point encodings require a signed integer type");
+
+    //! @brief The type of encoded values.
+    typedef I wire_type;
+
+    //! @brief Encodes a real number.
+    static wire_type encode(double x) {
+        if (std::isnan(x)) return 0;
+        if (std::isinf(x)) return x > 0 ? std::numeric_limits<I>::max() : std::numeric_limits<I>::min();
+        double y = std::round(x * den / num);
+        y = std::max(y, double(std::numeric_limits<I>::min() + 1));
+        y = std::min(y, double(std::numeric_limits<I>::max() - 1));
+        return I(y);
+    }
+
+    //! @brief Decodes a real number.
+    static double decode(wire_type h) {
+        if (h == std::numeric_limits<I>::max()) return std::numeric_limits<double>::infinity();
+        if (h == std::numeric_limits<I>::min()) return -std::numeric_limits<double>::infinity();
+        return double(h) * num / den;
+    }
+};
+
+
+/**
+ * @brief Declares types to be included in exports, and encoded on the wire through an encoding `E`.
+ *
+ * To be used at the top level of \ref component::tags::exports, where it behaves as the list of types `Ts...`,
+ * which are stored unchanged in exports. Each type in `Ts...` has to be a real type or a field of them.
+ *
+ * @param E The encoding (\ref fp16, \ref bfloat16 or \ref fixed).
+ * @param Ts The types to be encoded.
+ */
+template <typename E, typename... Ts>
+struct quantise : public type_sequence<Ts...> {};
+
+
+//! @cond INTERNAL
+namespace details {
+    //! @brief General form.
+    template <typename... Ts>
+    struct quantise_list {
+        using type = type_sequence<>;
+    };
+    //! @brief Quantise declaration argument.
+    template <typename E, typename... Ss, typename... Ts>
+    struct quantise_list<quantise<E, Ss...>, Ts...> {
+        using type = typename quantise_list<Ts...>::type::template push_front<quantise<E, Ss...>>;
+    };
+    //! @brief Other argument.
+    template <typename T, typename... Ts>
+    struct quantise_list<T, Ts...> : public quantise_list<Ts...> {};
+    //! @brief Single type sequence argument.
+    template <typename... Ts>
+    struct quantise_list<type_sequence<Ts...>> : public quantise_list<Ts...> {};
+
+    //! @brief General form (no declarations left).
+    template <typename A, typename Q>
+    struct quantise_encoding {
+        using type = void;
+    };
+    //! @brief Some declaration left.
+    template <typename A, typename E, typename... Ss, typename... Qs>
+    struct quantise_encoding<A, type_sequence<quantise<E, Ss...>, Qs...>> {
+        using type = std::conditional_t<type_count<A, Ss...> != 0, E, typename quantise_encoding<A, type_sequence<Qs...>>::type>;
+    };
+}
+//! @endcond
+
+//! @brief Extracts the quantise declarations from a sequence of types.
+template <typename... Ts>
+using quantise_list = typename details::quantise_list<Ts...>::type;
+
+//! @brief The encoding of a type according to a sequence of quantise declarations (`void` if not encoded).
+template <typename A, typename Q>
+using quantise_encoding = typename details::quantise_encoding<A, Q>::type;
+
+
+}
+
+
+//! @brief Allows usage of quantise in main namespace.
+using common::quantise;
+
+
+}
+
+#endif // FCPP_COMMON_QUANTISE_H_
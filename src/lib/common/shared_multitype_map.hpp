@@ -0,0 +1,399 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file shared_multitype_map.hpp
+ * @brief Implementation of the `shared_multitype_map<T, Ts...>` class template for handling heterogeneous indexed data with values shareable between maps.
+ */
+
+#ifndef FCPP_COMMON_SHARED_MULTITYPE_MAP_H_
+#define FCPP_COMMON_SHARED_MULTITYPE_MAP_H_
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "lib/common/arena.hpp"
+#include "lib/common/tagged_tuple.hpp"
+#include "lib/common/traits.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+/**
+ * @brief Namespace containing objects of common use.
+ */
+namespace common {
+
+
+//! @cond INTERNAL
+//! @brief Stream-like object for input or output serialization (depending on `io`).
+template <bool io>
+class sstream;
+//! @endcond
+
+
+/**
+ * @brief Class for handling heterogeneous indexed data, with values shareable between maps.
+ *
+ * Provides the same interface as \ref multitype_map, but holds every value through a shared pointer, so that
+ * copies of a map share their values, and equal values in different maps can be replaced by a single instance
+ * through \ref share (which visits only the values inserted since they were last shared). Values are copied on
+ * write when held by other maps or ever passed to \ref share, and are kept out of the \ref arena, since they may outlive the round in which they are inserted.
+ *
+ * @param T Key type.
+ * @param Ts Admissible value types.
+ */
+template <typename T, typename... Ts>
+class shared_multitype_map {
+    //! @brief Checks whether a type is supported by the map.
+    template <typename A>
+    constexpr static bool type_supported = type_count<std::remove_reference_t<A>, Ts...> != 0;
+
+  public:
+    //! @brief The type of the keys.
+    typedef T key_type;
+
+    //! @brief List of admissible types (without repetitions).
+    using value_types = type_uniq<Ts...>;
+
+    //! @brief List of map types (without repetitions).
+    using map_types = type_uniq<std::unordered_map<T, Ts>...>;
+
+    //! @name constructors
+    //! @{
+    /**
+     * @brief Default constructor (creates an empty structure).
+     */
+    shared_multitype_map() = default;
+
+    //! @brief Copy constructor (sharing the values).
+    shared_multitype_map(shared_multitype_map const&) = default;
+
+    //! @brief Move constructor.
+    shared_multitype_map(shared_multitype_map&&) = default;
+    //! @}
+
+    //! @name assignment operators
+    //! @{
+
+    //! @brief Copy assignment (sharing the values).
+    shared_multitype_map& operator=(shared_multitype_map const&) = default;
+
+    //! @brief Move assignment.
+    shared_multitype_map& operator=(shared_multitype_map&&) = default;
+    //! @}
+
+    //! @brief Exchanges contents of multitype maps.
+    void swap(shared_multitype_map& m) {
+        m_keys.swap(m.m_keys);
+        m_data.swap(m.m_data);
+        std::swap(m_shared, m.m_shared);
+    }
+
+    //! @brief Equality operator.
+    bool operator==(shared_multitype_map const& o) const {
+        return m_keys == o.m_keys and maps_compare(o, value_types{});
+    }
+
+    //! @cond INTERNAL
+    #define MISSING_TYPE_MESSAGE "unsupported type access (add type A to exports type list)"
+    //! @endcond
+
+    //! @brief Inserts value at corresponding key.
+    template<typename A>
+    void insert(T key, A const& value) {
+        static_assert(type_supported<A>, MISSING_TYPE_MESSAGE);
+        arena::suspend_guard g;
+        get_map<A>(number_sequence<type_supported<A>>{})[key] = {std::make_shared<A>(value), false};
+        m_shared = false;
+    }
+
+    //! @brief Inserts value at corresponding key by moving.
+    template<typename A, typename = std::enable_if_t<not std::is_reference<A>::value>>
+    void insert(T key, A&& value) {
+        static_assert(type_supported<A>, MISSING_TYPE_MESSAGE);
+        // values built in the arena are copied out of it instead of moved
+        bool copy = arena::active();
+        arena::suspend_guard g;
+        get_map<A>(number_sequence<type_supported<A>>{})[key] = {copy ? std::make_shared<A>(value) : std::make_shared<A>(std::move(value)), false};
+        m_shared = false;
+    }
+
+    #undef MISSING_TYPE_MESSAGE
+
+    //! @brief Inserts void value at corresponding key.
+    void insert(T key) {
+        m_keys.insert(key);
+    }
+
+    //! @brief Inserts the contents of another multitype map (sharing its values).
+    void insert(shared_multitype_map const& m) {
+        m_keys.insert(m.m_keys.begin(), m.m_keys.end());
+        multi_insert(m, value_types{});
+        m_shared = m_shared and m.m_shared;
+    }
+
+    //! @brief Deletes value at corresponding key.
+    template<typename A>
+    void erase(T key) {
+        get_map<A>(number_sequence<type_supported<A>>{}).erase(key);
+    }
+
+    //! @brief Deletes void value at corresponding key.
+    void remove(T key) {
+        m_keys.erase(key);
+    }
+
+    //! @brief Immutable reference to the value of a certain type at a given key.
+    template<typename A>
+    A const& at(T key) const {
+        return *get_map<A>(number_sequence<type_supported<A>>{}).at(key).value;
+    }
+
+    //! @brief Mutable reference to the value of a certain type at a given key (copied if held elsewhere, or ever shared).
+    template<typename A>
+    A& at(T key) {
+        item<std::remove_reference_t<A>>& x = get_map<A>(number_sequence<type_supported<A>>{}).at(key);
+        // shared values may be reached by other threads (e.g. through an intern table) even if not held elsewhere
+        if (x.shared or x.value.use_count() > 1) {
+            arena::suspend_guard g;
+            x.value = std::make_shared<std::remove_reference_t<A>>(*x.value);
+        }
+        x.shared = false;
+        m_shared = false;
+        return *x.value;
+    }
+
+    //! @brief Whether the key is present in the value map or not for a certain type.
+    template<typename A>
+    bool count(T key) const {
+        return get_map<A>(number_sequence<type_supported<A>>{}).count(key);
+    }
+
+    //! @brief Whether the key is present in the value map or not for the void type.
+    bool contains(T key) const {
+        return m_keys.count(key);
+    }
+
+    /**
+     * @brief Calls a function `f(key, type, ptr)` on every entry.
+     *
+     * The `type` is the index of the value type in `value_types` (or `value_types::size` for void values),
+     * and `ptr` points to the value (or is null for void values).
+     */
+    template <typename F>
+    void for_each(F&& f) const {
+        for (T const& k : m_keys) f(k, size_t(value_types::size), static_cast<void const*>(nullptr));
+        multi_for_each(f, value_types{});
+    }
+
+    /**
+     * @brief Calls a function `f(ptr)` on the shared pointer to every value not shared yet, which may replace it with a pointer to an equal value.
+     *
+     * Afterwards, the map counts as \ref shared until a value is inserted or accessed mutably.
+     */
+    template <typename F>
+    void share(F&& f) {
+        multi_share(f, value_types{});
+        m_shared = true;
+    }
+
+    //! @brief Whether the values have been shared through \ref share since the last insertion.
+    bool shared() const {
+        return m_shared;
+    }
+
+    //! @brief Prints the content of the multitype map.
+    template <typename O, typename... Ss>
+    void print(O& o, Ss... xs) const {
+        tagged_tuple<value_types, map_types> data;
+        multi_copy(data, value_types{});
+        data.print(o, xs...);
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream.
+    template <typename S>
+    S& serialize(S& s) {
+        return serialize_impl(s, number_sequence<std::is_same<S, sstream<false>>::value>{});
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream (const overload).
+    template <typename S>
+    S& serialize(S& s) const {
+        multi_serialize(s, value_types{});
+        return s << m_keys;
+    }
+
+  private:
+    //! @brief A value held, together with whether it has been shared.
+    template <typename A>
+    struct item {
+        //! @brief The value.
+        std::shared_ptr<A> value;
+        //! @brief Whether the value has been shared.
+        bool shared;
+    };
+
+    //! @brief List of the types of the maps holding values (without repetitions).
+    using pointer_map_types = type_uniq<std::unordered_map<T, item<Ts>>...>;
+
+    //! @brief Access to the map corresponding to a type.
+    template <typename A>
+    std::unordered_map<T, item<std::remove_reference_t<A>>>& get_map(number_sequence<true>) {
+        return get<std::remove_reference_t<A>>(m_data);
+    }
+
+    //! @brief Const access to the map corresponding to a type.
+    template <typename A>
+    std::unordered_map<T, item<std::remove_reference_t<A>>> const& get_map(number_sequence<true>) const {
+        return get<std::remove_reference_t<A>>(m_data);
+    }
+
+    //! @brief Access to a map corresponding to a missing type.
+    template <typename A>
+    std::unordered_map<T, item<std::remove_reference_t<A>>>& get_map(number_sequence<false>) const {
+        assert(false);
+        return common::declare_reference<std::unordered_map<T, item<std::remove_reference_t<A>>>>();
+    }
+
+    //! @brief Compares the values with those of another map (no types left).
+    bool maps_compare(shared_multitype_map const&, type_sequence<>) const {
+        return true;
+    }
+
+    //! @brief Compares the values with those of another map (some types left), even in case `decltype(S == S)` is not implicitly convertible to bool.
+    template <typename S, typename... Ss>
+    bool maps_compare(shared_multitype_map const& o, type_sequence<S, Ss...>) const {
+        auto const& x = get<S>(m_data);
+        auto const& y = get<S>(o.m_data);
+        if (x.size() != y.size()) return false;
+        for (auto const& xi : x) {
+            auto it = y.find(xi.first);
+            if (it == y.end()) return false;
+            if (xi.second.value != it->second.value and *xi.second.value != *it->second.value) return false;
+        }
+        return maps_compare(o, type_sequence<Ss...>{});
+    }
+
+    //! @brief Inserts the data from another multitype map (empty form).
+    inline void multi_insert(shared_multitype_map const&, type_sequence<>) {}
+
+    //! @brief Inserts the data from another multitype map (active form).
+    template <typename S, typename... Ss>
+    inline void multi_insert(shared_multitype_map const& m, type_sequence<S, Ss...>) {
+        get<S>(m_data).insert(get<S>(m.m_data).begin(), get<S>(m.m_data).end());
+        multi_insert(m, type_sequence<Ss...>{});
+    }
+
+    //! @brief Calls a function on every entry (empty form).
+    template <typename F>
+    inline void multi_for_each(F&, type_sequence<>) const {}
+
+    //! @brief Calls a function on every entry (active form).
+    template <typename F, typename S, typename... Ss>
+    inline void multi_for_each(F& f, type_sequence<S, Ss...>) const {
+        for (auto const& x : get<S>(m_data))
+            f(x.first, size_t(value_types::template find<S>), static_cast<void const*>(x.second.value.get()));
+        multi_for_each(f, type_sequence<Ss...>{});
+    }
+
+    //! @brief Calls a function on the pointer to every value (empty form).
+    template <typename F>
+    inline void multi_share(F&, type_sequence<>) {}
+
+    //! @brief Calls a function on the pointer to every value (active form).
+    template <typename F, typename S, typename... Ss>
+    inline void multi_share(F& f, type_sequence<S, Ss...>) {
+        for (auto& x : get<S>(m_data)) if (not x.second.shared) {
+            f(x.second.value);
+            x.second.shared = true;
+        }
+        multi_share(f, type_sequence<Ss...>{});
+    }
+
+    //! @brief Copies the values into maps holding them directly (empty form).
+    template <typename U>
+    inline void multi_copy(U&, type_sequence<>) const {}
+
+    //! @brief Copies the values into maps holding them directly (active form).
+    template <typename U, typename S, typename... Ss>
+    inline void multi_copy(U& data, type_sequence<S, Ss...>) const {
+        for (auto const& x : get<S>(m_data)) get<S>(data)[x.first] = *x.second.value;
+        multi_copy(data, type_sequence<Ss...>{});
+    }
+
+    //! @brief Serialises the values to a given output stream (empty form).
+    template <typename U>
+    inline void multi_serialize(U&, type_sequence<>) const {}
+
+    //! @brief Serialises the values to a given output stream (active form).
+    template <typename U, typename S, typename... Ss>
+    inline void multi_serialize(U& s, type_sequence<S, Ss...>) const {
+        s << get<S>(m_data).size();
+        for (auto const& x : get<S>(m_data)) s << x.first << *x.second.value;
+        multi_serialize(s, type_sequence<Ss...>{});
+    }
+
+    //! @brief Serialises the values from a given input stream (empty form).
+    template <typename U>
+    inline void multi_deserialize(U&, type_sequence<>) {}
+
+    //! @brief Serialises the values from a given input stream (active form).
+    template <typename U, typename S, typename... Ss>
+    inline void multi_deserialize(U& s, type_sequence<S, Ss...>) {
+        size_t n;
+        s >> n;
+        for (size_t i=0; i<n; ++i) {
+            T key;
+            std::shared_ptr<S> x = std::make_shared<S>();
+            s >> key >> *x;
+            get<S>(m_data)[key] = {std::move(x), false};
+        }
+        multi_deserialize(s, type_sequence<Ss...>{});
+    }
+
+    //! @brief Serialises the content to a given output stream.
+    template <typename S>
+    S& serialize_impl(S& s, number_sequence<false>) {
+        return static_cast<shared_multitype_map const*>(this)->serialize(s);
+    }
+
+    //! @brief Serialises the content from a given input stream.
+    template <typename S>
+    S& serialize_impl(S& s, number_sequence<true>) {
+        shared_multitype_map m;
+        m.multi_deserialize(s, value_types{});
+        s >> m.m_keys;
+        swap(m);
+        return s;
+    }
+
+    //! @brief Map associating keys to pointers to data.
+    tagged_tuple<value_types, pointer_map_types> m_data;
+    //! @brief Set of keys (for void data).
+    std::unordered_set<T> m_keys;
+    //! @brief Whether the values have been shared since the last insertion.
+    bool m_shared = false;
+};
+
+
+//! @brief Exchanges contents of multitype maps.
+template <typename T, typename... Ts>
+void swap(shared_multitype_map<T, Ts...>& x, shared_multitype_map<T, Ts...>& y) {
+    x.swap(y);
+}
+
+
+}
+
+
+}
+
+#endif // FCPP_COMMON_SHARED_MULTITYPE_MAP_H_
@@ -0,0 +1,419 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file simd.hpp
+ * @brief Implementation of vectorised kernels for arrays of real numbers.
+ */
+
+#ifndef FCPP_COMMON_SIMD_H_
+#define FCPP_COMMON_SIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <type_traits>
+
+#include "lib/settings.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+/**
+ * @brief Namespace containing objects of common use.
+ */
+namespace common {
+
+
+/**
+ * @brief Namespace containing vectorised kernels for arrays of `float` or `double`.
+ *
+ * The vector width is chosen at compile time from the target instruction set: 64 bytes with AVX-512,
+ * 32 bytes with AVX2, 16 bytes with SSE2 or NEON, and a scalar fallback otherwise (or if \ref FCPP_SIMD is false).
+ * Kernels are written through the vector extensions of GCC and Clang, which lower to the instructions of the target.
+ */
+namespace simd {
+
+
+//! @brief The width in bytes of vectors in kernels (zero for the scalar fallback).
+#if !FCPP_SIMD || !defined(__GNUC__)
+constexpr size_t width = 0;
+#elif defined(__AVX512F__)
+constexpr size_t width = 64;
+#elif defined(__AVX2__)
+constexpr size_t width = 32;
+#elif defined(__SSE2__) || defined(__ARM_NEON)
+constexpr size_t width = 16;
+#else
+constexpr size_t width = 0;
+#endif
+
+
+//! @brief Whether vectorised kernels apply to a type.
+template <typename T>
+constexpr bool supported = std::is_same<T, float>::value or std::is_same<T, double>::value;
+
+//! @brief Enables if vectorised kernels apply to a type.
+template <typename T, typename R = void>
+using if_supported = std::enable_if_t<supported<T>, R>;
+
+
+//! @cond INTERNAL
+namespace details {
+    //! @brief Vector types for a given element type (scalar fallback).
+    template <typename T, size_t w = width>
+    struct pack {
+        //! @brief The number of elements in a vector.
+        static constexpr size_t size = 1;
+        //! @brief The vector type.
+        typedef T type;
+        //! @brief The mask type.
+        typedef bool mask;
+    };
+
+#if FCPP_SIMD && defined(__GNUC__)
+    //! @brief Vector types for floats.
+    template <size_t w>
+    struct pack<float, w> {
+        static constexpr size_t size = w / sizeof(float);
+        typedef float type __attribute__((vector_size(w)));
+        typedef int32_t mask __attribute__((vector_size(w)));
+    };
+
+    //! @brief Vector types for doubles.
+    template <size_t w>
+    struct pack<double, w> {
+        static constexpr size_t size = w / sizeof(double);
+        typedef double type __attribute__((vector_size(w)));
+        typedef int64_t mask __attribute__((vector_size(w)));
+    };
+
+    //! @brief Scalar fallback for floats.
+    template <>
+    struct pack<float, 0> {
+        static constexpr size_t size = 1;
+        typedef float type;
+        typedef bool mask;
+    };
+
+    //! @brief Scalar fallback for doubles.
+    template <>
+    struct pack<double, 0> {
+        static constexpr size_t size = 1;
+        typedef double type;
+        typedef bool mask;
+    };
+#endif
+
+    //! @brief The element type of a pair of arguments (arrays or single values).
+    template <typename X, typename Y>
+    using element = std::remove_const_t<std::remove_pointer_t<std::conditional_t<std::is_pointer<X>::value, X, Y>>>;
+
+    //! @brief The vector type of an element type.
+    template <typename T>
+    using vec = typename pack<T>::type;
+
+    //! @brief The mask type of an element type.
+    template <typename T>
+    using mask = typename pack<T>::mask;
+
+    //! @brief Loads a vector from an array.
+    template <typename T>
+    inline vec<T> load(T const* p, size_t i) {
+        vec<T> v;
+        std::memcpy(&v, p + i, sizeof(v));
+        return v;
+    }
+
+    //! @brief Loads a vector from a repeated value.
+    template <typename T>
+    inline vec<T> load(T x, size_t) {
+        vec<T> v;
+        for (size_t j = 0; j < pack<T>::size; ++j) reinterpret_cast<T*>(&v)[j] = x;
+        return v;
+    }
+
+    //! @brief Stores a vector into an array.
+    template <typename T>
+    inline void store(T* p, size_t i, vec<T> v) {
+        std::memcpy(p + i, &v, sizeof(v));
+    }
+
+    //! @brief Accesses an element of an array.
+    template <typename T>
+    inline T at(T const* p, size_t i) {
+        return p[i];
+    }
+
+    //! @brief Accesses a repeated value.
+    template <typename T>
+    inline T at(T x, size_t) {
+        return x;
+    }
+
+    //! @brief Accesses a lane of a mask.
+    inline bool lane(bool m, size_t) {
+        return m;
+    }
+
+    //! @brief Accesses a lane of a mask.
+    template <typename M>
+    inline bool lane(M const& m, size_t j) {
+        return m[j] != 0;
+    }
+
+    //! @brief Selects between two values according to a mask (scalar case).
+    template <typename T>
+    inline T select(bool m, T x, T y) {
+        return m ? x : y;
+    }
+
+    //! @brief Selects between two vectors according to a mask.
+    template <typename V, typename M, typename = std::enable_if_t<not std::is_same<M, bool>::value>>
+    inline V select(M m, V x, V y) {
+        // casts between vectors of the same size reinterpret their bits
+        return (V)((m & (M)x) | (~m & (M)y));
+    }
+
+    //! @brief Sets a lane of a mask (scalar case).
+    inline void set_lane(bool& m, size_t, bool x) {
+        m = x;
+    }
+
+    //! @brief Sets a lane of a mask.
+    template <typename M>
+    inline void set_lane(M& m, size_t j, bool x) {
+        m[j] = x ? -1 : 0;
+    }
+
+    //! @brief Builds a mask from a sequence of booleans.
+    template <typename T, typename B>
+    inline mask<T> make_mask(B const& b, size_t i) {
+        mask<T> m;
+        for (size_t j = 0; j < pack<T>::size; ++j) set_lane(m, j, b[i+j]);
+        return m;
+    }
+
+}
+//! @endcond
+
+
+//! @brief Addition kernel.
+struct add {
+    template <typename V>
+    V operator()(V x, V y) const {
+        return x + y;
+    }
+};
+
+//! @brief Subtraction kernel.
+struct sub {
+    template <typename V>
+    V operator()(V x, V y) const {
+        return x - y;
+    }
+};
+
+//! @brief Multiplication kernel.
+struct mul {
+    template <typename V>
+    V operator()(V x, V y) const {
+        return x * y;
+    }
+};
+
+//! @brief Division kernel.
+struct div {
+    template <typename V>
+    V operator()(V x, V y) const {
+        return x / y;
+    }
+};
+
+//! @brief Minimum kernel (as `std::min`).
+struct min {
+    template <typename V>
+    V operator()(V x, V y) const {
+        return details::select(y < x, y, x);
+    }
+};
+
+//! @brief Maximum kernel (as `std::max`).
+struct max {
+    template <typename V>
+    V operator()(V x, V y) const {
+        return details::select(x < y, y, x);
+    }
+};
+
+//! @brief Less-than comparison kernel.
+struct less {
+    template <typename V>
+    auto operator()(V x, V y) const {
+        return x < y;
+    }
+};
+
+//! @brief Greater-than comparison kernel.
+struct greater {
+    template <typename V>
+    auto operator()(V x, V y) const {
+        return x > y;
+    }
+};
+
+//! @brief Less-or-equal comparison kernel.
+struct less_equal {
+    template <typename V>
+    auto operator()(V x, V y) const {
+        return x <= y;
+    }
+};
+
+//! @brief Greater-or-equal comparison kernel.
+struct greater_equal {
+    template <typename V>
+    auto operator()(V x, V y) const {
+        return x >= y;
+    }
+};
+
+//! @brief Equality comparison kernel.
+struct equal_to {
+    template <typename V>
+    auto operator()(V x, V y) const {
+        return x == y;
+    }
+};
+
+//! @brief Inequality comparison kernel.
+struct not_equal_to {
+    template <typename V>
+    auto operator()(V x, V y) const {
+        return x != y;
+    }
+};
+
+//! @brief Whether reductions through a kernel combine elements in vector lanes (for sums and products, only with \ref FCPP_SIMD_SUM, since their results depend on the order of combination).
+template <typename K>
+constexpr bool lane_reduce = true;
+
+//! @brief Whether reductions through the addition kernel combine elements in vector lanes.
+template <>
+constexpr bool lane_reduce<add> = FCPP_SIMD_SUM;
+
+//! @brief Whether reductions through the multiplication kernel combine elements in vector lanes.
+template <>
+constexpr bool lane_reduce<mul> = FCPP_SIMD_SUM;
+
+//! @brief Finiteness check kernel (unary).
+struct finite {
+    template <typename V>
+    auto operator()(V x) const {
+        return x - x == x - x;
+    }
+};
+
+
+/**
+ * @brief Applies an arithmetic kernel pointwise, storing the results in `r` (which may coincide with an argument).
+ *
+ * Each argument is either an array or a single value repeated.
+ */
+template <typename K, typename T, typename X, typename Y>
+if_supported<T> transform(K op, T* r, X x, Y y, size_t n) {
+    constexpr size_t w = details::pack<T>::size;
+    size_t i = 0;
+    if (w > 1) for (; i + w <= n; i += w)
+        details::store(r, i, op(details::load<T>(x, i), details::load<T>(y, i)));
+    for (; i < n; ++i) r[i] = op(details::at<T>(x, i), details::at<T>(y, i));
+}
+
+/**
+ * @brief Applies a comparison kernel pointwise, storing the results in the random-access sequence `r`.
+ *
+ * Each argument is either an array or a single value repeated.
+ */
+template <typename K, typename R, typename X, typename Y, typename T = details::element<X, Y>>
+if_supported<T> compare(K op, R& r, X x, Y y, size_t n) {
+    constexpr size_t w = details::pack<T>::size;
+    size_t i = 0;
+    if (w > 1) for (; i + w <= n; i += w) {
+        auto m = op(details::load<T>(x, i), details::load<T>(y, i));
+        for (size_t j = 0; j < w; ++j) r[i+j] = details::lane(m, j);
+    }
+    for (; i < n; ++i) r[i] = op(details::at<T>(x, i), details::at<T>(y, i));
+}
+
+//! @brief Applies a unary predicate kernel pointwise, storing the results in the random-access sequence `r`.
+template <typename K, typename T, typename R>
+if_supported<T> test(K op, R& r, T const* x, size_t n) {
+    constexpr size_t w = details::pack<T>::size;
+    size_t i = 0;
+    if (w > 1) for (; i + w <= n; i += w) {
+        auto m = op(details::load<T>(x, i));
+        for (size_t j = 0; j < w; ++j) r[i+j] = details::lane(m, j);
+    }
+    for (; i < n; ++i) r[i] = op(x[i]);
+}
+
+/**
+ * @brief Selects pointwise between two arguments according to a random-access sequence of booleans `b`.
+ *
+ * Each argument is either an array or a single value repeated.
+ */
+template <typename T, typename B, typename X, typename Y>
+if_supported<T> select(T* r, B const& b, X x, Y y, size_t n) {
+    constexpr size_t w = details::pack<T>::size;
+    size_t i = 0;
+    if (w > 1) for (; i + w <= n; i += w)
+        details::store(r, i, details::select(details::make_mask<T>(b, i), details::load<T>(x, i), details::load<T>(y, i)));
+    for (; i < n; ++i) r[i] = b[i] ? details::at<T>(x, i) : details::at<T>(y, i);
+}
+
+/**
+ * @brief Reduces an array through an associative kernel, starting from an initial value.
+ *
+ * Elements are combined in vector lanes before being reduced (if \ref lane_reduce holds for the kernel), so that the
+ * order of combination differs from a sequential fold `init = op(x[i], init)`: results of additions may differ from it
+ * in the last bits. Arrays containing NaN values are folded sequentially, as minima and maxima of them depend on the order.
+ */
+template <typename K, typename T>
+if_supported<T, T> reduce(K op, T init, T const* x, size_t n) {
+    constexpr size_t w = details::pack<T>::size;
+    size_t i = 0;
+    if (w > 1 and lane_reduce<K> and n >= w) {
+        details::vec<T> acc = details::load<T>(x, 0);
+        details::mask<T> nan = acc != acc;
+        for (i = w; i + w <= n; i += w) {
+            details::vec<T> v = details::load<T>(x, i);
+            nan |= v != v;
+            acc = op(v, acc);
+        }
+        bool found = false;
+        for (size_t j = 0; j < w; ++j) found = found or details::lane(nan, j);
+        if (found) i = 0;
+        else {
+            T lanes[w];
+            std::memcpy(lanes, &acc, sizeof(acc));
+            for (size_t j = 0; j < w; ++j) init = op(lanes[j], init);
+        }
+    }
+    for (; i < n; ++i) init = op(x[i], init);
+    return init;
+}
+
+
+}
+
+
+}
+
+
+}
+
+#endif // FCPP_COMMON_SIMD_H_
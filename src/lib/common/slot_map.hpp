@@ -0,0 +1,637 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file slot_map.hpp
+ * @brief Implementation of the `slot_map` class template storing elements in stable chunked slots with dense iteration.
+ */
+
+#ifndef FCPP_COMMON_SLOT_MAP_H_
+#define FCPP_COMMON_SLOT_MAP_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lib/common/algorithm.hpp"
+#include "lib/common/random_access_map.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+/**
+ * @brief Namespace containing objects of common use.
+ */
+namespace common {
+
+
+/**
+ * @brief Class providing an unordered map interface with integral keys, stable addresses and random access iterators.
+ *
+ * Elements are constructed in place within slots of contiguous chunks, which are never moved or freed before
+ * destruction (so that pointers to elements stay valid until they are erased). Erased slots are reused, and a
+ * generation counter per slot allows to detect stale handles. Elements are iterated through a dense array.
+ * Keys are looked up through a direct index while they are dense enough, and through a hash map otherwise.
+ *
+ * @param K Key type (integral).
+ * @param T Mapped type.
+ * @param chunk The number of slots allocated together.
+ */
+template <typename K, typename T, size_t chunk = 256>
+class slot_map {
+    static_assert(std::is_integral<K>::value, "slot maps require integral keys");
+
+  public:
+    //! @brief The key type.
+    using key_type = K;
+    //! @brief The mapped type.
+    using mapped_type = T;
+    //! @brief The value type.
+    using value_type = std::pair<key_type const, mapped_type>;
+    //! @brief Reference type.
+    using reference = value_type&;
+    //! @brief Const reference type.
+    using const_reference = value_type const&;
+    //! @brief Pointer type.
+    using pointer = value_type*;
+    //! @brief Const pointer type.
+    using const_pointer = value_type const*;
+    //! @brief The type for sizes.
+    using size_type = size_t;
+    //! @brief The type for pointer differences.
+    using difference_type = std::ptrdiff_t;
+    //! @brief The iterator type.
+    using iterator = details::iterator<typename std::vector<pointer>::iterator, value_type, difference_type, pointer, reference>;
+    //! @brief The const iterator type.
+    using const_iterator = details::iterator<typename std::vector<pointer>::const_iterator, value_type, difference_type, const_pointer, const_reference>;
+
+    //! @brief Handle to an element, invalidated by its erasure.
+    struct handle_type {
+        //! @brief The index of the slot.
+        size_t index;
+        //! @brief The generation of the slot.
+        size_t generation;
+
+        //! @brief Equality operator.
+        bool operator==(handle_type const& o) const {
+            return index == o.index and generation == o.generation;
+        }
+
+        //! @brief Inequality operator.
+        bool operator!=(handle_type const& o) const {
+            return not (*this == o);
+        }
+    };
+
+    //! @name constructors
+    //! @{
+
+    //! @brief Default constructor.
+    slot_map() = default;
+
+    //! @brief Copy constructor.
+    slot_map(slot_map const& o) {
+        for (const_reference x : o) emplace(x);
+    }
+
+    //! @brief Move constructor.
+    slot_map(slot_map&& o) {
+        swap(o);
+    }
+
+    //! @brief Range constructor.
+    template <typename I>
+    slot_map(I first, I last) {
+        insert(first, last);
+    }
+
+    //! @brief Initializer list constructor.
+    slot_map(std::initializer_list<value_type> il) {
+        insert(il.begin(), il.end());
+    }
+    //! @}
+
+    //! @brief Destructor.
+    ~slot_map() {
+        clear();
+    }
+
+    //! @name assignment operators
+    //! @{
+
+    //! @brief Copy assignment.
+    slot_map& operator=(slot_map const& o) {
+        if (this != &o) {
+            clear();
+            for (const_reference x : o) emplace(x);
+        }
+        return *this;
+    }
+
+    //! @brief Move assignment.
+    slot_map& operator=(slot_map&& o) {
+        swap(o);
+        return *this;
+    }
+
+    //! @brief Initializer list assignment.
+    slot_map& operator=(std::initializer_list<value_type> il) {
+        clear();
+        insert(il.begin(), il.end());
+        return *this;
+    }
+    //! @}
+
+    //! @brief Test whether the container is empty.
+    bool empty() const noexcept {
+        return m_dense.empty();
+    }
+
+    //! @brief Returns the number of elements in the container.
+    size_type size() const noexcept {
+        return m_dense.size();
+    }
+
+    //! @brief Reserves storage for at least `n` elements.
+    void reserve(size_type n) {
+        for (size_t i = grow(n); i < m_chunks.size() * chunk; ++i) slot_at(i).clear();
+        m_dense.reserve(n);
+        m_slots.reserve(n);
+    }
+
+    //! @brief Returns an iterator pointing to the first element in the container.
+    iterator begin() noexcept {
+        return m_dense.begin();
+    }
+
+    //! @brief Returns an iterator pointing to the first element in the container (const overload).
+    const_iterator begin() const noexcept {
+        return m_dense.begin();
+    }
+
+    //! @brief Returns a const iterator pointing to the first element in the container.
+    const_iterator cbegin() const noexcept {
+        return m_dense.begin();
+    }
+
+    //! @brief Returns an iterator pointing to the past-the-end element in the container.
+    iterator end() noexcept {
+        return m_dense.end();
+    }
+
+    //! @brief Returns an iterator pointing to the past-the-end element in the container (const overload).
+    const_iterator end() const noexcept {
+        return m_dense.end();
+    }
+
+    //! @brief Returns a const iterator pointing to the past-the-end element in the container.
+    const_iterator cend() const noexcept {
+        return m_dense.end();
+    }
+
+    //! @brief Accesses an element of the container creating one if not found.
+    mapped_type& operator[](key_type const& k) {
+        size_t i = lookup(k);
+        if (i == npos) return emplace(std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple()).first->second;
+        return element(i).second;
+    }
+
+    //! @brief Accesses an element of the container throwing if not found.
+    mapped_type& at(key_type const& k) {
+        return element(checked(k)).second;
+    }
+
+    //! @brief Accesses an element of the container throwing if not found (const overload).
+    mapped_type const& at(key_type const& k) const {
+        return element(checked(k)).second;
+    }
+
+    //! @brief Accesses an element of the container through a handle throwing if not valid.
+    mapped_type& at(handle_type const& h) {
+        return element(checked(h)).second;
+    }
+
+    //! @brief Accesses an element of the container through a handle throwing if not valid (const overload).
+    mapped_type const& at(handle_type const& h) const {
+        return element(checked(h)).second;
+    }
+
+    //! @brief Searches the container for an element with a given key, returning end if not found.
+    iterator find(key_type const& k) {
+        size_t i = lookup(k);
+        return i == npos ? end() : begin() + slot_at(i).dense;
+    }
+
+    //! @brief Searches the container for an element with a given key, returning end if not found (const overload).
+    const_iterator find(key_type const& k) const {
+        size_t i = lookup(k);
+        return i == npos ? end() : begin() + slot_at(i).dense;
+    }
+
+    //! @brief Pointer to the element with a given key, or `nullptr` if not found.
+    mapped_type* find_ptr(key_type const& k) {
+        size_t i = lookup(k);
+        return i == npos ? nullptr : &element(i).second;
+    }
+
+    //! @brief Pointer to the element with a given key, or `nullptr` if not found (const overload).
+    mapped_type const* find_ptr(key_type const& k) const {
+        size_t i = lookup(k);
+        return i == npos ? nullptr : &element(i).second;
+    }
+
+    //! @brief Counts the elements with a specific key.
+    size_type count(key_type const& k) const {
+        return lookup(k) == npos ? 0 : 1;
+    }
+
+    //! @brief Returns a handle to the element with a given key (not valid if not found).
+    handle_type handle(key_type const& k) const {
+        size_t i = lookup(k);
+        return i == npos ? handle_type{npos, 0} : handle_type{i, slot_at(i).generation};
+    }
+
+    //! @brief Whether a handle still refers to an element of the container.
+    bool valid(handle_type const& h) const {
+        return h.index < m_chunks.size() * chunk and slot_at(h.index).dense != npos and slot_at(h.index).generation == h.generation;
+    }
+
+    //! @brief Constructs and inserts an element (discarding it if its key is already present, or if its constructor throws).
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        size_t i = allocate();
+        pointer p;
+#ifndef FCPP_DISABLE_EXCEPTIONS
+        try {
+#endif
+            p = new (&slot_at(i).data) value_type(std::forward<Args>(args)...);
+#ifndef FCPP_DISABLE_EXCEPTIONS
+        } catch (...) {
+            m_free.push_back(i);
+            throw;
+        }
+#endif
+        size_t j = lookup(p->first);
+        if (j != npos) {
+            p->~value_type();
+            m_free.push_back(i);
+            return {begin() + slot_at(j).dense, false};
+        }
+        slot_at(i).dense = m_dense.size();
+        m_dense.push_back(p);
+        m_slots.push_back(i);
+        index(p->first, i, m_dense.size());
+        return {end() - 1, true};
+    }
+
+    /**
+     * @brief Constructs and inserts many elements, possibly in parallel.
+     *
+     * Keys already present (or repeated) are skipped. The element of key `keys[i]` is constructed from the
+     * tuple of arguments `args(i)`, with indices distributed among threads according to the execution policy.
+     * Slots of newly allocated chunks are first touched by the thread constructing their element (so that, with a
+     * policy pinning threads to NUMA nodes, they are placed in the memory of that node).
+     * Inserted elements follow the order of their keys in iteration. If a constructor throws, the elements
+     * constructed are destroyed, none is inserted, and the first exception is rethrown.
+     *
+     * @param e The execution policy.
+     * @param keys The keys of the elements.
+     * @param args A function `tuple(size_t)` giving the constructor arguments for each element.
+     * @return The number of elements inserted.
+     */
+    template <typename E, typename G>
+    size_type emplace_bulk(E const& e, std::vector<key_type> const& keys, G&& args) {
+        size_t n = m_dense.size() + keys.size();
+        size_t fresh = grow(n);
+        m_dense.reserve(n);
+        m_slots.reserve(n);
+        std::vector<std::pair<size_t, size_t>> todo;
+        todo.reserve(keys.size());
+        for (size_t k = 0; k < keys.size(); ++k) if (lookup(keys[k]) == npos) {
+            size_t i = allocate();
+            // the direct index is sized for the elements after the insertion
+            index(keys[k], i, n);
+            todo.emplace_back(k, i);
+        }
+#ifndef FCPP_DISABLE_EXCEPTIONS
+        std::vector<std::exception_ptr> errors(todo.size());
+#endif
+        {
+            // fresh slots left free are initialised by the calling thread
+            std::vector<bool> used(m_chunks.size() * chunk - fresh, false);
+            for (auto const& x : todo) if (x.second >= fresh) used[x.second - fresh] = true;
+            for (size_t i = fresh; i < m_chunks.size() * chunk; ++i) if (not used[i - fresh]) slot_at(i).clear();
+        }
+        parallel_for(e, todo.size(), [&](size_t j, size_t){
+#ifndef FCPP_DISABLE_EXCEPTIONS
+            try {
+#endif
+                if (todo[j].second >= fresh) slot_at(todo[j].second).clear();
+                new (&slot_at(todo[j].second).data) value_type(std::piecewise_construct, std::forward_as_tuple(keys[todo[j].first]), args(todo[j].first));
+#ifndef FCPP_DISABLE_EXCEPTIONS
+            } catch (...) {
+                errors[j] = std::current_exception();
+            }
+#endif
+        });
+#ifndef FCPP_DISABLE_EXCEPTIONS
+        auto error = std::find_if(errors.begin(), errors.end(), [](std::exception_ptr const& x){
+            return x != nullptr;
+        });
+        if (error != errors.end()) {
+            for (size_t j = 0; j < todo.size(); ++j) {
+                if (errors[j] == nullptr) slot_at(todo[j].second).data_ptr()->~value_type();
+                unindex(keys[todo[j].first]);
+                m_free.push_back(todo[j].second);
+            }
+            std::rethrow_exception(*error);
+        }
+#endif
+        for (auto const& x : todo) {
+            slot_at(x.second).dense = m_dense.size();
+            m_dense.push_back(slot_at(x.second).data_ptr());
+            m_slots.push_back(x.second);
+        }
+        return todo.size();
+    }
+
+    //! @brief Inserts new elements in the map (const value overload).
+    std::pair<iterator,bool> insert(value_type const& val) {
+        return emplace(val);
+    }
+
+    //! @brief Inserts new elements in the map (rvalue overload).
+    std::pair<iterator,bool> insert(value_type&& val) {
+        return emplace(std::move(val));
+    }
+
+    //! @brief Inserts new elements in the map (range overload).
+    template <class I>
+    void insert(I first, I last) {
+        for (I it = first; it != last; ++it) insert(*it);
+    }
+
+    //! @brief Erases elements from the map (iterator overload).
+    iterator erase(iterator position) {
+        size_t d = position - begin();
+        erase_slot(m_slots[d]);
+        return begin() + d;
+    }
+
+    //! @brief Erases elements from the map (const iterator overload).
+    iterator erase(const_iterator position) {
+        size_t d = position - cbegin();
+        erase_slot(m_slots[d]);
+        return begin() + d;
+    }
+
+    //! @brief Erases elements from the map (key overload).
+    size_type erase(key_type const& k) {
+        size_t i = lookup(k);
+        if (i == npos) return 0;
+        erase_slot(i);
+        return 1;
+    }
+
+    //! @brief Erases many elements, destroying them according to an execution policy (possibly in parallel), and returns the number of elements erased.
+    template <typename E>
+    size_type erase_bulk(E const& e, std::vector<key_type> const& keys) {
+        std::vector<size_t> todo;
+        todo.reserve(keys.size());
+        for (key_type const& k : keys) {
+            size_t i = lookup(k);
+            if (i == npos) continue;
+            unindex(k);
+            todo.push_back(i);
+        }
+        parallel_for(e, todo.size(), [&](size_t j, size_t){
+            slot_at(todo[j]).data_ptr()->~value_type();
+        });
+        for (size_t i : todo) release(i);
+        return todo.size();
+    }
+
+    //! @brief The number of keys covered by the direct index (starting from zero).
+    size_type direct_range() const noexcept {
+        return m_direct.size();
+    }
+
+    //! @brief Sorts the iteration order of the elements by a key `f(x)` (without moving them).
+    template <typename F>
+    void sort_by(F&& f) {
+        using key_t = std::decay_t<decltype(f(std::declval<const_reference>()))>;
+        std::vector<std::pair<key_t, size_t>> v;
+        v.reserve(m_dense.size());
+        for (size_t d = 0; d < m_dense.size(); ++d) v.emplace_back(f(*m_dense[d]), m_slots[d]);
+        std::sort(v.begin(), v.end());
+        for (size_t d = 0; d < v.size(); ++d) {
+            m_slots[d] = v[d].second;
+            m_dense[d] = slot_at(v[d].second).data_ptr();
+            slot_at(v[d].second).dense = d;
+        }
+    }
+
+    //! @brief Clear content.
+    void clear() noexcept {
+        for (size_t i : m_slots) {
+            slot_at(i).data_ptr()->~value_type();
+            slot_at(i).dense = npos;
+            ++slot_at(i).generation;
+        }
+        m_dense.clear();
+        m_slots.clear();
+        m_free.clear();
+        for (size_t i = m_chunks.size() * chunk; i > 0; --i) m_free.push_back(i-1);
+        m_direct.clear();
+        m_sparse.clear();
+    }
+
+    //! @brief Swaps content with another map.
+    void swap(slot_map& o) {
+        using std::swap;
+        swap(m_chunks, o.m_chunks);
+        swap(m_free,   o.m_free);
+        swap(m_dense,  o.m_dense);
+        swap(m_slots,  o.m_slots);
+        swap(m_direct, o.m_direct);
+        swap(m_sparse, o.m_sparse);
+    }
+
+    //! @brief Equality operator.
+    bool operator==(slot_map const& o) const {
+        if (size() != o.size()) return false;
+        for (const_reference x : *this) {
+            size_t i = o.lookup(x.first);
+            if (i == npos or not (o.element(i).second == x.second)) return false;
+        }
+        return true;
+    }
+
+    //! @brief Inequality operator.
+    bool operator!=(slot_map const& o) const {
+        return not (*this == o);
+    }
+
+  private:
+    //! @brief Marker for missing indices.
+    constexpr static size_t npos = size_t(-1);
+
+    //! @brief A slot holding an element.
+    struct slot {
+        //! @brief Default constructor, leaving the slot uninitialised until \ref clear (so that its memory is not touched).
+        slot() {}
+
+        //! @brief Initialises the slot as free.
+        void clear() {
+            dense = npos;
+            generation = 0;
+        }
+
+        //! @brief The position of the element in the dense array (`npos` if free).
+        size_t dense;
+        //! @brief The number of times the slot has been freed.
+        size_t generation;
+        //! @brief The storage for the element.
+        typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type data;
+
+        //! @brief The element stored.
+        pointer data_ptr() {
+            return reinterpret_cast<pointer>(&data);
+        }
+    };
+
+    //! @brief Access to a slot by index.
+    inline slot& slot_at(size_t i) const {
+        return m_chunks[i / chunk][i % chunk];
+    }
+
+    //! @brief Access to the element in a slot by index.
+    inline reference element(size_t i) const {
+        return *slot_at(i).data_ptr();
+    }
+
+    //! @brief The slot of a key (`npos` if not found).
+    inline size_t lookup(key_type const& k) const {
+        if (in_direct(k)) return m_direct[k];
+        auto it = m_sparse.find(k);
+        return it == m_sparse.end() ? npos : it->second;
+    }
+
+    //! @brief The slot of a key, throwing if not found.
+    inline size_t checked(key_type const& k) const {
+        size_t i = lookup(k);
+        if (i == npos) throw std::out_of_range("slot_map::at");
+        return i;
+    }
+
+    //! @brief The slot of a handle, throwing if not valid.
+    inline size_t checked(handle_type const& h) const {
+        if (not valid(h)) throw std::out_of_range("slot_map::at");
+        return h.index;
+    }
+
+    //! @brief Whether a key belongs to the range of the direct index.
+    inline bool in_direct(key_type const& k) const {
+        return k >= key_type(0) and size_t(k) < m_direct.size();
+    }
+
+    //! @brief Indexes a key with a given slot, extending the direct index while it is dense enough for `n` elements.
+    void index(key_type const& k, size_t i, size_t n) {
+        if (not in_direct(k) and k >= key_type(0) and size_t(k) < 2 * n + chunk) {
+            m_direct.resize(std::max(size_t(k) + 1, 2 * m_direct.size()), npos);
+            for (auto it = m_sparse.begin(); it != m_sparse.end(); )
+                if (in_direct(it->first)) {
+                    m_direct[it->first] = it->second;
+                    it = m_sparse.erase(it);
+                } else ++it;
+        }
+        if (in_direct(k)) m_direct[k] = i;
+        else m_sparse[k] = i;
+    }
+
+    /**
+     * @brief Allocates chunks for at least `n` slots, without initialising them, and returns the first new slot.
+     *
+     * New slots are freed after those already available, so that the latter are reused first.
+     */
+    size_t grow(size_t n) {
+        size_t c = m_chunks.size();
+        while (m_chunks.size() * chunk < n) m_chunks.emplace_back(new slot[chunk]);
+        std::vector<size_t> fresh;
+        for (size_t i = m_chunks.size() * chunk; i > c * chunk; --i) fresh.push_back(i-1);
+        m_free.insert(m_free.begin(), fresh.begin(), fresh.end());
+        return c * chunk;
+    }
+
+    //! @brief Returns a free slot, allocating a new chunk if needed.
+    size_t allocate() {
+        if (m_free.empty())
+            for (size_t i = grow(m_chunks.size() * chunk + 1); i < m_chunks.size() * chunk; ++i) slot_at(i).clear();
+        size_t i = m_free.back();
+        m_free.pop_back();
+        return i;
+    }
+
+    //! @brief Removes a key from the index.
+    inline void unindex(key_type const& k) {
+        if (in_direct(k)) m_direct[k] = npos;
+        else m_sparse.erase(k);
+    }
+
+    //! @brief Removes a slot (with its element already destroyed) from the dense array and frees it.
+    void release(size_t i) {
+        slot& s = slot_at(i);
+        m_dense[s.dense] = m_dense.back();
+        m_slots[s.dense] = m_slots.back();
+        slot_at(m_slots[s.dense]).dense = s.dense;
+        m_dense.pop_back();
+        m_slots.pop_back();
+        s.dense = npos;
+        ++s.generation;
+        m_free.push_back(i);
+    }
+
+    //! @brief Destroys the element in a slot and frees it.
+    void erase_slot(size_t i) {
+        unindex(slot_at(i).data_ptr()->first);
+        slot_at(i).data_ptr()->~value_type();
+        release(i);
+    }
+
+    //! @brief The chunks of slots.
+    std::vector<std::unique_ptr<slot[]>> m_chunks;
+    //! @brief The indices of free slots.
+    std::vector<size_t> m_free;
+    //! @brief Pointers to the elements in a dense array.
+    std::vector<pointer> m_dense;
+    //! @brief The slot indices of the elements in the dense array.
+    std::vector<size_t> m_slots;
+    //! @brief Slot indices by key, for keys up to a dense enough bound.
+    std::vector<size_t> m_direct;
+    //! @brief Slot indices by key, for the other keys.
+    std::unordered_map<key_type, size_t> m_sparse;
+};
+
+//! @cond INTERNAL
+template <typename K, typename T, size_t chunk>
+constexpr size_t slot_map<K, T, chunk>::npos;
+//! @endcond
+
+
+}
+
+
+}
+
+#endif // FCPP_COMMON_SLOT_MAP_H_
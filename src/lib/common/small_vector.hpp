@@ -0,0 +1,572 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file small_vector.hpp
+ * @brief Implementation of the `small_vector` class template, a vector storing a few elements inline.
+ */
+
+#ifndef FCPP_COMMON_SMALL_VECTOR_H_
+#define FCPP_COMMON_SMALL_VECTOR_H_
+
+#include <cstddef>
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+/**
+ * @brief Namespace containing objects of common use.
+ */
+namespace common {
+
+
+/**
+ * @brief Vector storing up to `N` elements inline, and drawing memory from an allocator only beyond them.
+ *
+ * Provides the interface of `std::vector` (also for `bool`, whose elements are stored as plain booleans).
+ * Moving a vector with inline elements moves them one by one, while moving a vector spilled
+ * to the heap transfers the memory. All allocators of type `A` are assumed to be equivalent.
+ *
+ * @param T The type of the elements.
+ * @param N The number of elements stored inline.
+ * @param A The allocator used for elements beyond the inline ones.
+ */
+template <typename T, size_t N, typename A = std::allocator<T>>
+class small_vector : private A {
+    //! @brief Allocator traits.
+    using traits = std::allocator_traits<A>;
+
+    //! @brief Enables if a type is an iterator.
+    template <typename I>
+    using if_iterator = std::enable_if_t<std::is_convertible<typename std::iterator_traits<I>::iterator_category, std::input_iterator_tag>::value>;
+
+  public:
+    //! @name standard member types
+    //! @{
+    using value_type = T;
+    using allocator_type = A;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = T const&;
+    using pointer = T*;
+    using const_pointer = T const*;
+    using iterator = T*;
+    using const_iterator = T const*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    //! @}
+
+    //! @brief The number of elements stored inline.
+    static constexpr size_t inline_capacity = N;
+
+    //! @name constructors
+    //! @{
+    //! @brief Default constructor.
+    small_vector() noexcept : m_data(inline_data()), m_size(0), m_capacity(N) {}
+
+    //! @brief Constructor with a number of default-constructed elements.
+    explicit small_vector(size_t n) : small_vector() {
+        resize(n);
+    }
+
+    //! @brief Constructor with a number of copies of an element.
+    small_vector(size_t n, T const& x) : small_vector() {
+        assign(n, x);
+    }
+
+    //! @brief Constructor from a range of elements.
+    template <typename I, typename = if_iterator<I>>
+    small_vector(I first, I last) : small_vector() {
+        assign(first, last);
+    }
+
+    //! @brief Constructor from an initializer list.
+    small_vector(std::initializer_list<T> l) : small_vector() {
+        assign(l.begin(), l.end());
+    }
+
+    //! @brief Copy constructor.
+    small_vector(small_vector const& v) : small_vector() {
+        assign(v.begin(), v.end());
+    }
+
+    //! @brief Move constructor.
+    small_vector(small_vector&& v) noexcept : small_vector() {
+        steal(v);
+    }
+
+    //! @brief Constructor from a standard vector.
+    template <typename B>
+    small_vector(std::vector<T, B> const& v) : small_vector() {
+        assign(v.begin(), v.end());
+    }
+
+    //! @brief Destructor.
+    ~small_vector() {
+        clear();
+        release();
+    }
+    //! @}
+
+    //! @name assignment operators
+    //! @{
+    //! @brief Copy assignment.
+    small_vector& operator=(small_vector const& v) {
+        if (this != &v) assign(v.begin(), v.end());
+        return *this;
+    }
+
+    //! @brief Move assignment.
+    small_vector& operator=(small_vector&& v) noexcept {
+        if (this != &v) {
+            clear();
+            release();
+            steal(v);
+        }
+        return *this;
+    }
+
+    //! @brief Assignment from an initializer list.
+    small_vector& operator=(std::initializer_list<T> l) {
+        assign(l.begin(), l.end());
+        return *this;
+    }
+
+    //! @brief Replaces the content with a number of copies of an element.
+    void assign(size_t n, T const& x) {
+        T y(x);
+        clear();
+        reserve(n);
+        for (; m_size < n; ++m_size) construct(m_data + m_size, y);
+    }
+
+    //! @brief Replaces the content with a range of elements.
+    template <typename I, typename = if_iterator<I>>
+    void assign(I first, I last) {
+        clear();
+        insert(end(), first, last);
+    }
+
+    //! @brief Replaces the content with an initializer list.
+    void assign(std::initializer_list<T> l) {
+        assign(l.begin(), l.end());
+    }
+    //! @}
+
+    //! @brief Returns the allocator.
+    allocator_type get_allocator() const {
+        return *this;
+    }
+
+    //! @name element access
+    //! @{
+    //! @brief Access with bounds checking.
+    T& at(size_t i) {
+        if (i >= m_size) throw std::out_of_range("small_vector::at");
+        return m_data[i];
+    }
+
+    //! @brief Const access with bounds checking.
+    T const& at(size_t i) const {
+        if (i >= m_size) throw std::out_of_range("small_vector::at");
+        return m_data[i];
+    }
+
+    //! @brief Access.
+    T& operator[](size_t i) {
+        return m_data[i];
+    }
+
+    //! @brief Const access.
+    T const& operator[](size_t i) const {
+        return m_data[i];
+    }
+
+    //! @brief Access to the first element.
+    T& front() {
+        return m_data[0];
+    }
+
+    //! @brief Const access to the first element.
+    T const& front() const {
+        return m_data[0];
+    }
+
+    //! @brief Access to the last element.
+    T& back() {
+        return m_data[m_size-1];
+    }
+
+    //! @brief Const access to the last element.
+    T const& back() const {
+        return m_data[m_size-1];
+    }
+
+    //! @brief Access to the underlying array.
+    T* data() noexcept {
+        return m_data;
+    }
+
+    //! @brief Const access to the underlying array.
+    T const* data() const noexcept {
+        return m_data;
+    }
+    //! @}
+
+    //! @name iterators
+    //! @{
+    iterator begin() noexcept {
+        return m_data;
+    }
+    const_iterator begin() const noexcept {
+        return m_data;
+    }
+    const_iterator cbegin() const noexcept {
+        return m_data;
+    }
+    iterator end() noexcept {
+        return m_data + m_size;
+    }
+    const_iterator end() const noexcept {
+        return m_data + m_size;
+    }
+    const_iterator cend() const noexcept {
+        return m_data + m_size;
+    }
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator crbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+    const_reverse_iterator crend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+    //! @}
+
+    //! @name capacity
+    //! @{
+    //! @brief Whether the vector is empty.
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    //! @brief The number of elements.
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+    //! @brief The maximum number of elements.
+    size_t max_size() const noexcept {
+        return traits::max_size(*this);
+    }
+
+    //! @brief Reserves space for a number of elements.
+    void reserve(size_t n) {
+        if (n > m_capacity) reallocate(n);
+    }
+
+    //! @brief The number of elements that can be held without reallocating.
+    size_t capacity() const noexcept {
+        return m_capacity;
+    }
+
+    //! @brief Moves the elements inline if they fit, releasing memory otherwise unused.
+    void shrink_to_fit() {
+        if (m_data != inline_data() and m_size < m_capacity) reallocate(m_size);
+    }
+
+    //! @brief Whether the elements are stored inline.
+    bool is_inline() const noexcept {
+        return m_data == inline_data();
+    }
+    //! @}
+
+    //! @name modifiers
+    //! @{
+    //! @brief Removes all elements (keeping capacity).
+    void clear() noexcept {
+        for (size_t i = 0; i < m_size; ++i) m_data[i].~T();
+        m_size = 0;
+    }
+
+    //! @brief Inserts a copy of an element before a position.
+    iterator insert(const_iterator pos, T const& x) {
+        return emplace(pos, x);
+    }
+
+    //! @brief Inserts an element before a position.
+    iterator insert(const_iterator pos, T&& x) {
+        return emplace(pos, std::move(x));
+    }
+
+    //! @brief Inserts a number of copies of an element before a position.
+    iterator insert(const_iterator pos, size_t n, T const& x) {
+        size_t i = pos - m_data, s = m_size;
+        T y(x);
+        reserve(m_size + n);
+        for (; m_size < s + n; ++m_size) construct(m_data + m_size, y);
+        std::rotate(m_data + i, m_data + s, m_data + m_size);
+        return m_data + i;
+    }
+
+    //! @brief Inserts a range of elements before a position.
+    template <typename I, typename = if_iterator<I>>
+    iterator insert(const_iterator pos, I first, I last) {
+        size_t i = pos - m_data, s = m_size;
+        reserve_range(first, last, typename std::iterator_traits<I>::iterator_category{});
+        for (; first != last; ++first) emplace_back(*first);
+        std::rotate(m_data + i, m_data + s, m_data + m_size);
+        return m_data + i;
+    }
+
+    //! @brief Inserts an initializer list before a position.
+    iterator insert(const_iterator pos, std::initializer_list<T> l) {
+        return insert(pos, l.begin(), l.end());
+    }
+
+    //! @brief Constructs an element in place before a position.
+    template <typename... Ts>
+    iterator emplace(const_iterator pos, Ts&&... xs) {
+        size_t i = pos - m_data;
+        if (i == m_size) {
+            emplace_back(std::forward<Ts>(xs)...);
+            return m_data + i;
+        }
+        T x(std::forward<Ts>(xs)...);
+        if (m_size == m_capacity) reallocate(grown());
+        construct(m_data + m_size, std::move(m_data[m_size-1]));
+        std::move_backward(m_data + i, m_data + m_size - 1, m_data + m_size);
+        m_data[i] = std::move(x);
+        ++m_size;
+        return m_data + i;
+    }
+
+    //! @brief Removes the element at a position.
+    iterator erase(const_iterator pos) {
+        return erase(pos, pos + 1);
+    }
+
+    //! @brief Removes the elements in a range.
+    iterator erase(const_iterator first, const_iterator last) {
+        T* f = m_data + (first - m_data);
+        T* e = std::move(m_data + (last - m_data), end(), f);
+        for (T* p = e; p != end(); ++p) p->~T();
+        m_size = e - m_data;
+        return f;
+    }
+
+    //! @brief Appends a copy of an element.
+    void push_back(T const& x) {
+        emplace_back(x);
+    }
+
+    //! @brief Appends an element.
+    void push_back(T&& x) {
+        emplace_back(std::move(x));
+    }
+
+    //! @brief Constructs an element in place at the end.
+    template <typename... Ts>
+    T& emplace_back(Ts&&... xs) {
+        if (m_size == m_capacity) {
+            // the arguments may refer to elements of the vector
+            T x(std::forward<Ts>(xs)...);
+            reallocate(grown());
+            construct(m_data + m_size, std::move(x));
+        } else construct(m_data + m_size, std::forward<Ts>(xs)...);
+        return m_data[m_size++];
+    }
+
+    //! @brief Removes the last element.
+    void pop_back() {
+        m_data[--m_size].~T();
+    }
+
+    //! @brief Resizes the vector, default-constructing new elements.
+    void resize(size_t n) {
+        if (n < m_size) erase(begin() + n, end());
+        else {
+            reserve(n);
+            for (; m_size < n; ++m_size) construct(m_data + m_size);
+        }
+    }
+
+    //! @brief Resizes the vector, copying an element into new positions.
+    void resize(size_t n, T const& x) {
+        if (n < m_size) erase(begin() + n, end());
+        else insert(end(), n - m_size, x);
+    }
+
+    //! @brief Exchanges the content of the vectors.
+    void swap(small_vector& v) noexcept {
+        small_vector t(std::move(v));
+        v = std::move(*this);
+        *this = std::move(t);
+    }
+    //! @}
+
+    //! @brief Conversion to a standard vector.
+    template <typename B>
+    operator std::vector<T, B>() const {
+        return std::vector<T, B>(begin(), end());
+    }
+
+    //! @name comparison operators
+    //! @{
+    friend bool operator==(small_vector const& x, small_vector const& y) {
+        return x.size() == y.size() and std::equal(x.begin(), x.end(), y.begin());
+    }
+    friend bool operator!=(small_vector const& x, small_vector const& y) {
+        return not (x == y);
+    }
+    friend bool operator<(small_vector const& x, small_vector const& y) {
+        return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+    }
+    friend bool operator>(small_vector const& x, small_vector const& y) {
+        return y < x;
+    }
+    friend bool operator<=(small_vector const& x, small_vector const& y) {
+        return not (y < x);
+    }
+    friend bool operator>=(small_vector const& x, small_vector const& y) {
+        return not (x < y);
+    }
+    //! @}
+
+    //! @name comparison operators with standard vectors
+    //! @{
+    template <typename B>
+    friend bool operator==(small_vector const& x, std::vector<T, B> const& y) {
+        return x.size() == y.size() and std::equal(x.begin(), x.end(), y.begin());
+    }
+    template <typename B>
+    friend bool operator==(std::vector<T, B> const& x, small_vector const& y) {
+        return y == x;
+    }
+    template <typename B>
+    friend bool operator!=(small_vector const& x, std::vector<T, B> const& y) {
+        return not (x == y);
+    }
+    template <typename B>
+    friend bool operator!=(std::vector<T, B> const& x, small_vector const& y) {
+        return not (y == x);
+    }
+    //! @}
+
+    //! @brief Exchanges the content of the vectors.
+    friend void swap(small_vector& x, small_vector& y) noexcept {
+        x.swap(y);
+    }
+
+  private:
+    //! @brief The inline storage.
+    T* inline_data() noexcept {
+        return reinterpret_cast<T*>(&m_inline);
+    }
+
+    //! @brief The inline storage (const).
+    T const* inline_data() const noexcept {
+        return reinterpret_cast<T const*>(&m_inline);
+    }
+
+    //! @brief Constructs an element at a given address.
+    template <typename... Ts>
+    void construct(T* p, Ts&&... xs) {
+        ::new (static_cast<void*>(p)) T(std::forward<Ts>(xs)...);
+    }
+
+    //! @brief The capacity after growing for one more element.
+    size_t grown() const {
+        return std::max(2*m_capacity, size_t(4));
+    }
+
+    //! @brief Reserves space for a range of forward iterators.
+    template <typename I>
+    void reserve_range(I first, I last, std::forward_iterator_tag) {
+        reserve(m_size + std::distance(first, last));
+    }
+
+    //! @brief Does not reserve space for a range of input iterators.
+    template <typename I>
+    void reserve_range(I, I, std::input_iterator_tag) {}
+
+    //! @brief Moves the elements into a given capacity (inline if it fits).
+    void reallocate(size_t n) {
+        T* data = n <= N ? inline_data() : traits::allocate(*this, n);
+        if (data == m_data) return;
+        for (size_t i = 0; i < m_size; ++i) {
+            construct(data + i, std::move(m_data[i]));
+            m_data[i].~T();
+        }
+        release();
+        m_data = data;
+        m_capacity = std::max(n, N);
+    }
+
+    //! @brief Releases the heap memory (elements must be already destroyed).
+    void release() noexcept {
+        if (m_data != inline_data()) traits::deallocate(*this, m_data, m_capacity);
+        m_data = inline_data();
+        m_capacity = N;
+    }
+
+    //! @brief Takes the content of another vector, leaving it empty (the vector must be empty and inline).
+    void steal(small_vector& v) noexcept {
+        if (v.m_data == v.inline_data()) {
+            for (size_t i = 0; i < v.m_size; ++i) construct(m_data + i, std::move(v.m_data[i]));
+            m_size = v.m_size;
+            v.clear();
+        } else {
+            m_data = v.m_data;
+            m_size = v.m_size;
+            m_capacity = v.m_capacity;
+            v.m_data = v.inline_data();
+            v.m_size = 0;
+            v.m_capacity = N;
+        }
+    }
+
+    //! @brief Pointer to the elements.
+    T* m_data;
+
+    //! @brief The number of elements.
+    size_t m_size;
+
+    //! @brief The number of elements that can be held.
+    size_t m_capacity;
+
+    //! @brief Storage for the inline elements.
+    std::aligned_storage_t<sizeof(T) * (N > 0 ? N : 1), alignof(T)> m_inline;
+};
+
+
+}
+
+
+}
+
+#endif // FCPP_COMMON_SMALL_VECTOR_H_
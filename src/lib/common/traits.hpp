@@ -318,24 +318,6 @@ using apply_templates = typename details::apply_templates<S,Ts...>::type;
 
 //! @cond INTERNAL
 namespace details {
-    //! @brief Type referencing vector values (value type case).
-    template <typename T>
-    struct vectorize {
-        using type = typename std::vector<T>::value_type;
-    };
-
-    //! @brief Type referencing vector values (reference case).
-    template <typename T>
-    struct vectorize<T&> {
-        using type = typename std::vector<T>::reference;
-    };
-
-    //! @brief Type referencing vector values (const reference case).
-    template <typename T>
-    struct vectorize<T const&> {
-        using type = typename std::vector<T>::const_reference;
-    };
-
     //! @brief General form.
     template <template<class> class T, class A, bool b = has_template<T, A>>
     struct extract_template;
@@ -391,7 +373,7 @@ namespace details {
     //! @brief If the second parameter is of the form T<A>.
     template <template<class> class T, class A>
     struct extract_template<T, T<A>, true> {
-        using type = typename vectorize<common::partial_decay<A>>::type;
+        using type = common::partial_decay<A>;
     };
 }
 //! @endcond
@@ -12,6 +12,7 @@
 #include <chrono>
 #include <iostream>
 #include <limits>
+#include <tuple>
 
 #include "lib/settings.hpp"
 #include "lib/common/mutex.hpp"
@@ -177,6 +178,21 @@ struct base {
                 return t;
             }
 
+            //! @brief Delivers an incoming message, receiving it directly unless executing optimistically.
+            template <typename S, typename T>
+            void deliver(times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
+                as_final().receive(t, d, m);
+            }
+
+            //! @brief Notifies that the node state is read by the event executing in the current thread (used by optimistic executions).
+            void speculative_read() {}
+
+            //! @brief Serialises the state of the node from/to a given input/output stream.
+            template <typename S>
+            S& serialize(S& s) {
+                return s;
+            }
+
             //! @brief The unique identifier of the device.
             device_t const uid;
 
@@ -227,6 +243,7 @@ struct base {
                 m_realtime_start = clock_t::now();
                 m_realtime_factor = real_t(clock_t::period::num) / clock_t::period::den;
                 m_last_update = m_next_update = 0;
+                m_run_end = TIME_MAX;
                 m_warn_delay = FCPP_TIME_EPSILON;
             }
 
@@ -250,18 +267,50 @@ struct base {
             //! @brief Updates the internal status of net component.
             void update() {}
 
+            //! @brief Ordering key of events, as time, index among the events of the node at that time, and device identifier.
+            using event_key = std::tuple<times_t, size_t, device_t>;
+
+            //! @brief Whether events may be rolled back (only with optimistic executions).
+            constexpr static bool speculative = false;
+
+            //! @brief The time before which events cannot be rolled back (`TIME_MAX` when not executing optimistically).
+            times_t virtual_time() const {
+                return TIME_MAX;
+            }
+
+            //! @brief The key of the event executing in the current thread (used by optimistic executions).
+            event_key speculation_key() const {
+                return event_key(TIME_MAX, 0, 0);
+            }
+
+            //! @brief Rolls back the event with a given key, and the following events of the same node (used by optimistic executions).
+            void speculation_rollback(event_key const&) {}
+
+            //! @brief Notifies that nodes are about to be constructed in bulk, possibly in parallel.
+            void emplace_bulk_start() {}
+
+            //! @brief Notifies that the nodes constructed in bulk are complete.
+            void emplace_bulk_end() {}
+
             //! @brief Runs the events until a given end. Should NEVER be overridden.
             void run(times_t end = TIME_MAX) {
                 times_t nxt;
+                m_run_end = end;
                 while ((nxt = as_final().next()) < end) {
                     m_next_update = nxt;
                     maybe_sleep(nxt, std::integral_constant<bool, realtime>{});
                     m_last_update = nxt;
                     as_final().update();
                 }
+                m_run_end = TIME_MAX;
                 PROFILE_REPORT();
             }
 
+            //! @brief The end of the current run (`TIME_MAX` outside of runs).
+            times_t run_end() const {
+                return m_run_end;
+            }
+
             //! @brief A measure of the internal time clock.
             times_t internal_time() const {
                 if (not realtime or (m_last_update == m_next_update)) return m_last_update;
@@ -311,6 +360,9 @@ struct base {
             //! @brief The internal time of the last and next update.
             times_t m_last_update, m_next_update;
 
+            //! @brief The end of the current run.
+            times_t m_run_end;
+
             //! @brief The minimum delay triggering a warning.
             times_t m_warn_delay;
         };
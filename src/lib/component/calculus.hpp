@@ -14,8 +14,12 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "lib/common/arena.hpp"
 #include "lib/common/serialize.hpp"
 #include "lib/internal/context.hpp"
+#include "lib/internal/delta.hpp"
+#include "lib/internal/intern.hpp"
+#include "lib/internal/quantised.hpp"
 #include "lib/internal/trace.hpp"
 #include "lib/internal/twin.hpp"
 #include "lib/option/metric.hpp"
@@ -71,6 +75,22 @@ namespace tags {
     template <bool b>
     struct export_split {};
 
+    //! @brief Declaration flag associating to whether exports are stored in flat contiguous buffers (defaults to \ref FCPP_EXPORT_FLAT).
+    template <bool b>
+    struct export_flat {};
+
+    //! @brief Declaration flag associating to whether exports are stored in slots of a layout learned at run time and reused across rounds (defaults to \ref FCPP_EXPORT_LAYOUT).
+    template <bool b>
+    struct export_layout {};
+
+    //! @brief Declaration flag associating to whether equal values in exports share a single instance process-wide, overriding \ref export_flat and \ref export_layout (defaults to \ref FCPP_EXPORT_INTERN).
+    template <bool b>
+    struct export_intern {};
+
+    //! @brief Declaration tag associating to the number of rounds between full exports, sending only changes in between, so that an unchanged export is sent as an empty delta (defaults to \ref FCPP_EXPORT_DELTA, zero to always send full exports).
+    template <intmax_t n>
+    struct export_delta {};
+
     //! @brief Declaration flag associating to whether messages are dropped as they arrive (reduces memory footprint, defaults to \ref FCPP_ONLINE_DROP).
     template <bool b>
     struct online_drop {};
@@ -87,13 +107,17 @@ namespace tags {
  * @brief Component providing the field calculus APIs.
  *
  * <b>Declaration tags:</b>
- * - \ref tags::exports defines a sequence of types to be used in exports (defaults to the empty sequence).
+ * - \ref tags::exports defines a sequence of types to be used in exports (defaults to the empty sequence); types listed in a \ref common::quantise declaration at its top level are encoded in reduced precision when messages are serialised.
  * - \ref tags::program defines a callable class to be executed during rounds (defaults to \ref calculus::null_program).
  * - \ref tags::retain defines a metric class regulating the discard of exports (defaults to \ref metric::once).
+ * - \ref tags::export_delta defines the number of rounds between full exports, sending only changes in between, so that an unchanged export is sent as an empty delta (defaults to \ref FCPP_EXPORT_DELTA, zero to always send full exports).
  *
  * <b>Declaration flags:</b>
  * - \ref tags::export_pointer defines whether exports are wrapped in smart pointers (defaults to \ref FCPP_EXPORT_PTR).
  * - \ref tags::export_split defines whether exports for neighbours are split from those for self (defaults to \ref FCPP_EXPORT_NUM `== 2`).
+ * - \ref tags::export_flat defines whether exports are stored in flat contiguous buffers (defaults to \ref FCPP_EXPORT_FLAT).
+ * - \ref tags::export_layout defines whether exports are stored in slots of a layout learned in the first round and reused in the following ones (defaults to \ref FCPP_EXPORT_LAYOUT).
+ * - \ref tags::export_intern defines whether equal values in exports share a single instance process-wide, overriding \ref tags::export_flat and \ref tags::export_layout (defaults to \ref FCPP_EXPORT_INTERN).
  * - \ref tags::online_drop defines whether messages are dropped as they arrive (reduces memory footprint, defaults to \ref FCPP_ONLINE_DROP).
  *
  * <b>Node initialisation tags:</b>
@@ -144,12 +168,27 @@ struct calculus {
     //! @brief Sequence of types to be used in exports.
     using exports_type = common::export_list<common::option_types<tags::exports, Ts...>>;
 
+    //! @brief Sequence of \ref common::quantise declarations of types encoded in reduced precision on the wire.
+    using quantise_type = common::quantise_list<common::option_types<tags::exports, Ts...>>;
+
     //! @brief Whether exports are wrapped in smart pointers.
     constexpr static bool export_pointer = common::option_flag<tags::export_pointer, FCPP_EXPORT_PTR, Ts...>;
 
     //! @brief Whether exports for neighbours are split from those for self.
     constexpr static bool export_split = common::option_flag<tags::export_split, FCPP_EXPORT_NUM == 2, Ts...>;
 
+    //! @brief Whether exports are stored in flat contiguous buffers.
+    constexpr static bool export_flat = common::option_flag<tags::export_flat, FCPP_EXPORT_FLAT, Ts...>;
+
+    //! @brief Whether exports are stored in slots of a layout reused across rounds.
+    constexpr static bool export_layout = common::option_flag<tags::export_layout, FCPP_EXPORT_LAYOUT, Ts...>;
+
+    //! @brief Whether equal values in exports share a single instance process-wide.
+    constexpr static bool export_intern = common::option_flag<tags::export_intern, FCPP_EXPORT_INTERN, Ts...>;
+
+    //! @brief Number of rounds between full exports (zero to always send full exports).
+    constexpr static intmax_t export_delta = common::option_num<tags::export_delta, FCPP_EXPORT_DELTA, Ts...>;
+
     //! @brief Whether messages are dropped as they arrive.
     constexpr static bool online_drop = common::option_flag<tags::online_drop, FCPP_ONLINE_DROP, Ts...>;
 
@@ -183,11 +222,14 @@ struct calculus {
             using metric_type = typename retain_type::result_type;
 
             //! @brief The type of the context of exports from other devices.
-            using context_type = internal::context_t<online_drop, export_pointer, metric_type, exports_type>;
+            using context_type = internal::context_t<online_drop, export_pointer, metric_type, exports_type, export_flat, export_layout, export_intern>;
 
             //! @brief The type of the exports of the current device.
             using export_type = typename context_type::export_type;
 
+            //! @brief The type of the codec of exports into messages.
+            using codec_type = internal::delta_codec<export_type, export_delta>;
+
             //! @brief Helper type providing access to the context for self-messages.
             template <typename A>
             struct self_context_type {
@@ -232,6 +274,11 @@ struct calculus {
                     return n.m_context.second().template nbr<A>(t, def, n.uid);
                 }
 
+                //! @brief Accesses a lazy view of old stored values given a default.
+                inline nbr_view<A> lazy_nbr(A const& def) {
+                    return n.m_context.second().template lazy_nbr<A>(t, def, n.uid);
+                }
+
               private:
                 //! @brief Private constructor.
                 nbr_context_type(node& n, trace_t t) : n(n), t(t) {}
@@ -246,7 +293,7 @@ struct calculus {
             //! @brief Helper type providing access to the context for neighbour call points.
             struct void_context_type {
                 //! @brief Accesses the list of devices aligned with the call point.
-                inline std::vector<device_t> align() {
+                inline fcpp::details::field_vector<device_t> align() {
                     n.m_export.second()->insert(t);
                     return n.m_context.second().align(t, n.uid);
                 }
@@ -263,7 +310,7 @@ struct calculus {
             };
 
             //! @brief A `tagged_tuple` type used for messages to be exchanged with neighbours.
-            using message_t = typename P::node::message_t::template push_back<calculus_tag, export_type>;
+            using message_t = typename P::node::message_t::template push_back<calculus_tag, internal::quantised_t<typename codec_type::message_type, quantise_type>>;
 
             /**
              * @brief Main constructor.
@@ -272,19 +319,26 @@ struct calculus {
              * @param t A `tagged_tuple` gathering initialisation values.
              */
             template <typename S, typename T>
-            node(typename F::net& n, common::tagged_tuple<S,T> const& t) : P::node(n,t), m_context{}, m_metric{t}, m_hoodsize{common::get_or<tags::hoodsize>(t, std::numeric_limits<device_t>::max())}, m_threshold{common::get_or<tags::threshold>(t, m_metric.build())} {}
+            node(typename F::net& n, common::tagged_tuple<S,T> const& t) : P::node(n,t), m_context{}, m_metric{t}, m_hoodsize{common::get_or<tags::hoodsize>(t, std::numeric_limits<device_t>::max())}, m_threshold{common::get_or<tags::threshold>(t, m_metric.build())}, m_nbr_uid{P::node::uid} {}
 
             //! @brief Performs computations at round start with current time `t`.
             void round_start(times_t t) {
                 P::node::round_start(t);
                 assert(stack_trace.empty());
                 m_context.second().freeze(m_hoodsize, P::node::uid);
-                m_export = {};
-                std::vector<device_t> nbr_ids = m_context.second().align(P::node::uid);
-                std::vector<device_t> nbr_vals;
+                m_export.first() = context_type::renew(m_export.first());
+                if (export_split) m_export.second() = context_type::renew(m_export.second());
+                fcpp::details::field_vector<device_t> nbr_ids = m_context.second().align(P::node::uid);
+                fcpp::details::field_vector<device_t> nbr_vals;
                 nbr_vals.emplace_back();
                 nbr_vals.insert(nbr_vals.end(), nbr_ids.begin(), nbr_ids.end());
+                m_codec.prune(t);
                 m_nbr_uid = fcpp::details::make_field(std::move(nbr_ids), std::move(nbr_vals));
+                // the neighbour identifiers outlive the round, thus are built before the arena is opened
+                if (FCPP_ROUND_ARENA and not m_arena) {
+                    common::arena::open();
+                    m_arena = true;
+                }
             }
 
             //! @brief Performs computations at round middle with current time `t`.
@@ -297,6 +351,16 @@ struct calculus {
             void round_end(times_t t) {
                 assert(stack_trace.empty());
                 P::node::round_end(t);
+                if (FCPP_ROUND_ARENA and m_arena) {
+                    // exports outlive the round, thus are copied out of the arena before it is rewound
+                    m_export.second() = export_type(common::arena::escape(*m_export.second()));
+                    if (export_split) m_export.first() = export_type(common::arena::escape(*m_export.first()));
+                    common::arena::close();
+                    m_arena = false;
+                }
+                // values are shared before sending, so that exports received by pointer are not interned again
+                if (export_intern) m_export.second() = internal::intern(m_export.second());
+                m_codec.renew();
                 m_context.second().unfreeze(P::node::as_final(), m_metric, m_threshold);
             }
 
@@ -304,7 +368,11 @@ struct calculus {
             template <typename S, typename T>
             void receive(times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
                 P::node::receive(t, d, m);
-                m_context.second().insert(d, common::get<calculus_tag>(m), m_metric.build(P::node::as_final(), t, d, m), m_threshold, m_hoodsize);
+                export_type const* e = m_codec.decode(t, d, P::node::uid, common::get<calculus_tag>(m));
+                if (e != nullptr and export_intern)
+                    m_context.second().insert(d, internal::intern(*e), m_metric.build(P::node::as_final(), t, d, m), m_threshold, m_hoodsize);
+                else if (e != nullptr)
+                    m_context.second().insert(d, *e, m_metric.build(P::node::as_final(), t, d, m), m_threshold, m_hoodsize);
                 if (export_split and d == P::node::uid)
                     m_context.first().insert(d, m_export.first(), m_metric.build(P::node::as_final(), t, d, m), m_threshold, m_hoodsize);
             }
@@ -313,7 +381,7 @@ struct calculus {
             template <typename S, typename T>
             common::tagged_tuple<S,T>& send(times_t t, common::tagged_tuple<S,T>& m) const {
                 P::node::send(t, m);
-                common::get<calculus_tag>(m) = m_export.second();
+                common::get<calculus_tag>(m) = m_codec.message(m_export.second());
                 return m;
             }
 
@@ -327,6 +395,11 @@ struct calculus {
                 return m_nbr_uid;
             }
 
+            //! @brief Memory statistics of the export values shared between neighbours (empty without \ref tags::export_intern).
+            static internal::intern_stats intern_stats() {
+                return export_intern ? internal::intern_statistics(export_type{}) : internal::intern_stats{};
+            }
+
             //! @brief Accesses the threshold for message retain.
             metric_type message_threshold() const {
                 return m_threshold;
@@ -354,6 +427,12 @@ struct calculus {
                 return {*this, stack_trace.hash(call_point)};
             }
 
+            //! @brief Serialises the state of the node from/to a given input/output stream.
+            template <typename S>
+            S& serialize(S& s) {
+                return P::node::serialize(s) & m_context & m_export & m_codec & m_threshold & m_nbr_uid;
+            }
+
             //! @brief Stack trace maintained during aggregate function execution.
             internal::trace stack_trace;
 
@@ -364,6 +443,9 @@ struct calculus {
             //! @brief Exports of the current device (`first` for local device, `second` for others).
             internal::twin<export_type, not export_split> m_export;
 
+            //! @brief Codec of exports into messages (encoding lazily as messages are sent).
+            mutable codec_type m_codec;
+
             //! @brief The callable class representing the main round.
             program_type m_callback;
 
@@ -378,6 +460,9 @@ struct calculus {
 
             //! @brief Identifiers of the neighbours.
             field<device_t> m_nbr_uid;
+
+            //! @brief Whether the round arena has been opened by this node.
+            bool m_arena = false;
         };
 
         //! @brief The global part of the component.
@@ -8,12 +8,21 @@
 #ifndef FCPP_COMPONENT_IDENTIFIER_H_
 #define FCPP_COMPONENT_IDENTIFIER_H_
 
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <deque>
 #include <map>
 #include <queue>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "lib/common/algorithm.hpp"
-#include "lib/common/random_access_map.hpp"
+#include "lib/common/slot_map.hpp"
+#include "lib/common/serialize.hpp"
 #include "lib/component/base.hpp"
 
 
@@ -104,6 +113,172 @@ namespace details {
         //! @brief The actual priority queue.
         std::priority_queue<type, std::vector<type>, std::greater<type>> m_queue;
     };
+
+    /**
+     * @brief Calendar queue of pairs `(times_t, device_t)` with amortised constant time operations.
+     *
+     * Pairs are kept in a circular array of buckets (days) of a fixed width, adapted to the
+     * average separation between events whenever the number of buckets is resized.
+     * Bucket vectors are never deallocated, so that steady-state pushes do not allocate.
+     * Pops return the same elements in the same order as \ref times_queue.
+     *
+     * @param synchronised Whether only the elements with the smallest time are popped at once.
+     */
+    template <bool synchronised>
+    class calendar_queue {
+      public:
+        //! @brief Default constructor.
+        calendar_queue() : m_buckets(min_buckets), m_scale(1), m_size(0), m_day(0), m_next(TIME_MAX), m_valid(true) {}
+
+        //! @brief The smallest time in the queue.
+        inline times_t next() const {
+            if (not m_valid) find_next();
+            return m_next;
+        }
+
+        //! @brief Adds a new pair to the queue.
+        void push(times_t t, device_t uid) {
+            if (day_of(t) >= max_day) m_overflow.emplace_back(t, uid);
+            else {
+                int64_t d = day_of(t);
+                m_buckets[d & (m_buckets.size()-1)].emplace_back(t, uid);
+                if (d < m_day) m_day = d;
+            }
+            if (m_valid and t < m_next) m_next = t;
+            if (++m_size > 4*m_buckets.size()) resize(2*m_buckets.size());
+        }
+
+        //! @brief Pops elements with the smallest time if up to `t` (if synchronised), or with times up to `t` (otherwise).
+        std::vector<device_t> pop(times_t t) {
+            times_t m = next();
+            if (m > t) return {};
+            std::vector<type>& v = m_popped;
+            v.clear();
+            if (synchronised) t = m;
+            size_t n = m_buckets.size();
+            if (day_of(t) - m_day < int64_t(n)) {
+                for (int64_t d = m_day; d <= day_of(t); ++d)
+                    extract(m_buckets[d & (n-1)], t, v);
+            } else for (auto& b : m_buckets) extract(b, t, v);
+            if (day_of(t) >= max_day) extract(m_overflow, t, v);
+            if (not synchronised) std::sort(v.begin(), v.end());
+            m_size -= v.size();
+            m_valid = false;
+            if (m_size < n and n > min_buckets) resize(n/2);
+            std::vector<device_t> r;
+            r.reserve(v.size());
+            for (type const& x : v) r.push_back(x.second);
+            return r;
+        }
+
+      private:
+        //! @brief The type of queue elements.
+        using type = std::pair<times_t, device_t>;
+
+        //! @brief The minimum number of buckets.
+        constexpr static size_t min_buckets = 16;
+
+        //! @brief Days from this on are stored in the overflow vector.
+        constexpr static int64_t max_day = int64_t(1) << 60;
+
+        //! @brief The day of a given time.
+        inline int64_t day_of(times_t t) const {
+            double d = std::floor(double(t) * m_scale);
+            return d < max_day ? d > -max_day ? int64_t(d) : -max_day : max_day;
+        }
+
+        //! @brief Moves elements of a bucket with time up to `t` into `v` (preserving order).
+        static void extract(std::vector<type>& b, times_t t, std::vector<type>& v) {
+            size_t w = 0;
+            for (size_t r = 0; r < b.size(); ++r) {
+                if (b[r].first <= t) v.push_back(b[r]);
+                else b[w++] = b[r];
+            }
+            b.resize(w);
+        }
+
+        //! @brief Computes the smallest time and the corresponding day.
+        void find_next() const {
+            m_valid = true;
+            m_next = TIME_MAX;
+            size_t n = m_buckets.size();
+            if (m_size > m_overflow.size()) {
+                for (size_t k = 0; k < n; ++k, ++m_day) {
+                    for (type const& x : m_buckets[m_day & (n-1)])
+                        if (x.first < m_next and day_of(x.first) == m_day)
+                            m_next = x.first;
+                    if (m_next < TIME_MAX) return;
+                }
+                for (auto const& b : m_buckets)
+                    for (type const& x : b)
+                        m_next = std::min(m_next, x.first);
+                m_day = day_of(m_next);
+            }
+            for (type const& x : m_overflow)
+                m_next = std::min(m_next, x.first);
+        }
+
+        //! @brief Changes the number of buckets, adapting their width to the current separation of events.
+        void resize(size_t n) {
+            std::vector<type> v;
+            v.reserve(m_size);
+            for (auto& b : m_buckets) {
+                v.insert(v.end(), b.begin(), b.end());
+                b.clear();
+            }
+            v.insert(v.end(), m_overflow.begin(), m_overflow.end());
+            m_overflow.clear();
+            std::vector<times_t> ts;
+            for (type const& x : v) if (x.first < TIME_MAX) ts.push_back(x.first);
+            size_t k = std::min<size_t>(ts.size(), 64);
+            if (k > 1) {
+                std::partial_sort(ts.begin(), ts.begin() + k, ts.end());
+                size_t distinct = std::unique(ts.begin(), ts.begin() + k) - ts.begin();
+                if (distinct > 1) m_scale = (distinct-1) / (3 * (double(ts[distinct-1]) - double(ts[0])));
+            }
+            m_buckets.resize(n);
+            m_size = 0;
+            m_day = max_day;
+            for (type const& x : v) push(x.first, x.second);
+            m_valid = false;
+        }
+
+        //! @brief The circular array of buckets.
+        std::vector<std::vector<type>> m_buckets;
+        //! @brief Elements too far in the future to be assigned to a day.
+        std::vector<type> m_overflow;
+        //! @brief Elements being popped.
+        std::vector<type> m_popped;
+        //! @brief The inverse of the time width of a bucket.
+        double m_scale;
+        //! @brief The number of elements in the queue.
+        size_t m_size;
+        //! @brief The current day, not after the day of the smallest time.
+        mutable int64_t m_day;
+        //! @brief The smallest time (if valid).
+        mutable times_t m_next;
+        //! @brief Whether the smallest time is valid.
+        mutable bool m_valid;
+    };
+
+    //! @brief Morton code of a position, interleaving the bits of its coordinates quantised within a bounding box.
+    template <typename V>
+    uint64_t morton_code(V const& p, V const& lo, V const& hi) {
+        constexpr size_t n = V::dimension;
+        constexpr size_t bits = n > 1 ? 64 / n : 32;
+        uint64_t q[n];
+        for (size_t i = 0; i < n; ++i) {
+            double f = hi[i] > lo[i] ? (p[i] - lo[i]) / (hi[i] - lo[i]) : 0;
+            if (not (f > 0)) f = 0;
+            if (f > 1) f = 1;
+            q[i] = uint64_t(f * ((uint64_t(1) << bits) - 1));
+        }
+        uint64_t code = 0;
+        for (size_t b = bits; b-- > 0; )
+            for (size_t i = 0; i < n; ++i)
+                code = (code << 1) | ((q[i] >> b) & 1);
+        return code;
+    }
 }
 //! @endcond
 
@@ -118,6 +293,22 @@ namespace tags {
     template <bool b>
     struct synchronised {};
 
+    //! @brief Declaration flag associating to whether events are scheduled through a calendar queue (defaults to \ref FCPP_CALENDAR_QUEUE).
+    template <bool b>
+    struct calendar_queue {};
+
+    //! @brief Declaration flag associating to whether all events which cannot be affected by messages are executed together (defaults to \ref FCPP_CONSERVATIVE).
+    template <bool b>
+    struct conservative {};
+
+    //! @brief Declaration flag associating to whether events are executed speculatively, rolling back on causality conflicts (defaults to \ref FCPP_OPTIMISTIC).
+    template <bool b>
+    struct optimistic {};
+
+    //! @brief Declaration flag associating to whether messages are buffered and received in canonical order after the events executing together (defaults to \ref FCPP_DETERMINISTIC).
+    template <bool b>
+    struct deterministic {};
+
     //! @brief Node initialisation tag associating to a `device_t` unique identifier (required).
     struct uid;
 
@@ -126,6 +317,21 @@ namespace tags {
 
     //! @brief Net initialisation tag associating to the number of threads that can be created (defaults to \ref FCPP_THREADS).
     struct threads {};
+
+    //! @brief Net initialisation tag associating to a lower bound on the delay between a round and its message sending (defaults to the bound provided by the connector, or zero).
+    struct lookahead {};
+
+    //! @brief Net initialisation tag associating to the maximum number of events executed speculatively together (defaults to 1024).
+    struct speculation_window {};
+
+    //! @brief Net initialisation tag associating to the period of the reordering of nodes by position (defaults to `TIME_MAX`, disabling it).
+    struct reorder_period {};
+
+    //! @brief Net initialisation tag associating to the number of NUMA nodes among which threads and nodes are partitioned (defaults to 1).
+    struct numa_nodes {};
+
+    //! @brief Net initialisation tag associating to the load imbalance above which threads are assigned chunks of nodes balanced by round cost (defaults to `INF`, disabling cost measurement).
+    struct balance_threshold {};
 }
 
 
@@ -137,12 +343,69 @@ namespace tags {
  * <b>Declaration flags:</b>
  * - \ref tags::parallel defines whether parallelism is enabled (defaults to \ref FCPP_PARALLEL).
  * - \ref tags::synchronised defines whether many events are expected to happen at the same time (defaults to \ref FCPP_SYNCHRONISED).
+ * - \ref tags::calendar_queue defines whether events are scheduled through a calendar queue (defaults to \ref FCPP_CALENDAR_QUEUE).
+ * - \ref tags::conservative defines whether all events which cannot be affected by messages are executed together (defaults to \ref FCPP_CONSERVATIVE).
+ * - \ref tags::optimistic defines whether events are executed speculatively, rolling back on causality conflicts (defaults to \ref FCPP_OPTIMISTIC).
+ * - \ref tags::deterministic defines whether messages are buffered and received in canonical order after the events executing together (defaults to \ref FCPP_DETERMINISTIC).
  *
  * <b>Net initialisation tags:</b>
  * - \ref tags::epsilon associates to the time sensitivity, allowing indeterminacy below it (defaults to \ref FCPP_TIME_EPSILON).
  * - \ref tags::threads associates to the number of threads that can be created (defaults to \ref FCPP_THREADS).
+ * - \ref tags::lookahead associates to a lower bound on the delay between a round and its message sending (defaults to the bound provided by the connector, or zero).
+ * - \ref tags::speculation_window associates to the maximum number of events executed speculatively together (defaults to 1024).
+ * - \ref tags::reorder_period associates to the period of the reordering of nodes by position (defaults to `TIME_MAX`, disabling it).
+ * - \ref tags::numa_nodes associates to the number of NUMA nodes among which threads and nodes are partitioned (defaults to 1).
+ * - \ref tags::balance_threshold associates to the load imbalance above which threads are assigned chunks of nodes balanced by round cost (defaults to `INF`, disabling cost measurement).
  *
  * Whenever \ref tags::parallel is false, \ref tags::threads is ignored and \ref tags::epsilon has only a minor effect (it is recommended to set it to zero).
+ *
+ * With \ref tags::conservative, every update executes in parallel the events within \ref tags::epsilon from the first,
+ * together with all subsequent events preceding any possible message sending. A node may send a message at its planned
+ * send time (as given by `send_time()`) or \ref tags::lookahead after its next event. Given a positive lookahead,
+ * asynchronous schedules are thus executed with many events at once, producing the same results as a sequential execution.
+ *
+ * With \ref tags::optimistic, every update executes in parallel a window of up to \ref tags::speculation_window events
+ * (one per node), regardless of the messages they may exchange. After every event, the state of the node is saved through
+ * its `serialize` method. Events are ordered by time, then by the number of previous events of the same node at that
+ * time (as in sequential updates), then by identifier; messages and reads are ordered as the event performing them
+ * (given by `speculation_key()`). Messages following the next event of their receiver wait for it to happen, while
+ * those preceding an event which already happened (stragglers) roll back their receiver to the state saved before that
+ * event. Rolling back a node cancels the messages it sent (as anti-messages, possibly causing further rollbacks), and
+ * also rolls back the events which read its state (through `speculative_read`) after the events rolled back.
+ * Windows shrunk to a single time are executed sequentially by key, ensuring progress.
+ * The window size is halved after windows causing rollbacks, and doubled otherwise. The time of the first event in the
+ * queue is the global virtual time (as given by `virtual_time()`), before which saved states and messages are discarded.
+ * Statistics on speculation are available through `speculation_stats()`. Node events should not have side effects
+ * outside the node state, and every component keeping node state should serialise it: a \ref logger pushing values to
+ * aggregators (with \ref tags::value_push) and a \ref displayer are rejected at compile time, while user components are
+ * not checked. Messages from different nodes received between two events should commute, and \ref tags::epsilon and
+ * \ref tags::conservative are ignored.
+ *
+ * With \ref tags::reorder_period, nodes with a `position()` (as given by a \ref simulated_positioner) are sorted every
+ * period by the Morton code of their position. Nodes keep their identifier and address, while both the iteration
+ * order (through `node_begin()` and `node_end()`) and the order in which nodes executing together are assigned to
+ * threads follow the sorting, so that nearby nodes are updated by the same thread (except with \ref tags::optimistic).
+ *
+ * With \ref tags::numa_nodes, the iteration order is split into equal consecutive parts owned by each NUMA node
+ * (spatial cells, together with \ref tags::reorder_period), and the threads are split and pinned accordingly.
+ * Events are executed first by threads of the NUMA node owning them, and stolen by other nodes only when idle.
+ * The number of events executed by threads of each NUMA node is available through `numa_events()`.
+ *
+ * With \ref tags::deterministic, the events of an update are executed together up to the first whose node may send
+ * messages (as bounded by `send_time()` and \ref tags::lookahead, so that a positive lookahead is needed for parallelism).
+ * Messages delivered meanwhile are buffered by receiver, and received before the following events, sorted by time and
+ * then by sender (in parallel among receivers). Every message thus reaches its receiver before the events following its
+ * sender, and after those preceding it, so that results do not depend on the number of threads or their timing, and
+ * coincide with those of a plain sequential execution (ignored with \ref tags::optimistic).
+ *
+ * With a finite \ref tags::balance_threshold, the duration of every round (from its start to its end, other events of
+ * the node not being measured) is smoothed exponentially into the `round_cost()` of the node. Parallel updates
+ * accumulate the total duration of the rounds among the events initially assigned to each thread, until at least as
+ * many events as nodes are accounted: the load imbalance (as maximum over average) is then measured, available through
+ * `load_imbalance()`. When it exceeds the threshold, the iteration order is cut into contiguous chunks of equal cost,
+ * one per thread, assigned to threads in the following updates until the next rebalancing, or until nodes are created,
+ * erased or reordered, which falls back to an even split (except with \ref tags::numa_nodes or \ref tags::optimistic). Since cuts are recomputed at most once every as many events as nodes, their linear cost is
+ * amortised even if updates execute few events.
  */
 template <class... Ts>
 struct identifier {
@@ -152,6 +415,21 @@ struct identifier {
     //! @brief Whether new values are pushed to aggregators or pulled when needed.
     constexpr static bool synchronised = common::option_flag<tags::synchronised, FCPP_SYNCHRONISED, Ts...>;
 
+    //! @brief Whether events are scheduled through a calendar queue.
+    constexpr static bool calendar_queue = common::option_flag<tags::calendar_queue, FCPP_CALENDAR_QUEUE, Ts...>;
+
+    //! @brief Whether all events which cannot be affected by messages are executed together.
+    constexpr static bool conservative = common::option_flag<tags::conservative, FCPP_CONSERVATIVE, Ts...>;
+
+    //! @brief Whether events are executed speculatively, rolling back on causality conflicts.
+    constexpr static bool optimistic = common::option_flag<tags::optimistic, FCPP_OPTIMISTIC, Ts...>;
+
+    //! @brief Whether messages are buffered and received in canonical order after the events executing together.
+    constexpr static bool deterministic = common::option_flag<tags::deterministic, FCPP_DETERMINISTIC, Ts...> and not optimistic;
+
+    //! @brief The type of the queue of identifiers by next event.
+    using queue_type = std::conditional_t<calendar_queue, details::calendar_queue<synchronised>, details::times_queue<synchronised>>;
+
     /**
      * @brief The actual component.
      *
@@ -166,10 +444,101 @@ struct identifier {
         //! @cond INTERNAL
         DECLARE_COMPONENT(identifier);
         AVOID_COMPONENT(identifier,timer);
+        CHECK_COMPONENT(randomizer);
         //! @endcond
 
         //! @brief The local part of the component.
-        using node = typename P::node;
+        class node : public P::node {
+          public: // visible by net objects and the main program
+            /**
+             * @brief Main constructor.
+             *
+             * @param n The corresponding net object.
+             * @param t A `tagged_tuple` gathering initialisation values.
+             */
+            template <typename S, typename T>
+            node(typename F::net& n, common::tagged_tuple<S,T> const& t) : P::node(n,t), m_round_cost(0) {}
+
+            //! @brief The smoothed duration of rounds in seconds (with \ref tags::balance_threshold).
+            real_t round_cost() const {
+                return m_round_cost;
+            }
+
+            //! @brief Accounts for the duration of a round in seconds, smoothing it exponentially.
+            void round_cost(real_t c) {
+                m_round_cost = m_round_cost == 0 ? c : m_round_cost + (c - m_round_cost) / 4;
+            }
+
+            //! @brief The duration in seconds of the rounds executed since last called, resetting it (with \ref tags::balance_threshold).
+            real_t event_cost() {
+                real_t c = m_event_cost;
+                m_event_cost = 0;
+                return c;
+            }
+
+            //! @brief Performs computations at round start with current time `t`.
+            void round_start(times_t t) {
+                if (P::node::net.load_balancing()) m_round_start = std::chrono::steady_clock::now();
+                P::node::round_start(t);
+            }
+
+            //! @brief Performs computations at round end with current time `t`.
+            void round_end(times_t t) {
+                P::node::round_end(t);
+                if (P::node::net.load_balancing()) {
+                    real_t c = std::chrono::duration<real_t>(std::chrono::steady_clock::now() - m_round_start).count();
+                    round_cost(c);
+                    m_event_cost += c;
+                }
+            }
+
+            //! @brief Delivers an incoming message, receiving it directly unless executing optimistically.
+            template <typename S, typename T>
+            void deliver(times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
+                maybe_deliver(common::number_sequence<optimistic, deterministic>{}, t, d, m);
+            }
+
+            //! @brief Notifies that the node state is read by the event executing in the current thread (used by optimistic executions).
+            void speculative_read() {
+                maybe_read(common::number_sequence<optimistic>{});
+            }
+
+          private: // implementation details
+            //! @brief Delivers an incoming message (direct overload).
+            template <typename S, typename T>
+            inline void maybe_deliver(common::number_sequence<false, false>, times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
+                P::node::deliver(t, d, m);
+            }
+
+            //! @brief Delivers an incoming message (deterministic overload).
+            template <typename S, typename T>
+            inline void maybe_deliver(common::number_sequence<false, true>, times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
+                P::node::net.buffer_deliver(P::node::as_final(), t, d, m);
+            }
+
+            //! @brief Delivers an incoming message (optimistic overload).
+            template <intmax_t b, typename S, typename T>
+            inline void maybe_deliver(common::number_sequence<true, b>, times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
+                P::node::net.speculation_deliver(P::node::as_final(), t, d, m);
+            }
+
+            //! @brief Notifies a read of the node state (non-optimistic overload).
+            inline void maybe_read(common::number_sequence<false>) {}
+
+            //! @brief Notifies a read of the node state (optimistic overload).
+            inline void maybe_read(common::number_sequence<true>) {
+                P::node::net.speculation_read(P::node::as_final());
+            }
+
+            //! @brief The smoothed duration of rounds.
+            real_t m_round_cost;
+
+            //! @brief The duration of the rounds executed since last accounted.
+            real_t m_event_cost = 0;
+
+            //! @brief The start of the current round (with \ref tags::balance_threshold).
+            std::chrono::steady_clock::time_point m_round_start;
+        };
 
         //! @brief The global part of the component.
         class net : public P::net {
@@ -178,14 +547,26 @@ struct identifier {
             using node_type = typename F::node;
 
             //! @brief The map type used internally for storing nodes.
-            using map_type = common::random_access_map<device_t, node_type>;
+            using map_type = common::slot_map<device_t, node_type>;
 
             //! @brief The type of node locks.
             using lock_type = common::unique_lock<parallel>;
 
+            //! @brief Statistics on optimistic executions.
+            struct speculation_stats_type {
+                //! @brief Number of windows executed.
+                size_t windows = 0;
+                //! @brief Number of events executed (including those rolled back).
+                size_t events = 0;
+                //! @brief Number of rollbacks of a node.
+                size_t rollbacks = 0;
+                //! @brief Number of events rolled back.
+                size_t rolled_back = 0;
+            };
+
             //! @brief Constructor from a tagged tuple.
             template <typename S, typename T>
-            explicit net(common::tagged_tuple<S,T> const& t) : P::net(t), m_next_uid(0), m_epsilon(common::get_or<tags::epsilon>(t, FCPP_TIME_EPSILON)), m_threads(common::get_or<tags::threads>(t, FCPP_THREADS)) {}
+            explicit net(common::tagged_tuple<S,T> const& t) : P::net(t), m_next_uid(0), m_epsilon(common::get_or<tags::epsilon>(t, FCPP_TIME_EPSILON)), m_threads(common::get_or<tags::threads>(t, FCPP_THREADS)), m_lookahead(common::get_or<tags::lookahead>(t, default_lookahead<typename F::net>(0))), m_window_max(common::get_or<tags::speculation_window>(t, 1024)), m_window(m_window_max), m_gvt(optimistic ? TIME_MIN : TIME_MAX), m_reorder_period(common::get_or<tags::reorder_period>(t, TIME_MAX)), m_reorder_next(m_reorder_period < TIME_MAX ? 0 : TIME_MAX), m_numa(std::max<size_t>(common::get_or<tags::numa_nodes>(t, 1), 1)), m_numa_events(m_numa), m_balance_threshold(common::get_or<tags::balance_threshold>(t, INF)), m_imbalance(1) {}
 
             /**
              * @brief Returns next event to schedule for the net component.
@@ -199,22 +580,157 @@ struct identifier {
             //! @brief Updates the internal status of net component.
             void update() {
                 if (m_queue.next() < P::net::next()) {
-                    std::vector<device_t> nv = m_queue.pop(m_queue.next() + m_epsilon);
-                    common::parallel_for(common::tags::general_execution<parallel>(m_threads), nv.size(), [&nv,this](size_t i, size_t){
-                        if (m_nodes.count(nv[i]) > 0) {
-                            node_type& n = m_nodes.at(nv[i]);
-                            common::lock_guard<parallel> device_lock(n.mutex);
-                            n.update();
+                    if (optimistic) speculate(common::number_sequence<optimistic>{});
+                    else {
+                        if (m_queue.next() >= m_reorder_next) reorder();
+                        std::vector<device_t> nv = m_queue.pop(m_queue.next() + m_epsilon);
+                        if (conservative) pop_safe(nv);
+                        bool balancing = load_balancing();
+                        std::vector<size_t> pos;
+                        if (m_reorder_period < TIME_MAX or m_numa > 1 or balancing) pos = sort_order(nv);
+                        auto update_node = [&nv,this](size_t i){
+                            node_type* n = m_nodes.find_ptr(nv[i]);
+                            if (n != nullptr) {
+                                common::lock_guard<parallel> device_lock(n->mutex);
+                                n->update();
+                            }
+                        };
+                        size_t k = deterministic ? next_sender(nv, 0) : nv.size();
+                        if (k + 1 < nv.size()) {
+                            // messages are received before the events following their sender, as in sequential order
+                            for (size_t i = 0; i < nv.size(); i = k + 1, k = next_sender(nv, i)) {
+                                common::parallel_for(common::tags::general_execution<parallel>(m_threads), k + 1 - i, [&](size_t j, size_t){
+                                    update_node(i + j);
+                                });
+                                flush_inboxes();
+                            }
+                        } else if (parallel and m_numa > 1) {
+                            // counters are padded, so that threads do not share cache lines
+                            struct counter {
+                                size_t events;
+                                char padding[64];
+                            };
+                            std::vector<counter> counters(m_threads, counter{0, {}});
+                            common::parallel_for(common::tags::numa_execution(m_threads, numa_bounds(pos)), nv.size(), [&](size_t i, size_t t){
+                                update_node(i);
+                                ++counters[t].events;
+                            });
+                            for (size_t t = 0; t < m_threads; ++t) m_numa_events[t * m_numa / m_threads] += counters[t].events;
+                        } else if (balancing) {
+                            std::vector<size_t> bounds = chunk_bounds(pos, m_cuts);
+                            common::parallel_for(common::tags::chunked_execution(m_threads, bounds), nv.size(), [&](size_t i, size_t){
+                                update_node(i);
+                            });
+                            balance(nv, bounds);
+                        } else common::parallel_for(common::tags::general_execution<parallel>(m_threads), nv.size(), [&](size_t i, size_t){
+                            update_node(i);
+                        });
+                        if (deterministic) flush_inboxes();
+                        std::vector<device_t> done;
+                        for (device_t uid : nv) {
+                            node_type* n = m_nodes.find_ptr(uid);
+                            if (n == nullptr) continue;
+                            times_t nxt = n->next();
+                            if (nxt < TIME_MAX) m_queue.push(nxt, uid);
+                            else done.push_back(uid);
                         }
-                    });
-                    for (device_t uid : nv) if (m_nodes.count(uid) > 0) {
-                        times_t nxt = m_nodes.at(uid).next();
-                        if (nxt < TIME_MAX) m_queue.push(nxt, uid);
-                        else node_erase(uid);
+                        node_erase_bulk(done);
                     }
                 } else P::net::update();
             }
 
+            //! @brief The number of events executed by threads of each NUMA node (with \ref tags::numa_nodes).
+            std::vector<size_t> const& numa_events() const {
+                return m_numa_events;
+            }
+
+            //! @brief Whether the duration of rounds is measured to balance the load among threads (with \ref tags::balance_threshold).
+            bool load_balancing() const {
+                return parallel and not optimistic and m_balance_threshold < INF and m_numa == 1 and m_threads > 1;
+            }
+
+            //! @brief The load imbalance last measured (with \ref tags::balance_threshold).
+            real_t load_imbalance() const {
+                return m_imbalance;
+            }
+
+            //! @brief The first position in the iteration order of the chunk of each thread (empty for an even split, with \ref tags::balance_threshold).
+            std::vector<size_t> const& load_cuts() const {
+                return m_cuts;
+            }
+
+            //! @brief The time before which events cannot be rolled back (`TIME_MAX` when not executing optimistically).
+            times_t virtual_time() const {
+                return m_gvt;
+            }
+
+            //! @brief The type of keys ordering events.
+            using event_key = typename P::net::event_key;
+
+            //! @brief Whether events may be rolled back (only with optimistic executions).
+            constexpr static bool speculative = optimistic;
+
+            //! @brief The key of the event executing in the current thread (used by optimistic executions).
+            event_key speculation_key() const {
+                return current_key();
+            }
+
+            //! @brief Rolls back the event with a given key, and the following events of the same node (used by optimistic executions).
+            void speculation_rollback(event_key const& k) {
+                request(std::get<2>(k), k, false);
+            }
+
+            //! @brief Buffers a message at time `t` from node `d` to a locked node `n`, to be received before the following events (used by deterministic executions).
+            template <typename S, typename T>
+            void buffer_deliver(node_type& n, times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
+                std::vector<inbox_type>* box;
+                {
+                    common::shared_guard<parallel> l(m_inbox_mutex);
+                    auto it = m_inboxes.find(n.uid);
+                    box = it == m_inboxes.end() ? nullptr : &it->second;
+                }
+                if (box == nullptr) {
+                    common::exclusive_guard<parallel> l(m_inbox_mutex);
+                    box = &m_inboxes[n.uid];
+                }
+                if (box->empty()) {
+                    common::exclusive_guard<parallel> l(m_inbox_mutex);
+                    m_receivers.push_back(n.uid);
+                }
+                box->emplace_back(t, d, m);
+            }
+
+            //! @brief Delivers a message at time `t` from node `d` to a locked node `n`, during the event of `d` (used by optimistic executions).
+            template <typename S, typename T>
+            void speculation_deliver(node_type& n, times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
+                sent_list().push_back(n.uid);
+                log_type& l = m_logs.at(n.uid);
+                event_key k = current_key();
+                auto it = std::upper_bound(l.inputs.begin(), l.inputs.end(), k, [](event_key const& x, input_type const& y){
+                    return x < y.first;
+                });
+                l.inputs.emplace(it, k, m);
+                if (k > l.history.back().next) return;
+                if (happened_after(l, k)) request(n.uid, k, true);
+                else n.receive(t, d, m);
+            }
+
+            //! @brief Notifies that a locked node `n` is read by the event executing in the current thread (used by optimistic executions).
+            void speculation_read(node_type& n) {
+                log_type& l = m_logs.at(n.uid);
+                event_key k = current_key();
+                l.reads.push_back(k);
+                if (happened_after(l, k)) {
+                    request(n.uid, k, false);
+                    request(std::get<2>(k), k, false);
+                }
+            }
+
+            //! @brief Statistics on optimistic executions.
+            speculation_stats_type const& speculation_stats() const {
+                return m_stats;
+            }
+
             //! @brief Returns the total number of nodes.
             inline size_t node_size() const {
                 return m_nodes.size();
@@ -264,20 +780,492 @@ struct identifier {
                 device_t const& id = common::get<tags::uid>(tt);
                 m_nodes.emplace(std::piecewise_construct, std::make_tuple(id), std::tuple<typename F::net&, decltype(tt)>(P::net::as_final(), tt));
                 m_queue.push(m_nodes.at(id).next(), id);
+                maybe_log(common::number_sequence<optimistic>{}, id);
+                m_cuts.clear();
                 return id;
             }
 
+            /**
+             * @brief Creates many nodes, initialising them with data in the tuples of `v` (returns the identifiers assigned).
+             *
+             * Tuples with an identifier already present, or repeated in `v`, are skipped (except for their first
+             * occurrence), so that the identifiers returned are those of the nodes created.
+             * Nodes are constructed in parallel if parallelism is enabled and a \ref randomizer provides
+             * independent random generators to nodes, and sequentially otherwise. Components are notified
+             * through `emplace_bulk_start()` and `emplace_bulk_end()`, so that they can set up nodes in batch.
+             * With \ref tags::numa_nodes, parallel constructions are split as the iteration order among NUMA
+             * nodes, so that every node is first touched by a thread pinned to the NUMA node owning it.
+             */
+            template <typename S, typename T>
+            std::vector<device_t> node_emplace_bulk(std::vector<common::tagged_tuple<S,T>> const& v) {
+                using tt_type = std::decay_t<decltype(push_uid(v[0], typename S::template intersect<tags::uid>()))>;
+                std::vector<tt_type> tts;
+                std::vector<device_t> ids;
+                tts.reserve(v.size());
+                ids.reserve(v.size());
+                std::unordered_set<device_t> batch;
+                for (auto const& t : v) {
+                    // identifiers repeated or already present are skipped
+                    if (has_uid(t, typename S::template intersect<tags::uid>())) continue;
+                    tts.emplace_back(push_uid(t, typename S::template intersect<tags::uid>()));
+                    device_t id = common::get<tags::uid>(tts.back());
+                    if (not batch.insert(id).second) tts.pop_back();
+                    else ids.push_back(id);
+                }
+                auto emplace = [&](auto const& e){
+                    m_nodes.emplace_bulk(e, ids, [&](size_t i){
+                        return std::tuple<typename F::net&, tt_type const&>(P::net::as_final(), tts[i]);
+                    });
+                };
+                P::net::as_final().emplace_bulk_start();
+#ifndef FCPP_DISABLE_EXCEPTIONS
+                try {
+#endif
+                    if (parallel and has_randomizer<P>::value and m_numa > 1) {
+                        // new nodes are appended to the iteration order, and split as it among NUMA nodes
+                        size_t base = m_nodes.size(), total = base + ids.size();
+                        std::vector<size_t> bounds(m_numa);
+                        for (size_t g = 0; g < m_numa; ++g)
+                            bounds[g] = std::min(std::max((g * total + m_numa - 1) / m_numa, base) - base, ids.size());
+                        emplace(common::tags::numa_execution(m_threads, bounds));
+                    } else emplace(common::tags::general_execution<parallel and has_randomizer<P>::value>(m_threads));
+#ifndef FCPP_DISABLE_EXCEPTIONS
+                } catch (...) {
+                    P::net::as_final().emplace_bulk_end();
+                    throw;
+                }
+#endif
+                P::net::as_final().emplace_bulk_end();
+                if (not ids.empty()) m_cuts.clear();
+                for (device_t id : ids) {
+                    m_queue.push(m_nodes.at(id).next(), id);
+                    maybe_log(common::number_sequence<optimistic>{}, id);
+                }
+                return ids;
+            }
+
             //! @brief Erases the node with a given identifier.
             inline size_t node_erase(device_t uid) {
-                return m_nodes.erase(uid);
+                m_logs.erase(uid);
+                m_inboxes.erase(uid);
+                size_t n = m_nodes.erase(uid);
+                if (n > 0) m_cuts.clear();
+                return n;
+            }
+
+            //! @brief Erases the nodes with given identifiers, destroying them in parallel if enabled (returns the number of nodes erased).
+            size_t node_erase_bulk(std::vector<device_t> const& uids) {
+                for (device_t uid : uids) {
+                    m_logs.erase(uid);
+                    m_inboxes.erase(uid);
+                }
+                size_t n = m_nodes.erase_bulk(common::tags::general_execution<parallel>(m_threads), uids);
+                if (n > 0) m_cuts.clear();
+                return n;
             }
 
             //! @brief Erases all nodes.
             inline void node_clear() {
+                m_logs.clear();
+                m_inboxes.clear();
+                m_receivers.clear();
                 m_nodes.clear();
+                m_cuts.clear();
             }
 
           private: // implementation details
+            //! @brief A message buffered during a deterministic execution, with its time and sender.
+            using inbox_type = std::tuple<times_t, device_t, typename F::node::message_t>;
+
+            //! @brief Receives the buffered messages, sorted by time and sender (used by deterministic executions).
+            void flush_inboxes() {
+                common::parallel_for(common::tags::general_execution<parallel>(m_threads), m_receivers.size(), [this](size_t i, size_t){
+                    auto it = m_inboxes.find(m_receivers[i]);
+                    if (it == m_inboxes.end()) return;
+                    std::vector<inbox_type>& box = it->second;
+                    node_type* n = m_nodes.find_ptr(m_receivers[i]);
+                    if (n != nullptr) {
+                        std::stable_sort(box.begin(), box.end(), [](inbox_type const& x, inbox_type const& y){
+                            return std::make_pair(std::get<0>(x), std::get<1>(x)) < std::make_pair(std::get<0>(y), std::get<1>(y));
+                        });
+                        common::lock_guard<parallel> device_lock(n->mutex);
+                        for (inbox_type const& x : box) n->receive(std::get<0>(x), std::get<1>(x), std::get<2>(x));
+                    }
+                    box.clear();
+                });
+                m_receivers.clear();
+            }
+
+            //! @brief A message received during an optimistic execution, with its key.
+            using input_type = std::pair<event_key, typename F::node::message_t>;
+
+            //! @brief A node state saved during an optimistic execution.
+            struct snapshot_type {
+                //! @brief The keys of the events preceding and following the state.
+                event_key prev, next;
+                //! @brief The serialised state.
+                common::osstream state;
+                //! @brief Whether the following event happened (or is happening).
+                bool done;
+                //! @brief The receivers of messages sent by the following event.
+                std::vector<device_t> sent;
+            };
+
+            //! @brief The data needed to roll back a node.
+            struct log_type {
+                //! @brief States saved after events which can still be rolled back, the last preceding the next event.
+                std::deque<snapshot_type> history;
+                //! @brief Messages which can still be rolled back, sorted by key.
+                std::vector<input_type> inputs;
+                //! @brief Keys of the events reading the node state, which can still be rolled back.
+                std::vector<event_key> reads;
+                //! @brief The time the node is queued for (`TIME_MAX` if not queued).
+                times_t queued;
+            };
+
+            //! @brief Does not log nodes (non-optimistic overload).
+            inline void maybe_log(common::number_sequence<false>, device_t) {}
+
+            //! @brief Starts the log of a newly created node (optimistic overload).
+            void maybe_log(common::number_sequence<true>, device_t uid) {
+                log_type& l = m_logs[uid];
+                l.history.push_back(save(m_nodes.at(uid), event_key(TIME_MIN, 0, uid)));
+                l.queued = std::get<0>(l.history.back().next);
+            }
+
+            //! @brief Saves the state of a node following a given event.
+            snapshot_type save(node_type& n, event_key prev) {
+                times_t t = n.next();
+                snapshot_type s{prev, event_key(t, t == std::get<0>(prev) ? std::get<1>(prev) + 1 : 0, n.uid), {}, false, {}};
+                s.state << n;
+                return s;
+            }
+
+            //! @brief Whether an event following key `k` already happened for the node with log `l`.
+            static bool happened_after(log_type const& l, event_key const& k) {
+                for (size_t i = l.history.size(); i > 0; --i) if (l.history[i-1].done)
+                    return l.history[i-1].next > k;
+                return false;
+            }
+
+            //! @brief The key of the event executing in the current thread.
+            static event_key& current_key() {
+                static thread_local event_key k(TIME_MAX, 0, 0);
+                return k;
+            }
+
+            //! @brief The receivers of messages sent by the event executing in the current thread.
+            static std::vector<device_t>& sent_list() {
+                static thread_local std::vector<device_t> v;
+                return v;
+            }
+
+            //! @brief Requests the rollback of node `uid` before key `k` (also when no event follows it, if its messages changed).
+            void request(device_t uid, event_key k, bool changed) {
+                common::lock_guard<parallel> l(m_request_mutex);
+                m_requests.emplace_back(uid, k, changed);
+            }
+
+            //! @brief Executes events speculatively (disabled).
+            inline void speculate(common::number_sequence<false>) {}
+
+            //! @brief Executes speculatively a window of events, rolling back after causality conflicts.
+            void speculate(common::number_sequence<true>) {
+                std::vector<device_t> nv;
+                times_t end = std::min(P::net::next(), P::net::run_end());
+                while (nv.size() < m_window and m_queue.next() < end) {
+                    times_t t = m_queue.next();
+                    for (device_t uid : m_queue.pop(t)) if (m_logs.count(uid) > 0 and m_logs.at(uid).queued == t) {
+                        m_logs.at(uid).queued = TIME_MAX;
+                        nv.push_back(uid);
+                    }
+                }
+                std::sort(nv.begin(), nv.end(), [this](device_t x, device_t y){
+                    return m_logs.at(x).history.back().next < m_logs.at(y).history.back().next;
+                });
+                common::parallel_for(common::tags::general_execution<parallel>(m_window > 1 ? m_threads : 1), nv.size(), [&nv,this](size_t i, size_t){
+                    node_type& n = m_nodes.at(nv[i]);
+                    common::lock_guard<parallel> device_lock(n.mutex);
+                    log_type& l = m_logs.at(nv[i]);
+                    event_key e = l.history.back().next;
+                    l.history.back().done = true;
+                    current_key() = e;
+                    sent_list().clear();
+                    n.update();
+                    current_key() = event_key(TIME_MAX, 0, 0);
+                    l.history.back().sent = sent_list();
+                    for (size_t j = 0; j < l.reads.size(); ++j) if (l.reads[j] > e) {
+                        request(std::get<2>(l.reads[j]), l.reads[j], false);
+                        l.reads[j--] = l.reads.back();
+                        l.reads.pop_back();
+                    }
+                    l.history.push_back(save(n, e));
+                    apply(n, l, l.history.back());
+                    while (std::get<0>(l.history.front().next) < m_gvt) l.history.pop_front();
+                    event_key k = l.history.front().prev;
+                    l.inputs.erase(l.inputs.begin(), std::upper_bound(l.inputs.begin(), l.inputs.end(), k, [](event_key const& x, input_type const& y){
+                        return x < y.first;
+                    }));
+                    l.reads.erase(std::remove_if(l.reads.begin(), l.reads.end(), [this](event_key const& r){
+                        return std::get<0>(r) < m_gvt;
+                    }), l.reads.end());
+                });
+                ++m_stats.windows;
+                m_stats.events += nv.size();
+                bool conflict = m_requests.size() > 0;
+                while (m_requests.size() > 0) {
+                    auto r = m_requests.back();
+                    m_requests.pop_back();
+                    rollback(std::get<0>(r), std::get<1>(r), std::get<2>(r));
+                }
+                for (device_t uid : nv) {
+                    log_type& l = m_logs.at(uid);
+                    if (l.queued == TIME_MAX) {
+                        l.queued = std::get<0>(l.history.back().next);
+                        if (l.queued < TIME_MAX) m_queue.push(l.queued, uid);
+                        else m_retired.push_back(uid);
+                    }
+                }
+                m_gvt = m_queue.next();
+                for (size_t i = 0; i < m_retired.size(); ++i) {
+                    device_t uid = m_retired[i];
+                    bool erase = m_logs.count(uid) == 0 or m_logs.at(uid).queued < TIME_MAX;
+                    if (not erase and std::get<0>(m_logs.at(uid).history.back().prev) < m_gvt) {
+                        node_erase(uid);
+                        erase = true;
+                    }
+                    if (erase) {
+                        m_retired[i--] = m_retired.back();
+                        m_retired.pop_back();
+                    }
+                }
+                m_window = conflict ? std::max(m_window / 2, size_t(1)) : std::min(2 * m_window, m_window_max);
+            }
+
+            //! @brief Receives the messages between the events preceding and following a saved state.
+            void apply(node_type& n, log_type& l, snapshot_type const& s) {
+                for (input_type const& x : l.inputs)
+                    if (s.prev < x.first and x.first < s.next)
+                        n.receive(std::get<0>(x.first), std::get<2>(x.first), x.second);
+            }
+
+            //! @brief Rolls back node `uid` before key `k` (also when no event follows it, if its messages changed).
+            void rollback(device_t uid, event_key k, bool changed) {
+                if (m_logs.count(uid) == 0) return;
+                log_type& l = m_logs.at(uid);
+                std::deque<snapshot_type>& h = l.history;
+                if (h.back().next < k) return;
+                size_t i = h.size() - 1;
+                while (i > 0 and h[i-1].next >= k) --i;
+                if (i == h.size() - 1 and not changed) return;
+                ++m_stats.rollbacks;
+                for (size_t j = i; j < h.size(); ++j) if (h[j].done) {
+                    ++m_stats.rolled_back;
+                    for (device_t y : h[j].sent) cancel(y, h[j].next);
+                }
+                h.erase(h.begin() + i + 1, h.end());
+                snapshot_type& s = h.back();
+                s.done = false;
+                s.sent.clear();
+                node_type& n = m_nodes.at(uid);
+                common::isstream is(s.state.data());
+                current_key() = s.next;
+                is >> n;
+                current_key() = event_key(TIME_MAX, 0, 0);
+                apply(n, l, s);
+                for (size_t j = 0; j < l.reads.size(); ++j) if (l.reads[j] > k) {
+                    request(std::get<2>(l.reads[j]), l.reads[j], false);
+                    l.reads[j--] = l.reads.back();
+                    l.reads.pop_back();
+                }
+                if (l.queued != std::get<0>(s.next)) {
+                    l.queued = std::get<0>(s.next);
+                    if (l.queued < TIME_MAX) m_queue.push(l.queued, uid);
+                }
+            }
+
+            //! @brief Cancels a message with key `k` received by node `uid` (as an anti-message).
+            void cancel(device_t uid, event_key k) {
+                if (m_logs.count(uid) == 0) return;
+                log_type& l = m_logs.at(uid);
+                auto it = std::lower_bound(l.inputs.begin(), l.inputs.end(), k, [](input_type const& x, event_key const& y){
+                    return x.first < y;
+                });
+                if (it == l.inputs.end() or it->first != k) return;
+                l.inputs.erase(it);
+                if (k < l.history.back().next) request(uid, k, true);
+            }
+
+            //! @brief The lookahead provided by the connector.
+            template <typename N>
+            static constexpr auto default_lookahead(int) -> decltype(N::delay_lookahead()) {
+                return N::delay_lookahead();
+            }
+
+            //! @brief The lookahead if not provided by the connector.
+            template <typename N>
+            static constexpr times_t default_lookahead(long) {
+                return 0;
+            }
+
+            //! @brief The earliest time at which a node may send a message (nodes with a connector).
+            template <typename N>
+            inline auto send_bound(N const& n, int) const -> decltype(n.send_time()) {
+                return std::min(n.send_time(), n.next() + m_lookahead);
+            }
+
+            //! @brief The earliest time at which a node may send a message (nodes without a connector).
+            template <typename N>
+            inline times_t send_bound(N const&, long) const {
+                return TIME_MAX;
+            }
+
+            //! @brief The index of the first event from `i` whose node may send messages (or of the last event if none).
+            size_t next_sender(std::vector<device_t> const& nv, size_t i) const {
+                for (; i + 1 < nv.size(); ++i) {
+                    node_type const* n = m_nodes.find_ptr(nv[i]);
+                    if (n != nullptr and send_bound(*n, 0) <= n->next()) break;
+                }
+                return i;
+            }
+
+            //! @brief Adds to `nv` all the events preceding any message that could affect them.
+            void pop_safe(std::vector<device_t>& nv) {
+                times_t bound = P::net::next();
+                for (device_t uid : nv) if (m_nodes.count(uid) > 0)
+                    bound = std::min(bound, send_bound(m_nodes.at(uid), 0));
+                while (m_queue.next() < bound) {
+                    times_t t = m_queue.next();
+                    std::vector<device_t> v = m_queue.pop(t);
+                    times_t b = bound;
+                    for (device_t uid : v) if (m_nodes.count(uid) > 0)
+                        b = std::min(b, send_bound(m_nodes.at(uid), 0));
+                    if (b <= t) {
+                        for (device_t uid : v) m_queue.push(t, uid);
+                        break;
+                    }
+                    bound = b;
+                    nv.insert(nv.end(), v.begin(), v.end());
+                }
+            }
+
+            //! @brief Sorts nodes by position, and schedules the following sorting.
+            void reorder() {
+                m_reorder_next = m_queue.next() + m_reorder_period;
+                reorder_impl(0);
+                m_cuts.clear();
+            }
+
+            //! @brief Sorts nodes by the Morton code of their position (nodes with a position).
+            template <typename N = node_type>
+            auto reorder_impl(int) -> decltype(std::declval<N const&>().position(), void()) {
+                if (m_nodes.size() == 0) return;
+                auto lo = m_nodes.begin()->second.position();
+                auto hi = lo;
+                for (auto const& x : m_nodes) {
+                    auto const& p = x.second.position();
+                    for (size_t i = 0; i < p.dimension; ++i) {
+                        lo[i] = std::min(lo[i], p[i]);
+                        hi[i] = std::max(hi[i], p[i]);
+                    }
+                }
+                m_nodes.sort_by([&lo,&hi](typename map_type::const_reference x){
+                    return details::morton_code(x.second.position(), lo, hi);
+                });
+            }
+
+            //! @brief Keeps the current order (nodes without a position).
+            template <typename N = node_type>
+            inline void reorder_impl(long) {}
+
+            //! @brief Sorts identifiers by the iteration order of their nodes, returning their positions in it.
+            std::vector<size_t> sort_order(std::vector<device_t>& nv) {
+                std::vector<std::pair<size_t, device_t>> v;
+                v.reserve(nv.size());
+                for (device_t uid : nv) {
+                    auto it = m_nodes.find(uid);
+                    v.emplace_back(it - m_nodes.begin(), uid);
+                }
+                std::sort(v.begin(), v.end());
+                std::vector<size_t> pos(v.size());
+                for (size_t i = 0; i < v.size(); ++i) {
+                    nv[i] = v[i].second;
+                    pos[i] = v[i].first;
+                }
+                return pos;
+            }
+
+            //! @brief The index of the first event owned by each NUMA node, given the sorted positions of the nodes.
+            std::vector<size_t> numa_bounds(std::vector<size_t> const& pos) const {
+                std::vector<size_t> cuts(m_numa);
+                for (size_t g = 0; g < m_numa; ++g) cuts[g] = (g * m_nodes.size() + m_numa - 1) / m_numa;
+                return chunk_bounds(pos, cuts);
+            }
+
+            //! @brief The index of the first event of each chunk, given the sorted positions of the nodes and the first position of each chunk (or an even split if none).
+            std::vector<size_t> chunk_bounds(std::vector<size_t> const& pos, std::vector<size_t> const& cuts) const {
+                if (cuts.empty()) {
+                    std::vector<size_t> bounds(m_threads);
+                    for (size_t g = 0; g < m_threads; ++g) bounds[g] = g * pos.size() / m_threads;
+                    return bounds;
+                }
+                std::vector<size_t> bounds(cuts.size());
+                size_t i = 0;
+                for (size_t g = 0; g < cuts.size(); ++g) {
+                    while (i < pos.size() and pos[i] < cuts[g]) ++i;
+                    bounds[g] = i;
+                }
+                return bounds;
+            }
+
+            /**
+             * @brief Accumulates the cost of the rounds executed among chunks, measuring its imbalance once at least as
+             * many events as nodes are accounted, and cutting nodes into chunks of equal cost if above threshold.
+             */
+            void balance(std::vector<device_t> const& nv, std::vector<size_t> const& bounds) {
+                m_balance_cost.resize(m_threads);
+                for (size_t g = 0; g < m_threads; ++g)
+                    for (size_t i = bounds[g]; i < (g+1 < m_threads ? bounds[g+1] : nv.size()); ++i) {
+                        node_type* n = m_nodes.find_ptr(nv[i]);
+                        // events other than rounds are not charged
+                        if (n != nullptr) m_balance_cost[g] += n->event_cost();
+                    }
+                m_balance_events += nv.size();
+                if (m_balance_events < std::max<size_t>(m_nodes.size(), m_threads)) return;
+                real_t total = 0, top = 0;
+                for (real_t c : m_balance_cost) {
+                    total += c;
+                    top = std::max(top, c);
+                }
+                m_balance_cost.assign(m_threads, 0);
+                m_balance_events = 0;
+                m_imbalance = total > 0 ? top * m_threads / total : 1;
+                if (m_imbalance <= m_balance_threshold) return;
+                total = 0;
+                for (auto const& x : m_nodes) total += x.second.round_cost();
+                m_cuts.assign(1, 0);
+                real_t acc = 0;
+                size_t i = 0;
+                for (auto const& x : m_nodes) {
+                    acc += x.second.round_cost();
+                    ++i;
+                    while (m_cuts.size() < m_threads and acc * m_threads >= total * m_cuts.size()) m_cuts.push_back(i);
+                }
+                while (m_cuts.size() < m_threads) m_cuts.push_back(m_nodes.size());
+            }
+
+            //! @brief Whether the device UID requested is already present (never without request).
+            template <typename T>
+            inline bool has_uid(T const&, common::type_sequence<>) const {
+                return false;
+            }
+
+            //! @brief Whether the device UID requested is already present (with request).
+            template <typename T>
+            inline bool has_uid(T const& t, common::type_sequence<tags::uid>) const {
+                return m_nodes.count(common::get<tags::uid>(t)) > 0;
+            }
+
             //! @brief Returns the next device UID to be created (without request).
             template <typename T>
             inline auto push_uid(T const& t, common::type_sequence<>) {
@@ -299,7 +1287,7 @@ struct identifier {
             map_type m_nodes;
 
             //! @brief The queue of identifiers by next event.
-            details::times_queue<synchronised> m_queue;
+            queue_type m_queue;
 
             //! @brief The next free identifier.
             device_t m_next_uid;
@@ -309,6 +1297,67 @@ struct identifier {
 
             //! @brief The number of threads to be used.
             size_t const m_threads;
+
+            //! @brief Lower bound on the delay between a round and its message sending.
+            times_t const m_lookahead;
+
+            //! @brief The maximum and current number of events executed speculatively together.
+            size_t const m_window_max;
+            size_t m_window;
+
+            //! @brief The global virtual time.
+            times_t m_gvt;
+
+            //! @brief The rollback data of nodes.
+            std::unordered_map<device_t, log_type> m_logs;
+
+            //! @brief Nodes without further events, to be erased when they cannot be rolled back.
+            std::vector<device_t> m_retired;
+
+            //! @brief Requested rollbacks.
+            std::vector<std::tuple<device_t, event_key, bool>> m_requests;
+
+            //! @brief A mutex regulating access to requested rollbacks.
+            common::mutex<parallel> m_request_mutex;
+
+            //! @brief Statistics on optimistic executions.
+            speculation_stats_type m_stats;
+
+            //! @brief Messages buffered for each receiver during deterministic executions.
+            std::unordered_map<device_t, std::vector<inbox_type>> m_inboxes;
+
+            //! @brief Nodes with buffered messages.
+            std::vector<device_t> m_receivers;
+
+            //! @brief A mutex regulating access to buffered messages.
+            common::shared_mutex<parallel> m_inbox_mutex;
+
+            //! @brief The period of the reordering of nodes by position.
+            times_t const m_reorder_period;
+
+            //! @brief The time of the next reordering of nodes by position.
+            times_t m_reorder_next;
+
+            //! @brief The number of NUMA nodes.
+            size_t const m_numa;
+
+            //! @brief The number of events executed by threads of each NUMA node.
+            std::vector<size_t> m_numa_events;
+
+            //! @brief The load imbalance above which chunks are rebalanced.
+            real_t const m_balance_threshold;
+
+            //! @brief The load imbalance last measured.
+            real_t m_imbalance;
+
+            //! @brief The cost of the events assigned to each thread since the imbalance was last measured.
+            std::vector<real_t> m_balance_cost;
+
+            //! @brief The number of events executed since the imbalance was last measured.
+            size_t m_balance_events = 0;
+
+            //! @brief The first position in the iteration order of the chunk of each thread (empty for an even split, cleared as nodes change).
+            std::vector<size_t> m_cuts;
         };
     };
 };
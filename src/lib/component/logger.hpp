@@ -251,6 +251,10 @@ struct logger {
 
         //! @brief The global part of the component.
         class net : public P::net {
+            //! @cond INTERNAL
+            static_assert(not value_push or not P::net::speculative, "values pushed by logger cannot be rolled back by optimistic identifier");
+            //! @endcond
+
           public: // visible by node objects and the main program
             //! @brief Type for the result of an aggregation (printed on the console).
             using log_type = common::tagged_tuple_cat<common::tagged_tuple_t<plot::time, times_t>, typename details::row_type<aggregators_type, functors_type>::type>;
@@ -124,6 +124,12 @@ struct randomizer {
                 return dist(m_generator);
             }
 
+            //! @brief Serialises the state of the node from/to a given input/output stream.
+            template <typename S>
+            S& serialize(S& s) {
+                return P::node::serialize(s) & m_generator;
+            }
+
           private: // implementation details
             //! @brief The random number generator.
             generator_type m_generator;
@@ -94,6 +94,12 @@ struct scheduler {
                 } else P::node::update();
             }
 
+            //! @brief Serialises the state of the node from/to a given input/output stream.
+            template <typename S>
+            S& serialize(S& s) {
+                return P::node::serialize(s) & m_schedule;
+            }
+
           private: // implementation details
             //! @brief Returns the `randomizer` generator if available.
             template <typename N>
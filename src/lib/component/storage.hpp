@@ -11,6 +11,7 @@
 #include <cassert>
 #include <type_traits>
 
+#include "lib/common/arena.hpp"
 #include "lib/component/base.hpp"
 
 
@@ -151,6 +152,19 @@ struct storage {
 
             #undef MISSING_TYPE_MESSAGE
 
+            //! @brief Performs computations at round end with current time `t`.
+            void round_end(times_t t) {
+                // stored data outlives the round, thus is copied out of the round arena before it is rewound
+                if (FCPP_ROUND_ARENA) m_storage = common::arena::escape(m_storage);
+                P::node::round_end(t);
+            }
+
+            //! @brief Serialises the state of the node from/to a given input/output stream.
+            template <typename S>
+            S& serialize(S& s) {
+                return P::node::serialize(s) & m_storage;
+            }
+
           private: // implementation details
             //! @brief The data storage.
             node_tuple_type m_storage;
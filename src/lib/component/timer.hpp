@@ -177,11 +177,17 @@ struct timer {
                 m_fact = f;
             }
 
+            //! @brief Serialises the state of the node from/to a given input/output stream.
+            template <typename S>
+            S& serialize(S& s) {
+                return P::node::serialize(s) & m_prev & m_cur & m_next & m_neigh & m_offs & m_fact;
+            }
+
           private: // implementation details
             //! @brief Changes the domain of a field-like structure to match the domain of the neightbours ids.
             template <typename A>
             void maybe_align_inplace(field<A>& x, std::true_type) {
-                align_inplace(x, std::vector<device_t>(fcpp::details::get_ids(P::node::nbr_uid())));
+                align_inplace(x, fcpp::details::field_vector<device_t>(fcpp::details::get_ids(P::node::nbr_uid())));
             }
 
             //! @brief Does not perform any alignment
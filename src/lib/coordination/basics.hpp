@@ -9,6 +9,7 @@
 #define FCPP_COORDINATION_BASICS_H_
 
 #include "lib/data/field.hpp"
+#include "lib/data/nbr_view.hpp"
 #include "lib/internal/trace.hpp"
 
 
@@ -197,8 +198,8 @@ size_t count_hood(node_t& node, trace_t call_point) {
 template <typename node_t>
 field<device_t> nbr_uid(node_t& node, trace_t call_point) {
     auto ctx = node.void_context(call_point);
-    std::vector<device_t> ids = ctx.align();
-    std::vector<device_t> vals;
+    fcpp::details::field_vector<device_t> ids = ctx.align();
+    fcpp::details::field_vector<device_t> vals;
     vals.emplace_back();
     vals.insert(vals.end(), ids.begin(), ids.end());
     return fcpp::details::make_field(std::move(ids), std::move(vals));
@@ -345,6 +346,27 @@ template <typename node_t, typename A>
 inline to_field<A> nbr(node_t& node, trace_t call_point, A const& f) {
     return nbr(node, call_point, f, f);
 }
+/**
+ * @brief A lazy view of the neighbours' value of the second argument, defaulting to the first argument.
+ *
+ * Equivalent to `nbr(f0, f)`, except that hood reductions read the values directly from the neighbours' exports,
+ * and a field is built only if the view is converted to one. The view can only be used within the current round.
+ */
+template <typename node_t, typename D, typename A, typename = std::enable_if_t<std::is_convertible<D, A>::value>>
+nbr_view<A> lazy_nbr(node_t& node, trace_t call_point, D const& f0, A const& f) {
+    auto ctx = node.template nbr_context<A>(call_point);
+    ctx.insert(f);
+    return ctx.lazy_nbr(f0);
+}
+/**
+ * @brief A lazy view of the neighbours' value of the argument.
+ *
+ * Equivalent to `lazy_nbr(f, f)`.
+ */
+template <typename node_t, typename A>
+inline nbr_view<A> lazy_nbr(node_t& node, trace_t call_point, A const& f) {
+    return lazy_nbr(node, call_point, f, f);
+}
 
 //! @brief The exports type used by the nbr construct with message type `T`.
 template <typename T>
@@ -433,12 +455,16 @@ spawn(node_t& node, trace_t call_point, G&& process, S&& key_set, Ts const&... x
         for (bool b : fcpp::details::get_vals(fb)) if (b) return true;
         return false;
     };
+    auto any_nbr = [](nbr_view<field<bool>> const& vb){
+        for (auto const& e : vb) if (vb.value(e)) return true;
+        return false;
+    };
     resmap_t rm;
     // run process for every gathered key
     for (K const& k : ky) {
         trace_t kh = common::hash_to<trace_t>(k);
         auto fctx = node.template nbr_context<field<bool>>(kh);
-        if (kstart.count(k) == 0 and not any_hood(fctx.nbr(false))) continue;
+        if (kstart.count(k) == 0 and not any_nbr(fctx.lazy_nbr(false))) continue;
         internal::trace_key trace_process(node.stack_trace, kh);
         field<bool> fb;
         tie(rm[k], fb) = process(k, xs...);
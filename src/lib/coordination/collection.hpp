@@ -105,9 +105,9 @@ T wmp_collection(node_t& node, trace_t call_point, real_t distance, real_t radiu
     internal::trace_call trace_caller(node.stack_trace, call_point);
 
     field<real_t> nbrdist = nbr(node, 0, distance);
-    field<real_t> d = max(radius - node.nbr_dist(), field<real_t>{0});
-    field<real_t> p = mux(isinf(distance) or isinf(nbrdist), field<real_t>{0},  distance - nbrdist);
-    field<real_t> out_w = max(d * p, field<real_t>{0});
+    auto d = max(radius - lazy(node.nbr_dist()), real_t{0});
+    auto p = mux(isinf(distance) or isinf(lazy(nbrdist)), real_t{0}, distance - lazy(nbrdist));
+    field<real_t> out_w = max(std::move(d) * std::move(p), real_t{0});
     real_t factor = sum_hood(node, 0, out_w, real_t{0});
     if (factor == 0) factor = 1;
     field<real_t> in_w = nbr(node, 0, out_w / factor);
@@ -129,12 +129,12 @@ T list_idem_collection(node_t& node, trace_t call_point, real_t const& distance,
     real_t t = node.current_time();
     field<real_t> Tu = nbr(node, 1, node.next_time() + epsilon);
     field<real_t> Pu = nbr(node, 2, distance + speed * (node.next_time() - t));
-    field<real_t> maxDistNow = node.nbr_dist() + speed * node.nbr_lag();
-    field<real_t> Vwst = mux(isfinite(distance) and maxDistNow < radius, (distance - Pu) / (Tu - t), (real_t)(-INF));
+    auto maxDistNow = lazy(node.nbr_dist()) + speed * lazy(node.nbr_lag());
+    auto Vwst = mux(isfinite(distance) and std::move(maxDistNow) < radius, (distance - lazy(Pu)) / (lazy(Tu) - t), (real_t)(-INF));
     field<real_t> nbrThreshold = nbr(node, 4, max_hood(node, 0, Vwst, 0));
 
     return nbr(node, 3, value, [&](field<T> old){
-        field<T> nv = mux(isfinite(distance) and nbrdist >= distance + node.nbr_lag() * nbrThreshold, old, null);
+        auto nv = mux(isfinite(distance) and lazy(nbrdist) >= distance + lazy(node.nbr_lag()) * nbrThreshold, old, null);
         return fold_hood(node, 0, accumulate, nv, value);
     });
 }
@@ -157,7 +157,7 @@ T list_arith_collection(node_t& node, trace_t call_point, real_t const& distance
     return old(node, 6, value, [&](T x){
 
         tuple<field<real_t>, unsigned int, T> data = make_tuple(Vwst,node.uid,x);
-        tuple<field<real_t>, unsigned int, T> parentData = max_hood(node, 0, nbr(node,4,data));
+        tuple<field<real_t>, unsigned int, T> parentData = max_hood(node, 0, lazy_nbr(node,4,data));
 
         device_t parent = get<1>(parentData);
         field<T> sum = mux(nbr_uid(node, 0) == parent, get<2>(parentData), null);
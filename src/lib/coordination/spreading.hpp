@@ -56,7 +56,7 @@ real_t abf_distance(node_t& node, trace_t call_point, bool source, G&& metric) {
     internal::trace_call trace_caller(node.stack_trace, call_point);
 
     return nbr(node, 0, INF, [&] (field<real_t> d) {
-        return min_hood(node, 0, d + metric(), source ? 0 : INF);
+        return min_hood(node, 0, lazy(d) + metric(), source ? 0 : INF);
     });
 }
 
@@ -79,9 +79,9 @@ real_t bis_distance(node_t& node, trace_t call_point, bool source, times_t perio
 
     tuple<real_t,times_t> loc = source ? tuple<real_t,times_t>(0, 0) : make_tuple(INF, TIME_MAX);
     return get<0>(nbr(node, 0, loc, [&] (field<tuple<real_t,times_t>> x) {
-        field<real_t> d = get<0>(x) + metric();
         field<times_t> t = get<1>(x) + node.nbr_lag();
-        return min_hood(node, 0, make_tuple(max(d, (t-period)*speed), t), loc);
+        field<real_t> d = max(lazy(get<0>(x)) + metric(), (lazy(t)-period)*speed);
+        return min_hood(node, 0, make_tuple(d, t), loc);
     }));
 }
 
@@ -15,6 +15,7 @@
 
 #include "lib/common/algorithm.hpp"
 #include "lib/coordination/basics.hpp"
+#include "lib/data/field_expr.hpp"
 
 
 /**
@@ -49,10 +50,17 @@ to_field<A> mux(bool b, A const& x, B const& y) {
 //! @brief field guard
 template <typename A, typename B, typename = std::enable_if_t<std::is_same<to_local<A>, to_local<B>>::value>>
 to_field<A> mux(field<bool> b, A const& x, B const& y) {
-    return map_hood([] (bool b, to_local<A> x, to_local<B> y) -> to_local<A> {
+    return details::kernel_select([] (bool b, to_local<A> x, to_local<B> y) -> to_local<A> {
         return b ? x : y;
     }, b, x, y);
 }
+//! @brief lazy expression guard
+template <typename B, typename A, typename C, typename = std::enable_if_t<details::is_field_expr<B> and std::is_same<to_local<std::decay_t<A>>, to_local<std::decay_t<C>>>::value>>
+auto mux(B&& b, A&& x, C&& y) {
+    return details::make_expr([] (bool b, to_local<std::decay_t<A>> const& x, to_local<std::decay_t<C>> const& y) -> to_local<std::decay_t<A>> {
+        return b ? x : y;
+    }, std::forward<B>(b), std::forward<A>(x), std::forward<C>(y));
+}
 
 //! @}
 
@@ -64,13 +72,21 @@ inline A const& max(A const& x, A const& y) {
 }
 
 //! @brief Maximum between two field values.
-template <typename A, typename B, typename = std::enable_if_t<common::has_template<field, tuple<A,B>> and std::is_same<to_local<A>, to_local<B>>::value>>
+template <typename A, typename B, typename = std::enable_if_t<common::has_template<field, tuple<A,B>> and not details::is_field_expr<A> and not details::is_field_expr<B> and std::is_same<to_local<A>, to_local<B>>::value>>
 inline to_field<A> max(A const& x, B const& y) {
     return map_hood([] (to_local<A> x, to_local<B> y) -> to_local<A> {
         return std::max(x, y);
     }, x, y);
 }
 
+//! @brief Maximum between two values, one of which is a lazy expression.
+template <typename A, typename B, typename = std::enable_if_t<(details::is_field_expr<A> or details::is_field_expr<B>) and std::is_same<to_local<std::decay_t<A>>, to_local<std::decay_t<B>>>::value>>
+inline auto max(A&& x, B&& y) {
+    return details::make_expr([] (to_local<std::decay_t<A>> const& x, to_local<std::decay_t<B>> const& y) -> to_local<std::decay_t<A>> {
+        return std::max(x, y);
+    }, std::forward<A>(x), std::forward<B>(y));
+}
+
 //! @brief Minimum between two local values.
 template <typename A, typename = if_local<A>>
 inline A const& min(A const& x, A const& y) {
@@ -78,13 +94,21 @@ inline A const& min(A const& x, A const& y) {
 }
 
 //! @brief Minimum between two field values.
-template <typename A, typename B, typename = std::enable_if_t<common::has_template<field, tuple<A,B>> and std::is_same<to_local<A>, to_local<B>>::value>>
+template <typename A, typename B, typename = std::enable_if_t<common::has_template<field, tuple<A,B>> and not details::is_field_expr<A> and not details::is_field_expr<B> and std::is_same<to_local<A>, to_local<B>>::value>>
 inline to_field<A> min(A const& x, B const& y) {
     return map_hood([] (to_local<A> x, to_local<B> y) -> to_local<A> {
         return std::min(x, y);
     }, x, y);
 }
 
+//! @brief Minimum between two values, one of which is a lazy expression.
+template <typename A, typename B, typename = std::enable_if_t<(details::is_field_expr<A> or details::is_field_expr<B>) and std::is_same<to_local<std::decay_t<A>>, to_local<std::decay_t<B>>>::value>>
+inline auto min(A&& x, B&& y) {
+    return details::make_expr([] (to_local<std::decay_t<A>> const& x, to_local<std::decay_t<B>> const& y) -> to_local<std::decay_t<A>> {
+        return std::min(x, y);
+    }, std::forward<A>(x), std::forward<B>(y));
+}
+
 
 //! @brief Extracts a component from a field of tuple-like structures.
 template <size_t n, typename A>
@@ -105,6 +129,14 @@ inline field<real_t> round(field<real_t> const& f) {
     }, f);
 }
 
+//! @brief Lazy pointwise rounding.
+template <typename F, typename... As>
+inline auto round(field_expr<F, As...> e) {
+    return details::make_expr([](real_t x){
+        return std::round(x);
+    }, std::move(e));
+}
+
 //! @brief Floor rounding.
 using std::floor;
 
@@ -115,6 +147,14 @@ inline field<real_t> floor(field<real_t> const& f) {
     }, f);
 }
 
+//! @brief Lazy pointwise floor rounding.
+template <typename F, typename... As>
+inline auto floor(field_expr<F, As...> e) {
+    return details::make_expr([](real_t x){
+        return std::floor(x);
+    }, std::move(e));
+}
+
 //! @brief Ceil rounding.
 using std::ceil;
 
@@ -125,6 +165,14 @@ inline field<real_t> ceil(field<real_t> const& f) {
     }, f);
 }
 
+//! @brief Lazy pointwise ceil rounding.
+template <typename F, typename... As>
+inline auto ceil(field_expr<F, As...> e) {
+    return details::make_expr([](real_t x){
+        return std::ceil(x);
+    }, std::move(e));
+}
+
 //! @brief Natural logarithm.
 using std::log;
 
@@ -135,6 +183,14 @@ inline field<real_t> log(field<real_t> const& f) {
     }, f);
 }
 
+//! @brief Lazy pointwise natural logarithm.
+template <typename F, typename... As>
+inline auto log(field_expr<F, As...> e) {
+    return details::make_expr([](real_t x){
+        return std::log(x);
+    }, std::move(e));
+}
+
 //! @brief Natural exponentiation.
 using std::exp;
 
@@ -145,6 +201,14 @@ inline field<real_t> exp(field<real_t> const& f) {
     }, f);
 }
 
+//! @brief Lazy pointwise natural exponentiation.
+template <typename F, typename... As>
+inline auto exp(field_expr<F, As...> e) {
+    return details::make_expr([](real_t x){
+        return std::exp(x);
+    }, std::move(e));
+}
+
 //! @brief Square root.
 using std::sqrt;
 
@@ -155,6 +219,14 @@ inline field<real_t> sqrt(field<real_t> const& f) {
     }, f);
 }
 
+//! @brief Lazy pointwise square root.
+template <typename F, typename... As>
+inline auto sqrt(field_expr<F, As...> e) {
+    return details::make_expr([](real_t x){
+        return std::sqrt(x);
+    }, std::move(e));
+}
+
 //! @brief Power.
 using std::pow;
 
@@ -179,6 +251,13 @@ inline field<real_t> pow(field<real_t> const& base, real_t exponent) {
         return std::pow(x, y);
     }, base, exponent);
 }
+//! @brief lazy expression arguments
+template <typename A, typename B, typename = std::enable_if_t<details::is_field_expr<A> or details::is_field_expr<B>>>
+inline auto pow(A&& base, B&& exponent) {
+    return details::make_expr([](real_t x, real_t y){
+        return std::pow(x, y);
+    }, std::forward<A>(base), std::forward<B>(exponent));
+}
 
 //! @}
 
@@ -192,6 +271,14 @@ inline field<bool> isinf(field<real_t> const& f) {
     }, f);
 }
 
+//! @brief Lazy pointwise check for infinite values.
+template <typename F, typename... As>
+inline auto isinf(field_expr<F, As...> e) {
+    return details::make_expr([](real_t x){
+        return std::isinf(x);
+    }, std::move(e));
+}
+
 //! @brief Check for not-a-number values.
 using std::isnan;
 
@@ -202,14 +289,28 @@ inline field<bool> isnan(field<real_t> const& f) {
     }, f);
 }
 
+//! @brief Lazy pointwise check for not-a-number values.
+template <typename F, typename... As>
+inline auto isnan(field_expr<F, As...> e) {
+    return details::make_expr([](real_t x){
+        return std::isnan(x);
+    }, std::move(e));
+}
+
 //! @brief Check for finite values.
 using std::isfinite;
 
 //! @brief Pointwise check for finite values.
 inline field<bool> isfinite(field<real_t> const& f) {
-    return map_hood([](real_t x){
+    return details::kernel_test(common::simd::finite{}, f);
+}
+
+//! @brief Lazy pointwise check for finite values.
+template <typename F, typename... As>
+inline auto isfinite(field_expr<F, As...> e) {
+    return details::make_expr([](real_t x){
         return std::isfinite(x);
-    }, f);
+    }, std::move(e));
 }
 
 //! @brief Check for normal values (finite, non-zero and not sub-normal).
@@ -222,6 +323,14 @@ inline field<bool> isnormal(field<real_t> const& f) {
     }, f);
 }
 
+//! @brief Lazy pointwise check for normal values (finite, non-zero and not sub-normal).
+template <typename F, typename... As>
+inline auto isnormal(field_expr<F, As...> e) {
+    return details::make_expr([](real_t x){
+        return std::isnormal(x);
+    }, std::move(e));
+}
+
 
 //! @brief Namespace containing the libraries of coordination routines.
 namespace coordination {
@@ -277,6 +386,24 @@ inline to_local<A> min_hood(node_t& node, trace_t call_point, A const& a, B cons
     }, a, b);
 }
 
+//! @brief Reduces a field of reals to a single value by minimum (through SIMD kernels).
+template <typename node_t, typename T, typename = common::simd::if_supported<T>>
+inline T min_hood(node_t& node, trace_t call_point, field<T> const& a) {
+    auto ctx = node.void_context(call_point);
+    return fcpp::details::kernel_fold_hood<common::simd::min>([] (T const& x, T const& y) {
+        return std::min(x, y);
+    }, a, ctx.align());
+}
+
+//! @brief Reduces a field of reals to a single value by minimum with a given value for self (through SIMD kernels).
+template <typename node_t, typename T, typename B, typename = common::simd::if_supported<T>>
+inline T min_hood(node_t& node, trace_t call_point, field<T> const& a, B const& b) {
+    auto ctx = node.void_context(call_point);
+    return fcpp::details::kernel_fold_hood<common::simd::min>([] (T const& x, T const& y) {
+        return std::min(x, y);
+    }, a, b, ctx.align(), node.uid);
+}
+
 
 //! @brief Reduces a field to a single value by maximum.
 template <typename node_t, typename A>
@@ -294,6 +421,24 @@ inline to_local<A> max_hood(node_t& node, trace_t call_point, A const& a, B cons
     }, a, b);
 }
 
+//! @brief Reduces a field of reals to a single value by maximum (through SIMD kernels).
+template <typename node_t, typename T, typename = common::simd::if_supported<T>>
+inline T max_hood(node_t& node, trace_t call_point, field<T> const& a) {
+    auto ctx = node.void_context(call_point);
+    return fcpp::details::kernel_fold_hood<common::simd::max>([] (T const& x, T const& y) {
+        return std::max(x, y);
+    }, a, ctx.align());
+}
+
+//! @brief Reduces a field of reals to a single value by maximum with a given value for self (through SIMD kernels).
+template <typename node_t, typename T, typename B, typename = common::simd::if_supported<T>>
+inline T max_hood(node_t& node, trace_t call_point, field<T> const& a, B const& b) {
+    auto ctx = node.void_context(call_point);
+    return fcpp::details::kernel_fold_hood<common::simd::max>([] (T const& x, T const& y) {
+        return std::max(x, y);
+    }, a, b, ctx.align(), node.uid);
+}
+
 
 //! @brief Reduces a field to a single value by addition.
 template <typename node_t, typename A>
@@ -311,6 +456,24 @@ inline auto sum_hood(node_t& node, trace_t call_point, A const& a, B const& b) {
     }, a, b);
 }
 
+//! @brief Reduces a field of reals to a single value by addition (through SIMD kernels).
+template <typename node_t, typename T, typename = common::simd::if_supported<T>>
+inline T sum_hood(node_t& node, trace_t call_point, field<T> const& a) {
+    auto ctx = node.void_context(call_point);
+    return fcpp::details::kernel_fold_hood<common::simd::add>([] (T const& x, T const& y) {
+        return x + y;
+    }, a, ctx.align());
+}
+
+//! @brief Reduces a field of reals to a single value by addition with a given value for self (through SIMD kernels).
+template <typename node_t, typename T, typename B, typename = common::simd::if_supported<T>>
+inline T sum_hood(node_t& node, trace_t call_point, field<T> const& a, B const& b) {
+    auto ctx = node.void_context(call_point);
+    return fcpp::details::kernel_fold_hood<common::simd::add>([] (T const& x, T const& y) {
+        return x + y;
+    }, a, b, ctx.align(), node.uid);
+}
+
 
 //! @brief Reduces a field to a single value by averaging.
 template <typename node_t, typename A>
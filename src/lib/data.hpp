@@ -11,7 +11,9 @@
 #include "lib/data/bloom.hpp"
 #include "lib/data/color.hpp"
 #include "lib/data/field.hpp"
+#include "lib/data/field_expr.hpp"
 #include "lib/data/hyperloglog.hpp"
+#include "lib/data/nbr_view.hpp"
 #include "lib/data/ordered.hpp"
 #include "lib/data/shape.hpp"
 #include "lib/data/tuple.hpp"
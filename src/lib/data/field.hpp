@@ -14,7 +14,10 @@
 #include <vector>
 
 #include "lib/settings.hpp"
+#include "lib/common/arena.hpp"
 #include "lib/common/serialize.hpp"
+#include "lib/common/simd.hpp"
+#include "lib/common/small_vector.hpp"
 #include "lib/data/tuple.hpp"
 
 
@@ -26,6 +29,7 @@ namespace fcpp {
 
 //! @cond INTERNAL
 template <typename T> class field;
+template <typename F, typename... As> class field_expr;
 //! @endcond
 
 
@@ -59,6 +63,10 @@ using field_result = field<local_result<F, A...>>;
 //! @cond INTERNAL
 //! @brief Forward declarations for enabling friendships.
 namespace details {
+    //! @brief Vector type holding the content of fields, inline up to \ref FCPP_FIELD_INLINE neighbours.
+    template <typename T>
+    using field_vector = common::small_vector<T, FCPP_FIELD_INLINE + 1, common::round_allocator<T>>;
+
     template <typename T, typename>
     class field_iterator;
 
@@ -66,21 +74,21 @@ namespace details {
     struct field_base {};
 
     template <typename A>
-    field<A> make_field(std::vector<device_t>&&, std::vector<A>&&);
+    field<A> make_field(field_vector<device_t>&&, field_vector<A>&&);
 
     template <typename A>
-    std::vector<device_t>& get_ids(field<A>&);
+    field_vector<device_t>& get_ids(field<A>&);
     template <typename A>
-    std::vector<device_t> get_ids(field<A>&&);
+    field_vector<device_t> get_ids(field<A>&&);
     template <typename A>
-    std::vector<device_t> const& get_ids(field<A> const&);
+    field_vector<device_t> const& get_ids(field<A> const&);
 
     template <typename A>
-    std::vector<A>& get_vals(field<A>&);
+    field_vector<A>& get_vals(field<A>&);
     template <typename A>
-    std::vector<A> get_vals(field<A>&&);
+    field_vector<A> get_vals(field<A>&&);
     template <typename A>
-    std::vector<A> const& get_vals(field<A> const&);
+    field_vector<A> const& get_vals(field<A> const&);
 
     template <typename A>
     if_local<A, to_local<A&&>> other(A&&);
@@ -96,21 +104,26 @@ namespace details {
     template <typename A, typename = if_field<A>, typename = common::if_class_template<tuple, A>>
     to_local<A&&> self(A&&, device_t);
 
+    template <typename F, typename... As>
+    typename field_expr<F, As...>::value_type other(field_expr<F, As...> const&);
+    template <typename F, typename... As>
+    typename field_expr<F, As...>::value_type self(field_expr<F, As...> const&, device_t);
+
     template <typename A, typename = if_local<A>>
-    inline A align(A&&, std::vector<device_t> const&);
+    inline A align(A&&, field_vector<device_t> const&);
     template <typename A>
-    field<A>& align(field<A>&, std::vector<device_t> const&);
+    field<A>& align(field<A>&, field_vector<device_t> const&);
     template <typename A>
-    field<A> align(field<A>&&, std::vector<device_t> const&);
+    field<A> align(field<A>&&, field_vector<device_t> const&);
     template <typename A>
-    field<A> align(field<A> const&, std::vector<device_t> const&);
+    field<A> align(field<A> const&, field_vector<device_t> const&);
     template <typename A, typename = if_field<A>, typename = common::if_class_template<tuple, A>>
-    decltype(auto) align(A&&, std::vector<device_t> const&);
+    decltype(auto) align(A&&, field_vector<device_t> const&);
 
     template <typename A>
-    field<A>& align_inplace(field<A>&, std::vector<device_t>&&);
+    field<A>& align_inplace(field<A>&, field_vector<device_t>&&);
     template <typename... A>
-    tuple<A...>& align_inplace(tuple<A...>&, std::vector<device_t>&&);
+    tuple<A...>& align_inplace(tuple<A...>&, field_vector<device_t>&&);
 }
 //! @endcond
 
@@ -133,21 +146,21 @@ class field : public details::field_base<std::is_same<T, bool>::value> {
     //! @brief Function friendships
     //! @{
     template <typename A>
-    friend field<A> details::make_field(std::vector<device_t>&&, std::vector<A>&&);
+    friend field<A> details::make_field(details::field_vector<device_t>&&, details::field_vector<A>&&);
 
     template <typename A>
-    friend std::vector<device_t>& details::get_ids(field<A>&);
+    friend details::field_vector<device_t>& details::get_ids(field<A>&);
     template <typename A>
-    friend std::vector<device_t> details::get_ids(field<A>&&);
+    friend details::field_vector<device_t> details::get_ids(field<A>&&);
     template <typename A>
-    friend std::vector<device_t> const& details::get_ids(field<A> const&);
+    friend details::field_vector<device_t> const& details::get_ids(field<A> const&);
 
     template <typename A>
-    friend std::vector<A>& details::get_vals(field<A>&);
+    friend details::field_vector<A>& details::get_vals(field<A>&);
     template <typename A>
-    friend std::vector<A> details::get_vals(field<A>&&);
+    friend details::field_vector<A> details::get_vals(field<A>&&);
     template <typename A>
-    friend std::vector<A> const& details::get_vals(field<A> const&);
+    friend details::field_vector<A> const& details::get_vals(field<A> const&);
     //! @}
     //! @endcond
 
@@ -179,11 +192,11 @@ class field : public details::field_base<std::is_same<T, bool>::value> {
 
     //! @brief Implicit conversion copy constructor.
     template <typename A, typename = std::enable_if_t<std::is_convertible<A,T>::value>>
-    field(field<A> const& f) : m_ids(f.m_ids), m_vals{f.m_vals.begin(), f.m_vals.end()} {}
+    field(field<A> const& f) : m_ids(f.m_ids), m_vals(f.m_vals.begin(), f.m_vals.end()) {}
 
     //! @brief Implicit conversion move constructor.
     template <typename A, typename = std::enable_if_t<std::is_convertible<A,T>::value>>
-    field(field<A>&& f) : m_ids(std::move(f.m_ids)), m_vals{make_move_iterator(f.m_vals.begin()), make_move_iterator(f.m_vals.end())} {}
+    field(field<A>&& f) : m_ids(std::move(f.m_ids)), m_vals(std::make_move_iterator(f.m_vals.begin()), std::make_move_iterator(f.m_vals.end())) {}
 
     //! @brief Implicit conversion copy constructor from field-like structures.
     template <typename A, typename = std::enable_if_t<std::is_convertible<to_local<A>,T>::value and (not common::is_class_template<fcpp::field,A>) and not std::is_convertible<A,T>::value>>
@@ -219,7 +232,7 @@ class field : public details::field_base<std::is_same<T, bool>::value> {
     field& operator=(field<A>&& f) {
         m_ids = std::move(f.m_ids);
         m_vals.clear();
-        m_vals.insert(m_vals.end(), make_move_iterator(f.m_vals.begin()), make_move_iterator(f.m_vals.end()));
+        m_vals.insert(m_vals.end(), std::make_move_iterator(f.m_vals.begin()), std::make_move_iterator(f.m_vals.end()));
         return *this;
     }
     //! @}
@@ -288,13 +301,13 @@ class field : public details::field_base<std::is_same<T, bool>::value> {
     }
 
     //! @brief Ordered IDs of exceptions.
-    std::vector<device_t> m_ids;
+    details::field_vector<device_t> m_ids;
 
     //! @brief Corresponding values of exceptions (default value in position 0).
-    std::vector<T> m_vals;
+    details::field_vector<T> m_vals;
 
     //! @brief Member constructor, for internal use only.
-    field(std::vector<device_t>&& ids, std::vector<T>&& vals) : m_ids(std::move(ids)), m_vals(std::move(vals)) {}
+    field(details::field_vector<device_t>&& ids, details::field_vector<T>&& vals) : m_ids(std::move(ids)), m_vals(std::move(vals)) {}
 };
 
 
@@ -312,22 +325,28 @@ namespace details {
 
     //! @brief Builds a field from member values.
     template <typename A>
-    field<A> make_field(std::vector<device_t>&& ids, std::vector<A>&& vals) {
+    field<A> make_field(field_vector<device_t>&& ids, field_vector<A>&& vals) {
         return {std::move(ids), std::move(vals)};
     }
 
+    //! @brief Builds a field from member values held in standard vectors.
+    template <typename A, typename V, typename I = std::allocator<device_t>>
+    field<A> make_field(std::vector<device_t, I>&& ids, std::vector<A, V>&& vals) {
+        return make_field(field_vector<device_t>(ids.begin(), ids.end()), field_vector<A>(vals.begin(), vals.end()));
+    }
+
     //! @brief Accesses the private field `m_ids` of a field.
     //! @{
     template <typename A>
-    std::vector<device_t>& get_ids(field<A>& f) {
+    field_vector<device_t>& get_ids(field<A>& f) {
         return f.m_ids;
     }
     template <typename A>
-    std::vector<device_t> get_ids(field<A>&& f) {
+    field_vector<device_t> get_ids(field<A>&& f) {
         return std::move(f.m_ids);
     }
     template <typename A>
-    std::vector<device_t> const& get_ids(field<A> const& f) {
+    field_vector<device_t> const& get_ids(field<A> const& f) {
         return f.m_ids;
     }
     //! @}
@@ -335,15 +354,15 @@ namespace details {
     //! @brief Accesses the private field `m_vals` of a field.
     //! @{
     template <typename A>
-    std::vector<A>& get_vals(field<A>& f) {
+    field_vector<A>& get_vals(field<A>& f) {
         return f.m_vals;
     }
     template <typename A>
-    std::vector<A> get_vals(field<A>&& f) {
+    field_vector<A> get_vals(field<A>&& f) {
         return std::move(f.m_vals);
     }
     template <typename A>
-    std::vector<A> const& get_vals(field<A> const& f) {
+    field_vector<A> const& get_vals(field<A> const& f) {
         return f.m_vals;
     }
     //! @}
@@ -436,13 +455,13 @@ namespace details {
     //! @{
     //! @brief align of locals.
     template <typename A, typename>
-    inline A align(A&& x, std::vector<device_t> const&) {
+    inline A align(A&& x, field_vector<device_t> const&) {
         return x;
     }
 
     //! @brief align of fields.
     template <typename A>
-    field<A>& align(field<A>& x, std::vector<device_t> const& s) {
+    field<A>& align(field<A>& x, field_vector<device_t> const& s) {
         size_t rx = 0, wx = 0, ks = 0;
         while (ks < s.size() and rx < get_ids(x).size()) {
             if      (s[ks] < get_ids(x)[rx]) ++ks;
@@ -462,14 +481,14 @@ namespace details {
         return x;
     }
     template <typename A>
-    field<A> align(field<A>&& x, std::vector<device_t> const& s) {
+    field<A> align(field<A>&& x, field_vector<device_t> const& s) {
         align(x, s);
         return x;
     }
     template <typename A>
-    field<A> align(field<A> const& x, std::vector<device_t> const& s) {
-        std::vector<device_t> ids;
-        std::vector<A> vals;
+    field<A> align(field<A> const& x, field_vector<device_t> const& s) {
+        field_vector<device_t> ids;
+        field_vector<A> vals;
         ids.reserve(get_ids(x).size());
         vals.reserve(get_vals(x).size());
         vals.push_back(get_vals(x)[0]);
@@ -488,21 +507,21 @@ namespace details {
 
     //! @brief align of tuples.
     template <typename... A, size_t... is>
-    tuple<A...>& align(tuple<A...>& x, std::vector<device_t> const& s, std::index_sequence<is...>) {
+    tuple<A...>& align(tuple<A...>& x, field_vector<device_t> const& s, std::index_sequence<is...>) {
         common::ignore_args(align(get<is>(x), s)...);
         return x;
     }
     template <typename... A, size_t... is>
-    tuple<A...> align(tuple<A...>&& x, std::vector<device_t> const& s, std::index_sequence<is...>) {
+    tuple<A...> align(tuple<A...>&& x, field_vector<device_t> const& s, std::index_sequence<is...>) {
         common::ignore_args(align(get<is>(x), s)...);
         return x;
     }
     template <typename... A, size_t... is>
-    tuple<A...> align(tuple<A...> const& x, std::vector<device_t> const& s, std::index_sequence<is...>) {
+    tuple<A...> align(tuple<A...> const& x, field_vector<device_t> const& s, std::index_sequence<is...>) {
         return {align(get<is>(x), s)...};
     }
     template <typename A, typename, typename>
-    decltype(auto) align(A&& x, std::vector<device_t> const& s) {
+    decltype(auto) align(A&& x, field_vector<device_t> const& s) {
         return align(std::forward<A>(x), s, std::make_index_sequence<common::template_args<A>::size>{});
     }
     //! @}
@@ -868,8 +887,8 @@ namespace details {
     //! @{
     //! @brief Field case.
     template <typename A>
-    field<A>& align_inplace(field<A>& x, std::vector<device_t>&& s) {
-        std::vector<A> vals;
+    field<A>& align_inplace(field<A>& x, field_vector<device_t>&& s) {
+        field_vector<A> vals;
         vals.reserve(s.size()+1);
         vals.push_back(other(x));
         field_iterator<field<A> const> it(x);
@@ -883,22 +902,22 @@ namespace details {
     }
     //! @brief Indexed structures case.
     template <typename A, size_t i, size_t... is>
-    A& align_inplace(A& x, std::vector<device_t>&& s, std::index_sequence<i, is...>) {
-        common::ignore_args(align_inplace(get<is>(x), std::vector<device_t>{s})...);
+    A& align_inplace(A& x, field_vector<device_t>&& s, std::index_sequence<i, is...>) {
+        common::ignore_args(align_inplace(get<is>(x), field_vector<device_t>{s})...);
         align_inplace(get<i>(x), std::move(s));
         return x;
     }
     //! @brief Tuple case.
     template <typename... A>
-    tuple<A...>& align_inplace(tuple<A...>& x, std::vector<device_t>&& s) {
+    tuple<A...>& align_inplace(tuple<A...>& x, field_vector<device_t>&& s) {
         return align_inplace(x, std::move(s), std::make_index_sequence<sizeof...(A)>{});
     }
     //! @{
 
     //! @brief Returns a fully aligned field with the default value modified.
     template <typename A, typename B>
-    to_field<A> mod_other(A const& x, B const& y, std::vector<device_t>&& s) {
-        std::vector<to_local<A>> vals;
+    to_field<A> mod_other(A const& x, B const& y, field_vector<device_t>&& s) {
+        field_vector<to_local<A>> vals;
         vals.reserve(s.size()+1);
         vals.push_back(other(y));
         field_iterator<A const> it(x);
@@ -918,8 +937,8 @@ namespace details {
     //! @brief General case.
     template <typename A, typename B>
     to_field<A> mod_self(A const& x, B const& y, device_t i) {
-        std::vector<device_t> ids;
-        std::vector<to_local<A>> vals;
+        field_vector<device_t> ids;
+        field_vector<to_local<A>> vals;
         vals.push_back(other(x));
         field_iterator<A const> it(x);
         for (; it.id() < i; ++it) {
@@ -952,7 +971,7 @@ namespace details {
     //! @brief Inclusive folding (optimization for locals).
     template <typename F, typename A>
     if_local<A, local_result<F,A const&,A const&>>
-    fold_hood(F&& op, A const& x, std::vector<device_t> const& dom) {
+    fold_hood(F&& op, A const& x, field_vector<device_t> const& dom) {
         assert(dom.size() > 0);
         size_t n = dom.size();
         local_result<F,A const&,A const&> res = x;
@@ -962,7 +981,7 @@ namespace details {
     //! @brief Inclusive folding.
     template <typename F, typename A>
     if_field<A, local_result<F,A const&,A const&>>
-    fold_hood(F&& op, A const& f, std::vector<device_t> const& dom) {
+    fold_hood(F&& op, A const& f, field_vector<device_t> const& dom) {
         assert(dom.size() > 0);
         field_iterator<A const> it(f);
         while (it.id() < dom[0]) ++it;
@@ -976,7 +995,7 @@ namespace details {
     //! @brief Inclusive folding with ids.
     template <typename F, typename A>
     if_field<A, local_result<F,device_t,A const&,A const&>>
-    fold_hood(F&& op, A const& f, std::vector<device_t> const& dom) {
+    fold_hood(F&& op, A const& f, field_vector<device_t> const& dom) {
         assert(dom.size() > 0);
         field_iterator<A const> it(f);
         while (it.id() < dom[0]) ++it;
@@ -990,7 +1009,7 @@ namespace details {
     //! @brief Exclusive folding (optimization for locals).
     template <typename F, typename A, typename B>
     if_local<A, local_result<F,A const&,B const&>>
-    fold_hood(F&& op, A const& x, B const& b, std::vector<device_t> const& dom, device_t i) {
+    fold_hood(F&& op, A const& x, B const& b, field_vector<device_t> const& dom, device_t i) {
         assert(std::binary_search(dom.begin(), dom.end(), i));
         local_result<F,A const&,B const&> res = details::self(b, i);
         for (size_t n = dom.size(); n>1; --n) res = op(x, res);
@@ -999,7 +1018,7 @@ namespace details {
     //! @brief Exclusive folding.
     template <typename F, typename A, typename B>
     if_field<A, local_result<F,A const&,B const&>>
-    fold_hood(F&& op, A const& f, B const& b, std::vector<device_t> const& dom, device_t i) {
+    fold_hood(F&& op, A const& f, B const& b, field_vector<device_t> const& dom, device_t i) {
         assert(std::binary_search(dom.begin(), dom.end(), i));
         local_result<F,A const&,B const&> res = self(b, i);
         field_iterator<A const> it(f);
@@ -1012,7 +1031,7 @@ namespace details {
     //! @brief Exclusive folding with ids.
     template <typename F, typename A, typename B>
     if_field<A, local_result<F,device_t,A const&,B const&>>
-    fold_hood(F&& op, A const& f, B const& b, std::vector<device_t> const& dom, device_t i) {
+    fold_hood(F&& op, A const& f, B const& b, field_vector<device_t> const& dom, device_t i) {
         assert(std::binary_search(dom.begin(), dom.end(), i));
         local_result<F,device_t,A const&,B const&> res = self(b, i);
         field_iterator<A const> it(f);
@@ -1157,12 +1176,224 @@ if_local<tuple<A,L...>, A&> mod_hood(F&& op, A& a, L&&... l) {
 //! @brief Optimisation for a single field argument in first position.
 template <typename F, typename A, typename... L>
 if_local<tuple<L...>, field<A>&> mod_hood(F&& op, field<A>& a, L const&... l) {
-    for (typename std::vector<A>::reference x : details::get_vals(a)) x = op(x, l...);
+    for (typename details::field_vector<A>::reference x : details::get_vals(a)) x = op(x, l...);
     return a;
 }
 //! @}
 
 
+//! @cond INTERNAL
+namespace details {
+    //! @brief The real type of a field operand of a kernel (void for local operands).
+    //! @{
+    template <typename A>
+    struct kernel_real {
+        using type = void;
+    };
+    template <typename T>
+    struct kernel_real<field<T>> {
+        using type = T;
+    };
+    //! @}
+
+    //! @brief The real type of the field operands of a kernel.
+    template <typename A, typename B>
+    using kernel_t = std::conditional_t<std::is_void<typename kernel_real<A>::type>::value, typename kernel_real<B>::type, typename kernel_real<A>::type>;
+
+    //! @brief Whether an operand fits a kernel on a real type (a field of it, or a local arithmetic value converted to it).
+    //! @{
+    template <typename T, typename A, bool = common::simd::supported<T> and std::is_arithmetic<A>::value>
+    constexpr bool kernel_fits = std::is_same<A, field<T>>::value;
+    template <typename T, typename A>
+    constexpr bool kernel_fits<T, A, true> = std::is_same<std::common_type_t<T, A>, T>::value;
+    //! @}
+
+    //! @brief Whether some operands can be processed by SIMD kernels.
+    template <typename... As>
+    constexpr bool kernel_args = false;
+    template <typename A, typename B>
+    constexpr bool kernel_args<A, B> = common::simd::supported<kernel_t<A, B>> and kernel_fits<kernel_t<A, B>, A> and kernel_fits<kernel_t<A, B>, B>;
+
+    //! @brief Checks whether a field operand shares a domain with the previous ones, pointing to it.
+    template <typename T>
+    inline bool kernel_domain(field_vector<device_t> const*& d, field<T> const& f) {
+        if (d == nullptr) d = &get_ids(f);
+        return d == &get_ids(f) or *d == get_ids(f);
+    }
+    //! @brief Local operands share every domain.
+    template <typename A, typename = if_local<A>>
+    inline bool kernel_domain(field_vector<device_t> const*&, A const&) {
+        return true;
+    }
+
+    //! @brief The values of a field operand.
+    template <typename T>
+    inline T const* kernel_arg(field<T> const& f) {
+        return get_vals(f).data();
+    }
+    //! @brief A local operand converted to the real type.
+    template <typename T, typename A, typename = if_local<A>>
+    inline T kernel_arg(A const& x) {
+        return T(x);
+    }
+
+    //! @brief Whether a kernel compares its operands.
+    //! @{
+    template <typename K, typename = void>
+    constexpr bool kernel_compare = false;
+    template <typename K>
+    constexpr bool kernel_compare<K, std::enable_if_t<std::is_same<std::result_of_t<K(int, int)>, bool>::value>> = true;
+    //! @}
+
+    //! @brief Whether the operands of an operator are converted to their common type (for comparisons between arithmetic types, as kernels do).
+    template <typename K, typename A, typename B>
+    constexpr bool kernel_common = kernel_compare<K> and std::is_arithmetic<A>::value and std::is_arithmetic<B>::value;
+
+    //! @brief An operand of an operator against a value of type `B`, converted to their common type if needed.
+    //! @{
+    template <typename K, typename B, typename A>
+    inline std::enable_if_t<not kernel_common<K, std::decay_t<A>, B>, A&&> kernel_operand(A&& x) {
+        return std::forward<A>(x);
+    }
+    template <typename K, typename B, typename A>
+    inline std::enable_if_t<kernel_common<K, std::decay_t<A>, B>, std::common_type_t<std::decay_t<A>, B>> kernel_operand(A&& x) {
+        return static_cast<std::common_type_t<std::decay_t<A>, B>>(x);
+    }
+    //! @}
+
+    //! @brief Applies an arithmetic kernel.
+    template <typename K, typename T, typename X, typename Y>
+    inline void kernel_apply(K op, field_vector<T>& r, X x, Y y) {
+        common::simd::transform(op, r.data(), x, y, r.size());
+    }
+    //! @brief Applies a comparison kernel.
+    template <typename K, typename X, typename Y>
+    inline void kernel_apply(K op, field_vector<bool>& r, X x, Y y) {
+        common::simd::compare(op, r, x, y, r.size());
+    }
+
+    /**
+     * @name kernel_hood
+     *
+     * Applies an operator pointwise on two arguments, through the SIMD kernel `K` if they are fields of reals
+     * sharing the same domain (or a field and a local value), as is the case for fields from `nbr` in a round.
+     */
+    //! @{
+    //! @brief No kernel applicable.
+    template <typename K, typename F, typename A, typename B>
+    std::enable_if_t<std::is_void<K>::value or not kernel_args<A, B>, field_result<F,A,B>>
+    kernel_hood(F&& op, A const& x, B const& y) {
+        return map_hood(op, x, y);
+    }
+    //! @brief Kernel applicable.
+    template <typename K, typename F, typename A, typename B>
+    std::enable_if_t<not std::is_void<K>::value and kernel_args<A, B>, field_result<F,A,B>>
+    kernel_hood(F&& op, A const& x, B const& y) {
+        using T = kernel_t<A, B>;
+        field_vector<device_t> const* d = nullptr;
+        if (not (kernel_domain(d, x) and kernel_domain(d, y))) return map_hood(op, x, y);
+        field_result<F,A,B> r;
+        get_ids(r) = *d;
+        get_vals(r).resize(d->size() + 1);
+        kernel_apply(K{}, get_vals(r), kernel_arg<T>(x), kernel_arg<T>(y));
+        return r;
+    }
+    //! @}
+
+    /**
+     * @name kernel_mod_hood
+     *
+     * Modifies a field in-place by applying an operator pointwise with another argument, through the SIMD kernel `K`
+     * if they are fields of reals sharing the same domain (or a field and a local value).
+     */
+    //! @{
+    //! @brief No kernel applicable.
+    template <typename K, typename F, typename A, typename B>
+    std::enable_if_t<std::is_void<K>::value or not kernel_args<field<A>, B>, field<A>&>
+    kernel_mod_hood(F&& op, field<A>& x, B const& y) {
+        return mod_hood(op, x, y);
+    }
+    //! @brief Kernel applicable.
+    template <typename K, typename F, typename A, typename B>
+    std::enable_if_t<not std::is_void<K>::value and kernel_args<field<A>, B>, field<A>&>
+    kernel_mod_hood(F&& op, field<A>& x, B const& y) {
+        field_vector<device_t> const* d = &get_ids(x);
+        if (not kernel_domain(d, y)) return mod_hood(op, x, y);
+        kernel_apply(K{}, get_vals(x), kernel_arg<A>(x), kernel_arg<A>(y));
+        return x;
+    }
+    //! @}
+
+    /**
+     * @name kernel_select
+     *
+     * Selects pointwise between two arguments according to a field of booleans, through a SIMD kernel if the arguments
+     * are fields of reals sharing the same domain (or local values).
+     */
+    //! @{
+    //! @brief No kernel applicable.
+    template <typename F, typename A, typename B>
+    std::enable_if_t<not kernel_args<A, B> or not std::is_same<local_result<F,field<bool>,A,B>, kernel_t<A, B>>::value, field_result<F,field<bool>,A,B>>
+    kernel_select(F&& op, field<bool> const& b, A const& x, B const& y) {
+        return map_hood(op, b, x, y);
+    }
+    //! @brief Kernel applicable.
+    template <typename F, typename A, typename B>
+    std::enable_if_t<kernel_args<A, B> and std::is_same<local_result<F,field<bool>,A,B>, kernel_t<A, B>>::value, field_result<F,field<bool>,A,B>>
+    kernel_select(F&& op, field<bool> const& b, A const& x, B const& y) {
+        using T = kernel_t<A, B>;
+        field_vector<device_t> const* d = &get_ids(b);
+        if (not (kernel_domain(d, x) and kernel_domain(d, y))) return map_hood(op, b, x, y);
+        field_result<F,field<bool>,A,B> r;
+        get_ids(r) = *d;
+        get_vals(r).resize(d->size() + 1);
+        common::simd::select(get_vals(r).data(), get_vals(b), kernel_arg<T>(x), kernel_arg<T>(y), d->size() + 1);
+        return r;
+    }
+    //! @}
+
+    //! @brief Applies a unary predicate SIMD kernel to a field of reals.
+    template <typename K, typename T>
+    common::simd::if_supported<T, field<bool>> kernel_test(K op, field<T> const& f) {
+        field<bool> r;
+        get_ids(r) = get_ids(f);
+        get_vals(r).resize(get_vals(f).size());
+        common::simd::test(op, get_vals(r), get_vals(f).data(), get_vals(f).size());
+        return r;
+    }
+
+    /**
+     * @name kernel_fold_hood
+     *
+     * Reduces the values in a part of a field of reals (determined by domain) to a single value, through the associative
+     * SIMD kernel `K` if the field has that domain (or through the equivalent binary operation otherwise). With
+     * \ref FCPP_SIMD_SUM, the order of combination differs from that of `fold_hood`, so that results of additions may
+     * differ from it in the last bits.
+     */
+    //! @{
+    //! @brief Inclusive folding.
+    template <typename K, typename F, typename T>
+    common::simd::if_supported<T, T> kernel_fold_hood(F&& op, field<T> const& f, field_vector<device_t> const& dom) {
+        assert(dom.size() > 0);
+        if (get_ids(f) != dom) return fold_hood(op, f, dom);
+        field_vector<T> const& v = get_vals(f);
+        return common::simd::reduce(K{}, v[1], v.data() + 2, dom.size() - 1);
+    }
+    //! @brief Exclusive folding.
+    template <typename K, typename F, typename T, typename B>
+    common::simd::if_supported<T, T> kernel_fold_hood(F&& op, field<T> const& f, B const& b, field_vector<device_t> const& dom, device_t i) {
+        assert(std::binary_search(dom.begin(), dom.end(), i));
+        if (get_ids(f) != dom) return fold_hood(op, f, b, dom, i);
+        field_vector<T> const& v = get_vals(f);
+        size_t p = std::lower_bound(dom.begin(), dom.end(), i) - dom.begin();
+        T res = common::simd::reduce(K{}, T(self(b, i)), v.data() + 1, p);
+        return common::simd::reduce(K{}, res, v.data() + p + 2, dom.size() - p - 1);
+    }
+    //! @}
+}
+//! @endcond
+
+
 //! @cond INTERNAL
 #define _BOP_TYPE(A,op,B)                                                           \
 field<decltype(std::declval<to_local<A>>() op std::declval<to_local<B>>())>
@@ -1191,25 +1422,26 @@ field<A> operator op(field<A>&& x) {
  * Used to overload every operator available for the base type.
  * Macro not available outside of the scope of this file.
  */
-#define _DEF_BOP(op)                                                                                    \
+#define _DEF_BOP(op, K)                                                                                 \
 template <typename A, typename B>                                                                       \
-_BOP_TYPE(field<A>,op,B) operator op(field<A> const& x, B const& y) {                                   \
-    return map_hood([](A const& a, to_local<B> const& b) { return a op b; }, x, y);                     \
+common::ifn_class_template<field_expr, B, _BOP_TYPE(field<A>,op,B)>                                     \
+operator op(field<A> const& x, B const& y) {                                                            \
+    return details::kernel_hood<K>([](A const& a, to_local<B> const& b) { return details::kernel_operand<K, to_local<B>>(a) op details::kernel_operand<K, A>(b); }, x, y); \
 }                                                                                                       \
 template <typename A, typename B>                                                                       \
-std::enable_if_t<std::is_same<_BOP_TYPE(field<A>,op,B), field<A>>::value, field<A>>                     \
+std::enable_if_t<std::is_same<_BOP_TYPE(field<A>,op,B), field<A>>::value and not common::is_class_template<field_expr, B>, field<A>> \
 operator op(field<A>&& x, B const& y) {                                                                 \
-    return mod_hood([](A const& a, to_local<B> const& b) { return std::move(a) op b; }, x, y);          \
+    return details::kernel_mod_hood<K>([](A const& a, to_local<B> const& b) { return details::kernel_operand<K, to_local<B>>(std::move(a)) op details::kernel_operand<K, A>(b); }, x, y); \
 }                                                                                                       \
 template <typename A, typename B>                                                                       \
-std::enable_if_t<not std::is_same<_BOP_TYPE(field<A>,op,B), field<A>>::value, _BOP_TYPE(field<A>,op,B)> \
+std::enable_if_t<not std::is_same<_BOP_TYPE(field<A>,op,B), field<A>>::value and not common::is_class_template<field_expr, B>, _BOP_TYPE(field<A>,op,B)> \
 operator op(field<A>&& x, B const& y) {                                                                 \
-    return map_hood([](A const& a, to_local<B> const& b) { return a op b; }, x, y);                     \
+    return details::kernel_hood<K>([](A const& a, to_local<B> const& b) { return details::kernel_operand<K, to_local<B>>(a) op details::kernel_operand<K, A>(b); }, x, y); \
 }                                                                                                       \
 template <typename A, typename B>                                                                       \
-common::ifn_class_template<field, A, _BOP_TYPE(A,op,field<B>)>                                          \
+common::ifn_class_template<field, A, common::ifn_class_template<field_expr, A, _BOP_TYPE(A,op,field<B>)>> \
 operator op(A const& x, field<B> const& y) {                                                            \
-    return map_hood([](to_local<A> const& a, B const& b) { return a op b; }, x, y);                     \
+    return details::kernel_hood<K>([](to_local<A> const& a, B const& b) { return details::kernel_operand<K, B>(a) op details::kernel_operand<K, to_local<A>>(b); }, x, y); \
 }                                                                                                       \
 
 /**
@@ -1218,10 +1450,10 @@ operator op(A const& x, field<B> const& y) {
  * Used to overload every operator available for the base type.
  * Macro not available outside of the scope of this file.
  */
-#define _DEF_IOP(op)                                                                                    \
+#define _DEF_IOP(op, K)                                                                                 \
 template <typename A, typename B>                                                                       \
 field<A>& operator op##=(field<A>& x, B const& y) {                                                     \
-    return mod_hood([](A const& a, to_local<B> const& b) { return std::move(a) op b; }, x, y);          \
+    return details::kernel_mod_hood<K>([](A const& a, to_local<B> const& b) { return std::move(a) op b; }, x, y); \
 }
 
 
@@ -1230,34 +1462,34 @@ _DEF_UOP(-)
 _DEF_UOP(~)
 _DEF_UOP(!)
 
-_DEF_BOP(+)
-_DEF_BOP(-)
-_DEF_BOP(*)
-_DEF_BOP(/)
-_DEF_BOP(%)
-_DEF_BOP(^)
-_DEF_BOP(&)
-_DEF_BOP(|)
-_DEF_BOP(<)
-_DEF_BOP(>)
-_DEF_BOP(<=)
-_DEF_BOP(>=)
-_DEF_BOP(==)
-_DEF_BOP(!=)
-_DEF_BOP(&&)
-_DEF_BOP(||)
-_DEF_BOP(>>)
-
-_DEF_IOP(+)
-_DEF_IOP(-)
-_DEF_IOP(*)
-_DEF_IOP(/)
-_DEF_IOP(%)
-_DEF_IOP(^)
-_DEF_IOP(&)
-_DEF_IOP(|)
-_DEF_IOP(>>)
-_DEF_IOP(<<)
+_DEF_BOP(+, common::simd::add)
+_DEF_BOP(-, common::simd::sub)
+_DEF_BOP(*, common::simd::mul)
+_DEF_BOP(/, common::simd::div)
+_DEF_BOP(%, void)
+_DEF_BOP(^, void)
+_DEF_BOP(&, void)
+_DEF_BOP(|, void)
+_DEF_BOP(<, common::simd::less)
+_DEF_BOP(>, common::simd::greater)
+_DEF_BOP(<=, common::simd::less_equal)
+_DEF_BOP(>=, common::simd::greater_equal)
+_DEF_BOP(==, common::simd::equal_to)
+_DEF_BOP(!=, common::simd::not_equal_to)
+_DEF_BOP(&&, void)
+_DEF_BOP(||, void)
+_DEF_BOP(>>, void)
+
+_DEF_IOP(+, common::simd::add)
+_DEF_IOP(-, common::simd::sub)
+_DEF_IOP(*, common::simd::mul)
+_DEF_IOP(/, common::simd::div)
+_DEF_IOP(%, void)
+_DEF_IOP(^, void)
+_DEF_IOP(&, void)
+_DEF_IOP(|, void)
+_DEF_IOP(>>, void)
+_DEF_IOP(<<, void)
 
 //! @cond INTERNAL
 template <typename A, typename B>
@@ -0,0 +1,374 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file field_expr.hpp
+ * @brief Implementation of the `field_expr<F, As...>` class template for fused pointwise expressions on fields.
+ */
+
+#ifndef FCPP_DATA_FIELD_EXPR_H_
+#define FCPP_DATA_FIELD_EXPR_H_
+
+#include <cstddef>
+
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "lib/settings.hpp"
+#include "lib/common/traits.hpp"
+#include "lib/data/field.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+//! @cond INTERNAL
+namespace details {
+    //! @brief The local type of the values of an expression applying `F` to arguments stored as `As`.
+    template <typename F, typename... As>
+    using expr_value = std::decay_t<std::result_of_t<F const&(to_local<As const&>...)>>;
+
+    //! @brief How an argument is stored in an expression: fields by reference if lvalues, everything else by value.
+    //! @{
+    template <typename T>
+    struct expr_arg {
+        using type = std::decay_t<T>;
+    };
+    template <typename A>
+    struct expr_arg<field<A>&> {
+        using type = field<A> const&;
+    };
+    template <typename A>
+    struct expr_arg<field<A> const&> {
+        using type = field<A> const&;
+    };
+    //! @}
+
+    //! @brief Whether a type is an expression.
+    template <typename T>
+    constexpr bool is_field_expr = common::is_class_template<field_expr, T>;
+
+    //! @brief Enables if a type can be combined with an expression (a field or a local value, but not an expression).
+    template <typename T>
+    using if_expr_operand = std::enable_if_t<not is_field_expr<T> and (common::is_class_template<field, T> or not common::has_template<field, T>)>;
+}
+//! @endcond
+
+
+/**
+ * @brief Lazy pointwise application of an operator `F` to fields and local values stored as `As`.
+ *
+ * Expressions are built by applying operators, `mux`, `max`, `min` and the math functions in `coordination/utils.hpp`
+ * to an expression obtained through \ref lazy, and nest without building intermediate fields. An expression is
+ * evaluated in a single pass over the union of the domains of its fields when it is converted to a field, or
+ * directly during a hood reduction. If all its fields share the same domain (as they do after `nbr` within a round),
+ * it is evaluated by a plain index loop.
+ *
+ * Fields given as lvalues are referenced, so an expression is meant to be consumed within the full-expression
+ * that creates it (or while the fields it references are alive and unchanged).
+ */
+template <typename F, typename... As>
+class field_expr {
+  public:
+    //! @brief The type of the values of the expression.
+    using value_type = details::expr_value<F, As...>;
+
+    //! @brief Constructor from an operator and its arguments.
+    template <typename... Bs>
+    field_expr(F const& op, Bs&&... xs) : m_op(op), m_args(std::forward<Bs>(xs)...) {}
+
+    //! @brief The operator applied.
+    F const& op() const {
+        return m_op;
+    }
+
+    //! @brief The arguments of the operator.
+    std::tuple<As...> const& args() const {
+        return m_args;
+    }
+
+    //! @brief Conversion to a field.
+    operator field<value_type>() const;
+
+  private:
+    //! @brief The operator applied.
+    F m_op;
+    //! @brief The arguments of the operator.
+    std::tuple<As...> m_args;
+};
+
+
+//! @cond INTERNAL
+namespace common {
+    //! @brief Expressions count as fields for trait purposes.
+    template <typename F, typename... As>
+    constexpr bool has_template<field, field_expr<F, As...>> = true;
+
+    namespace details {
+        //! @brief The local type of an expression is that of its values.
+        template <typename F, typename... As>
+        struct extract_template<field, field_expr<F, As...>, true> {
+            using type = fcpp::details::expr_value<F, As...>;
+        };
+    }
+}
+//! @endcond
+
+
+//! @cond INTERNAL
+namespace details {
+    //! @brief Builds an expression applying an operator to some arguments.
+    template <typename F, typename... Ts>
+    field_expr<F, typename expr_arg<Ts&&>::type...> make_expr(F const& op, Ts&&... xs) {
+        return {op, std::forward<Ts>(xs)...};
+    }
+
+    /**
+     * @name expr_domain
+     *
+     * Checks whether all the fields in an expression share the same domain, pointing to it.
+     */
+    //! @{
+    //! @brief Local case.
+    template <typename A>
+    inline if_local<A, bool> expr_domain(field_vector<device_t> const*&, A const&) {
+        return true;
+    }
+    //! @brief Field case.
+    template <typename A>
+    inline bool expr_domain(field_vector<device_t> const*& d, field<A> const& f) {
+        if (d == nullptr) d = &get_ids(f);
+        return d == &get_ids(f) or *d == get_ids(f);
+    }
+    //! @brief Expression case.
+    template <typename F, typename... As, size_t... is>
+    inline bool expr_domain(field_vector<device_t> const*& d, field_expr<F, As...> const& e, std::index_sequence<is...>) {
+        bool same[] = {true, expr_domain(d, std::get<is>(e.args()))...};
+        for (bool b : same) if (not b) return false;
+        return true;
+    }
+    template <typename F, typename... As>
+    inline bool expr_domain(field_vector<device_t> const*& d, field_expr<F, As...> const& e) {
+        return expr_domain(d, e, std::index_sequence_for<As...>{});
+    }
+    //! @}
+
+    /**
+     * @name expr_at
+     *
+     * Accesses the value of an expression at a position of a domain shared by all its fields (zero for the default).
+     */
+    //! @{
+    //! @brief Local case.
+    template <typename A>
+    inline if_local<A, A const&> expr_at(A const& x, size_t) {
+        return x;
+    }
+    //! @brief Field case.
+    template <typename A>
+    inline to_local<field<A> const&> expr_at(field<A> const& f, size_t k) {
+        return get_vals(f)[k];
+    }
+    //! @brief Expression case.
+    template <typename F, typename... As, size_t... is>
+    inline typename field_expr<F, As...>::value_type expr_at(field_expr<F, As...> const& e, size_t k, std::index_sequence<is...>) {
+        return e.op()(expr_at(std::get<is>(e.args()), k)...);
+    }
+    template <typename F, typename... As>
+    inline typename field_expr<F, As...>::value_type expr_at(field_expr<F, As...> const& e, size_t k) {
+        return expr_at(e, k, std::index_sequence_for<As...>{});
+    }
+    //! @}
+
+    //! @brief Default value of an expression.
+    template <typename F, typename... As>
+    typename field_expr<F, As...>::value_type other(field_expr<F, As...> const& e) {
+        return expr_at(e, 0);
+    }
+
+    //! @brief Value of an expression corresponding to a certain device (with index sequence).
+    template <typename F, typename... As, size_t... is>
+    typename field_expr<F, As...>::value_type self(field_expr<F, As...> const& e, device_t i, std::index_sequence<is...>) {
+        return e.op()(self(std::get<is>(e.args()), i)...);
+    }
+
+    //! @brief Value of an expression corresponding to a certain device.
+    template <typename F, typename... As>
+    typename field_expr<F, As...>::value_type self(field_expr<F, As...> const& e, device_t i) {
+        return self(e, i, std::index_sequence_for<As...>{});
+    }
+
+    //! @brief Expression case of field iterators, merging the domains of the arguments.
+    template <typename F, typename... As>
+    class field_iterator<field_expr<F, As...> const, void> {
+      public:
+        //! @brief Constructor.
+        field_iterator(field_expr<F, As...> const& ref) : field_iterator(ref, std::index_sequence_for<As...>{}) {}
+
+        //! @brief Deleted constructor on temporary values.
+        field_iterator(field_expr<F, As...> const&&) = delete;
+
+        //! @brief Checks if the iterator reached the end.
+        inline bool end() const {
+            return m_id == std::numeric_limits<device_t>::max();
+        }
+
+        //! @brief Accesses the device id.
+        inline device_t id() const {
+            return m_id;
+        }
+
+        //! @brief Accesses the value.
+        inline typename field_expr<F, As...>::value_type value() const {
+            return value(m_id, std::index_sequence_for<As...>{});
+        }
+
+        //! @brief Accesses the value (given a device id).
+        inline typename field_expr<F, As...>::value_type value(device_t i) const {
+            return value(i, std::index_sequence_for<As...>{});
+        }
+
+        //! @brief Increments the iterator.
+        inline field_iterator& operator++() {
+            increment(std::index_sequence_for<As...>{});
+            return *this;
+        }
+
+      private:
+        //! @brief Constructor (with index sequence).
+        template <size_t... is>
+        field_iterator(field_expr<F, As...> const& ref, std::index_sequence<is...>) : m_ref(ref), m_its(field_iterator<std::remove_reference_t<As> const>{std::get<is>(ref.args())}...) {
+            init(std::index_sequence_for<As...>{});
+        }
+
+        //! @brief Initialises the current iterated id.
+        template <size_t... is>
+        inline void init(std::index_sequence<is...>) {
+            device_t ids[] = {std::numeric_limits<device_t>::max(), std::get<is>(m_its).id()...};
+            m_id = *std::min_element(ids, ids + sizeof...(As) + 1);
+        }
+
+        //! @brief Accesses the value (with index sequence).
+        template <size_t... is>
+        inline typename field_expr<F, As...>::value_type value(device_t i, std::index_sequence<is...>) const {
+            return m_ref.op()(std::get<is>(m_its).value(i)...);
+        }
+
+        //! @brief Increments the iterator (with index sequence).
+        template <size_t... is>
+        inline void increment(std::index_sequence<is...>) {
+            device_t ids[] = {std::numeric_limits<device_t>::max(), (std::get<is>(m_its).id() == m_id ? ++std::get<is>(m_its) : std::get<is>(m_its)).id()...};
+            m_id = *std::min_element(ids, ids + sizeof...(As) + 1);
+        }
+
+        //! @brief The expression iterated.
+        field_expr<F, As...> const& m_ref;
+        //! @brief A tuple of iterators to the arguments.
+        std::tuple<field_iterator<std::remove_reference_t<As> const>...> m_its;
+        //! @brief The current iterated id.
+        device_t m_id;
+    };
+
+    //! @brief The identity operator.
+    struct expr_identity {
+        template <typename A>
+        A const& operator()(A const& x) const {
+            return x;
+        }
+    };
+}
+//! @endcond
+
+
+template <typename F, typename... As>
+field_expr<F, As...>::operator field<value_type>() const {
+    details::field_vector<device_t> const* dom = nullptr;
+    details::field_vector<device_t> ids;
+    details::field_vector<value_type> vals;
+    if (details::expr_domain(dom, *this) and dom != nullptr) {
+        ids = *dom;
+        vals.reserve(ids.size() + 1);
+        for (size_t k = 0; k <= ids.size(); ++k)
+            vals.push_back(details::expr_at(*this, k));
+    } else {
+        vals.push_back(details::expr_at(*this, 0));
+        for (details::field_iterator<field_expr const> it(*this); not it.end(); ++it) {
+            ids.push_back(it.id());
+            vals.push_back(it.value());
+        }
+    }
+    return details::make_field(std::move(ids), std::move(vals));
+}
+
+
+//! @brief Starts a lazy expression on a field, to be combined with other fields and evaluated in a single pass.
+template <typename A, typename = common::if_class_template<field, A>>
+field_expr<details::expr_identity, typename details::expr_arg<A&&>::type> lazy(A&& f) {
+    return {details::expr_identity{}, std::forward<A>(f)};
+}
+
+
+/**
+ * @brief Overloads unary operators for expressions.
+ *
+ * Macro not available outside of the scope of this file.
+ */
+#define _DEF_UOP(op)                                                                                    \
+template <typename F, typename... As>                                                                   \
+auto operator op(field_expr<F, As...> x) {                                                              \
+    return details::make_expr([](auto const& a) { return op a; }, std::move(x));                        \
+}
+
+/**
+ * @brief Overloads binary operators for expressions.
+ *
+ * Macro not available outside of the scope of this file.
+ */
+#define _DEF_BOP(op)                                                                                    \
+template <typename F, typename... As, typename G, typename... Bs>                                       \
+auto operator op(field_expr<F, As...> x, field_expr<G, Bs...> y) {                                      \
+    return details::make_expr([](auto const& a, auto const& b) { return a op b; }, std::move(x), std::move(y)); \
+}                                                                                                       \
+template <typename F, typename... As, typename B, typename = details::if_expr_operand<B>>               \
+auto operator op(field_expr<F, As...> x, B&& y) {                                                       \
+    return details::make_expr([](auto const& a, auto const& b) { return a op b; }, std::move(x), std::forward<B>(y)); \
+}                                                                                                       \
+template <typename A, typename F, typename... As, typename = details::if_expr_operand<A>>               \
+auto operator op(A&& x, field_expr<F, As...> y) {                                                       \
+    return details::make_expr([](auto const& a, auto const& b) { return a op b; }, std::forward<A>(x), std::move(y)); \
+}
+
+_DEF_UOP(+)
+_DEF_UOP(-)
+_DEF_UOP(~)
+_DEF_UOP(!)
+
+_DEF_BOP(+)
+_DEF_BOP(-)
+_DEF_BOP(*)
+_DEF_BOP(/)
+_DEF_BOP(%)
+_DEF_BOP(^)
+_DEF_BOP(&)
+_DEF_BOP(|)
+_DEF_BOP(<)
+_DEF_BOP(>)
+_DEF_BOP(<=)
+_DEF_BOP(>=)
+_DEF_BOP(==)
+_DEF_BOP(!=)
+_DEF_BOP(&&)
+_DEF_BOP(||)
+_DEF_BOP(>>)
+
+#undef _DEF_UOP
+#undef _DEF_BOP
+
+
+}
+
+#endif // FCPP_DATA_FIELD_EXPR_H_
@@ -0,0 +1,201 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file nbr_view.hpp
+ * @brief Implementation of the `nbr_view<A>` class template for lazy views of neighbours' values.
+ */
+
+#ifndef FCPP_DATA_NBR_VIEW_H_
+#define FCPP_DATA_NBR_VIEW_H_
+
+#include <cassert>
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#include "lib/settings.hpp"
+#include "lib/common/traits.hpp"
+#include "lib/data/field.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+/**
+ * @brief Lazy view of the neighbours' values of type `A`, read directly from their exports.
+ *
+ * Hood reductions fold a view without building a field. A view converts to a `to_field<A>` when it is
+ * stored into one, and needs to be converted explicitly before being combined with other fields.
+ * Since it refers to the exports received, a view can only be used within the round in which it was created.
+ */
+template <typename A>
+class nbr_view {
+  public:
+    //! @brief The type of an entry, pairing a neighbour with a pointer to its value.
+    using entry_type = std::pair<device_t, void const*>;
+
+    //! @brief Constructor from a range of entries (sorted by device), a default value and the current device.
+    nbr_view(entry_type const* begin, entry_type const* end, A const& def, device_t self) : m_begin(begin), m_end(end), m_def(details::other(def)), m_self(self) {}
+
+    //! @brief Iterator to the first entry.
+    entry_type const* begin() const {
+        return m_begin;
+    }
+
+    //! @brief Iterator past the last entry.
+    entry_type const* end() const {
+        return m_end;
+    }
+
+    //! @brief Number of neighbours with a value.
+    size_t size() const {
+        return m_end - m_begin;
+    }
+
+    //! @brief The local value of an entry.
+    to_local<A const&> value(entry_type const& e) const {
+        return details::self(*static_cast<A const*>(e.second), m_self);
+    }
+
+    //! @brief The local value for neighbours without an entry.
+    to_local<A> const& other() const {
+        return m_def;
+    }
+
+    //! @brief The local value for a device, given an entry not preceding it (or `end()`).
+    to_local<A const&> value(device_t d, entry_type const* it) const {
+        if (it != m_end and it->first == d) return value(*it);
+        return m_def;
+    }
+
+    //! @brief Conversion to a field.
+    operator to_field<A>() const {
+        details::field_vector<device_t> ids;
+        details::field_vector<to_local<A>> vals;
+        ids.reserve(size());
+        vals.reserve(size() + 1);
+        vals.push_back(other());
+        for (entry_type const& e : *this) {
+            ids.push_back(e.first);
+            vals.push_back(value(e));
+        }
+        return details::make_field(std::move(ids), std::move(vals));
+    }
+
+  private:
+    //! @brief The first entry.
+    entry_type const* m_begin;
+    //! @brief Past the last entry.
+    entry_type const* m_end;
+    //! @brief The local default value.
+    to_local<A> m_def;
+    //! @brief The current device.
+    device_t m_self;
+};
+
+
+//! @cond INTERNAL
+namespace common {
+    //! @brief Views count as fields for trait purposes.
+    template <typename A>
+    constexpr bool has_template<field, nbr_view<A>> = true;
+
+    namespace details {
+        //! @brief The local type of a view is that of its values.
+        template <typename A>
+        struct extract_template<field, nbr_view<A>, true> {
+            using type = typename extract_template<field, common::partial_decay<A>>::type;
+        };
+    }
+}
+//! @endcond
+
+
+//! @cond INTERNAL
+namespace details {
+    //! @brief First entry of a view not preceding a given device.
+    template <typename A>
+    typename nbr_view<A>::entry_type const* advance(nbr_view<A> const& v, typename nbr_view<A>::entry_type const* it, device_t d) {
+        while (it != v.end() and it->first < d) ++it;
+        return it;
+    }
+
+    //! @brief The local value of a view for a device.
+    template <typename A>
+    to_local<A const&> self(nbr_view<A> const& v, device_t i) {
+        auto it = std::lower_bound(v.begin(), v.end(), i, [](typename nbr_view<A>::entry_type const& e, device_t d){
+            return e.first < d;
+        });
+        return v.value(i, it);
+    }
+
+    /**
+     * @name fold_hood
+     *
+     * Reduces the values of a view in a domain to a single value through a binary operation.
+     */
+    //! @{
+    //! @brief Inclusive folding.
+    template <typename F, typename A>
+    std::result_of_t<F(to_local<A const&>, to_local<A const&>)>
+    fold_hood(F&& op, nbr_view<A> const& v, field_vector<device_t> const& dom) {
+        assert(dom.size() > 0);
+        auto it = advance(v, v.begin(), dom[0]);
+        std::result_of_t<F(to_local<A const&>, to_local<A const&>)> res = v.value(dom[0], it);
+        for (size_t k=1; k<dom.size(); ++k) {
+            it = advance(v, it, dom[k]);
+            res = op(v.value(dom[k], it), res);
+        }
+        return res;
+    }
+    //! @brief Inclusive folding with ids.
+    template <typename F, typename A>
+    std::result_of_t<F(device_t, to_local<A const&>, to_local<A const&>)>
+    fold_hood(F&& op, nbr_view<A> const& v, field_vector<device_t> const& dom) {
+        assert(dom.size() > 0);
+        auto it = advance(v, v.begin(), dom[0]);
+        std::result_of_t<F(device_t, to_local<A const&>, to_local<A const&>)> res = v.value(dom[0], it);
+        for (size_t k=1; k<dom.size(); ++k) {
+            it = advance(v, it, dom[k]);
+            res = op(dom[k], v.value(dom[k], it), res);
+        }
+        return res;
+    }
+    //! @brief Exclusive folding.
+    template <typename F, typename A, typename B>
+    std::result_of_t<F(to_local<A const&>, to_local<B const&>)>
+    fold_hood(F&& op, nbr_view<A> const& v, B const& b, field_vector<device_t> const& dom, device_t i) {
+        assert(std::binary_search(dom.begin(), dom.end(), i));
+        std::result_of_t<F(to_local<A const&>, to_local<B const&>)> res = self(b, i);
+        auto it = v.begin();
+        for (size_t k=0; k<dom.size(); ++k) if (dom[k] != i) {
+            it = advance(v, it, dom[k]);
+            res = op(v.value(dom[k], it), res);
+        }
+        return res;
+    }
+    //! @brief Exclusive folding with ids.
+    template <typename F, typename A, typename B>
+    std::result_of_t<F(device_t, to_local<A const&>, to_local<B const&>)>
+    fold_hood(F&& op, nbr_view<A> const& v, B const& b, field_vector<device_t> const& dom, device_t i) {
+        assert(std::binary_search(dom.begin(), dom.end(), i));
+        std::result_of_t<F(device_t, to_local<A const&>, to_local<B const&>)> res = self(b, i);
+        auto it = v.begin();
+        for (size_t k=0; k<dom.size(); ++k) if (dom[k] != i) {
+            it = advance(v, it, dom[k]);
+            res = op(dom[k], v.value(dom[k], it), res);
+        }
+        return res;
+    }
+    //! @}
+}
+//! @endcond
+
+
+}
+
+#endif // FCPP_DATA_NBR_VIEW_H_
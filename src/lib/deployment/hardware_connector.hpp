@@ -19,6 +19,7 @@
 #include "lib/component/base.hpp"
 #include "lib/data/field.hpp"
 #include "lib/deployment/os.hpp"
+#include "lib/internal/nbr_sensor.hpp"
 #include "lib/option/distribution.hpp"
 
 
@@ -160,7 +161,7 @@ struct hardware_connector {
                     common::osstream os;
                     typename F::node::message_t m;
                     os << P::node::as_final().send(m_send, m);
-                    fcpp::details::self(m_nbr_msg_size, P::node::uid) = os.size();
+                    m_nbr_msg_size.set(P::node::uid, os.size());
                     m_network.send(std::move(os));
                     P::node::as_final().receive(m_send, P::node::uid, m);
                     m_send = TIME_MAX;
@@ -176,8 +177,8 @@ struct hardware_connector {
                     for (message_type& m : mv) receive(m);
                 }
                 P::node::round_start(t);
-                maybe_align_inplace(m_nbr_dist, has_calculus<P>{});
-                maybe_align_inplace(m_nbr_msg_size, has_calculus<P>{});
+                maybe_align_inplace(m_nbr_dist.get(), has_calculus<P>{});
+                maybe_align_inplace(m_nbr_msg_size.get(), has_calculus<P>{});
             }
 
             //! @brief Receives an incoming message (possibly reading values from sensors).
@@ -187,8 +188,8 @@ struct hardware_connector {
             void receive(message_type& m) {
                 PROFILE_COUNT("connector");
                 common::lock_guard<parallel> l(P::node::mutex);
-                fcpp::details::self(m_nbr_dist, m.device) = m.power;
-                fcpp::details::self(m_nbr_msg_size, m.device) = m.content.size();
+                m_nbr_dist.set(m.device, m.power);
+                m_nbr_msg_size.set(m.device, m.content.size());
                 common::isstream is(std::move(m.content));
                 typename F::node::message_t mt;
 #ifndef FCPP_DISABLE_EXCEPTIONS
@@ -204,17 +205,17 @@ struct hardware_connector {
 
             //! @brief Perceived distances from neighbours.
             field<real_t> const& nbr_dist() const {
-                return m_nbr_dist;
+                return m_nbr_dist.get();
             }
 
             //! @brief Size of last message sent.
             size_t msg_size() const {
-                return fcpp::details::self(m_nbr_msg_size, P::node::uid);
+                return fcpp::details::self(m_nbr_msg_size.get(), P::node::uid);
             }
 
             //! @brief Sizes of messages received from neighbours.
             field<size_t> const& nbr_msg_size() const {
-                return m_nbr_msg_size;
+                return m_nbr_msg_size.get();
             }
 
           private: // implementation details
@@ -233,7 +234,7 @@ struct hardware_connector {
             //! @brief Changes the domain of a field-like structure to match the domain of the neightbours ids.
             template <typename A>
             void maybe_align_inplace(field<A>& x, std::true_type) {
-                align_inplace(x, std::vector<device_t>(fcpp::details::get_ids(P::node::nbr_uid())));
+                align_inplace(x, fcpp::details::field_vector<device_t>(fcpp::details::get_ids(P::node::nbr_uid())));
             }
 
             //! @brief Does not perform any alignment
@@ -247,10 +248,10 @@ struct hardware_connector {
             times_t m_send;
 
             //! @brief Perceived distances from neighbours.
-            field<real_t> m_nbr_dist;
+            internal::nbr_sensor<real_t> m_nbr_dist;
 
             //! @brief Sizes of messages received from neighbours.
-            field<size_t> m_nbr_msg_size;
+            internal::nbr_sensor<size_t> m_nbr_msg_size;
 
             //! @brief Backend regulating and performing the connection.
             connector_type m_network;
@@ -9,7 +9,11 @@
 #define FCPP_INTERNAL_H_
 
 #include "lib/internal/context.hpp"
+#include "lib/internal/delta.hpp"
 #include "lib/internal/flat_ptr.hpp"
+#include "lib/internal/intern.hpp"
+#include "lib/internal/nbr_sensor.hpp"
+#include "lib/internal/quantised.hpp"
 #include "lib/internal/trace.hpp"
 #include "lib/internal/twin.hpp"
 
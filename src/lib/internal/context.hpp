@@ -9,14 +9,18 @@
 #define FCPP_INTERNAL_CONTEXT_H_
 
 #include <algorithm>
+#include <array>
 #include <ostream>
-#include <queue>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "lib/common/flat_multitype_map.hpp"
+#include "lib/common/layout_multitype_map.hpp"
 #include "lib/common/multitype_map.hpp"
+#include "lib/common/shared_multitype_map.hpp"
 #include "lib/data/field.hpp"
+#include "lib/data/nbr_view.hpp"
 #include "lib/internal/flat_ptr.hpp"
 #include "lib/internal/trace.hpp"
 
@@ -42,6 +46,229 @@ class sstream;
 namespace internal {
 
 
+/**
+ * @brief Wrapper of the types included in the exports, requiring them to be stored in a \ref common::flat_multitype_map.
+ *
+ * @param Ts Types included in the exports.
+ */
+template <typename... Ts>
+struct flat_exports {};
+
+
+/**
+ * @brief Wrapper of the types included in the exports, requiring them to be stored in a \ref common::layout_multitype_map.
+ *
+ * @param Ts Types included in the exports.
+ */
+template <typename... Ts>
+struct layout_exports {};
+
+
+/**
+ * @brief Wrapper of the types included in the exports, requiring them to be stored in a \ref common::shared_multitype_map.
+ *
+ * @param Ts Types included in the exports.
+ */
+template <typename... Ts>
+struct shared_exports {};
+
+
+//! @cond INTERNAL
+namespace details {
+    // Exports stored in a multitype map.
+    template <typename... Ts>
+    struct export_map {
+        using type = common::multitype_map<trace_t, Ts...>;
+    };
+
+    // Exports stored in a flat multitype map.
+    template <typename... Ts>
+    struct export_map<flat_exports<Ts...>> {
+        using type = common::flat_multitype_map<trace_t, Ts...>;
+    };
+
+    // Exports stored in a layout multitype map.
+    template <typename... Ts>
+    struct export_map<layout_exports<Ts...>> {
+        using type = common::layout_multitype_map<trace_t, Ts...>;
+    };
+
+    // Exports stored in a shared multitype map.
+    template <typename... Ts>
+    struct export_map<shared_exports<Ts...>> {
+        using type = common::shared_multitype_map<trace_t, Ts...>;
+    };
+
+    // Empty exports for a new round.
+    template <typename M>
+    M renew(M const&) {
+        return {};
+    }
+
+    // Empty exports for a new round, keeping the layout of the previous round.
+    template <typename... Ts>
+    common::layout_multitype_map<trace_t, Ts...> renew(common::layout_multitype_map<trace_t, Ts...> const& m) {
+        return m.same_layout();
+    }
+
+    // Devices in a column, with self added in order.
+    template <typename C>
+    fcpp::details::field_vector<device_t> align(C const& c, device_t self) {
+        fcpp::details::field_vector<device_t> v;
+        v.reserve(c.size() + 1);
+        auto it = c.begin();
+        for (; it != c.end() and it->first < self; ++it)
+            v.push_back(it->first);
+        v.push_back(self);
+        if (it != c.end() and it->first == self) ++it;
+        for (; it != c.end(); ++it)
+            v.push_back(it->first);
+        return v;
+    }
+
+    // Lazy view of values of type A in a column, with default `def`.
+    template <typename A, typename C>
+    nbr_view<A> lazy_nbr(C const& c, A const& def, device_t self) {
+        return {c.data(), c.data() + c.size(), def, self};
+    }
+}
+//! @endcond
+
+
+/**
+ * @brief Index associating each trace and value type to the list of neighbours' values for it.
+ *
+ * Built when a context is frozen, so that every `nbr` call materialises its field by a linear scan of
+ * a single column, instead of probing the export of every neighbour. Since neighbours usually list
+ * the same traces in the same order, the column of the i-th entry of the previous export is tried
+ * first, falling back to hashing only when it does not match. Columns are found through an open-addressing
+ * table whose slots are invalidated at once when cleared, and both columns and table keep their capacity
+ * across rounds, so that a steady-state round does not allocate memory.
+ *
+ * @param E The type of the exports.
+ */
+template <typename E>
+class trace_index {
+  public:
+    //! @brief The type of a column, listing devices and pointers to their values (ordered by device).
+    using column_type = std::vector<std::pair<device_t, void const*>>;
+
+    //! @brief Removes all entries (keeping the memory allocated).
+    void clear() {
+        ++m_stamp;
+        m_used = 0;
+    }
+
+    //! @brief Adds the entries of an export for a device (devices need to be added in increasing order).
+    void insert(device_t d, E const& e) {
+        size_t i = 0;
+        e.for_each([this,d,&i](trace_t t, size_t type, void const* p){
+            if (i == m_hints.size()) m_hints.push_back(0);
+            size_t& h = m_hints[i++];
+            if (h >= m_used or m_data[h].trace != t or m_data[h].type != type) {
+                if (2 * (m_used + 1) > m_table.size()) grow();
+                slot_type& x = m_table[locate(t, type)];
+                if (x.stamp != m_stamp) {
+                    if (m_used == m_data.size()) m_data.emplace_back();
+                    m_data[m_used].trace = t;
+                    m_data[m_used].type = type;
+                    m_data[m_used].values.clear();
+                    x = {t, type, m_used++, m_stamp};
+                }
+                h = x.column;
+            }
+            m_data[h].values.emplace_back(d, p);
+        });
+    }
+
+    //! @brief The column of values of a given type for a given trace.
+    template <typename A>
+    column_type const& column(trace_t trace) const {
+        return column<A>(trace, common::number_sequence<value_types::template count<A> != 0>{});
+    }
+
+    //! @brief The column of void values for a given trace.
+    column_type const& keys(trace_t trace) const {
+        return find(trace, value_types::size);
+    }
+
+  private:
+    //! @brief The value types supported by the exports.
+    using value_types = typename E::value_types;
+
+    //! @brief The column of values of a supported type.
+    template <typename A>
+    column_type const& column(trace_t trace, common::number_sequence<true>) const {
+        return find(trace, value_types::template find<A>);
+    }
+
+    //! @brief The column of values of an unsupported type (always empty).
+    template <typename A>
+    column_type const& column(trace_t, common::number_sequence<false>) const {
+        return m_empty;
+    }
+
+    //! @brief The column for a given trace and type index.
+    column_type const& find(trace_t trace, size_t type) const {
+        if (m_table.empty()) return m_empty;
+        slot_type const& x = m_table[locate(trace, type)];
+        return x.stamp == m_stamp ? m_data[x.column].values : m_empty;
+    }
+
+    //! @brief The slot of the table holding a given trace and type index, or the free slot where it would be inserted.
+    size_t locate(trace_t trace, size_t type) const {
+        size_t mask = m_table.size() - 1;
+        size_t i = (trace ^ (type * 0x9e3779b97f4a7c15ULL)) & mask;
+        while (m_table[i].stamp == m_stamp and (m_table[i].trace != trace or m_table[i].type != type))
+            i = (i + 1) & mask;
+        return i;
+    }
+
+    //! @brief Doubles the size of the table, inserting again the columns in use.
+    void grow() {
+        m_table.assign(std::max<size_t>(2 * m_table.size(), 16), slot_type{});
+        ++m_stamp;
+        for (size_t c = 0; c < m_used; ++c)
+            m_table[locate(m_data[c].trace, m_data[c].type)] = {m_data[c].trace, m_data[c].type, c, m_stamp};
+    }
+
+    //! @brief A column together with its trace and type index.
+    struct column_data {
+        //! @brief The trace.
+        trace_t trace;
+        //! @brief The type index.
+        size_t type;
+        //! @brief The values.
+        column_type values;
+    };
+
+    //! @brief A slot of the table associating traces and type indices (including void) to columns.
+    struct slot_type {
+        //! @brief The trace.
+        trace_t trace;
+        //! @brief The type index.
+        size_t type;
+        //! @brief The column index.
+        size_t column;
+        //! @brief The clearing the slot belongs to (free if different from `m_stamp`).
+        size_t stamp;
+    };
+
+    //! @brief Open-addressing table associating traces and type indices to columns (with a power of two size).
+    std::vector<slot_type> m_table;
+    //! @brief The current clearing of the table.
+    size_t m_stamp = 1;
+    //! @brief The columns (only the first `m_used` of which are in use).
+    std::vector<column_data> m_data;
+    //! @brief The number of columns in use.
+    size_t m_used = 0;
+    //! @brief The columns of the entries of the last export inserted.
+    std::vector<size_t> m_hints;
+    //! @brief An empty column.
+    column_type m_empty;
+};
+
+
 /**
  * @brief Keeps associations between devices and export received.
  *
@@ -51,7 +278,7 @@ namespace internal {
  * @param online Whether the number of stored exports should be kept cleaned as exports are inserted.
  * @param pointer Whether the exports should be stored in pointers or not.
  * @param M Type of the export metrics.
- * @param Ts Types included in the exports.
+ * @param Ts Types included in the exports (or a single \ref flat_exports, \ref layout_exports or \ref shared_exports wrapping them).
  */
 template <bool online, bool pointer, typename M, typename... Ts>
 class context;
@@ -60,17 +287,26 @@ class context;
 /**
  * @brief Keeps associations between devices and export received.
  *
- * Specialisation for online cleaning of export as they are inserted.
+ * Specialisation for online cleaning of export as they are inserted. Exports are kept in a flat table, ordered by
+ * metric through an indexed d-ary heap of table positions, so that metrics can be changed in place without stale entries.
  */
 template <bool pointer, typename M, typename... Ts>
 class context<true, pointer, M, Ts...> {
   public:
     //! @brief The type of the exports contained in the context.
-    typedef internal::flat_ptr<common::multitype_map<trace_t, Ts...>, not pointer> export_type;
+    typedef internal::flat_ptr<typename details::export_map<Ts...>::type, not pointer> export_type;
+
+    //! @brief The type of the index of exports by trace.
+    typedef trace_index<typename details::export_map<Ts...>::type> index_type;
 
     //! @brief The type of the metric on exports.
     typedef M metric_type;
 
+    //! @brief Empty exports for a new round, keeping the layout of given exports if they have one.
+    static export_type renew(export_type const& e) {
+        return details::renew(*e);
+    }
+
     //! @brief Default constructor creating an empty context.
     context() = default;
 
@@ -88,75 +324,110 @@ class context<true, pointer, M, Ts...> {
 
     //! @brief Equality operator.
     bool operator==(context const& o) const {
-        return m_data == o.m_data && m_metrics == o.m_metrics;
+        if (m_table.size() != o.m_table.size()) return false;
+        for (entry const& x : m_table) {
+            auto it = o.m_pos.find(x.device);
+            if (it == o.m_pos.end()) return false;
+            entry const& y = o.m_table[it->second];
+            if (not (x.metric == y.metric) or not (x.data == y.data)) return false;
+        }
+        return true;
     }
 
     //! @brief Number of exports contained.
     size_t size(device_t self) const {
-        return m_data.size() + 1-m_data.count(self);
+        return m_table.size() + 1-m_pos.count(self);
     }
 
     //! @brief Inserts an export for a device with a certain metric, possibly cleaning up.
     void insert(device_t d, export_type e, metric_type m, metric_type threshold, device_t hoodsize) {
         assert(m_sorted_data.size() == 0);
         if (m <= threshold) {
-            if (m_metrics.count(d) == 0 or m_metrics[d] != m)
-                m_queue.emplace(m, d);
-            m_metrics[d] = m;
-            m_data[d] = std::move(e);
-            if (m_data.size() > hoodsize) pop();
-            else clean();
+            auto it = m_pos.find(d);
+            if (it == m_pos.end()) {
+                m_pos.emplace(d, m_table.size());
+                m_table.push_back({d, m, std::move(e), m_heap.size()});
+                m_heap.push_back(m_table.size()-1);
+                sift_up(m_heap.size()-1);
+                if (m_table.size() > hoodsize) pop();
+            } else {
+                entry& x = m_table[it->second];
+                x.data = std::move(e);
+                if (x.metric != m) {
+                    bool up = x.metric < m;
+                    x.metric = m;
+                    if (up) sift_up(x.heap);
+                    else sift_down(x.heap);
+                }
+            }
         }
     }
 
     //! @brief The worst export currently in context.
     device_t top() {
         assert(m_sorted_data.size() == 0);
-        clean();
-        return m_queue.top().second;
+        return m_table[m_heap.front()].device;
     }
 
     //! @brief Erases the worst export.
     void pop() {
         assert(m_sorted_data.size() == 0);
-        clean();
-        m_data.erase(m_queue.top().second);
-        m_metrics.erase(m_queue.top().second);
-        m_queue.pop();
+        size_t i = m_heap.front();
+        m_heap.front() = m_heap.back();
+        m_heap.pop_back();
+        if (not m_heap.empty()) {
+            m_table[m_heap.front()].heap = 0;
+            sift_down(0);
+        }
+        m_pos.erase(m_table[i].device);
+        if (i+1 < m_table.size()) {
+            m_table[i] = std::move(m_table.back());
+            m_pos[m_table[i].device] = i;
+            m_heap[m_table[i].heap] = i;
+        }
+        m_table.pop_back();
     }
 
     //! @brief Changes the status of the context from "modify" to "query".
     void freeze(device_t, device_t) {
         assert(m_sorted_data.size() == 0);
-        for (auto const& x : m_data)
-            m_sorted_data.emplace_back(x.first, &x.second);
+        for (auto const& x : m_table)
+            m_sorted_data.emplace_back(x.device, &x.data);
         std::sort(m_sorted_data.begin(), m_sorted_data.end());
-        assert(m_sorted_data.size() == m_data.size());
+        assert(m_sorted_data.size() == m_table.size());
+        for (auto const& x : m_sorted_data)
+            m_index.insert(x.first, **x.second);
     }
 
     //! @brief Changes the status of the context from "query" to "modify", updating metrics.
     template <typename N, typename T>
     void unfreeze(N const& node, T const& metric, metric_type threshold) {
-        assert(m_sorted_data.size() == m_data.size());
+        assert(m_sorted_data.size() == m_table.size());
         m_sorted_data.clear();
-        m_queue = {};
-        for (auto it = m_metrics.begin(); it != m_metrics.end(); ) {
-            it->second = metric.update(it->second, node);
-            if (it->second > threshold) {
-                m_data.erase(it->first);
-                it = m_metrics.erase(it);
-            } else {
-                m_queue.emplace(it->second, it->first);
-                ++it;
+        m_index.clear();
+        size_t j = 0;
+        for (size_t i = 0; i < m_table.size(); ++i) {
+            metric_type m = metric.update(m_table[i].metric, node);
+            if (m > threshold) {
+                m_pos.erase(m_table[i].device);
+                continue;
+            }
+            if (i != j) {
+                m_table[j] = std::move(m_table[i]);
+                m_pos[m_table[j].device] = j;
             }
+            m_table[j].metric = m;
+            ++j;
         }
+        m_table.erase(m_table.begin() + j, m_table.end());
+        heapify();
         assert(m_sorted_data.size() == 0);
     }
 
     //! @brief Returns list of all devices.
-    std::vector<device_t> align(device_t self) const {
-        assert(m_sorted_data.size() == m_data.size());
-        std::vector<device_t> v;
+    fcpp::details::field_vector<device_t> align(device_t self) const {
+        assert(m_sorted_data.size() == m_table.size());
+        fcpp::details::field_vector<device_t> v;
         auto it = m_sorted_data.begin();
         for (; it != m_sorted_data.end() and it->first < self; ++it)
             v.push_back(it->first);
@@ -168,87 +439,147 @@ class context<true, pointer, M, Ts...> {
     }
 
     //! @brief Returns list of devices with specified trace.
-    std::vector<device_t> align(trace_t trace, device_t self) const {
-        assert(m_sorted_data.size() == m_data.size());
-        std::vector<device_t> v;
-        auto it = m_sorted_data.begin();
-        for (; it != m_sorted_data.end() and it->first < self; ++it)
-            if ((*(it->second))->contains(trace)) {
-                v.push_back(it->first);
-            }
-        v.push_back(self);
-        if (it != m_sorted_data.end() and it->first == self) ++it;
-        for (; it != m_sorted_data.end(); ++it)
-            if ((*(it->second))->contains(trace)) {
-                v.push_back(it->first);
-            }
-        return v;
+    fcpp::details::field_vector<device_t> align(trace_t trace, device_t self) const {
+        assert(m_sorted_data.size() == m_table.size());
+        return details::align(m_index.keys(trace), self);
     }
 
     //! @brief Returns the old value for a certain trace (unaligned).
     template <typename A>
     A const& old(trace_t trace, A const& def, device_t self) const {
-        assert(m_sorted_data.size() == m_data.size() or m_data.size() == 1);
-        if (m_data.count(self) and m_data.at(self)->template count<A>(trace))
-            return m_data.at(self)->template at<A>(trace);
+        assert(m_sorted_data.size() == m_table.size() or m_table.size() == 1);
+        auto it = m_pos.find(self);
+        if (it != m_pos.end() and m_table[it->second].data->template count<A>(trace))
+            return m_table[it->second].data->template at<A>(trace);
         return def;
     }
 
     //! @brief Returns neighbours' values for a certain trace (default from `def`, and also self if not present).
     template <typename A>
     to_field<A> nbr(trace_t trace, A const& def, device_t self) const {
-        assert(m_sorted_data.size() == m_data.size());
-        std::vector<device_t> ids;
-        std::vector<to_local<A>> vals;
-        vals.push_back(fcpp::details::other(def));
-        for (auto const& x : m_sorted_data)
-            if ((*x.second)->template count<A>(trace)) {
-                ids.push_back(x.first);
-                vals.push_back(fcpp::details::self(static_cast<A const&>((*x.second)->template at<A>(trace)), self));
-            }
-        return fcpp::details::make_field(std::move(ids), std::move(vals));
+        return lazy_nbr(trace, def, self);
+    }
+
+    //! @brief Returns a lazy view of neighbours' values for a certain trace (valid until the context is unfrozen).
+    template <typename A>
+    nbr_view<A> lazy_nbr(trace_t trace, A const& def, device_t self) const {
+        assert(m_sorted_data.size() == m_table.size());
+        return details::lazy_nbr(m_index.template column<A>(trace), def, self);
     }
 
     //! @brief Prints the context in a stream.
     template <typename O>
     void print(O& o) const {
         bool first = true;
-        for (auto const& x : m_metrics) {
+        for (auto const& x : m_table) {
             if (first) first = false;
             else o << ", ";
-            o << x.first << ":" << m_data.at(x.first) << "@" << 0+x.second;
+            o << x.device << ":" << x.data << "@" << 0+x.metric;
         }
     }
 
     //! @brief Serialises the content from/to a given input/output stream.
     common::sstream<false>& serialize(common::sstream<false>& s) {
-        s >> m_data >> m_metrics;
+        s >> m_table;
         m_sorted_data.clear();
-        for (auto const& x : m_metrics)
-            m_queue.emplace(x.second, x.first);
+        m_index.clear();
+        m_pos.clear();
+        for (size_t i = 0; i < m_table.size(); ++i)
+            m_pos[m_table[i].device] = i;
+        heapify();
         return s;
     }
 
     //! @brief Serialises the content from/to a given input/output stream (const overload).
     common::sstream<true>& serialize(common::sstream<true>& s) const {
-        return s << m_data << m_metrics;
+        return s << m_table;
     }
 
   private:
-    //! @brief Erases invalid values from the queue.
-    void clean() {
-        while (m_metrics.count(m_queue.top().second) == 0 or m_metrics.at(m_queue.top().second) != m_queue.top().first)
-            m_queue.pop();
-    }
-
-    //! @brief Map associating devices to exports.
-    std::unordered_map<device_t, export_type> m_data;
-    //! @brief Map associating devices to metric results.
-    std::unordered_map<device_t, metric_type> m_metrics;
-    //! @brief Exports ordered by metric results.
-    std::priority_queue<std::pair<metric_type, device_t>> m_queue;
+    //! @brief Arity of the heap.
+    constexpr static size_t arity = 4;
+
+    //! @brief An export together with its device and metric.
+    struct entry {
+        //! @brief The device which sent the export.
+        device_t device;
+        //! @brief The metric result of the export.
+        metric_type metric;
+        //! @brief The export.
+        export_type data;
+        //! @brief The position of the entry in the heap.
+        size_t heap = 0;
+
+        //! @brief Serialises the content from/to a given input/output stream.
+        template <typename S>
+        S& serialize(S& s) {
+            return s & device & metric & data;
+        }
+
+        //! @brief Serialises the content from/to a given input/output stream (const overload).
+        template <typename S>
+        S& serialize(S& s) const {
+            return s << device << metric << data;
+        }
+    };
+
+    //! @brief Whether the entry at a table position should be below another in the heap (worse exports are closer to the top).
+    bool below(size_t i, size_t j) const {
+        entry const& x = m_table[i];
+        entry const& y = m_table[j];
+        return x.metric < y.metric or (x.metric == y.metric and x.device < y.device);
+    }
+
+    //! @brief Sets a position of the heap to a table position, updating the table entry.
+    void place(size_t i, size_t t) {
+        m_heap[i] = t;
+        m_table[t].heap = i;
+    }
+
+    //! @brief Moves the element at a given position towards the top of the heap until in order.
+    void sift_up(size_t i) {
+        size_t t = m_heap[i];
+        for (; i > 0 and below(m_heap[(i-1)/arity], t); i = (i-1)/arity)
+            place(i, m_heap[(i-1)/arity]);
+        place(i, t);
+    }
+
+    //! @brief Moves the element at a given position towards the bottom of the heap until in order.
+    void sift_down(size_t i) {
+        size_t n = m_heap.size(), t = m_heap[i];
+        while (true) {
+            size_t c = arity*i+1, best = t, k = i;
+            for (size_t h = c; h < std::min(c+arity, n); ++h)
+                if (below(best, m_heap[h])) {
+                    best = m_heap[h];
+                    k = h;
+                }
+            if (k == i) break;
+            place(i, best);
+            i = k;
+        }
+        place(i, t);
+    }
+
+    //! @brief Arranges all table entries in the heap, in linear time.
+    void heapify() {
+        m_heap.resize(m_table.size());
+        for (size_t i = 0; i < m_table.size(); ++i)
+            place(i, i);
+        for (size_t i = m_heap.size() / arity + 1; i-- > 0; )
+            if (i < m_heap.size()) sift_down(i);
+    }
+
+    //! @brief Exports together with their devices and metric results.
+    std::vector<entry> m_table;
+    //! @brief Positions in the table arranged as a heap by metric results (worst on top).
+    std::vector<size_t> m_heap;
+    //! @brief Map associating devices to their position in the table.
+    std::unordered_map<device_t, size_t> m_pos;
     //! @brief Exports ordered by device.
     std::vector<std::pair<device_t, export_type const*>> m_sorted_data;
+    //! @brief Index of exports by trace.
+    index_type m_index;
 };
 
 
@@ -261,11 +592,19 @@ template <bool pointer, typename M, typename... Ts>
 class context<false, pointer, M, Ts...> {
   public:
     //! @brief The type of the exports contained in the context.
-    typedef internal::flat_ptr<common::multitype_map<trace_t, Ts...>, not pointer> export_type;
+    typedef internal::flat_ptr<typename details::export_map<Ts...>::type, not pointer> export_type;
+
+    //! @brief The type of the index of exports by trace.
+    typedef trace_index<typename details::export_map<Ts...>::type> index_type;
 
     //! @brief The type of the metric on exports.
     typedef M metric_type;
 
+    //! @brief Empty exports for a new round, keeping the layout of given exports if they have one.
+    static export_type renew(export_type const& e) {
+        return details::renew(*e);
+    }
+
     //! @brief Default constructor creating an empty context.
     context() = default;
 
@@ -332,11 +671,15 @@ class context<false, pointer, M, Ts...> {
         m_self = std::lower_bound(m_data.begin(), m_data.end(), data_type{self, metric_type{}, export_type{}}, [](data_type const& x, data_type const& y) {
             return get<0>(x) < get<0>(y);
         }) - m_data.begin();
+        m_index.clear();
+        for (auto const& x : m_data)
+            m_index.insert(get<0>(x), *get<2>(x));
     }
 
     //! @brief Changes the status of the context from "query" to "modify", updating metrics.
     template <typename N, typename T>
     void unfreeze(N const& node, T const& metric, metric_type threshold) {
+        m_index.clear();
         size_t w = 0;
         for (size_t r = 0; r < m_data.size(); ++r) {
             get<1>(m_data[r]) = metric.update(get<1>(m_data[r]), node);
@@ -349,8 +692,8 @@ class context<false, pointer, M, Ts...> {
     }
 
     //! @brief Returns list of all devices.
-    std::vector<device_t> align(device_t self) const {
-        std::vector<device_t> v;
+    fcpp::details::field_vector<device_t> align(device_t self) const {
+        fcpp::details::field_vector<device_t> v;
         size_t i = 0;
         for (; i < m_self; ++i)
             v.push_back(get<0>(m_data[i]));
@@ -362,18 +705,8 @@ class context<false, pointer, M, Ts...> {
     }
 
     //! @brief Returns list of devices with specified trace.
-    std::vector<device_t> align(trace_t trace, device_t self) const {
-        std::vector<device_t> v;
-        size_t i = 0;
-        for (; i < m_self; ++i)
-            if (get<2>(m_data[i])->contains(trace))
-                v.push_back(get<0>(m_data[i]));
-        v.push_back(self);
-        if (i < m_data.size() and get<0>(m_data[i]) == self) ++i;
-        for (; i < m_data.size(); ++i)
-            if (get<2>(m_data[i])->contains(trace))
-                v.push_back(get<0>(m_data[i]));
-        return v;
+    fcpp::details::field_vector<device_t> align(trace_t trace, device_t self) const {
+        return details::align(m_index.keys(trace), self);
     }
 
     //! @brief Returns the old value for a certain trace (unaligned).
@@ -387,15 +720,13 @@ class context<false, pointer, M, Ts...> {
     //! @brief Returns neighbours' values for a certain trace (default from `def`, and also self if not present).
     template <typename A>
     to_field<A> nbr(trace_t trace, A const& def, device_t self) const {
-        std::vector<device_t> ids;
-        std::vector<to_local<A>> vals;
-        vals.push_back(fcpp::details::other(def));
-        for (auto const& x : m_data)
-            if (get<2>(x)->template count<A>(trace)) {
-                ids.push_back(get<0>(x));
-                vals.push_back(fcpp::details::self(static_cast<A const&>(get<2>(x)->template at<A>(trace)), self));
-            }
-        return fcpp::details::make_field(std::move(ids), std::move(vals));
+        return lazy_nbr(trace, def, self);
+    }
+
+    //! @brief Returns a lazy view of neighbours' values for a certain trace (valid until the context is unfrozen).
+    template <typename A>
+    nbr_view<A> lazy_nbr(trace_t trace, A const& def, device_t self) const {
+        return details::lazy_nbr(m_index.template column<A>(trace), def, self);
     }
 
     //! @brief Prints the context in a stream.
@@ -412,6 +743,7 @@ class context<false, pointer, M, Ts...> {
     //! @brief Serialises the content from/to a given input/output stream.
     template <typename S>
     S& serialize(S& s) {
+        m_index.clear();
         return s & m_data & m_self;
     }
 
@@ -429,27 +761,48 @@ class context<false, pointer, M, Ts...> {
     std::vector<data_type> m_data;
 
     //! @brief Index of self in @ref m_data.
-    size_t m_self;
+    size_t m_self = 0;
+
+    //! @brief Index of exports by trace.
+    index_type m_index;
 };
 
 
 //! @cond INTERNAL
 namespace details {
     // General form.
-    template <bool online, bool pointer, typename M, typename T>
+    template <bool online, bool pointer, typename M, typename T, bool flat, bool layout, bool shared>
     struct context_t;
 
     // Unpacking form.
     template <bool online, bool pointer, typename M, typename... Ts>
-    struct context_t<online, pointer, M, common::type_sequence<Ts...>> {
+    struct context_t<online, pointer, M, common::type_sequence<Ts...>, false, false, false> {
         using type = context<online, pointer, M, Ts...>;
     };
+
+    // Unpacking form with flat exports.
+    template <bool online, bool pointer, typename M, typename... Ts>
+    struct context_t<online, pointer, M, common::type_sequence<Ts...>, true, false, false> {
+        using type = context<online, pointer, M, flat_exports<Ts...>>;
+    };
+
+    // Unpacking form with layout exports.
+    template <bool online, bool pointer, typename M, typename... Ts, bool flat>
+    struct context_t<online, pointer, M, common::type_sequence<Ts...>, flat, true, false> {
+        using type = context<online, pointer, M, layout_exports<Ts...>>;
+    };
+
+    // Unpacking form with shared exports.
+    template <bool online, bool pointer, typename M, typename... Ts, bool flat, bool layout>
+    struct context_t<online, pointer, M, common::type_sequence<Ts...>, flat, layout, true> {
+        using type = context<online, pointer, M, shared_exports<Ts...>>;
+    };
 }
 //! @endcond
 
-//! @brief Context built with a type sequence of types.
-template <bool online, bool pointer, typename M, typename T>
-using context_t = typename details::context_t<online,pointer,M,T>::type;
+//! @brief Context built with a type sequence of types (with exports in shared multitype maps if `shared` is true, or else in layout multitype maps if `layout` is true, or else in flat multitype maps if `flat` is true).
+template <bool online, bool pointer, typename M, typename T, bool flat = false, bool layout = false, bool shared = false>
+using context_t = typename details::context_t<online,pointer,M,T,flat,layout,shared>::type;
 
 
 }
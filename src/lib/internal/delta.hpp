@@ -0,0 +1,460 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file delta.hpp
+ * @brief Implementation of the `export_delta<M>`, `shared_delta<E>` and `delta_codec<E, period>` class templates for delta-encoding exports across rounds.
+ */
+
+#ifndef FCPP_INTERNAL_DELTA_H_
+#define FCPP_INTERNAL_DELTA_H_
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/common/serialize.hpp"
+#include "lib/common/traits.hpp"
+#include "lib/internal/flat_ptr.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+//! @brief Namespace containing objects of internal use.
+namespace internal {
+
+
+/**
+ * @brief Difference between two consecutive exports of a device.
+ *
+ * A delta is either full, carrying a whole export, or partial, carrying the entries which were added or changed
+ * since the previous export together with the entries which were removed. Every delta is tagged with the generation
+ * of the export it describes, so that partial deltas are applied only on top of the export of the previous generation.
+ *
+ * @param M The type of the exports (a \ref common::multitype_map or \ref common::flat_multitype_map).
+ */
+template <typename M>
+class export_delta {
+  public:
+    //! @brief The type of the exports.
+    typedef M map_type;
+
+    //! @brief The type of the keys.
+    typedef typename M::key_type key_type;
+
+    //! @brief List of admissible types.
+    using value_types = typename M::value_types;
+
+    //! @name constructors
+    //! @{
+
+    //! @brief Default constructor (empty full delta).
+    export_delta() = default;
+
+    //! @brief Full delta carrying a whole export.
+    export_delta(M const& e, size_t generation) : m_generation(generation), m_full(true), m_values(e) {}
+
+    //! @brief Partial delta from a previous export to the current one.
+    export_delta(M const& prev, M const& e, size_t generation) : m_generation(generation), m_full(false) {
+        e.for_each([&](key_type k, size_t type, void const* p){
+            if (type == value_types::size) {
+                if (not prev.contains(k)) m_values.insert(k);
+            } else visit(type, [&](auto t){
+                using A = typename decltype(t)::front;
+                A const& x = *static_cast<A const*>(p);
+                if (not prev.template count<A>(k) or not static_cast<bool>(prev.template at<A>(k) == x)) m_values.insert(k, x);
+            });
+        });
+        prev.for_each([&](key_type k, size_t type, void const*){
+            bool found = false;
+            if (type == value_types::size) found = e.contains(k);
+            else visit(type, [&](auto t){
+                found = e.template count<typename decltype(t)::front>(k);
+            });
+            if (not found) m_removed.emplace_back(k, type);
+        });
+    }
+
+    //! @brief Copy constructor.
+    export_delta(export_delta const&) = default;
+
+    //! @brief Move constructor.
+    export_delta(export_delta&&) = default;
+    //! @}
+
+    //! @name assignment operators
+    //! @{
+
+    //! @brief Copy assignment.
+    export_delta& operator=(export_delta const&) = default;
+
+    //! @brief Move assignment.
+    export_delta& operator=(export_delta&&) = default;
+    //! @}
+
+    //! @brief Equality operator.
+    bool operator==(export_delta const& o) const {
+        return m_generation == o.m_generation and m_full == o.m_full and m_values == o.m_values and m_removed == o.m_removed;
+    }
+
+    //! @brief The generation of the export described.
+    size_t generation() const {
+        return m_generation;
+    }
+
+    //! @brief Whether the delta carries a whole export.
+    bool full() const {
+        return m_full;
+    }
+
+    //! @brief Whether the delta is partial and carries no changes.
+    bool empty() const {
+        bool e = not m_full and m_removed.empty();
+        m_values.for_each([&](key_type, size_t, void const*){
+            e = false;
+        });
+        return e;
+    }
+
+    //! @brief The entries added or changed (or the whole export, for full deltas).
+    M const& values() const {
+        return m_values;
+    }
+
+    //! @brief The entries removed, as pairs of a key and a type index (`value_types::size` for void values).
+    std::vector<std::pair<key_type, size_t>> const& removed() const {
+        return m_removed;
+    }
+
+    //! @brief Applies the delta to the export of the previous generation (or any export, for full deltas).
+    void apply(M& e) const {
+        if (m_full) {
+            e = m_values;
+            return;
+        }
+        for (auto const& x : m_removed) {
+            if (x.second == value_types::size) e.remove(x.first);
+            else visit(x.second, [&](auto t){
+                e.template erase<typename decltype(t)::front>(x.first);
+            });
+        }
+        m_values.for_each([&](key_type k, size_t type, void const* p){
+            if (type == value_types::size) e.insert(k);
+            else visit(type, [&](auto t){
+                using A = typename decltype(t)::front;
+                e.insert(k, *static_cast<A const*>(p));
+            });
+        });
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream.
+    template <typename S>
+    S& serialize(S& s) {
+        return s & m_generation & m_full & m_values & m_removed;
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream (const overload).
+    template <typename S>
+    S& serialize(S& s) const {
+        return s << m_generation << m_full << m_values << m_removed;
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream, with a custom serialisation of the values.
+    template <typename S, typename F>
+    S& serialize(S& s, F&& f) {
+        s & m_generation & m_full;
+        f(s, m_values);
+        return s & m_removed;
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream, with a custom serialisation of the values (const overload).
+    template <typename S, typename F>
+    S& serialize(S& s, F&& f) const {
+        s << m_generation << m_full;
+        f(s, m_values);
+        return s << m_removed;
+    }
+
+  private:
+    //! @brief Calls a function on a type tag corresponding to a type index (no types left).
+    template <typename F>
+    static void visit(size_t, F&&, common::type_sequence<>) {
+        assert(false);
+    }
+
+    //! @brief Calls a function on a type tag corresponding to a type index (some types left).
+    template <typename F, typename S, typename... Ss>
+    static void visit(size_t type, F&& f, common::type_sequence<S, Ss...>) {
+        if (type == 0) f(common::type_sequence<S>{});
+        else visit(type-1, std::forward<F>(f), common::type_sequence<Ss...>{});
+    }
+
+    //! @brief Calls a function on a type tag corresponding to a type index.
+    template <typename F>
+    static void visit(size_t type, F&& f) {
+        visit(type, std::forward<F>(f), value_types{});
+    }
+
+    //! @brief The generation of the export described.
+    size_t m_generation = 0;
+    //! @brief Whether the delta carries a whole export.
+    bool m_full = true;
+    //! @brief The entries added or changed.
+    M m_values;
+    //! @brief The entries removed.
+    std::vector<std::pair<key_type, size_t>> m_removed;
+};
+
+
+/**
+ * @brief Delta which also shares the export it describes with receivers in the same process.
+ *
+ * Receivers holding the export of the previous generation can share the export described instead of patching a copy.
+ * The shared export is not serialised, so that deltas received through a network are patched as usual.
+ *
+ * @param E The type of the exports (a \ref flat_ptr to a multitype map).
+ */
+template <typename E>
+class shared_delta : public export_delta<typename E::value_type> {
+  public:
+    //! @brief Constructors from an export delta.
+    using export_delta<typename E::value_type>::export_delta;
+
+    //! @brief The export described (null if not available).
+    E const* source() const {
+        return m_source.get();
+    }
+
+    //! @brief Shares the export described.
+    void source(E const& e) {
+        m_source = std::make_shared<E const>(e);
+    }
+
+  private:
+    //! @brief The export described.
+    std::shared_ptr<E const> m_source;
+};
+
+
+/**
+ * @brief Encodes the exports of a device into deltas, and decodes the deltas received from neighbours.
+ *
+ * Exports are encoded only when a message is sent, against the last export sent, so that a generation is a message
+ * sent rather than a round. A full export is sent every `period` generations, and partial deltas in between. A neighbour
+ * decodes a partial delta only on top of the export of the previous generation from the same device: after a lost
+ * message, the deltas from that device are ignored until the next full export (unless the message shares its export). The export decoded from a device is kept independently of the
+ * exports retained in the context, and is forgotten once the device has surely sent its next full export (estimating
+ * the time between its generations from the messages received), or after `period` rounds without messages if no
+ * such estimate is available. Messages to self are always decoded from the last export encoded. Exports held in
+ * pointers are also shared through the messages, so that receivers in the same process do not need to copy them.
+ *
+ * @param E The type of the exports (a \ref flat_ptr to a multitype map).
+ * @param period The number of generations between full exports (zero to disable delta encoding).
+ */
+template <typename E, intmax_t period>
+class delta_codec {
+    //! @brief Whether exports are held in pointers.
+    constexpr static bool shared = std::is_same<E, flat_ptr<typename E::value_type, false>>::value;
+
+  public:
+    //! @brief The type of messages encoding exports.
+    using message_type = std::conditional_t<shared, shared_delta<E>, export_delta<typename E::value_type>>;
+
+    //! @brief Marks the export as renewed, so that the next message sent encodes it as a new generation.
+    void renew() {
+        m_renewed = true;
+    }
+
+    //! @brief The message encoding the current export, encoding it if renewed since the last message.
+    message_type const& message(E const& e) {
+        if (not m_renewed) return m_message;
+        if (m_generation % period == 0) m_message = message_type(*e, m_generation);
+        else m_message = message_type(*m_last, *e, m_generation);
+        share(m_message, e);
+        m_last = e;
+        ++m_generation;
+        m_renewed = false;
+        return m_message;
+    }
+
+    //! @brief Decodes a message from a device to the current one received at time `t`, returning the export described (or null if it cannot be decoded).
+    E const* decode(times_t t, device_t d, device_t self, message_type const& m) {
+        if (d == self and m.generation() + 1 == m_generation) return &m_last;
+        auto it = m_bases.find(d);
+        if (m.full()) {
+            if (it == m_bases.end()) it = m_bases.emplace(d, base{}).first;
+            else it->second.update(t, m.generation());
+            it->second.generation = m.generation();
+            it->second.time = t;
+            patch(it->second.data, m);
+            return &it->second.data;
+        }
+        if (it != m_bases.end() and it->second.generation == m.generation()) return &it->second.data;
+        if (it == m_bases.end() or it->second.generation + 1 != m.generation()) {
+            // without a base to patch, the export can only be rebuilt from the message itself
+            if (not has_source(m)) {
+                if (it != m_bases.end()) m_bases.erase(it);
+                return nullptr;
+            }
+            if (it == m_bases.end()) {
+                it = m_bases.emplace(d, base{}).first;
+                it->second.generation = m.generation();
+                it->second.time = t;
+            }
+        }
+        if (not m.empty() or has_source(m)) patch(it->second.data, m);
+        it->second.update(t, m.generation());
+        return &it->second.data;
+    }
+
+    //! @brief Forgets the exports which can no longer be patched at a round at time `t`.
+    void prune(times_t t) {
+        for (auto it = m_bases.begin(); it != m_bases.end(); ) {
+            base& b = it->second;
+            // the next full export from the device replaces the current one
+            size_t left = period - b.generation % period;
+            bool expired = b.interval < 0 ? ++b.idle > period : t > b.time + left * b.interval;
+            if (expired) it = m_bases.erase(it);
+            else ++it;
+        }
+    }
+
+    //! @brief Serialises the content from a given input stream.
+    common::isstream& serialize(common::isstream& s) {
+        s & m_generation & m_renewed & m_last & m_message & m_bases;
+        share(m_message, m_last);
+        return s;
+    }
+
+    //! @brief Serialises the content to a given output stream.
+    template <typename S>
+    S& serialize(S& s) const {
+        return s << m_generation << m_renewed << m_last << m_message << m_bases;
+    }
+
+  private:
+    //! @brief The last export decoded from a device.
+    struct base {
+        //! @brief Updates the timing with a message of a later generation received at time `t`.
+        void update(times_t t, size_t g) {
+            if (g > generation) interval = (t - time) / (g - generation);
+            generation = g;
+            time = t;
+            idle = 0;
+        }
+
+        //! @brief Serialises the content from/to a given input/output stream.
+        template <typename S>
+        S& serialize(S& s) {
+            return s & generation & data & time & interval & idle;
+        }
+
+        //! @brief Serialises the content to a given output stream.
+        template <typename S>
+        S& serialize(S& s) const {
+            return s << generation << data << time << interval << idle;
+        }
+
+        //! @brief The generation of the export.
+        size_t generation = 0;
+        //! @brief The export.
+        E data;
+        //! @brief The time of the last message received.
+        times_t time = 0;
+        //! @brief The estimated time between generations (negative if unknown).
+        times_t interval = -1;
+        //! @brief The number of rounds without messages, while the interval is unknown.
+        size_t idle = 0;
+    };
+
+    //! @brief Shares an export through a message.
+    static void share(shared_delta<E>& m, E const& e) {
+        m.source(e);
+    }
+
+    //! @brief Shares an export through a message (not held in pointers).
+    static void share(export_delta<typename E::value_type>&, E const&) {}
+
+    //! @brief Whether a message shares the export it describes.
+    static bool has_source(shared_delta<E> const& m) {
+        return m.source() != nullptr;
+    }
+
+    //! @brief Whether a message shares the export it describes (not held in pointers).
+    static bool has_source(export_delta<typename E::value_type> const&) {
+        return false;
+    }
+
+    //! @brief Updates an export with a message, sharing the export described if available.
+    static void patch(E& e, shared_delta<E> const& m) {
+        if (m.source() != nullptr) e = *m.source();
+        else if (m.full()) e = m.values();
+        else m.apply(e.detach());
+    }
+
+    //! @brief Updates an export with a message (not held in pointers).
+    static void patch(E& e, export_delta<typename E::value_type> const& m) {
+        if (m.full()) e = m.values();
+        else m.apply(e.detach());
+    }
+
+    //! @brief The generation of the next export.
+    size_t m_generation = 0;
+    //! @brief Whether the export has been renewed since the last message.
+    bool m_renewed = false;
+    //! @brief The last export encoded.
+    E m_last;
+    //! @brief The message encoding the last export.
+    message_type m_message;
+    //! @brief The last export decoded from each device.
+    std::unordered_map<device_t, base> m_bases;
+};
+
+
+//! @brief Passes exports through without delta encoding.
+template <typename E>
+class delta_codec<E, 0> {
+  public:
+    //! @brief The type of messages encoding exports.
+    using message_type = E;
+
+    //! @brief Marks the export as renewed (does nothing).
+    void renew() {}
+
+    //! @brief The message encoding an export.
+    E const& message(E const& e) const {
+        return e;
+    }
+
+    //! @brief Decodes a message from a device to the current one.
+    E const* decode(times_t, device_t, device_t, E const& m) {
+        return &m;
+    }
+
+    //! @brief Forgets the exports which can no longer be patched (does nothing).
+    void prune(times_t) {}
+
+    //! @brief Serialises the content from/to a given input/output stream (does nothing).
+    template <typename S>
+    S& serialize(S& s) const {
+        return s;
+    }
+};
+
+
+}
+
+
+}
+
+#endif // FCPP_INTERNAL_DELTA_H_
@@ -9,6 +9,7 @@
 #define FCPP_INTERNAL_FLAT_PTR_H_
 
 #include <memory>
+#include <utility>
 
 
 /**
@@ -49,9 +50,12 @@ class flat_ptr<T, false> {
 
     //! @brief Default moving constructor.
     flat_ptr(T&& d) {
-        m_data.reset(new T(d));
+        m_data.reset(new T(std::move(d)));
     }
 
+    //! @brief Constructor sharing an existing content.
+    explicit flat_ptr(std::shared_ptr<T> d) : m_data(std::move(d)) {}
+
     //! @brief Copy constructor.
     flat_ptr(flat_ptr const&) = default;
 
@@ -111,6 +115,17 @@ class flat_ptr<T, false> {
         return m_data.get();
     }
 
+    //! @brief Mutable access to the content, copying it first if it is shared with other pointers.
+    T& detach() {
+        if (m_data.use_count() > 1) m_data.reset(new T(*m_data));
+        return *m_data.get();
+    }
+
+    //! @brief The shared pointer to the content.
+    std::shared_ptr<T> const& shared() const {
+        return m_data;
+    }
+
     //! @brief Serialises the content from/to a given input/output stream.
     template <typename S>
     S& serialize(S& s) {
@@ -146,7 +161,7 @@ class flat_ptr<T, true> {
     flat_ptr(T const& d) : m_data(d) {}
 
     //! @brief Default moving constructor.
-    flat_ptr(T&& d) : m_data(d) {}
+    flat_ptr(T&& d) : m_data(std::move(d)) {}
 
     //! @brief Copy constructor.
     flat_ptr(flat_ptr const&) = default;
@@ -208,6 +223,11 @@ class flat_ptr<T, true> {
         return &m_data;
     }
 
+    //! @brief Mutable access to the content (never shared).
+    T& detach() {
+        return m_data;
+    }
+
     //! @brief Serialises the content from/to a given input/output stream.
     template <typename S>
     S& serialize(S& s) {
@@ -0,0 +1,225 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file intern.hpp
+ * @brief Implementation of the `intern_table<T>` class template for sharing equal export values across contexts.
+ */
+
+#ifndef FCPP_INTERNAL_INTERN_H_
+#define FCPP_INTERNAL_INTERN_H_
+
+#include <cstdint>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include "lib/common/mutex.hpp"
+#include "lib/common/serialize.hpp"
+#include "lib/common/shared_multitype_map.hpp"
+#include "lib/internal/flat_ptr.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+//! @brief Namespace containing objects of internal use.
+namespace internal {
+
+
+//! @brief Memory statistics of an intern table.
+struct intern_stats {
+    //! @brief Number of values looked up.
+    size_t lookups = 0;
+    //! @brief Number of values looked up which were already present.
+    size_t hits = 0;
+    //! @brief Number of distinct values currently shared.
+    size_t entries = 0;
+    //! @brief Number of references currently held to shared values.
+    size_t references = 0;
+    //! @brief Serialised size of the distinct values currently shared.
+    size_t bytes = 0;
+    //! @brief Memory held by the table itself (entries and buckets, including expired entries not yet purged).
+    size_t table_bytes = 0;
+    //! @brief Serialised size of the copies currently avoided (one for every reference beyond the first), net of `table_bytes`.
+    intmax_t bytes_saved = 0;
+
+    //! @brief Adds the statistics of another table.
+    intern_stats& operator+=(intern_stats const& o) {
+        lookups += o.lookups;
+        hits += o.hits;
+        entries += o.entries;
+        references += o.references;
+        bytes += o.bytes;
+        table_bytes += o.table_bytes;
+        bytes_saved += o.bytes_saved;
+        return *this;
+    }
+};
+
+
+/**
+ * @brief Hash-consing table sharing one immutable instance between equal values, process-wide.
+ *
+ * Values are keyed by a hash of their serialised content, and compared with the values stored under the same hash,
+ * so that the table holds no copy of their content. The table holds values weakly: a value is dropped as soon as
+ * nobody else references it. The table is split in shards with separate locks, so that threads interning different
+ * values seldom contend.
+ *
+ * @param T The type of the values (with serialisation and equality).
+ */
+template <typename T>
+class intern_table {
+  public:
+    //! @brief Number of shards of the table.
+    constexpr static size_t shards = 16;
+
+    //! @brief Returns a shared pointer to a value equal to the given one, sharing it with previous equal values.
+    static std::shared_ptr<T> intern(std::shared_ptr<T> const& x) {
+        size_t h = common::hash_to<size_t>(*x);
+        shard_type& s = get_shards()[h % shards];
+        common::lock_guard<true> l(s.mutex);
+        ++s.lookups;
+        auto range = s.data.equal_range(h);
+        auto slot = s.data.end();
+        for (auto it = range.first; it != range.second; ++it) {
+            if (std::shared_ptr<T> y = it->second.lock()) {
+                if (y == x or *y == *x) {
+                    ++s.hits;
+                    return y;
+                }
+            } else slot = it;
+        }
+        if (slot != s.data.end()) slot->second = x;
+        else {
+            purge(s.data, s.purge);
+            s.data.emplace(h, x);
+        }
+        return x;
+    }
+
+    //! @brief Current memory statistics of the table (serialising every value shared, thus costly).
+    static intern_stats stats() {
+        intern_stats r;
+        size_t saved = 0;
+        for (shard_type& s : get_shards()) {
+            common::lock_guard<true> l(s.mutex);
+            r.lookups += s.lookups;
+            r.hits += s.hits;
+            r.table_bytes += sizeof(shard_type) + s.data.bucket_count() * sizeof(void*) + s.data.size() * node_size;
+            for (auto const& x : s.data) {
+                std::shared_ptr<T> y = x.second.lock();
+                if (not y) continue;
+                size_t n = y.use_count() - 1;
+                if (n == 0) continue;
+                common::osstream os;
+                os << *y;
+                ++r.entries;
+                r.references += n;
+                r.bytes += os.size();
+                saved += (n - 1) * os.size();
+            }
+        }
+        r.bytes_saved = intmax_t(saved) - intmax_t(r.table_bytes);
+        return r;
+    }
+
+  private:
+    //! @brief Approximate memory of an entry of a shard (the value and the link to the next entry).
+    constexpr static size_t node_size = sizeof(std::pair<size_t const, std::weak_ptr<T>>) + sizeof(void*);
+
+    //! @brief Minimum number of entries of a shard before expired entries are purged.
+    constexpr static size_t min_purge = 64;
+
+    //! @brief A shard of the table.
+    struct shard_type {
+        //! @brief Lock guarding the shard.
+        common::mutex<true> mutex;
+        //! @brief Values by hash of their serialised content.
+        std::unordered_multimap<size_t, std::weak_ptr<T>> data;
+        //! @brief Number of entries after which expired entries are purged.
+        size_t purge = min_purge;
+        //! @brief Number of values looked up.
+        size_t lookups = 0;
+        //! @brief Number of values looked up which were already present.
+        size_t hits = 0;
+    };
+
+    //! @brief Drops the expired entries of a map, if it has grown beyond a threshold (updated accordingly).
+    template <typename M>
+    static void purge(M& m, size_t& threshold) {
+        if (m.size() < threshold) return;
+        for (auto it = m.begin(); it != m.end(); ) {
+            if (it->second.expired()) it = m.erase(it);
+            else ++it;
+        }
+        threshold = std::max(size_t(min_purge), 2 * m.size());
+    }
+
+    //! @brief The shards of the table.
+    static shard_type (&get_shards())[shards] {
+        static shard_type s[shards];
+        return s;
+    }
+};
+
+
+//! @cond INTERNAL
+namespace details {
+    //! @brief Replaces a pointer to a value with a pointer to the instance shared in its place.
+    struct interner {
+        template <typename A>
+        void operator()(std::shared_ptr<A>& p) const {
+            p = intern_table<A>::intern(p);
+        }
+    };
+
+    //! @brief Memory statistics of the values of some types.
+    template <typename... Ts>
+    intern_stats intern_statistics(common::type_sequence<Ts...>) {
+        intern_stats r;
+        for (intern_stats const& s : {intern_stats{}, intern_table<Ts>::stats()...}) r += s;
+        return r;
+    }
+}
+//! @endcond
+
+
+//! @brief Shares every value of an export with the equal values of other exports, process-wide.
+template <typename T, bool b, typename... Ts>
+flat_ptr<common::shared_multitype_map<T, Ts...>, b> intern(flat_ptr<common::shared_multitype_map<T, Ts...>, b> const& e) {
+    if (e->shared()) return e;
+    common::shared_multitype_map<T, Ts...> m = *e;
+    m.share(details::interner{});
+    return m;
+}
+
+//! @brief Leaves an export without shareable values unchanged.
+template <typename E>
+E const& intern(E const& e) {
+    return e;
+}
+
+//! @brief Memory statistics of the values shared by exports.
+template <typename T, bool b, typename... Ts>
+intern_stats intern_statistics(flat_ptr<common::shared_multitype_map<T, Ts...>, b> const&) {
+    return details::intern_statistics(typename common::shared_multitype_map<T, Ts...>::value_types{});
+}
+
+//! @brief Memory statistics of exports without shareable values (always empty).
+template <typename E>
+intern_stats intern_statistics(E const&) {
+    return {};
+}
+
+
+}
+
+
+}
+
+#endif // FCPP_INTERNAL_INTERN_H_
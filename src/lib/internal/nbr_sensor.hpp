@@ -0,0 +1,164 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file nbr_sensor.hpp
+ * @brief Implementation of the `nbr_sensor<T>` class template for fields of values sensed from neighbours.
+ */
+
+#ifndef FCPP_INTERNAL_NBR_SENSOR_H_
+#define FCPP_INTERNAL_NBR_SENSOR_H_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "lib/settings.hpp"
+#include "lib/common/arena.hpp"
+#include "lib/common/serialize.hpp"
+#include "lib/data/field.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+//! @brief Namespace containing objects of internal use.
+namespace internal {
+
+
+/**
+ * @brief Field of values sensed from neighbours, as they are updated by incoming messages.
+ *
+ * Updates are buffered as they arrive, and merged into the field at once (by sorting them and merging them with the
+ * existing neighbours) when the field is next read, so that receiving from n neighbours costs O(n log n) instead of
+ * inserting every value in the middle of the field. Merges never draw memory from the round arena.
+ *
+ * @param T The type of the values sensed.
+ */
+template <typename T>
+class nbr_sensor {
+  public:
+    //! @name constructors
+    //! @{
+
+    //! @brief Default constructor.
+    nbr_sensor() = default;
+
+    //! @brief Constructor from the default value of the field.
+    nbr_sensor(T const& def) : m_field(def) {}
+
+    //! @brief Copy constructor.
+    nbr_sensor(nbr_sensor const&) = default;
+
+    //! @brief Move constructor.
+    nbr_sensor(nbr_sensor&&) = default;
+    //! @}
+
+    //! @name assignment operators
+    //! @{
+
+    //! @brief Copy assignment.
+    nbr_sensor& operator=(nbr_sensor const&) = default;
+
+    //! @brief Move assignment.
+    nbr_sensor& operator=(nbr_sensor&&) = default;
+    //! @}
+
+    //! @brief Sets the value sensed from a device, overriding previous values (effective from the next read).
+    void set(device_t d, T const& x) {
+        m_updates.emplace_back(d, x);
+    }
+
+    //! @brief Sets the value sensed from a device, overriding previous values (effective from the next read).
+    void set(device_t d, T&& x) {
+        m_updates.emplace_back(d, std::move(x));
+    }
+
+    //! @brief Merges the pending updates into the field.
+    void flush() const {
+        if (not m_updates.empty()) merge();
+    }
+
+    //! @brief Access to the field of sensed values (merging the pending updates).
+    field<T> const& get() const {
+        flush();
+        return m_field;
+    }
+
+    //! @brief Access to the field of sensed values (merging the pending updates).
+    field<T>& get() {
+        flush();
+        return m_field;
+    }
+
+    //! @brief Serialises the content from a given input stream.
+    common::isstream& serialize(common::isstream& s) {
+        m_updates.clear();
+        return s & m_field;
+    }
+
+    //! @brief Serialises the content to a given output stream.
+    template <typename S>
+    S& serialize(S& s) const {
+        return s & get();
+    }
+
+  private:
+    //! @brief Sorts the pending updates (the last of each device prevailing) and merges them into the field.
+    void merge() const {
+        // the field outlives the round, thus it is not merged into the round arena
+        common::arena::suspend_guard g;
+        std::stable_sort(m_updates.begin(), m_updates.end(), [](update_type const& x, update_type const& y){
+            return x.first < y.first;
+        });
+        auto& ids = fcpp::details::get_ids(m_field);
+        auto& vals = fcpp::details::get_vals(m_field);
+        m_ids.clear();
+        m_vals.clear();
+        m_ids.reserve(ids.size() + m_updates.size());
+        m_vals.reserve(ids.size() + m_updates.size() + 1);
+        m_vals.push_back(std::move(vals[0]));
+        size_t i = 0;
+        for (size_t j = 0; j < m_updates.size(); ++j) {
+            device_t d = m_updates[j].first;
+            if (j+1 < m_updates.size() and m_updates[j+1].first == d) continue;
+            for (; i < ids.size() and ids[i] < d; ++i) {
+                m_ids.push_back(ids[i]);
+                m_vals.push_back(std::move(vals[i+1]));
+            }
+            if (i < ids.size() and ids[i] == d) ++i;
+            m_ids.push_back(d);
+            m_vals.push_back(std::move(m_updates[j].second));
+        }
+        for (; i < ids.size(); ++i) {
+            m_ids.push_back(ids[i]);
+            m_vals.push_back(std::move(vals[i+1]));
+        }
+        swap(ids, m_ids);
+        swap(vals, m_vals);
+        m_updates.clear();
+    }
+
+    //! @brief The type of a pending update.
+    using update_type = std::pair<device_t, T>;
+
+    //! @brief The field of sensed values.
+    mutable field<T> m_field;
+
+    //! @brief The updates not yet merged into the field.
+    mutable std::vector<update_type> m_updates;
+
+    //! @brief Buffers for merging, reused across merges.
+    mutable fcpp::details::field_vector<device_t> m_ids;
+    mutable fcpp::details::field_vector<T> m_vals;
+};
+
+
+}
+
+
+}
+
+#endif // FCPP_INTERNAL_NBR_SENSOR_H_
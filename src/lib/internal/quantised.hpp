@@ -0,0 +1,258 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+/**
+ * @file quantised.hpp
+ * @brief Implementation of the `quantised_message<T, Q>` class template for encoding exports in reduced precision on the wire.
+ */
+
+#ifndef FCPP_INTERNAL_QUANTISED_H_
+#define FCPP_INTERNAL_QUANTISED_H_
+
+#include <type_traits>
+#include <utility>
+
+#include "lib/common/quantise.hpp"
+#include "lib/common/serialize.hpp"
+#include "lib/data/field.hpp"
+#include "lib/internal/delta.hpp"
+#include "lib/internal/flat_ptr.hpp"
+
+
+/**
+ * @brief Namespace containing all the objects in the FCPP library.
+ */
+namespace fcpp {
+
+
+//! @brief Namespace containing objects of internal use.
+namespace internal {
+
+
+//! @cond INTERNAL
+namespace details {
+    //! @brief Writes a real value through an encoding.
+    template <typename E, typename S, typename A>
+    void quantised_write(S& s, A const& x) {
+        static_assert(std::is_floating_point<A>::value, "quantised export types must be real types or fields of them");
+        s << E::encode(x);
+    }
+
+    //! @brief Writes a field through an encoding.
+    template <typename E, typename S, typename A>
+    void quantised_write(S& s, field<A> const& x) {
+        fcpp::details::field_vector<device_t> const& ids = fcpp::details::get_ids(x);
+        s.write((device_t)ids.size());
+        for (device_t i : ids) s << i;
+        for (A const& v : fcpp::details::get_vals(x)) quantised_write<E>(s, v);
+    }
+
+    //! @brief Reads a real value through an encoding.
+    template <typename E, typename A>
+    void quantised_read(common::isstream& s, A& x) {
+        static_assert(std::is_floating_point<A>::value, "quantised export types must be real types or fields of them");
+        typename E::wire_type w;
+        s >> w;
+        x = A(E::decode(w));
+    }
+
+    //! @brief Reads a field through an encoding.
+    template <typename E, typename A>
+    void quantised_read(common::isstream& s, field<A>& x) {
+        device_t n = 0;
+        s.read(n);
+        fcpp::details::field_vector<device_t> ids(n);
+        for (device_t& i : ids) s >> i;
+        fcpp::details::field_vector<A> vals(n+1);
+        for (A& v : vals) quantised_read<E>(s, v);
+        x = fcpp::details::make_field(std::move(ids), std::move(vals));
+    }
+
+    //! @brief Writes a value of a type not encoded.
+    template <typename E, typename S, typename A>
+    std::enable_if_t<std::is_same<E, void>::value> quantised_put(S& s, A const& x) {
+        s << x;
+    }
+
+    //! @brief Writes a value of a type encoded.
+    template <typename E, typename S, typename A>
+    std::enable_if_t<not std::is_same<E, void>::value> quantised_put(S& s, A const& x) {
+        quantised_write<E>(s, x);
+    }
+
+    //! @brief Reads a value of a type not encoded.
+    template <typename E, typename A>
+    std::enable_if_t<std::is_same<E, void>::value> quantised_get(common::isstream& s, A& x) {
+        s >> x;
+    }
+
+    //! @brief Reads a value of a type encoded.
+    template <typename E, typename A>
+    std::enable_if_t<not std::is_same<E, void>::value> quantised_get(common::isstream& s, A& x) {
+        quantised_read<E>(s, x);
+    }
+
+    //! @brief Calls a function on a type tag corresponding to a type index (no types left).
+    template <typename F>
+    void quantised_visit(size_t, F&&, common::type_sequence<>) {}
+
+    //! @brief Calls a function on a type tag corresponding to a type index (some types left).
+    template <typename F, typename S, typename... Ss>
+    void quantised_visit(size_t type, F&& f, common::type_sequence<S, Ss...>) {
+        if (type == 0) f(common::type_sequence<S>{});
+        else quantised_visit(type-1, std::forward<F>(f), common::type_sequence<Ss...>{});
+    }
+
+    //! @brief Writes a multitype map, encoding the values of types declared in `Q`.
+    template <typename Q, typename S, typename M>
+    S& quantised_serialize(S& s, M const& m) {
+        size_t n = 0;
+        m.for_each([&](typename M::key_type, size_t, void const*){
+            ++n;
+        });
+        common::details::size_variable_write(s, n);
+        m.for_each([&](typename M::key_type k, size_t type, void const* p){
+            s << k;
+            common::details::size_variable_write(s, type);
+            quantised_visit(type, [&](auto t){
+                using A = typename decltype(t)::front;
+                quantised_put<common::quantise_encoding<A, Q>>(s, *static_cast<A const*>(p));
+            }, typename M::value_types{});
+        });
+        return s;
+    }
+
+    //! @brief Reads a multitype map, decoding the values of types declared in `Q`.
+    template <typename Q, typename M>
+    common::isstream& quantised_serialize(common::isstream& s, M& m) {
+        m = M{};
+        size_t n = 0;
+        common::details::size_variable_read(s, n);
+        for (size_t i = 0; i < n; ++i) {
+            typename M::key_type k;
+            size_t type = 0;
+            s >> k;
+            common::details::size_variable_read(s, type);
+            if (type == M::value_types::size) m.insert(k);
+            else quantised_visit(type, [&](auto t){
+                using A = typename decltype(t)::front;
+                A x;
+                quantised_get<common::quantise_encoding<A, Q>>(s, x);
+                m.insert(k, std::move(x));
+            }, typename M::value_types{});
+        }
+        return s;
+    }
+
+    //! @brief Serialises an export.
+    template <typename Q, typename S, typename M, bool b>
+    S& quantised_message_serialize(S& s, flat_ptr<M, b> const& x) {
+        return quantised_serialize<Q>(s, *x);
+    }
+
+    //! @brief Deserialises an export.
+    template <typename Q, typename M, bool b>
+    common::isstream& quantised_message_serialize(common::isstream& s, flat_ptr<M, b>& x) {
+        M m;
+        quantised_serialize<Q>(s, m);
+        x = std::move(m);
+        return s;
+    }
+
+    //! @brief Serialises a delta of exports.
+    template <typename Q, typename S, typename M>
+    S& quantised_message_serialize(S& s, export_delta<M> const& x) {
+        return x.serialize(s, [](S& t, M const& m){
+            quantised_serialize<Q>(t, m);
+        });
+    }
+
+    //! @brief Deserialises a delta of exports.
+    template <typename Q, typename M>
+    common::isstream& quantised_message_serialize(common::isstream& s, export_delta<M>& x) {
+        return x.serialize(s, [](common::isstream& t, M& m){
+            quantised_serialize<Q>(t, m);
+        });
+    }
+}
+//! @endcond
+
+
+/**
+ * @brief Message carrying exports, whose values of some types are encoded in reduced precision on the wire.
+ *
+ * Behaves as the message `T` it wraps, and only changes its serialisation: values of the types declared in `Q`
+ * are encoded through the corresponding encoding, so that receivers get them back within the error bound of the
+ * encoding. Messages passed without serialisation (as between nodes of a simulation) are unaffected.
+ *
+ * @param T The type of messages (exports held in a \ref flat_ptr, or deltas of them).
+ * @param Q A type sequence of \ref common::quantise declarations.
+ */
+template <typename T, typename Q>
+class quantised_message : public T {
+  public:
+    //! @brief Constructors of the message wrapped.
+    using T::T;
+
+    //! @brief Default constructor.
+    quantised_message() = default;
+
+    //! @brief Copying constructor from a message.
+    quantised_message(T const& x) : T(x) {}
+
+    //! @brief Moving constructor from a message.
+    quantised_message(T&& x) : T(std::move(x)) {}
+
+    //! @brief Serialises the content from/to a given input/output stream.
+    template <typename S>
+    S& serialize(S& s) {
+        return serialize_impl(s, common::number_sequence<std::is_same<S, common::isstream>::value>{});
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream (const overload).
+    template <typename S>
+    S& serialize(S& s) const {
+        return details::quantised_message_serialize<Q>(s, static_cast<T const&>(*this));
+    }
+
+  private:
+    //! @brief Serialises the content to a given output stream.
+    template <typename S>
+    S& serialize_impl(S& s, common::number_sequence<false>) {
+        return static_cast<quantised_message const*>(this)->serialize(s);
+    }
+
+    //! @brief Serialises the content from a given input stream.
+    template <typename S>
+    S& serialize_impl(S& s, common::number_sequence<true>) {
+        return details::quantised_message_serialize<Q>(s, static_cast<T&>(*this));
+    }
+};
+
+
+//! @cond INTERNAL
+namespace details {
+    //! @brief Messages with encoded values.
+    template <typename T, typename Q>
+    struct quantised_t {
+        using type = quantised_message<T, Q>;
+    };
+
+    //! @brief Messages without encoded values.
+    template <typename T>
+    struct quantised_t<T, common::type_sequence<>> {
+        using type = T;
+    };
+}
+//! @endcond
+
+//! @brief Messages of type `T`, with the values of types declared in `Q` encoded on the wire (if any).
+template <typename T, typename Q>
+using quantised_t = typename details::quantised_t<T, Q>::type;
+
+
+}
+
+
+}
+
+#endif // FCPP_INTERNAL_QUANTISED_H_
@@ -12,12 +12,13 @@
 #define ___ __COUNTER__
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 
-#include <vector>
 #include <functional>
 
 #include "lib/settings.hpp"
+#include "lib/common/small_vector.hpp"
 
 
 /**
@@ -107,11 +108,11 @@ class trace {
 
   public:
     //! @brief Constructs an empty trace.
-    trace() : m_stack{}, m_stack_hash{0} {};
+    trace() : m_stack_hash{0} {};
 
     //! @brief `true` if the trace is empty, `false` otherwise.
     bool empty() const {
-        return m_stack.size() == 0;
+        return m_stack.empty();
     }
 
     //! @brief Returns the hash together with the template argument into a @ref trace_t.
@@ -131,27 +132,30 @@ class trace {
     inline void push(trace_t x) {
         assert(x <= k_hash_mod and "code points overflow: reduce code or increase FCPP_TRACE");
         assert((x < k_hash_factor or !FCPP_WARNING_TRACE) and "warning: code points may induce colliding hashes (ignore with #define FCPP_WARNING_TRACE false)");
-        m_stack_hash = (m_stack_hash * k_hash_factor + x) & k_hash_mod;
-        m_stack.push_back(x);
+        push_key(x);
     }
 
     //! @brief Adds a custom hashed key to the stack trace updating the hash.
     inline void push_key(trace_t x) {
-        x &= k_hash_mod;
+        m_stack.push_back(m_stack_hash);
         m_stack_hash = (m_stack_hash * k_hash_factor + x) & k_hash_mod;
-        m_stack.push_back(x);
     }
 
     //! @brief Remove the last function call from the stack trace updating the hash.
     inline void pop() {
-        trace_t x = m_stack.back();
+        m_stack_hash = m_stack.back();
         m_stack.pop_back();
-        m_stack_hash = ((m_stack_hash + k_hash_mod+1 - x) * k_hash_inverse) & k_hash_mod;
+    }
+
+    //! @brief Replaces the last function call in the stack trace updating the hash (as `pop` followed by `push`).
+    inline void replace(trace_t x) {
+        assert(x <= k_hash_mod and "code points overflow: reduce code or increase FCPP_TRACE");
+        m_stack_hash = (m_stack.back() * k_hash_factor + x) & k_hash_mod;
     }
 
   private:
-    //! @brief Stack trace.
-    std::vector<trace_t> m_stack;
+    //! @brief Hashes preceding each element of the stack trace (restored as elements are removed), inline up to @ref FCPP_TRACE_DEPTH.
+    common::small_vector<trace_t, FCPP_TRACE_DEPTH> m_stack;
     //! @brief Summarising hash (@ref k_hash_len bits used, starting from 0).
     trace_t m_stack_hash;
 };
@@ -258,26 +262,22 @@ struct trace_cycle {
     }
     //! @brief Increment operator (increases the cycle element in the trace).
     inline trace_cycle& operator++() {
-        m_trace.pop();
-        m_trace.push(++m_i);
+        m_trace.replace(++m_i);
         return *this;
     }
     //! @brief Decrement operator (decreases the cycle element in the trace).
     inline trace_cycle& operator--() {
-        m_trace.pop();
-        m_trace.push(--m_i);
+        m_trace.replace(--m_i);
         return *this;
     }
     //! @brief Increasing operator (increases the cycle element in the trace).
     inline trace_cycle& operator+=(trace_t x) {
-        m_trace.pop();
-        m_trace.push(m_i+=x);
+        m_trace.replace(m_i+=x);
         return *this;
     }
     //! @brief Decreasing operator (decreases the cycle element in the trace).
     inline trace_cycle& operator-=(trace_t x) {
-        m_trace.pop();
-        m_trace.push(m_i-=x);
+        m_trace.replace(m_i-=x);
         return *this;
     }
     //! @brief Returns the current cycle element.
@@ -661,6 +661,34 @@ using rect_i = rect<constant_i<real_t, x_tag>...>;
 //! @}
 
 
+/**
+ * @brief Lower bound on the values generated by a distribution, whenever known at compile time (negative infinity otherwise).
+ * @tparam D The distribution.
+ */
+template <typename D>
+struct lower_bound {
+    //! @brief The lower bound.
+    constexpr static long double value = -std::numeric_limits<long double>::infinity();
+};
+//! @cond INTERNAL
+template <typename R, intmax_t num, intmax_t den>
+struct lower_bound<constant_n<R, num, den, void>> {
+    constexpr static long double value = den == 0 ? num * std::numeric_limits<long double>::infinity() : num / (long double)den;
+};
+
+template <typename D>
+struct lower_bound<constant<D>> : public lower_bound<D> {};
+
+template <typename min, typename max>
+struct lower_bound<interval<min, max, void, void>> : public lower_bound<min> {};
+
+template <typename D>
+struct lower_bound<positive<D>> {
+    constexpr static long double value = lower_bound<D>::value > 0 ? lower_bound<D>::value : 0;
+};
+//! @endcond
+
+
 }
 
 
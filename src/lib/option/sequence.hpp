@@ -165,6 +165,18 @@ class multiple<N, E, false> {
         return x;
     }
 
+    //! @brief Serialises the content from/to a given input/output stream.
+    template <typename S>
+    S& serialize(S& s) {
+        return s & pending;
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream (const overload).
+    template <typename S>
+    S& serialize(S& s) const {
+        return s << pending;
+    }
+
   private:
     //! @brief The time of the events.
     std::vector<times_t> pending;
@@ -408,6 +420,21 @@ class merge {
         return x;
     }
 
+    //! @brief Serialises the content from/to a given input/output stream (rebuilding the queue).
+    template <typename S>
+    S& serialize(S& s) {
+        s & m_generators;
+        m_queue = decltype(m_queue){};
+        fill_queue(std::make_index_sequence<size>{});
+        return s;
+    }
+
+    //! @brief Serialises the content from/to a given input/output stream (const overload).
+    template <typename S>
+    S& serialize(S& s) const {
+        return s << m_generators;
+    }
+
   private:
     //! @brief The type used to indicate an event in the queue.
     using event_t = std::pair<times_t, size_t>;
@@ -88,6 +88,10 @@
 
 
 #if   FCPP_ENVIRONMENT == FCPP_ENVIRONMENT_LOGICAL
+    #ifndef FCPP_TRACE_DEPTH
+    //! @brief Setting defining the nesting depth of the stack trace held inline in every node, deeper traces allocating memory (16 for simulated and logical systems, 64 for physical systems, while routines of the coordination library push at most two levels below their caller): every node holds 16 * FCPP_TRACE / 8 bytes for it, 128 bytes with 64-bit traces.
+    #define FCPP_TRACE_DEPTH 16
+    #endif
     #ifndef FCPP_EXPORT_NUM
     //! @brief Setting defining whether exports for self and other devices should be separated (2, default for physical systems) or together (1, default for simulated and logical systems).
     #define FCPP_EXPORT_NUM 1
@@ -109,6 +113,10 @@
     #define FCPP_SYNCHRONISED true
     #endif
 #elif FCPP_ENVIRONMENT == FCPP_ENVIRONMENT_PHYSICAL
+    #ifndef FCPP_TRACE_DEPTH
+    //! @brief Setting defining the nesting depth of the stack trace held inline in every node, deeper traces allocating memory (16 for simulated and logical systems, 64 for physical systems, while routines of the coordination library push at most two levels below their caller): a device holds 64 * FCPP_TRACE / 8 bytes for it, 128 bytes with 16-bit traces on embedded systems.
+    #define FCPP_TRACE_DEPTH 64
+    #endif
     #ifndef FCPP_EXPORT_NUM
     //! @brief Setting defining whether exports for self and other devices should be separated (2, default for physical systems) or together (1, default for simulated and logical systems).
     #define FCPP_EXPORT_NUM 2
@@ -130,6 +138,10 @@
     #define FCPP_SYNCHRONISED false
     #endif
 #elif FCPP_ENVIRONMENT == FCPP_ENVIRONMENT_SIMULATED
+    #ifndef FCPP_TRACE_DEPTH
+    //! @brief Setting defining the nesting depth of the stack trace held inline in every node, deeper traces allocating memory (16 for simulated and logical systems, 64 for physical systems, while routines of the coordination library push at most two levels below their caller): every node holds 16 * FCPP_TRACE / 8 bytes for it, 128 bytes with 64-bit traces.
+    #define FCPP_TRACE_DEPTH 16
+    #endif
     #ifndef FCPP_EXPORT_NUM
     //! @brief Setting defining whether exports for self and other devices should be separated (2, default for physical systems) or together (1, default for simulated and logical systems).
     #define FCPP_EXPORT_NUM 1
@@ -172,6 +184,78 @@
 #endif
 
 
+#ifndef FCPP_CALENDAR_QUEUE
+    //! @brief Setting defining whether node events should be scheduled through a calendar queue.
+    #define FCPP_CALENDAR_QUEUE false
+#endif
+
+
+#ifndef FCPP_CONSERVATIVE
+    //! @brief Setting defining whether all events which cannot be affected by messages should be executed together.
+    #define FCPP_CONSERVATIVE false
+#endif
+
+
+#ifndef FCPP_OPTIMISTIC
+    //! @brief Setting defining whether events should be executed speculatively, rolling back on causality conflicts.
+    #define FCPP_OPTIMISTIC false
+#endif
+
+
+#ifndef FCPP_DETERMINISTIC
+    //! @brief Setting defining whether messages should be buffered and received in canonical order after the events executing together.
+    #define FCPP_DETERMINISTIC false
+#endif
+
+
+#ifndef FCPP_ROUND_ARENA
+    //! @brief Setting defining whether fields and exports built during rounds should be allocated from a thread-local arena (exports and node storage being copied out of it at round end).
+    #define FCPP_ROUND_ARENA false
+#endif
+
+
+#ifndef FCPP_FIELD_INLINE
+    //! @brief Setting defining the number of neighbours for which fields hold their values inline, without allocating memory.
+    #define FCPP_FIELD_INLINE 4
+#endif
+
+
+#ifndef FCPP_EXPORT_FLAT
+    //! @brief Setting defining whether exports should be stored in flat contiguous buffers instead of per-type hash maps.
+    #define FCPP_EXPORT_FLAT false
+#endif
+
+
+#ifndef FCPP_EXPORT_LAYOUT
+    //! @brief Setting defining whether exports should be stored in slots of a layout reused across rounds, instead of being indexed anew in every round (the layout is learned at run time, since traces are run-time hashes of the call stack).
+    #define FCPP_EXPORT_LAYOUT false
+#endif
+
+
+#ifndef FCPP_EXPORT_INTERN
+    //! @brief Setting defining whether equal values in exports should share a single instance process-wide.
+    #define FCPP_EXPORT_INTERN false
+#endif
+
+
+#ifndef FCPP_EXPORT_DELTA
+    //! @brief Setting defining the number of rounds between full exports, sending only changes in between (zero to always send full exports).
+    #define FCPP_EXPORT_DELTA 0
+#endif
+
+
+#ifndef FCPP_SIMD
+    //! @brief Setting defining whether pointwise operations and reductions on fields of reals sharing a domain should use vectorised kernels (with the same results as scalar code, except for sums as by \ref FCPP_SIMD_SUM).
+    #define FCPP_SIMD true
+#endif
+
+
+#ifndef FCPP_SIMD_SUM
+    //! @brief Setting defining whether sums and products of fields of reals should be reduced in vector lanes (false by default, since the results depend on the vector width of the target, so that they may differ in the last bits across machines).
+    #define FCPP_SIMD_SUM false
+#endif
+
+
 #ifndef FCPP_MESSAGE_PUSH
     //! @brief Setting defining whether incoming messages are pushed or pulled.
     #define FCPP_MESSAGE_PUSH true
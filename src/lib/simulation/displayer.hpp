@@ -896,6 +896,10 @@ struct displayer {
 
         //! @brief The global part of the component.
         class net : public P::net {
+            //! @cond INTERNAL
+            static_assert(not P::net::speculative, "displayer state cannot be rolled back by optimistic identifier");
+            //! @endcond
+
         public: // visible by node objects and the main program
           //! @brief Constructor from a tagged tuple.
             template <typename S, typename T>
@@ -8,7 +8,9 @@
 #ifndef FCPP_SIMULATION_SIMULATED_CONNECTOR_H_
 #define FCPP_SIMULATION_SIMULATED_CONNECTOR_H_
 
+#include <algorithm>
 #include <cmath>
+#include <tuple>
 
 #include <type_traits>
 #include <unordered_map>
@@ -20,6 +22,7 @@
 #include "lib/component/base.hpp"
 #include "lib/data/field.hpp"
 #include "lib/data/vec.hpp"
+#include "lib/internal/nbr_sensor.hpp"
 #include "lib/option/connect.hpp"
 #include "lib/option/distribution.hpp"
 
@@ -66,10 +69,13 @@ namespace tags {
 
 //! @cond INTERNAL
 namespace details {
-    //! @brief A cell of space, containing nodes and linking to neighbour cells.
-    template <bool parallel, typename N>
+    //! @brief A cell of space, containing nodes and linking to neighbour cells (with accesses logged by event keys `K`).
+    template <bool parallel, typename N, typename K = std::tuple<times_t, size_t, device_t>>
     class cell {
       public:
+        //! @brief The type of accesses to the cell, as key of the event acting.
+        using access_type = K;
+
         //! @brief Default constructors.
         cell() = default;
         cell(cell const&) = delete;
@@ -89,6 +95,44 @@ namespace details {
             m_contents.erase(&n);
         }
 
+        //! @brief Inserts a node in the cell during event `k`, adding to `v` the conflicting accesses following it (for optimistic executions).
+        void insert(N& n, access_type const& k, times_t gvt, std::vector<access_type>& v) {
+            common::exclusive_guard<parallel> l(m_mutex);
+            m_contents.insert(&n);
+            write(k, gvt, v);
+        }
+
+        //! @brief Removes a node from the cell during event `k`, adding to `v` the conflicting accesses following it (for optimistic executions).
+        void erase(N& n, access_type const& k, times_t gvt, std::vector<access_type>& v) {
+            common::exclusive_guard<parallel> l(m_mutex);
+            m_contents.erase(&n);
+            write(k, gvt, v);
+        }
+
+        //! @brief Notifies a change of the cell during event `k`, adding to `v` the conflicting accesses following it (for optimistic executions).
+        void touch(access_type const& k, times_t gvt, std::vector<access_type>& v) {
+            common::exclusive_guard<parallel> l(m_mutex);
+            write(k, gvt, v);
+        }
+
+        //! @brief Discards the accesses of the node acting in `k` from `k` on, adding to `v` the reads following the changes discarded (for optimistic executions).
+        void revert(access_type const& k, times_t gvt, std::vector<access_type>& v) {
+            common::exclusive_guard<parallel> l(m_mutex);
+            prune(gvt);
+            auto rolled = [&k](access_type const& x){
+                return std::get<2>(x) == std::get<2>(k) and x >= k;
+            };
+            auto it = std::partition(m_writes.begin(), m_writes.end(), [&rolled](access_type const& x){
+                return not rolled(x);
+            });
+            if (it != m_writes.end()) {
+                access_type w = *std::min_element(it, m_writes.end());
+                m_writes.erase(it, m_writes.end());
+                for (access_type const& x : m_reads) if (x > w) v.push_back(x);
+            }
+            m_reads.erase(std::remove_if(m_reads.begin(), m_reads.end(), rolled), m_reads.end());
+        }
+
         //! @brief Links a new cell.
         void link(cell const& o) {
             common::exclusive_guard<parallel> l(m_mutex);
@@ -108,7 +152,36 @@ namespace details {
             return m_contents;
         }
 
+        //! @brief Gives const access to the content as read during event `k`, adding to `v` the conflicting accesses (for optimistic executions).
+        std::conditional_t<parallel, std::unordered_set<N*>, std::unordered_set<N*> const&>
+        content(access_type const& k, times_t gvt, std::vector<access_type>& v) const {
+            common::exclusive_guard<parallel> l(m_mutex);
+            prune(gvt);
+            for (access_type const& x : m_writes) if (x > k) {
+                v.push_back(x);
+                v.push_back(k);
+            }
+            m_reads.push_back(k);
+            return m_contents;
+        }
+
       private:
+        //! @brief Records a change during event `k`, adding to `v` the reads following it.
+        void write(access_type const& k, times_t gvt, std::vector<access_type>& v) {
+            prune(gvt);
+            for (access_type const& x : m_reads) if (x > k) v.push_back(x);
+            m_writes.push_back(k);
+        }
+
+        //! @brief Discards the accesses before the global virtual time.
+        void prune(times_t gvt) const {
+            auto old = [gvt](access_type const& x){
+                return std::get<0>(x) < gvt;
+            };
+            m_reads.erase(std::remove_if(m_reads.begin(), m_reads.end(), old), m_reads.end());
+            m_writes.erase(std::remove_if(m_writes.begin(), m_writes.end(), old), m_writes.end());
+        }
+
         //! @brief The content of the cell.
         std::unordered_set<N*> m_contents;
 
@@ -117,6 +190,9 @@ namespace details {
 
         //! @brief A mutex regulating access to this cell.
         mutable common::shared_mutex<parallel> m_mutex;
+
+        //! @brief Reads and changes of the cell which can still be rolled back.
+        mutable std::vector<access_type> m_reads, m_writes;
     };
 }
 //! @endcond
@@ -250,7 +326,7 @@ struct simulated_connector {
 
             //! @brief Size of last message sent (zero if `message_size` is false).
             size_t msg_size() const {
-                if (message_size) return fcpp::details::self(m_nbr_msg_size.front(), P::node::uid);
+                if (message_size) return fcpp::details::self(m_nbr_msg_size.front().get(), P::node::uid);
                 else return 0;
             }
 
@@ -293,13 +369,18 @@ struct simulated_connector {
                         P::node::as_final().send(t, m);
                         P::node::as_final().receive(t, P::node::uid, m);
                         common::unlock_guard<parallel> u(P::node::mutex);
+                        // reads are only tracked for executions which can be rolled back
+                        times_t gvt = F::net::speculative ? P::node::net.virtual_time() : TIME_MAX;
+                        std::vector<typename F::net::event_key> v;
                         for (auto c : P::node::net.cell_of(P::node::as_final()).linked())
-                            for (typename F::node* n : c->content()) {
+                            for (typename F::node* n : gvt < TIME_MAX ? c->content(P::node::net.speculation_key(), gvt, v) : c->content()) {
                                 common::lock_guard<parallel> l(n->mutex);
+                                if (n != this) n->speculative_read();
                                 if (n != this and P::node::net.connection_success(get_generator(has_randomizer<P>{}, *this), m_data, P::node::position(t), n->m_data, n->position(t))) {
-                                    n->receive(t, P::node::uid, m);
+                                    n->deliver(t, P::node::uid, m);
                                 }
                             }
+                        for (auto const& k : v) P::node::net.speculation_rollback(k);
                     }
                 } else P::node::update();
             }
@@ -326,21 +407,42 @@ struct simulated_connector {
                 receive_size(common::number_sequence<message_size>{}, d, m);
             }
 
+            //! @brief Serialises the state of the node from/to a given input/output stream.
+            template <typename S>
+            S& serialize(S& s) {
+                P::node::serialize(s) & m_delay & m_send & m_leave & m_data & m_nbr_msg_size;
+                return serialize_cell(s);
+            }
+
           private: // implementation details
+            //! @brief Serialises the cell of the node to a given output stream.
+            template <typename S>
+            S& serialize_cell(S& s) {
+                return s << P::node::net.cell_id(P::node::as_final());
+            }
+
+            //! @brief Serialises the cell of the node from a given input stream, moving the node back to it.
+            common::isstream& serialize_cell(common::isstream& s) {
+                typename F::net::cell_id_type c;
+                s >> c;
+                P::node::net.cell_restore(P::node::as_final(), c);
+                return s;
+            }
+
             //! @brief Sizes of messages received from neighbours (disabled).
             constexpr static size_t get_nbr_msg_size(common::number_sequence<false>) {
                 return 0;
             }
             //! @brief Sizes of messages received from neighbours (enabled).
             field<size_t> const& get_nbr_msg_size(common::number_sequence<true>) const {
-                return m_nbr_msg_size.front();
+                return m_nbr_msg_size.front().get();
             }
 
             //! @brief Changes the domain of m_nbr_msg_size to match the domain of the neightbours ids (disabled).
             void maybe_align_inplace_m_nbr_msg_size(common::number_sequence<false>) {}
             //! @brief Changes the domain of m_nbr_msg_size to match the domain of the neightbours ids (enabled).
             void maybe_align_inplace_m_nbr_msg_size(common::number_sequence<true>) {
-                align_inplace(m_nbr_msg_size.front(), std::vector<device_t>(fcpp::details::get_ids(P::node::nbr_uid())));
+                align_inplace(m_nbr_msg_size.front().get(), fcpp::details::field_vector<device_t>(fcpp::details::get_ids(P::node::nbr_uid())));
             }
 
             //! @brief Stores size of received message (disabled).
@@ -351,7 +453,7 @@ struct simulated_connector {
             void receive_size(common::number_sequence<true>, device_t d, common::tagged_tuple<S,T> const& m) {
                 common::osstream os;
                 os << m;
-                fcpp::details::self(m_nbr_msg_size.front(), d) = os.size();
+                m_nbr_msg_size.front().set(d, os.size());
             }
 
             //! @brief Checks when the node will leave the current cell.
@@ -390,14 +492,17 @@ struct simulated_connector {
             connection_data_type m_data;
 
             //! @brief Sizes of messages received from neighbours.
-            common::option<field<size_t>, message_size> m_nbr_msg_size;
+            common::option<internal::nbr_sensor<size_t>, message_size> m_nbr_msg_size;
         };
 
         //! @brief The global part of the component.
         class net : public P::net {
           public: // visible by node objects and the main program
             //! @brief The type of cells grouping nearby nodes.
-            using cell_type = details::cell<parallel, typename F::node>;
+            using cell_type = details::cell<parallel, typename F::node, typename P::net::event_key>;
+
+            //! @brief Type for representing a cell identifier.
+            using cell_id_type = simulated_connector<Ts...>::cell_id_type;
 
             //! @brief Type for representing a position.
             using position_type = simulated_connector<Ts...>::position_type;
@@ -414,22 +519,66 @@ struct simulated_connector {
                 maybe_clear(has_identifier<P>{}, *this);
             }
 
-            //! @brief Inserts a new node into its cell.
+            //! @brief Notifies that nodes are about to be constructed in bulk, deferring their insertion into cells.
+            void emplace_bulk_start() {
+                P::net::emplace_bulk_start();
+                m_deferred = true;
+            }
+
+            //! @brief Notifies that the nodes constructed in bulk are complete, inserting them into cells in batch.
+            void emplace_bulk_end() {
+                m_deferred = false;
+                cell_enter_bulk();
+                P::net::emplace_bulk_end();
+            }
+
+            //! @brief Inserts a new node into its cell (or defers it, during constructions in bulk).
             void cell_enter(typename F::node& n) {
-                cell_enter_impl<false>(n, n.position());
+                if (m_deferred) {
+                    common::lock_guard<parallel> l(m_deferred_mutex);
+                    m_entering.push_back(&n);
+                    return;
+                }
+                cell_enter_impl<false>(n, to_cell(n.position()), false);
             }
 
             //! @brief Removes a node from all cells.
             void cell_leave(typename F::node& n) {
-                if (m_nodes.size() == 0) return;
+                if (m_deferred) {
+                    common::lock_guard<parallel> l(m_deferred_mutex);
+                    auto it = std::find(m_entering.begin(), m_entering.end(), &n);
+                    if (it != m_entering.end()) {
+                        m_entering.erase(it);
+                        return;
+                    }
+                }
                 common::exclusive_guard<parallel> l(m_node_mutex);
+                if (m_nodes.size() == 0) return;
                 m_nodes.at(n.uid)->second.erase(n);
                 m_nodes.erase(n.uid);
+                if (P::net::speculative) m_changes.erase(n.uid);
             }
 
             //! @brief Moves a node across cells.
             void cell_move(typename F::node& n, times_t t) {
-                cell_enter_impl<true>(n, n.position(t));
+                cell_enter_impl<true>(n, to_cell(n.position(t)), P::net::speculative and P::net::virtual_time() < TIME_MAX);
+            }
+
+            //! @brief Moves a node back to a given cell, discarding its changes to cells from the event being rolled back on.
+            void cell_restore(typename F::node& n, cell_id_type const& c) {
+                typename P::net::event_key k = P::net::speculation_key();
+                times_t gvt = P::net::virtual_time();
+                std::vector<typename P::net::event_key> v;
+                {
+                    common::shared_guard<parallel> l(m_node_mutex);
+                    auto& w = m_changes.at(n.uid);
+                    for (auto const& x : w) if (x.first >= k) x.second->revert(k, gvt, v);
+                    w.erase(std::remove_if(w.begin(), w.end(), [&k,gvt](std::pair<typename P::net::event_key, cell_type*> const& x){
+                        return x.first >= k or std::get<0>(x.first) < gvt;
+                    }), w.end());
+                }
+                cell_enter_impl<true>(n, c, false);
+                for (auto const& x : v) P::net::speculation_rollback(x);
             }
 
             //! @brief Returns the cells in proximity of node `n`.
@@ -438,11 +587,22 @@ struct simulated_connector {
                 return m_nodes.at(n.uid)->second;
             }
 
+            //! @brief Returns the identifier of the cell of node `n`.
+            cell_id_type cell_id(typename F::node const& n) const {
+                common::shared_guard<parallel> l(m_node_mutex);
+                return m_nodes.at(n.uid)->first;
+            }
+
             //! @brief The maximum connection radius.
             inline real_t connection_radius() const {
                 return m_connector.maximum_radius();
             }
 
+            //! @brief A lower bound on the delay between a round and the sending of its message.
+            constexpr static times_t delay_lookahead() {
+                return distribution::lower_bound<delay_type>::value > 0 ? times_t(distribution::lower_bound<delay_type>::value) : 0;
+            }
+
             //! @brief Checks whether connection is possible.
             template <typename G>
             inline bool connection_success(G&& gen, connection_data_type const& data1, position_type const& position1, connection_data_type const& data2, position_type const& position2) const {
@@ -469,11 +629,80 @@ struct simulated_connector {
                 return c;
             }
 
-            //! @brief Interts a node in the cell correspoding to a given position.
+            /**
+             * @brief Creates a cell if missing, linking it to the neighbour cells (with `m_cell_mutex` held exclusively).
+             *
+             * If `log`, the changes to neighbour cells are logged for optimistic executions.
+             */
+            typename cell_map_type::iterator cell_create(cell_id_type const& c, bool log, typename P::net::event_key const& k, times_t gvt, std::vector<typename P::net::event_key>& v, std::vector<cell_type*>& touched) {
+                auto r = m_cells.emplace(std::piecewise_construct, std::make_tuple(c), std::make_tuple());
+                auto nit = r.first;
+                // the cell may have been created by another thread meanwhile
+                if (not r.second) return nit;
+                nit->second.link(nit->second);
+                cell_id_type d;
+                for (size_t i=0; i<dimension; ++i) d[i] = c[i]-1;
+                while (true) {
+                    if (c != d) {
+                        auto lit = m_cells.find(d);
+                        if (lit != m_cells.end()) {
+                            nit->second.link(lit->second);
+                            lit->second.link(nit->second);
+                            if (log) {
+                                lit->second.touch(k, gvt, v);
+                                touched.push_back(&lit->second);
+                            }
+                        }
+                    }
+                    size_t i;
+                    for (i = 0; i < dimension and d[i] == c[i]+1; ++i) d[i] = c[i]-1;
+                    if (i == dimension) break;
+                    ++d[i];
+                }
+                return nit;
+            }
+
+            //! @brief Inserts the nodes whose insertion was deferred into their cells, creating the cells needed at once.
+            void cell_enter_bulk() {
+                std::vector<std::pair<cell_id_type, typename F::node*>> entering;
+                entering.reserve(m_entering.size());
+                for (typename F::node* n : m_entering) entering.emplace_back(to_cell(n->position()), n);
+                m_entering.clear();
+                std::sort(entering.begin(), entering.end(), [](auto const& x, auto const& y){
+                    return x.first < y.first;
+                });
+                std::vector<typename cell_map_type::iterator> its(entering.size());
+                {
+                    typename P::net::event_key k;
+                    std::vector<typename P::net::event_key> v;
+                    std::vector<cell_type*> touched;
+                    common::exclusive_guard<parallel> l(m_cell_mutex);
+                    for (size_t i = 0; i < entering.size(); ++i)
+                        its[i] = i > 0 and entering[i].first == entering[i-1].first ? its[i-1] : cell_create(entering[i].first, false, k, 0, v, touched);
+                }
+                common::exclusive_guard<parallel> l(m_node_mutex);
+                m_nodes.reserve(m_nodes.size() + entering.size());
+                if (P::net::speculative) m_changes.reserve(m_changes.size() + entering.size());
+                for (size_t i = 0; i < entering.size(); ++i) {
+                    m_nodes[entering[i].second->uid] = its[i];
+                    if (P::net::speculative) m_changes[entering[i].second->uid];
+                    its[i]->second.insert(*entering[i].second);
+                }
+            }
+
+            //! @brief Inserts a node in a given cell (logging the changes to cells for moves of optimistic executions).
             template <bool move>
-            inline void cell_enter_impl(typename F::node& n, position_type const& p) {
-                cell_id_type c = to_cell(p);
+            inline void cell_enter_impl(typename F::node& n, cell_id_type const& c, bool log) {
                 typename cell_map_type::iterator nit;
+                log = P::net::speculative and move and log;
+                typename P::net::event_key k;
+                times_t gvt = TIME_MAX;
+                if (log) {
+                    k = P::net::speculation_key();
+                    gvt = P::net::virtual_time();
+                }
+                std::vector<typename P::net::event_key> v;
+                std::vector<cell_type*> touched;
                 bool create;
                 {
                     common::shared_guard<parallel> l(m_cell_mutex);
@@ -482,23 +711,7 @@ struct simulated_connector {
                 }
                 if (create) {
                     common::exclusive_guard<parallel> l(m_cell_mutex);
-                    nit = m_cells.emplace(std::piecewise_construct, std::make_tuple(c), std::make_tuple()).first;
-                    nit->second.link(nit->second);
-                    cell_id_type d;
-                    for (size_t i=0; i<dimension; ++i) d[i] = c[i]-1;
-                    while (true) {
-                        if (c != d) {
-                            auto lit = m_cells.find(d);
-                            if (lit != m_cells.end()) {
-                                nit->second.link(lit->second);
-                                lit->second.link(nit->second);
-                            }
-                        }
-                        size_t i;
-                        for (i = 0; i < dimension and d[i] == c[i]+1; ++i) d[i] = c[i]-1;
-                        if (i == dimension) break;
-                        ++d[i];
-                    }
+                    nit = cell_create(c, log, k, gvt, v, touched);
                 }
                 typename cell_map_type::iterator *it;
                 if (move) {
@@ -507,10 +720,25 @@ struct simulated_connector {
                         it = &m_nodes.at(n.uid);
                     }
                     if (c == (*it)->first) return;
-                    else (*it)->second.erase(n);
+                    if (log) {
+                        (*it)->second.erase(n, k, gvt, v);
+                        nit->second.insert(n, k, gvt, v);
+                        touched.push_back(&(*it)->second);
+                        touched.push_back(&nit->second);
+                        *it = nit;
+                        {
+                            common::shared_guard<parallel> l(m_node_mutex);
+                            auto& w = m_changes.at(n.uid);
+                            for (cell_type* x : touched) w.emplace_back(k, x);
+                        }
+                        for (auto const& x : v) P::net::speculation_rollback(x);
+                        return;
+                    }
+                    (*it)->second.erase(n);
                 } else {
                     common::exclusive_guard<parallel> l(m_node_mutex);
                     it = &m_nodes[n.uid];
+                    if (P::net::speculative) m_changes[n.uid];
                 }
                 *it = nit;
                 (*it)->second.insert(n);
@@ -544,11 +772,23 @@ struct simulated_connector {
             //! @brief The map associating devices identifiers to their cell.
             std::unordered_map<device_t, typename cell_map_type::iterator> m_nodes;
 
+            //! @brief The changes to cells by each device which can still be rolled back (only for optimistic executions).
+            std::unordered_map<device_t, std::vector<std::pair<typename P::net::event_key, cell_type*>>> m_changes;
+
             //! @brief The connector predicate.
             connector_type m_connector;
 
             //! @brief The mutexes regulating access to maps.
             mutable common::shared_mutex<parallel> m_node_mutex, m_cell_mutex;
+
+            //! @brief Whether the insertion of nodes into cells is deferred (during constructions in bulk).
+            bool m_deferred = false;
+
+            //! @brief The nodes whose insertion into cells is deferred.
+            std::vector<typename F::node*> m_entering;
+
+            //! @brief The mutex regulating access to deferred nodes.
+            common::mutex<parallel> m_deferred_mutex;
         };
     };
 };
@@ -15,6 +15,7 @@
 #include "lib/component/base.hpp"
 #include "lib/data/field.hpp"
 #include "lib/data/vec.hpp"
+#include "lib/internal/nbr_sensor.hpp"
 
 
 /**
@@ -121,8 +122,8 @@ struct simulated_positioner {
             node(typename F::net& n, common::tagged_tuple<S,T> const& t) : P::node(n,t), m_x(common::get_or<tags::x>(t, position_type{})), m_v(common::get_or<tags::v>(t, position_type{})), m_a(common::get_or<tags::a>(t, position_type{})), m_f(common::get_or<tags::f>(t, 0)), m_nbr_vec{details::nan_vec<dimension>()}, m_nbr_dist{INF} {
                 static_assert(common::tagged_tuple<S,T>::tags::template count<tags::x> >= 1, MISSING_TAG_MESSAGE);
                 m_last = TIME_MIN;
-                fcpp::details::self(m_nbr_vec, P::node::uid) = vec<dimension>();
-                fcpp::details::self(m_nbr_dist, P::node::uid) = 0;
+                m_nbr_vec.set(P::node::uid, vec<dimension>());
+                m_nbr_dist.set(P::node::uid, 0);
             }
 
             #undef MISSING_TAG_MESSAGE
@@ -277,6 +278,8 @@ struct simulated_positioner {
                     }
                 }
                 m_last = t;
+                m_nbr_vec.flush();
+                m_nbr_dist.flush();
             }
 
             //! @brief Receives an incoming message (possibly reading values from sensors).
@@ -285,8 +288,8 @@ struct simulated_positioner {
                 P::node::receive(t, d, m);
                 position_type v = common::get<positioner_tag>(m) - position(t);
                 if (d != P::node::uid) {
-                    fcpp::details::self(m_nbr_vec, d) = v;
-                    fcpp::details::self(m_nbr_dist, d) = norm(v);
+                    m_nbr_vec.set(d, v);
+                    m_nbr_dist.set(d, norm(v));
                 }
             }
 
@@ -300,12 +303,12 @@ struct simulated_positioner {
 
             //! @brief Perceived positions of neighbours as difference vectors.
             fcpp::field<position_type> const& nbr_vec() const {
-                return m_nbr_vec;
+                return m_nbr_vec.get();
             }
 
             //! @brief Perceived distances from neighbours.
             fcpp::field<real_t> const& nbr_dist() const {
-                return m_nbr_dist;
+                return m_nbr_dist.get();
             }
 
             //! @brief Lags since most recent distance measurements.
@@ -313,6 +316,12 @@ struct simulated_positioner {
                 return P::node::nbr_lag();
             }
 
+            //! @brief Serialises the state of the node from/to a given input/output stream.
+            template <typename S>
+            S& serialize(S& s) {
+                return P::node::serialize(s) & m_x & m_v & m_a & m_f & m_nbr_vec & m_nbr_dist & m_last;
+            }
+
           private: // implementation details
             //! @brief Position at a given time on a given coordinate (viscous general case; relative to round start).
             real_t position(size_t i, real_t dt) const {
@@ -349,10 +358,10 @@ struct simulated_positioner {
             real_t m_f;
 
             //! @brief Perceived positions of neighbours as difference vectors.
-            fcpp::field<position_type> m_nbr_vec;
+            internal::nbr_sensor<position_type> m_nbr_vec;
 
             //! @brief Perceived distances from neighbours.
-            fcpp::field<real_t> m_nbr_dist;
+            internal::nbr_sensor<real_t> m_nbr_dist;
 
             //! @brief Time of the last round happened.
             times_t m_last;
@@ -11,6 +11,7 @@
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "lib/component/base.hpp"
 #include "lib/option/sequence.hpp"
@@ -162,10 +163,16 @@ struct spawner {
                 using res_type = std::decay_t<decltype(std::declval<dist_type>()(crand{}, common::tagged_tuple_t<>{}))>;
                 using full_type = common::tagged_tuple_cat<common::tagged_tuple_t<tags::start, times_t>, res_type>;
                 using tag_type = typename dist_type::tags;
-                full_type tt;
-                common::get<tags::start>(tt) = t;
-                call_distribution(std::get<i>(m_distributions), get_generator(has_randomizer<P>{}, *this), tt, tag_type{});
-                P::net::node_emplace(tt);
+                // nodes spawned together by the same distribution are created in bulk
+                std::vector<full_type> v;
+                while (true) {
+                    v.emplace_back();
+                    common::get<tags::start>(v.back()) = t;
+                    call_distribution(std::get<i>(m_distributions), get_generator(has_randomizer<P>{}, *this), v.back(), tag_type{});
+                    if (m_schedule.next() != t or m_schedule.next_sequence() != i) break;
+                    m_schedule.step(get_generator(has_randomizer<P>{}, *this), common::tagged_tuple_t<>{});
+                }
+                P::net::node_emplace_bulk(v);
             }
 
             //! @brief Calls a distribution, updating the tuple of results (empty case).
@@ -1,7 +1,10 @@
 // Copyright © 2021 Giorgio Audrito. All Rights Reserved.
 
+#include <atomic>
+#include <chrono>
 #include <queue>
 #include <random>
+#include <thread>
 
 #include "gtest/gtest.h"
 
@@ -90,6 +93,112 @@ TEST(AlgorithmTest, ParallelFor) {
         EXPECT_EQ(int(i+1), v[i]);
 }
 
+TEST(AlgorithmTest, ThreadPool) {
+    for (size_t n : {2, 3, 8}) for (size_t len : {0, 1, 2, 7, 100, 10000}) {
+        std::vector<int> v(len, 0);
+        std::vector<int> w(len, 0);
+        common::parallel_for(common::tags::parallel_execution(n), len, [&v,n](size_t i, size_t t) {
+            EXPECT_LT(t, n);
+            ++v[i];
+        });
+        common::parallel_for(common::tags::dynamic_execution(n,3), len, [&w,n](size_t i, size_t t) {
+            EXPECT_LT(t, n);
+            ++w[i];
+        });
+        for (size_t i=0; i<len; ++i) {
+            EXPECT_EQ(1, v[i]);
+            EXPECT_EQ(1, w[i]);
+        }
+    }
+#ifndef FCPP_DISABLE_THREADS
+    size_t workers = common::thread_pool::instance().size();
+    EXPECT_LE(7ULL, workers);
+    for (int k=0; k<100; ++k)
+        common::parallel_for(common::tags::parallel_execution(4), 10, [](size_t, size_t) {});
+    EXPECT_EQ(workers, common::thread_pool::instance().size());
+    EXPECT_FALSE(common::thread_pool::inside());
+#endif
+    std::vector<int> v(100, 0);
+    common::parallel_for(common::tags::parallel_execution(4), 10, [&v](size_t i, size_t) {
+        common::parallel_for(common::tags::parallel_execution(4), 10, [&v,i](size_t j, size_t) {
+            ++v[10*i+j];
+        });
+    });
+    for (size_t i=0; i<100; ++i)
+        EXPECT_EQ(1, v[i]);
+}
+
+TEST(AlgorithmTest, NumaFor) {
+    for (size_t n : {1, 2, 3, 8}) for (size_t len : {0, 1, 2, 7, 100, 10000}) {
+        std::vector<int> v(len, 0);
+        std::vector<size_t> b = {0, len/4, len/2};
+        common::parallel_for(common::tags::numa_execution(n, b), len, [&](size_t i, size_t t) {
+            EXPECT_LT(t, n);
+            ++v[i];
+        });
+        for (size_t i=0; i<len; ++i)
+            EXPECT_EQ(1, v[i]);
+    }
+#ifndef FCPP_DISABLE_THREADS
+    // slow tasks, so that every thread starts on its own range before ranges are stolen
+    for (size_t n : {3, 6}) {
+        size_t len = 120;
+        std::vector<size_t> b = {0, len/3, 2*len/3};
+        std::vector<std::atomic<size_t>> owned(3);
+        for (auto& x : owned) x = 0;
+        common::parallel_for(common::tags::numa_execution(n, b), len, [&](size_t i, size_t t) {
+            size_t g = i < b[1] ? 0 : i < b[2] ? 1 : 2;
+            if (g == t * 3 / n) ++owned[g];
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+        for (size_t g=0; g<3; ++g)
+            EXPECT_LT(len / 6, owned[g].load());
+    }
+    EXPECT_EQ(0ULL, common::details::numa_cpus(size_t(-1)).size());
+#if defined(__linux__)
+    // the caller is never pinned, and workers are pinned to their node only during the loop
+    auto affinity = [] () {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+        return set;
+    };
+    cpu_set_t caller = affinity();
+    std::vector<cpu_set_t> during(6), after(6);
+    std::vector<size_t> pinned(6), pinned_during(6);
+    common::parallel_for(common::tags::numa_execution(6, {0, 40, 80}), 120, [&](size_t, size_t t) {
+        during[t] = affinity();
+        pinned_during[t] = common::details::numa_pinned();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    common::thread_pool::instance().run(6, [&](size_t t) {
+        after[t] = affinity();
+        pinned[t] = common::details::numa_pinned();
+    });
+    EXPECT_TRUE(CPU_EQUAL(&caller, &during[0]));
+    EXPECT_TRUE(CPU_EQUAL(&caller, &after[0]));
+    for (size_t t=1; t<6; ++t) {
+        EXPECT_EQ(t / 2, pinned_during[t]);
+        EXPECT_EQ(size_t(-1), pinned[t]);
+        EXPECT_TRUE(CPU_EQUAL(&caller, &after[t]));
+    }
+#endif
+#endif
+}
+
+TEST(AlgorithmTest, ChunkedFor) {
+    for (size_t len : {0, 1, 2, 7, 100, 10000}) {
+        std::vector<int> v(len, 0);
+        std::vector<size_t> b = {0, 1, len/2, len};
+        common::parallel_for(common::tags::chunked_execution(4, b), len, [&](size_t i, size_t t) {
+            EXPECT_LT(t, 4ULL);
+            ++v[i];
+        });
+        for (size_t i=0; i<len; ++i)
+            EXPECT_EQ(1, v[i]);
+    }
+}
+
 TEST(AlgorithmTest, ParallelWhile) {
     std::mt19937 rnd(42);
     auto make_queue = [] (int N) {
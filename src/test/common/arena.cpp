@@ -0,0 +1,95 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/arena.hpp"
+
+using namespace fcpp;
+
+template <typename T>
+using arena_vector = std::vector<T, common::arena_allocator<T>>;
+
+
+TEST(ArenaTest, Closed) {
+    size_t c = common::arena::chunks();
+    EXPECT_FALSE(common::arena::active());
+    arena_vector<int> v(100, 42);
+    EXPECT_EQ(c, common::arena::chunks());
+    EXPECT_EQ(42, v[99]);
+}
+
+TEST(ArenaTest, Rewind) {
+    common::arena::open();
+    EXPECT_TRUE(common::arena::active());
+    int* p;
+    {
+        arena_vector<int> v(10, 1);
+        p = v.data();
+        arena_vector<double> w(10, 2.5);
+        EXPECT_EQ(2.5, w[9]);
+    }
+    common::arena::close();
+    EXPECT_FALSE(common::arena::active());
+    common::arena::open();
+    arena_vector<int> v(10, 1);
+    EXPECT_EQ(p, v.data());
+    arena_vector<char> big(common::arena::max_size, 'x');
+    EXPECT_EQ('x', big.back());
+    common::arena::close();
+}
+
+TEST(ArenaTest, Escape) {
+    arena_vector<int> escaped;
+    common::arena::open();
+    escaped = arena_vector<int>(10, 7);
+    common::arena::close();
+    for (int r = 0; r < 100; ++r) {
+        common::arena::open();
+        arena_vector<int> v(100, r);
+        EXPECT_EQ(r, v[50]);
+        common::arena::close();
+    }
+    for (int x : escaped) EXPECT_EQ(7, x);
+}
+
+TEST(ArenaTest, Retention) {
+    std::vector<arena_vector<int>> kept;
+    size_t c = common::arena::chunks();
+    for (int r = 0; r < 100; ++r) {
+        common::arena::open();
+        arena_vector<int> v(1000, r);
+        kept.emplace_back(4, r);
+        common::arena::close();
+    }
+    EXPECT_LT(c + 4, common::arena::chunks());
+    kept.clear();
+    c = common::arena::chunks();
+    for (int r = 0; r < 100; ++r) {
+        common::arena::open();
+        arena_vector<int> v(1000, r);
+        kept.push_back(common::arena::escape(arena_vector<int>(4, r)));
+        EXPECT_TRUE(common::arena::active());
+        common::arena::close();
+    }
+    EXPECT_LE(common::arena::chunks(), c + 1);
+    for (int r = 0; r < 100; ++r) EXPECT_EQ(r, kept[r][3]);
+}
+
+TEST(ArenaTest, Threads) {
+    size_t c = common::arena::chunks();
+    arena_vector<int> escaped;
+    std::thread t([&escaped](){
+        common::arena::open();
+        arena_vector<int> v(1000, 3);
+        escaped = arena_vector<int>(10, 5);
+        common::arena::close();
+    });
+    t.join();
+    EXPECT_EQ(c+1, common::arena::chunks());
+    EXPECT_EQ(5, escaped[9]);
+    escaped = arena_vector<int>();
+    EXPECT_EQ(c, common::arena::chunks());
+}
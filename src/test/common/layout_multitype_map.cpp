@@ -0,0 +1,173 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/layout_multitype_map.hpp"
+#include "lib/common/serialize.hpp"
+
+using namespace fcpp;
+
+
+class LayoutMultitypeMapTest : public ::testing::Test {
+  protected:
+    virtual void SetUp() {
+        data.insert(7, 'a');
+        data.insert<char>(7, 'b');
+        data.insert<char>(42, '+');
+        data.insert<int>(18, 31);
+        data.insert(18, 999);
+        data.insert(2);
+        data.insert(3);
+        data.insert(3);
+    }
+
+    common::layout_multitype_map<short, int, double, char> data;
+};
+
+
+TEST_F(LayoutMultitypeMapTest, Operators) {
+    common::layout_multitype_map<short, int, double, char> x(data), y, z, a, b;
+    z = y;
+    y = x;
+    z = std::move(y);
+    EXPECT_EQ(data, z);
+    EXPECT_EQ(a, b);
+    swap(z, a);
+    EXPECT_EQ(data, a);
+    EXPECT_EQ(z, b);
+    a.insert(7, 'c');
+    EXPECT_FALSE(data == a);
+}
+
+TEST_F(LayoutMultitypeMapTest, Points) {
+    EXPECT_TRUE(data.contains(2));
+    EXPECT_TRUE(data.contains(3));
+    data.remove(3);
+    EXPECT_FALSE(data.contains(3));
+    EXPECT_FALSE(data.contains(0));
+    EXPECT_FALSE(data.contains(999));
+}
+
+TEST_F(LayoutMultitypeMapTest, Values) {
+    EXPECT_TRUE(data.count<char>(42));
+    data.erase<char>(42);
+    EXPECT_FALSE(data.count<char>(42));
+    EXPECT_FALSE(data.count<double>(42));
+    EXPECT_FALSE(data.count<std::string>(42));
+    EXPECT_EQ(999, data.at<int>(18));
+    EXPECT_EQ('b', data.at<char>(7));
+    data.at<int>(18) = 5;
+    EXPECT_EQ(5, data.at<int>(18));
+    EXPECT_THROW(data.at<double>(18), std::out_of_range);
+}
+
+TEST_F(LayoutMultitypeMapTest, Insert) {
+    EXPECT_FALSE(data.count<char>(2));
+    EXPECT_FALSE(data.contains(17));
+    EXPECT_EQ(999, data.at<int>(18));
+    EXPECT_EQ('b', data.at<char>(7));
+    common::layout_multitype_map<short, int, double, char> newdata;
+    newdata.insert(7, 'x');
+    newdata.insert(2, '*');
+    newdata.insert(18, 0);
+    newdata.insert(3);
+    newdata.insert(17);
+    data.insert(newdata);
+    EXPECT_TRUE(data.count<char>(2));
+    EXPECT_TRUE(data.contains(17));
+    EXPECT_EQ(999, data.at<int>(18));
+    EXPECT_EQ('b', data.at<char>(7));
+    EXPECT_EQ('*', data.at<char>(2));
+}
+
+TEST(LayoutMultitypeMapGrowthTest, Relocation) {
+    common::layout_multitype_map<int, std::string, std::vector<int>, char> m;
+    for (int i=0; i<100; ++i) {
+        m.insert(i, std::string(i, 'x'));
+        m.insert(-i, std::vector<int>(i, i));
+        m.insert(i, char('a' + i % 26));
+    }
+    for (int i=0; i<100; ++i) {
+        EXPECT_EQ(std::string(i, 'x'), m.at<std::string>(i));
+        EXPECT_EQ(std::vector<int>(i, i), m.at<std::vector<int>>(-i));
+        EXPECT_EQ(char('a' + i % 26), m.at<char>(i));
+    }
+    m.insert(200, m.at<std::string>(99));
+    EXPECT_EQ(std::string(99, 'x'), m.at<std::string>(200));
+    m.erase<std::string>(50);
+    EXPECT_FALSE(m.count<std::string>(50));
+    common::layout_multitype_map<int, std::string, std::vector<int>, char> n(m);
+    EXPECT_EQ(m, n);
+    EXPECT_EQ(std::string(60, 'x'), n.at<std::string>(60));
+}
+
+TEST_F(LayoutMultitypeMapTest, Serialize) {
+    common::osstream os;
+    os << data;
+    common::isstream is(os.data());
+    common::layout_multitype_map<short, int, double, char> x;
+    is >> x;
+    EXPECT_EQ(data, x);
+    EXPECT_EQ(999, x.at<int>(18));
+    EXPECT_TRUE(x.contains(3));
+}
+
+TEST_F(LayoutMultitypeMapTest, ForEach) {
+    int keys = 0, sum = 0;
+    std::string chars;
+    data.for_each([&](short k, size_t type, void const* p){
+        switch (type) {
+            case 0:
+                sum += k + *static_cast<int const*>(p);
+                break;
+            case 2:
+                chars += *static_cast<char const*>(p);
+                break;
+            case 3:
+                EXPECT_EQ(nullptr, p);
+                keys += k;
+                break;
+            default:
+                ADD_FAILURE();
+        }
+    });
+    EXPECT_EQ(5, keys);
+    EXPECT_EQ(18+999, sum);
+    EXPECT_EQ(size_t(2), chars.size());
+    EXPECT_NE(std::string::npos, chars.find('b'));
+    EXPECT_NE(std::string::npos, chars.find('+'));
+}
+
+TEST_F(LayoutMultitypeMapTest, SameLayout) {
+    common::layout_multitype_map<short, int, double, char> x = data.same_layout();
+    EXPECT_FALSE(x.count<char>(7));
+    x.insert(7, 'c');
+    x.insert<char>(42, '-');
+    x.insert(18, 1);
+    x.insert(2);
+    x.insert(3);
+    EXPECT_EQ('c', x.at<char>(7));
+    EXPECT_EQ('b', data.at<char>(7));
+    EXPECT_EQ(1, x.at<int>(18));
+    EXPECT_TRUE(x.contains(3));
+    x.insert(7, 'b');
+    x.insert<char>(42, '+');
+    x.insert(18, 999);
+    EXPECT_EQ(data, x);
+    common::layout_multitype_map<short, int, double, char> y = data.same_layout();
+    y.insert(7, 'b');
+    y.insert(5, 2.5);
+    y.insert(18, 999);
+    EXPECT_EQ(2.5, y.at<double>(5));
+    EXPECT_FALSE(y.count<char>(42));
+    EXPECT_EQ(999, y.at<int>(18));
+    EXPECT_EQ('+', data.at<char>(42));
+    EXPECT_TRUE(data.contains(3));
+    common::layout_multitype_map<short, int, double, char> z(y);
+    EXPECT_EQ(y, z);
+    EXPECT_FALSE(data == y);
+}
@@ -1,5 +1,6 @@
 // Copyright © 2021 Giorgio Audrito. All Rights Reserved.
 
+#include <string>
 #include <utility>
 
 #include "gtest/gtest.h"
@@ -74,3 +75,29 @@ TEST_F(MultitypeMapTest, Insert) {
     EXPECT_EQ('b', data.at<char>(7));
     EXPECT_EQ('*', data.at<char>(2));
 }
+
+TEST_F(MultitypeMapTest, ForEach) {
+    int keys = 0, sum = 0;
+    std::string chars;
+    data.for_each([&](short k, size_t type, void const* p){
+        switch (type) {
+            case 0:
+                sum += k + *static_cast<int const*>(p);
+                break;
+            case 2:
+                chars += *static_cast<char const*>(p);
+                break;
+            case 3:
+                EXPECT_EQ(nullptr, p);
+                keys += k;
+                break;
+            default:
+                ADD_FAILURE();
+        }
+    });
+    EXPECT_EQ(5, keys);
+    EXPECT_EQ(18+999, sum);
+    EXPECT_EQ(size_t(2), chars.size());
+    EXPECT_NE(std::string::npos, chars.find('b'));
+    EXPECT_NE(std::string::npos, chars.find('+'));
+}
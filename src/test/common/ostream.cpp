@@ -5,6 +5,8 @@
 
 #include "gtest/gtest.h"
 
+#include "lib/common/flat_multitype_map.hpp"
+#include "lib/common/layout_multitype_map.hpp"
 #include "lib/common/multitype_map.hpp"
 #include "lib/common/ostream.hpp"
 #include "lib/common/random_access_map.hpp"
@@ -47,6 +49,14 @@ TEST(OstreamTest, FCPP) {
     m.insert(42, 'x');
     m.insert(10, false);
     PRINT_EQ("(bool => {10:false}; char => {42:'x'})", m);
+    common::flat_multitype_map<trace_t,bool,char> f;
+    f.insert(42, 'x');
+    f.insert(10, false);
+    PRINT_EQ("(bool => {10:false}; char => {42:'x'})", f);
+    common::layout_multitype_map<trace_t,bool,char> l;
+    l.insert(42, 'x');
+    l.insert(10, false);
+    PRINT_EQ("(bool => {10:false}; char => {42:'x'})", l);
     PRINT_EQ("{42:\"hello world\"}", common::random_access_map<int, std::string>{{42, "hello world"}});
     PRINT_EQ("(void => 3; int& => 'x')", common::make_tagged_tuple<void,int&>(3, 'x'));
     PRINT_EQ("(2)", internal::twin<int,true>{2});
@@ -0,0 +1,68 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <cmath>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/quantise.hpp"
+
+#include "test/helper.hpp"
+
+using namespace fcpp;
+
+
+template <typename E>
+double roundtrip(double x) {
+    return E::decode(E::encode(x));
+}
+
+
+TEST(QuantiseTest, Half) {
+    using E = common::fp16;
+    EXPECT_EQ(0.0, roundtrip<E>(0.0));
+    EXPECT_EQ(1.0, roundtrip<E>(1.0));
+    EXPECT_EQ(-2.5, roundtrip<E>(-2.5));
+    EXPECT_EQ(65504.0, roundtrip<E>(65504.0));
+    for (double x = -1000; x < 1000; x += 0.37)
+        EXPECT_LE(std::abs(roundtrip<E>(x) - x), std::abs(x) / 2048 + 1e-7);
+    EXPECT_NEAR(1e-6, roundtrip<E>(1e-6), 1e-7);
+    EXPECT_EQ(std::numeric_limits<double>::infinity(), roundtrip<E>(1e6));
+    EXPECT_EQ(-std::numeric_limits<double>::infinity(), roundtrip<E>(-std::numeric_limits<double>::infinity()));
+    EXPECT_TRUE(std::isnan(roundtrip<E>(std::nan(""))));
+}
+
+TEST(QuantiseTest, Brain) {
+    using E = common::bfloat16;
+    EXPECT_EQ(1.0, roundtrip<E>(1.0));
+    EXPECT_EQ(-0.5, roundtrip<E>(-0.5));
+    for (double x = -1e6; x < 1e6; x += 3571.3)
+        EXPECT_LE(std::abs(roundtrip<E>(x) - x), std::abs(x) / 256);
+    EXPECT_NEAR(1e30, roundtrip<E>(1e30), 1e30 / 256);
+    EXPECT_EQ(std::numeric_limits<double>::infinity(), roundtrip<E>(std::numeric_limits<double>::infinity()));
+    EXPECT_TRUE(std::isnan(roundtrip<E>(std::nan(""))));
+}
+
+TEST(QuantiseTest, Fixed) {
+    using E = common::fixed<1, 100>;
+    EXPECT_EQ(0.0, roundtrip<E>(0.0));
+    for (double x = -300; x < 300; x += 0.0137)
+        EXPECT_LE(std::abs(roundtrip<E>(x) - x), 0.005 + 1e-9);
+    EXPECT_DOUBLE_EQ(327.66, roundtrip<E>(1000.0));
+    EXPECT_DOUBLE_EQ(-327.67, roundtrip<E>(-1000.0));
+    EXPECT_EQ(std::numeric_limits<double>::infinity(), roundtrip<E>(std::numeric_limits<double>::infinity()));
+    EXPECT_EQ(-std::numeric_limits<double>::infinity(), roundtrip<E>(-std::numeric_limits<double>::infinity()));
+    EXPECT_EQ(0.0, roundtrip<E>(std::nan("")));
+    using F = common::fixed<5, 1, int8_t>;
+    EXPECT_EQ(15.0, roundtrip<F>(13.0));
+    EXPECT_EQ(630.0, roundtrip<F>(1e4));
+}
+
+TEST(QuantiseTest, Encoding) {
+    using Q = common::quantise_list<common::type_sequence<int, common::quantise<common::fp16, float, double>, char, common::quantise<common::bfloat16, long double>>>;
+    EXPECT_SAME(Q, common::type_sequence<common::quantise<common::fp16, float, double>, common::quantise<common::bfloat16, long double>>);
+    EXPECT_SAME(common::quantise_encoding<double, Q>, common::fp16);
+    EXPECT_SAME(common::quantise_encoding<long double, Q>, common::bfloat16);
+    EXPECT_SAME(common::quantise_encoding<int, Q>, void);
+    EXPECT_SAME(common::quantise_list<int, char>, common::type_sequence<>);
+}
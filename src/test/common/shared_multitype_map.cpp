@@ -0,0 +1,169 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/serialize.hpp"
+#include "lib/common/shared_multitype_map.hpp"
+
+using namespace fcpp;
+
+
+class SharedMultitypeMapTest : public ::testing::Test {
+  protected:
+    virtual void SetUp() {
+        data.insert(7, 'a');
+        data.insert<char>(7, 'b');
+        data.insert<char>(42, '+');
+        data.insert<int>(18, 31);
+        data.insert(18, 999);
+        data.insert(2);
+        data.insert(3);
+        data.insert(3);
+    }
+
+    common::shared_multitype_map<short, int, double, char> data;
+};
+
+
+TEST_F(SharedMultitypeMapTest, Operators) {
+    common::shared_multitype_map<short, int, double, char> x(data), y, z, a, b;
+    z = y;
+    y = x;
+    z = std::move(y);
+    EXPECT_EQ(data, z);
+    EXPECT_EQ(a, b);
+    swap(z, a);
+    EXPECT_EQ(data, a);
+    EXPECT_EQ(z, b);
+    a.insert(7, 'c');
+    EXPECT_FALSE(data == a);
+}
+
+TEST_F(SharedMultitypeMapTest, Points) {
+    EXPECT_TRUE(data.contains(2));
+    EXPECT_TRUE(data.contains(3));
+    data.remove(3);
+    EXPECT_FALSE(data.contains(3));
+    EXPECT_FALSE(data.contains(0));
+    EXPECT_FALSE(data.contains(999));
+}
+
+TEST_F(SharedMultitypeMapTest, Values) {
+    EXPECT_TRUE(data.count<char>(42));
+    data.erase<char>(42);
+    EXPECT_FALSE(data.count<char>(42));
+    EXPECT_FALSE(data.count<double>(42));
+    EXPECT_EQ(999, data.at<int>(18));
+    EXPECT_EQ('b', data.at<char>(7));
+    data.at<int>(18) = 5;
+    EXPECT_EQ(5, data.at<int>(18));
+    EXPECT_THROW(data.at<double>(18), std::out_of_range);
+}
+
+TEST_F(SharedMultitypeMapTest, Insert) {
+    EXPECT_FALSE(data.count<char>(2));
+    EXPECT_FALSE(data.contains(17));
+    common::shared_multitype_map<short, int, double, char> newdata;
+    newdata.insert(7, 'x');
+    newdata.insert(2, '*');
+    newdata.insert(18, 0);
+    newdata.insert(3);
+    newdata.insert(17);
+    data.insert(newdata);
+    EXPECT_TRUE(data.count<char>(2));
+    EXPECT_TRUE(data.contains(17));
+    EXPECT_EQ(999, data.at<int>(18));
+    EXPECT_EQ('b', data.at<char>(7));
+    EXPECT_EQ('*', data.at<char>(2));
+}
+
+// replaces integers equal to a given one with it
+struct replacer {
+    void operator()(std::shared_ptr<int>& p) const {
+        if (*p == *canonical) p = canonical;
+    }
+
+    template <typename A>
+    void operator()(std::shared_ptr<A>&) const {}
+
+    std::shared_ptr<int> canonical;
+};
+
+TEST_F(SharedMultitypeMapTest, Share) {
+    common::shared_multitype_map<short, int, double, char> x(data), y;
+    y.insert(18, 999);
+    y.insert(7, 'z');
+    auto const& cdata = data;
+    auto const& cx = x;
+    auto const& cy = y;
+    EXPECT_FALSE(x.shared());
+    // copies share their values, which are copied on write
+    EXPECT_EQ(&cdata.at<int>(18), &cx.at<int>(18));
+    x.at<int>(18) = 5;
+    EXPECT_EQ(999, data.at<int>(18));
+    EXPECT_EQ(5, x.at<int>(18));
+    // equal values of different maps are replaced by the same instance
+    replacer replace{std::make_shared<int>(999)};
+    data.share(replace);
+    y.share(replace);
+    EXPECT_TRUE(data.shared());
+    EXPECT_TRUE(y.shared());
+    EXPECT_EQ(&cdata.at<int>(18), &cy.at<int>(18));
+    EXPECT_NE(&cdata.at<char>(7), &cy.at<char>(7));
+    y.insert(8, 'w');
+    EXPECT_FALSE(y.shared());
+    // values ever shared are copied on write, even if not held elsewhere
+    replacer keep{std::make_shared<int>(0)};
+    common::shared_multitype_map<short, int, double, char> z;
+    auto const& cz = z;
+    z.insert(3, 42);
+    z.share(keep);
+    int const* p = &cz.at<int>(3);
+    z.at<int>(3) = 1;
+    EXPECT_NE(p, &cz.at<int>(3));
+    p = &cz.at<int>(3);
+    z.at<int>(3) = 2;
+    EXPECT_EQ(p, &cz.at<int>(3));
+}
+
+TEST_F(SharedMultitypeMapTest, Serialize) {
+    common::osstream os;
+    os << data;
+    common::isstream is(os.data());
+    common::shared_multitype_map<short, int, double, char> x;
+    is >> x;
+    EXPECT_EQ(data, x);
+    EXPECT_EQ(999, x.at<int>(18));
+    EXPECT_TRUE(x.contains(3));
+}
+
+TEST_F(SharedMultitypeMapTest, ForEach) {
+    int keys = 0, sum = 0;
+    std::string chars;
+    data.for_each([&](short k, size_t type, void const* p){
+        switch (type) {
+            case 0:
+                sum += k + *static_cast<int const*>(p);
+                break;
+            case 2:
+                chars += *static_cast<char const*>(p);
+                break;
+            case 3:
+                EXPECT_EQ(nullptr, p);
+                keys += k;
+                break;
+            default:
+                ADD_FAILURE();
+        }
+    });
+    EXPECT_EQ(5, keys);
+    EXPECT_EQ(18+999, sum);
+    EXPECT_EQ(size_t(2), chars.size());
+    EXPECT_NE(std::string::npos, chars.find('b'));
+    EXPECT_NE(std::string::npos, chars.find('+'));
+}
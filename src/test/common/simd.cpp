@@ -0,0 +1,125 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#define FCPP_SIMD true
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/simd.hpp"
+
+using namespace fcpp;
+
+
+template <typename T>
+class SimdTest : public ::testing::Test {
+  protected:
+    virtual void SetUp() {
+        for (int i = 0; i < 37; ++i) {
+            x.push_back(T(i % 7) - 2);
+            y.push_back(T(i % 5) * T(0.5));
+        }
+        x[3] = std::numeric_limits<T>::infinity();
+        x[20] = std::numeric_limits<T>::quiet_NaN();
+    }
+
+    std::vector<T> x, y;
+};
+
+//! @brief Checks equality of reals, with NaN values equal to each other.
+template <typename T>
+bool same(T x, T y) {
+    return (std::isnan(x) and std::isnan(y)) or x == y;
+}
+
+using SimdTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(SimdTest, SimdTypes);
+
+
+TYPED_TEST(SimdTest, Transform) {
+    using T = TypeParam;
+    size_t n = this->x.size();
+    std::vector<T> r(n);
+    common::simd::transform(common::simd::add{}, r.data(), this->x.data(), this->y.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_PRED2(same<T>, this->x[i] + this->y[i], r[i]);
+    common::simd::transform(common::simd::div{}, r.data(), T(3), this->y.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(T(3) / this->y[i], r[i]);
+    common::simd::transform(common::simd::max{}, r.data(), this->x.data(), T(0), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_PRED2(same<T>, std::max(this->x[i], T(0)), r[i]);
+    r = this->x;
+    common::simd::transform(common::simd::mul{}, r.data(), r.data(), T(2), n - 1);
+    for (size_t i = 0; i < n - 1; ++i) EXPECT_PRED2(same<T>, this->x[i] * 2, r[i]);
+    EXPECT_EQ(this->x[n-1], r[n-1]);
+}
+
+TYPED_TEST(SimdTest, Compare) {
+    using T = TypeParam;
+    size_t n = this->x.size();
+    std::vector<bool> r(n);
+    common::simd::compare(common::simd::less{}, r, this->x.data(), this->y.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(this->x[i] < this->y[i], r[i]);
+    common::simd::compare(common::simd::not_equal_to{}, r, this->x.data(), T(0), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(this->x[i] != 0, r[i]);
+    common::simd::test(common::simd::finite{}, r, this->x.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(bool(std::isfinite(this->x[i])), r[i]);
+}
+
+TYPED_TEST(SimdTest, Select) {
+    using T = TypeParam;
+    size_t n = this->y.size();
+    std::vector<bool> b(n);
+    for (size_t i = 0; i < n; ++i) b[i] = i % 3 == 0;
+    std::vector<T> r(n);
+    common::simd::select(r.data(), b, this->y.data(), T(-1), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(b[i] ? this->y[i] : T(-1), r[i]);
+}
+
+TYPED_TEST(SimdTest, Reduce) {
+    using T = TypeParam;
+    size_t n = this->y.size();
+    T sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += this->y[i];
+    EXPECT_EQ(sum + 1, common::simd::reduce(common::simd::add{}, T(1), this->y.data(), n));
+    EXPECT_EQ(T(2), common::simd::reduce(common::simd::max{}, T(0), this->y.data(), n));
+    EXPECT_EQ(T(-3), common::simd::reduce(common::simd::min{}, T(-3), this->y.data(), n));
+    EXPECT_EQ(T(0), common::simd::reduce(common::simd::min{}, T(5), this->y.data(), n));
+    EXPECT_EQ(T(5), common::simd::reduce(common::simd::min{}, T(5), this->y.data(), 0));
+    EXPECT_EQ(T(2), common::simd::reduce(common::simd::min{}, T(5), this->x.data() + 4, 2));
+}
+
+TYPED_TEST(SimdTest, ReduceSpecial) {
+    using T = TypeParam;
+    auto fold = [](auto op, T init, std::vector<T> const& v, size_t n) {
+        for (size_t i = 0; i < n; ++i) init = op(v[i], init);
+        return init;
+    };
+    std::vector<T> v = this->x;
+    for (size_t k : {size_t(0), size_t(20), size_t(35)}) {
+        v = this->x;
+        v[20] = 0;
+        v[k] = std::numeric_limits<T>::quiet_NaN();
+        for (size_t n : {size_t(36), size_t(37)}) {
+            EXPECT_PRED2(same<T>, fold(common::simd::min{}, T(1), v, n), common::simd::reduce(common::simd::min{}, T(1), v.data(), n));
+            EXPECT_PRED2(same<T>, fold(common::simd::max{}, T(1), v, n), common::simd::reduce(common::simd::max{}, T(1), v.data(), n));
+            EXPECT_PRED2(same<T>, fold(common::simd::add{}, T(1), v, n), common::simd::reduce(common::simd::add{}, T(1), v.data(), n));
+        }
+    }
+    v[35] = -std::numeric_limits<T>::infinity();
+    EXPECT_EQ(fold(common::simd::min{}, T(1), v, 37), common::simd::reduce(common::simd::min{}, T(1), v.data(), 37));
+    EXPECT_EQ(fold(common::simd::max{}, T(1), v, 37), common::simd::reduce(common::simd::max{}, T(1), v.data(), 37));
+    EXPECT_PRED2(same<T>, fold(common::simd::add{}, T(1), v, 37), common::simd::reduce(common::simd::add{}, T(1), v.data(), 37));
+}
+
+TYPED_TEST(SimdTest, ReduceOrder) {
+    using T = TypeParam;
+    std::vector<T> v;
+    for (int i = 0; i < 37; ++i) v.push_back(T(1) / T(i + 3));
+    T sum = T(1);
+    for (T x : v) sum = x + sum;
+    EXPECT_FALSE(common::simd::lane_reduce<common::simd::add>);
+    EXPECT_TRUE(common::simd::lane_reduce<common::simd::min>);
+    // sums are folded in the sequential order by default
+    EXPECT_EQ(sum, common::simd::reduce(common::simd::add{}, T(1), v.data(), v.size()));
+}
@@ -0,0 +1,248 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/slot_map.hpp"
+
+using namespace fcpp;
+
+
+TEST(SlotMapTest, Constructors) {
+    std::unordered_map<int, double> m = {{1,3}, {2,4}};
+    common::slot_map<int, double> k;
+    common::slot_map<int, double> x = {{1,3}, {2,4}};
+    common::slot_map<int, double> y(x);
+    EXPECT_EQ(x, y);
+    common::slot_map<int, double> z(std::move(y));
+    EXPECT_EQ(x, z);
+    common::slot_map<int, double> w(m.begin(), m.end());
+    EXPECT_EQ(x, w);
+    y = w;
+    EXPECT_EQ(x, y);
+    y = {{2,2}, {5,7}};
+    EXPECT_NE(x, y);
+    m = {{2,2}, {5,7}};
+    common::slot_map<int, double> l(m.begin(), m.end());
+    EXPECT_EQ(l, y);
+    w = std::move(y);
+    EXPECT_EQ(l, w);
+}
+
+TEST(SlotMapTest, Access) {
+    common::slot_map<int, double> x = {{1,3}, {2,4}}, y;
+    EXPECT_TRUE(y.empty());
+    EXPECT_FALSE(x.empty());
+    EXPECT_EQ(2, (int)x.size());
+    EXPECT_EQ(0, (int)y.size());
+    EXPECT_EQ(3.0, x[1]);
+    EXPECT_EQ(4.0, x[2]);
+    EXPECT_EQ(0.0, x[7]);
+    EXPECT_EQ(3, (int)x.size());
+    EXPECT_EQ(3.0, x.at(1));
+    EXPECT_EQ(4.0, x.at(2));
+    EXPECT_EQ(0.0, x.at(7));
+    EXPECT_EQ(1, (int)x.count(7));
+    EXPECT_EQ(0, (int)x.count(42));
+    EXPECT_THROW(x.at(42), std::out_of_range);
+    x[-5] = 1;
+    x[1000000] = 2;
+    EXPECT_EQ(1.0, x.at(-5));
+    EXPECT_EQ(2.0, x.at(1000000));
+    EXPECT_EQ(0, (int)x.count(-4));
+    y = x;
+    x.clear();
+    EXPECT_EQ(0, (int)x.size());
+    EXPECT_EQ(0, (int)x.count(7));
+    x.swap(y);
+    EXPECT_EQ(5, (int)x.size());
+    EXPECT_EQ(4.0, x.at(2));
+    EXPECT_EQ(2.0, x.at(1000000));
+}
+
+TEST(SlotMapTest, Modify) {
+    common::slot_map<int, double> x = {{1,3}, {2,4}, {3,8}, {11,42}};
+    auto p = x.emplace(9,4.5);
+    EXPECT_TRUE(p.second);
+    EXPECT_EQ(9, p.first->first);
+    EXPECT_EQ(4.5, p.first->second);
+    p = x.emplace(2,5);
+    EXPECT_FALSE(p.second);
+    EXPECT_EQ(2, p.first->first);
+    EXPECT_EQ(4.0, p.first->second);
+    p = x.insert({23,4.5});
+    EXPECT_TRUE(p.second);
+    EXPECT_EQ(23, p.first->first);
+    EXPECT_EQ(4.5, p.first->second);
+    auto arg = std::make_pair(2,5.0);
+    p = x.insert(arg);
+    EXPECT_FALSE(p.second);
+    EXPECT_EQ(2, p.first->first);
+    EXPECT_EQ(4.0, p.first->second);
+    EXPECT_EQ(6, (int)x.size());
+    common::slot_map<int, double> y = {{2,2}, {5,7}};
+    x.insert(y.begin(), y.end());
+    EXPECT_EQ(7, (int)x.size());
+    EXPECT_EQ(0, (int)x.erase(92));
+    EXPECT_EQ(7, (int)x.size());
+    EXPECT_EQ(1, (int)x.erase(11));
+    EXPECT_EQ(6, (int)x.size());
+    auto it = x.erase(x.find(3));
+    EXPECT_TRUE(it == x.end() or it->first != 3);
+    EXPECT_EQ(5, (int)x.size());
+    EXPECT_EQ(0, (int)x.count(3));
+    EXPECT_EQ(4.5, x.at(23));
+}
+
+TEST(SlotMapTest, Iterators) {
+    common::slot_map<int, double> x = {{1,3}, {2,4}, {3,8}, {11,42}};
+    common::slot_map<int, double> y(x.begin(), x.end());
+    EXPECT_EQ(x, y);
+    auto it = x.find(2);
+    EXPECT_EQ(2, it->first);
+    EXPECT_EQ(4.0, it->second);
+    it = x.find(9);
+    EXPECT_EQ(x.end(), it);
+    EXPECT_EQ(x.size(), (size_t)(x.end()-x.begin()));
+    std::vector<int> v;
+    it = x.begin();
+    for (size_t i=0; i<x.size(); ++i) {
+        v.push_back(it[i].first);
+        v.push_back((int)it[i].second);
+    }
+    std::sort(v.begin(), v.end());
+    std::vector<int> w = {1,2,3,3,4,8,11,42};
+    EXPECT_EQ(w, v);
+}
+
+TEST(SlotMapTest, Handles) {
+    common::slot_map<int, double, 4> x;
+    for (int i=0; i<10; ++i) x[i] = i;
+    std::vector<double*> ptrs;
+    for (int i=0; i<10; ++i) ptrs.push_back(&x.at(i));
+    auto h = x.handle(3);
+    EXPECT_TRUE(x.valid(h));
+    EXPECT_EQ(3.0, x.at(h));
+    EXPECT_FALSE(x.valid(x.handle(42)));
+    EXPECT_EQ(&x.at(5), x.find_ptr(5));
+    EXPECT_EQ(nullptr, x.find_ptr(42));
+    x.erase(3);
+    EXPECT_FALSE(x.valid(h));
+    EXPECT_THROW(x.at(h), std::out_of_range);
+    for (int i=10; i<100; ++i) x[i] = i;
+    for (int i=0; i<10; ++i) if (i != 3) {
+        EXPECT_EQ(ptrs[i], &x.at(i));
+        EXPECT_EQ(double(i), *ptrs[i]);
+    }
+    x[3] = 7;
+    EXPECT_FALSE(x.valid(h));
+    // stale handles do not reach the element now occupying their slot
+    EXPECT_THROW(x.at(h), std::out_of_range);
+    EXPECT_TRUE(x.valid(x.handle(3)));
+    EXPECT_EQ(7.0, x.at(x.handle(3)));
+    EXPECT_EQ(100, (int)x.size());
+}
+
+TEST(SlotMapTest, Sort) {
+    common::slot_map<int, double> x = {{1,3}, {2,4}, {3,8}, {11,42}, {5,-1}};
+    double* p = &x.at(11);
+    x.sort_by([](std::pair<int const, double> const& y){
+        return y.second;
+    });
+    std::vector<int> v;
+    for (auto const& y : x) v.push_back(y.first);
+    std::vector<int> w = {5,1,2,3,11};
+    EXPECT_EQ(w, v);
+    EXPECT_EQ(p, &x.at(11));
+    EXPECT_EQ(3, x.find(3) - x.begin());
+    x.erase(1);
+    EXPECT_EQ(4, (int)x.size());
+    EXPECT_EQ(8.0, x.at(3));
+    EXPECT_EQ(42.0, x.at(11));
+}
+
+TEST(SlotMapTest, Bulk) {
+    common::slot_map<int, double, 4> x = {{1,3}, {2,4}};
+    std::vector<int> keys = {5, 2, 7, 5, 9, 11, 12};
+    size_t n = x.emplace_bulk(common::tags::parallel_execution(3), keys, [&keys](size_t i){
+        return std::make_tuple(keys[i] * 0.5);
+    });
+    EXPECT_EQ(5, (int)n);
+    EXPECT_EQ(7, (int)x.size());
+    EXPECT_EQ(4.0, x.at(2));
+    EXPECT_EQ(2.5, x.at(5));
+    EXPECT_EQ(6.0, x.at(12));
+    std::vector<int> v;
+    for (auto const& y : x) v.push_back(y.first);
+    std::vector<int> w = {1,2,5,7,9,11,12};
+    EXPECT_EQ(w, v);
+    auto h = x.handle(9);
+    n = x.erase_bulk(common::tags::parallel_execution(3), std::vector<int>{9, 1, 42, 9});
+    EXPECT_EQ(2, (int)n);
+    EXPECT_EQ(5, (int)x.size());
+    EXPECT_FALSE(x.valid(h));
+    EXPECT_EQ(0, (int)x.count(1));
+    EXPECT_EQ(5.5, x.at(11));
+    x.reserve(100);
+    double* p = &x.at(11);
+    for (int i=100; i<190; ++i) x[i] = i;
+    EXPECT_EQ(p, &x.at(11));
+    EXPECT_EQ(95, (int)x.size());
+}
+
+TEST(SlotMapTest, BulkDirect) {
+    common::slot_map<int, int> x;
+    std::vector<int> keys;
+    for (int i = 0; i < 3000; ++i) keys.push_back(i);
+    x.emplace_bulk(common::tags::parallel_execution(3), keys, [](size_t i){
+        return std::make_tuple(int(i));
+    });
+    EXPECT_EQ(3000, (int)x.size());
+    EXPECT_LE(3000, (int)x.direct_range());
+    EXPECT_EQ(2999, x.at(2999));
+}
+
+struct throwing {
+    throwing(int i) : value(std::make_shared<int>(i)) {
+        if (i < 0) throw std::invalid_argument("negative");
+    }
+    std::shared_ptr<int> value;
+};
+
+TEST(SlotMapTest, Throw) {
+    common::slot_map<int, throwing, 4> x, y;
+    x.emplace(std::piecewise_construct, std::forward_as_tuple(1), std::forward_as_tuple(1));
+    y.emplace(std::piecewise_construct, std::forward_as_tuple(1), std::forward_as_tuple(1));
+    for (int i = 0; i < 10; ++i)
+        EXPECT_THROW(x.emplace(std::piecewise_construct, std::forward_as_tuple(2), std::forward_as_tuple(-1)), std::invalid_argument);
+    EXPECT_EQ(1, (int)x.size());
+    EXPECT_EQ(0, (int)x.count(2));
+    x.emplace(std::piecewise_construct, std::forward_as_tuple(3), std::forward_as_tuple(3));
+    y.emplace(std::piecewise_construct, std::forward_as_tuple(3), std::forward_as_tuple(3));
+    EXPECT_EQ(y.handle(3).index, x.handle(3).index);
+    EXPECT_EQ(3, *x.at(3).value);
+}
+
+TEST(SlotMapTest, BulkThrow) {
+    common::slot_map<int, throwing, 4> x;
+    x.emplace(std::piecewise_construct, std::forward_as_tuple(1), std::forward_as_tuple(1));
+    std::vector<int> keys = {2, 3, 4, 5, 6, 7};
+    EXPECT_THROW(x.emplace_bulk(common::tags::sequential_execution(), keys, [](size_t i){
+        return std::make_tuple(i == 3 ? -1 : int(i));
+    }), std::invalid_argument);
+    EXPECT_EQ(1, (int)x.size());
+    EXPECT_EQ(0, (int)x.count(2));
+    EXPECT_EQ(0, (int)x.count(5));
+    size_t n = x.emplace_bulk(common::tags::parallel_execution(2), keys, [](size_t i){
+        return std::make_tuple(int(i));
+    });
+    EXPECT_EQ(6, (int)n);
+    EXPECT_EQ(7, (int)x.size());
+    EXPECT_EQ(3, *x.at(5).value);
+}
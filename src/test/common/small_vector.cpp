@@ -0,0 +1,123 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/small_vector.hpp"
+
+using namespace fcpp;
+
+using vec_t = common::small_vector<int, 4>;
+using svec_t = common::small_vector<std::string, 2>;
+
+
+TEST(SmallVectorTest, Constructors) {
+    vec_t v;
+    EXPECT_TRUE(v.empty());
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_EQ(4ULL, v.capacity());
+    vec_t w{1, 2, 3};
+    EXPECT_EQ(3ULL, w.size());
+    EXPECT_TRUE(w.is_inline());
+    vec_t x(6, 7);
+    EXPECT_EQ(6ULL, x.size());
+    EXPECT_FALSE(x.is_inline());
+    EXPECT_EQ(7, x.back());
+    std::vector<int> s{4, 5, 6, 7, 8};
+    vec_t y(s.begin(), s.end());
+    EXPECT_TRUE(std::equal(s.begin(), s.end(), y.begin()));
+    vec_t z(y);
+    EXPECT_EQ(y, z);
+    z = w;
+    EXPECT_EQ(w, z);
+    z = {9};
+    EXPECT_EQ(vec_t{9}, z);
+    EXPECT_EQ(vec_t(3), (vec_t{0, 0, 0}));
+}
+
+TEST(SmallVectorTest, Move) {
+    svec_t v{"a", "b"};
+    svec_t w(std::move(v));
+    EXPECT_TRUE(v.empty());
+    EXPECT_TRUE(w.is_inline());
+    EXPECT_EQ((svec_t{"a", "b"}), w);
+    w.push_back("c");
+    EXPECT_FALSE(w.is_inline());
+    std::string const* p = w.data();
+    v = std::move(w);
+    EXPECT_EQ(p, v.data());
+    EXPECT_TRUE(w.empty());
+    EXPECT_TRUE(w.is_inline());
+    w.push_back("d");
+    swap(v, w);
+    EXPECT_EQ(svec_t{"d"}, v);
+    EXPECT_EQ((svec_t{"a", "b", "c"}), w);
+    w.pop_back();
+    w.shrink_to_fit();
+    EXPECT_TRUE(w.is_inline());
+    EXPECT_EQ((svec_t{"a", "b"}), w);
+}
+
+TEST(SmallVectorTest, Modifiers) {
+    vec_t v{1, 3};
+    v.insert(v.begin() + 1, 2);
+    EXPECT_EQ((vec_t{1, 2, 3}), v);
+    v.insert(v.begin(), v[2]);
+    v.insert(v.begin() + 2, v[0]);
+    EXPECT_EQ((vec_t{3, 1, 3, 2, 3}), v);
+    v.erase(v.begin() + 1, v.begin() + 3);
+    EXPECT_EQ((vec_t{3, 2, 3}), v);
+    v.erase(v.begin());
+    EXPECT_EQ((vec_t{2, 3}), v);
+    std::vector<int> s{4, 5, 6};
+    v.insert(v.begin() + 1, s.begin(), s.end());
+    EXPECT_EQ((vec_t{2, 4, 5, 6, 3}), v);
+    v.insert(v.end(), 2, 0);
+    EXPECT_EQ((vec_t{2, 4, 5, 6, 3, 0, 0}), v);
+    v.resize(2);
+    EXPECT_EQ((vec_t{2, 4}), v);
+    v.resize(4, 1);
+    EXPECT_EQ((vec_t{2, 4, 1, 1}), v);
+    v.emplace_back(v[1]);
+    EXPECT_EQ((vec_t{2, 4, 1, 1, 4}), v);
+    v.clear();
+    EXPECT_TRUE(v.empty());
+    EXPECT_LT((vec_t{1, 2}), (vec_t{1, 3}));
+    EXPECT_LT((vec_t{1, 2}), (vec_t{1, 2, 0}));
+    EXPECT_THROW(v.at(0), std::out_of_range);
+}
+
+TEST(SmallVectorTest, Elements) {
+    common::small_vector<std::shared_ptr<int>, 2> v;
+    std::shared_ptr<int> p = std::make_shared<int>(1);
+    for (int i = 0; i < 5; ++i) v.push_back(p);
+    EXPECT_EQ(6, p.use_count());
+    v.erase(v.begin(), v.begin() + 3);
+    EXPECT_EQ(3, p.use_count());
+    v.shrink_to_fit();
+    EXPECT_EQ(3, p.use_count());
+    EXPECT_TRUE(v.is_inline());
+    v = {};
+    EXPECT_EQ(1, p.use_count());
+    common::small_vector<bool, 0> b(3, true);
+    b[1] = false;
+    EXPECT_FALSE(b.is_inline());
+    EXPECT_EQ((common::small_vector<bool, 0>{true, false, true}), b);
+}
+
+TEST(SmallVectorTest, Standard) {
+    std::vector<int> s{1, 2, 3, 4, 5};
+    vec_t v = s;
+    EXPECT_EQ(s, v);
+    EXPECT_EQ(v, s);
+    std::vector<int> w = v;
+    EXPECT_EQ(s, w);
+    v.pop_back();
+    EXPECT_NE(s, v);
+    EXPECT_NE(v, s);
+    w = v;
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4}), w);
+}
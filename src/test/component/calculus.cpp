@@ -3,6 +3,7 @@
 #define FCPP_WARNING_TRACE false
 
 #include <algorithm>
+#include <memory>
 #include <sstream>
 
 #include "gtest/gtest.h"
@@ -23,11 +24,50 @@ using combo = component::combine_spec<
         exports<common::export_list<int>>,
         export_pointer<(O & 1) == 1>,
         export_split<(O & 2) == 2>,
-        online_drop<(O & 4) == 4>
+        online_drop<(O & 4) == 4>,
+        export_flat<(O & 8) == 8>,
+        export_layout<(O & 16) == 16>
     >,
     component::base<>
 >;
 
+template <int O>
+using delta_combo = component::combine_spec<
+    component::calculus<
+        exports<common::export_list<int>>,
+        export_pointer<(O & 1) == 1>,
+        export_split<(O & 2) == 2>,
+        online_drop<(O & 4) == 4>,
+        export_flat<(O & 8) == 8>,
+        export_layout<(O & 16) == 16>,
+        export_delta<4>
+    >,
+    component::base<>
+>;
+
+template <int O>
+using intern_combo = component::combine_spec<
+    component::calculus<
+        exports<common::export_list<int>>,
+        export_pointer<(O & 1) == 1>,
+        export_split<(O & 2) == 2>,
+        online_drop<(O & 4) == 4>,
+        export_intern<true>
+    >,
+    component::base<>
+>;
+
+template <int O, typename... Ts>
+using quantise_combo = component::combine_spec<
+    component::calculus<
+        exports<common::export_list<int>, Ts...>,
+        export_pointer<(O & 1) == 1>,
+        export_delta<(O & 2) == 2 ? 4 : 0>
+    >,
+    component::base<>
+>;
+
+
 template <typename T>
 void sendto(T const& source, T& dest) {
     typename T::message_t m;
@@ -35,7 +75,7 @@ void sendto(T const& source, T& dest) {
 }
 
 
-MULTI_TEST(CalculusTest, SizeThreshold, O, 3) {
+MULTI_TEST(CalculusTest, SizeThreshold, O, 5) {
     typename combo<O>::net  network{common::make_tagged_tuple<>()};
     typename combo<O>::node d0{network, common::make_tagged_tuple<uid, hoodsize>(0, device_t(3))};
     typename combo<O>::node d1{network, common::make_tagged_tuple<uid>(1)};
@@ -91,3 +131,191 @@ MULTI_TEST(CalculusTest, SizeThreshold, O, 3) {
     EXPECT_EQ(2, (int)d0.size());
     d0.round_end(0);
 }
+
+template <typename T>
+size_t message_size(T const& source) {
+    typename T::message_t m;
+    common::osstream os;
+    os << source.send(0, m);
+    return os.size();
+}
+
+template <typename T>
+void sendwire(T const& source, T& dest) {
+    typename T::message_t m, r;
+    common::osstream os;
+    os << source.send(0, m);
+    common::isstream is(os);
+    is >> r;
+    dest.receive(0, source.uid, r);
+}
+
+template <typename T>
+void round(T& node, int x, int y) {
+    node.round_start(0);
+    node.template nbr_context<int>(1).insert(x);
+    node.template nbr_context<int>(2).insert(y);
+    node.round_end(0);
+}
+
+template <typename T>
+int nbr_sum(T& node, int def) {
+    node.round_start(0);
+    field<int> f = node.template nbr_context<int>(1).nbr(def);
+    node.round_end(0);
+    int s = 0;
+    for (device_t i : {0, 1, 2}) s += details::self(f, i);
+    return s;
+}
+
+MULTI_TEST(CalculusTest, ExportDelta, O, 5) {
+    typename delta_combo<O>::net  network{common::make_tagged_tuple<>()};
+    typename delta_combo<O>::node d0{network, common::make_tagged_tuple<uid>(0)};
+    typename delta_combo<O>::node d1{network, common::make_tagged_tuple<uid>(1)};
+    typename delta_combo<O>::node d2{network, common::make_tagged_tuple<uid>(2)};
+    // full export
+    round(d1, 10, 20);
+    round(d2, 30, 40);
+    size_t full = message_size(d1);
+    sendto(d1, d0);
+    sendto(d2, d0);
+    EXPECT_EQ(40, nbr_sum(d0, 0));
+    // partial export with a change
+    round(d1, 11, 20);
+    round(d2, 30, 40);
+    EXPECT_LT(message_size(d1), full);
+    EXPECT_LT(message_size(d2), message_size(d1));
+    sendto(d1, d0);
+    sendto(d2, d0);
+    EXPECT_EQ(41, nbr_sum(d0, 0));
+    // lost message from d1, later deltas are ignored (unless exports are shared through pointers)
+    round(d1, 12, 20);
+    message_size(d1);
+    sendto(d2, d0);
+    EXPECT_EQ(30, nbr_sum(d0, 0));
+    round(d1, 13, 20);
+    sendto(d1, d0);
+    sendto(d2, d0);
+    EXPECT_EQ((O & 1) == 1 ? 43 : 30, nbr_sum(d0, 0));
+    // full export recovers
+    round(d1, 14, 20);
+    EXPECT_EQ(full, message_size(d1));
+    sendto(d1, d0);
+    sendto(d2, d0);
+    EXPECT_EQ(44, nbr_sum(d0, 0));
+    // rounds without messages sent are not lost messages
+    round(d1, 15, 20);
+    round(d1, 16, 20);
+    EXPECT_LT(message_size(d1), full);
+    sendto(d1, d0);
+    sendto(d2, d0);
+    EXPECT_EQ(46, nbr_sum(d0, 0));
+}
+
+MULTI_TEST(CalculusTest, ExportDeltaIdle, O, 5) {
+    typename delta_combo<O>::net  network{common::make_tagged_tuple<>()};
+    typename delta_combo<O>::node d0{network, common::make_tagged_tuple<uid>(0)};
+    typename delta_combo<O>::node d1{network, common::make_tagged_tuple<uid>(1)};
+    // the receiver runs several rounds between two messages from the sender
+    for (int i = 0; i < 8; ++i) {
+        d1.round_start(3*i);
+        d1.template nbr_context<int>(1).insert(10+i);
+        d1.round_end(3*i);
+        typename delta_combo<O>::node::message_t m;
+        d0.receive(3*i, d1.uid, d1.send(3*i, m));
+        for (int j = 0; j < 3; ++j) {
+            d0.round_start(3*i+j+0.5);
+            field<int> f = d0.template nbr_context<int>(1).nbr(0);
+            d0.round_end(3*i+j+0.5);
+            EXPECT_EQ(j == 0 ? 10+i : 0, details::self(f, 1));
+        }
+    }
+}
+
+MULTI_TEST(CalculusTest, ExportDeltaRestore, O, 5) {
+    typename delta_combo<O>::net  network{common::make_tagged_tuple<>()};
+    typename delta_combo<O>::node d0{network, common::make_tagged_tuple<uid>(0)};
+    typename delta_combo<O>::node d1{network, common::make_tagged_tuple<uid>(1)};
+    round(d1, 10, 20);
+    sendto(d1, d0);
+    round(d1, 11, 20);
+    sendto(d1, d0);
+    EXPECT_EQ(11, nbr_sum(d0, 0));
+    // a speculative round is rolled back by restoring a snapshot
+    common::osstream os;
+    os << d1;
+    round(d1, 50, 60);
+    common::isstream is(os);
+    is >> d1;
+    round(d1, 12, 20);
+    sendto(d1, d0);
+    EXPECT_EQ(12, nbr_sum(d0, 0));
+    round(d1, 13, 20);
+    sendto(d1, d0);
+    EXPECT_EQ(13, nbr_sum(d0, 0));
+}
+
+MULTI_TEST(CalculusTest, ExportIntern, O, 3) {
+    typename intern_combo<O>::net  network{common::make_tagged_tuple<>()};
+    typename intern_combo<O>::node d0{network, common::make_tagged_tuple<uid>(0)};
+    typename intern_combo<O>::node d1{network, common::make_tagged_tuple<uid>(1)};
+    typename intern_combo<O>::node d2{network, common::make_tagged_tuple<uid>(2)};
+    typename intern_combo<O>::node d3{network, common::make_tagged_tuple<uid>(3)};
+    internal::intern_stats s0 = d0.intern_stats();
+    round(d1, 1010, 1020);
+    round(d2, 1010, 1030);
+    for (auto* d : {&d0, &d3}) {
+        sendwire(d1, *d);
+        sendwire(d2, *d);
+    }
+    // values are interned when sent, and again when deserialised by receivers
+    internal::intern_stats s1 = d0.intern_stats();
+    EXPECT_EQ(s0.lookups + 12, s1.lookups);
+    EXPECT_EQ(s0.hits + 9, s1.hits);
+    EXPECT_EQ(s0.entries + 3, s1.entries);
+    EXPECT_LT(s0.bytes_saved + intmax_t(s0.table_bytes), s1.bytes_saved + intmax_t(s1.table_bytes));
+    // the entry equal in both exports is shared by all of them, the others by the exports of their sender
+    std::shared_ptr<int> x = internal::intern_table<int>::intern(std::make_shared<int>(1010));
+    std::shared_ptr<int> y = internal::intern_table<int>::intern(std::make_shared<int>(1020));
+    std::shared_ptr<int> z = internal::intern_table<int>::intern(std::make_shared<int>(1030));
+    EXPECT_EQ(y.use_count(), z.use_count());
+    EXPECT_EQ(x.use_count() - 1, 2 * (y.use_count() - 1));
+    EXPECT_EQ(2020, nbr_sum(d0, 0));
+    EXPECT_EQ(2020, nbr_sum(d3, 0));
+    round(d2, 1030, 1040);
+    sendto(d1, d0);
+    sendto(d2, d0);
+    EXPECT_EQ(2040, nbr_sum(d0, 0));
+}
+
+MULTI_TEST(CalculusTest, ExportQuantise, O, 2) {
+    using plain_combo = quantise_combo<O, real_t>;
+    using fixed_combo = quantise_combo<O, quantise<common::fixed<1, 100>, real_t>>;
+    typename plain_combo::net  plain_network{common::make_tagged_tuple<>()};
+    typename fixed_combo::net  fixed_network{common::make_tagged_tuple<>()};
+    typename plain_combo::node p0{plain_network, common::make_tagged_tuple<uid>(0)};
+    typename plain_combo::node p1{plain_network, common::make_tagged_tuple<uid>(1)};
+    typename fixed_combo::node f0{fixed_network, common::make_tagged_tuple<uid>(0)};
+    typename fixed_combo::node f1{fixed_network, common::make_tagged_tuple<uid>(1)};
+    for (int r = 0; r < 3; ++r) {
+        p1.round_start(0);
+        f1.round_start(0);
+        for (trace_t t = 1; t <= 8; ++t) {
+            p1.template nbr_context<real_t>(t).insert(t / 3.0 + r);
+            f1.template nbr_context<real_t>(t).insert(t / 3.0 + r);
+        }
+        p1.round_end(0);
+        f1.round_end(0);
+        EXPECT_LT(message_size(f1), message_size(p1));
+        sendwire(p1, p0);
+        sendwire(f1, f0);
+        p0.round_start(0);
+        f0.round_start(0);
+        for (trace_t t = 1; t <= 8; ++t) {
+            EXPECT_DOUBLE_EQ(t / 3.0 + r, details::self(p0.template nbr_context<real_t>(t).nbr(0), 1));
+            EXPECT_NEAR(t / 3.0 + r, details::self(f0.template nbr_context<real_t>(t).nbr(0), 1), 0.005);
+        }
+        p0.round_end(0);
+        f0.round_end(0);
+    }
+}
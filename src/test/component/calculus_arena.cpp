@@ -0,0 +1,84 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#define FCPP_ROUND_ARENA true
+#define FCPP_WARNING_TRACE false
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/arena.hpp"
+#include "lib/component/base.hpp"
+#include "lib/component/calculus.hpp"
+#include "lib/internal/nbr_sensor.hpp"
+
+#include "test/helper.hpp"
+
+using namespace fcpp;
+using namespace component::tags;
+
+
+// Component sensing the identifiers of neighbours as messages arrive.
+struct sensor {
+    template <typename F, typename P>
+    struct component : public P {
+        struct node : public P::node {
+            using P::node::node;
+
+            template <typename S, typename T>
+            void receive(times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
+                P::node::receive(t, d, m);
+                m_sensed.set(d, int(d));
+            }
+
+            field<int> const& nbr_sensed() const {
+                return m_sensed.get();
+            }
+
+            internal::nbr_sensor<int> m_sensed{0};
+        };
+        using net = typename P::net;
+    };
+};
+
+template <int O>
+using combo = component::combine_spec<
+    sensor,
+    component::calculus<
+        exports<common::export_list<int>>,
+        export_pointer<(O & 1) == 1>,
+        export_split<(O & 2) == 2>
+    >,
+    component::base<>
+>;
+
+
+MULTI_TEST(CalculusArenaTest, Bounded, O, 2) {
+    typename combo<O>::net network{common::make_tagged_tuple<>()};
+    std::vector<std::unique_ptr<typename combo<O>::node>> nodes;
+    for (device_t i = 0; i < 12; ++i)
+        nodes.emplace_back(new typename combo<O>::node{network, common::make_tagged_tuple<uid>(i)});
+    size_t c = common::arena::chunks();
+    // nodes run rounds at different paces, so that values left in the arena would retain different chunks
+    for (int r = 0; r < 2000; ++r) for (size_t i = 0; i < nodes.size(); ++i) if (r % (i+1) == 0) {
+        auto& n = *nodes[i];
+        n.round_start(0);
+        field<int> f = n.template nbr_context<int>(1).nbr(int(i)) + n.nbr_sensed();
+        n.template nbr_context<int>(1).insert(int(i) + details::fold_hood([](int x, int y){ return x + y; }, f, details::get_ids(n.nbr_uid())));
+        n.round_end(0);
+        for (auto& d : nodes) {
+            typename combo<O>::node::message_t m;
+            d->receive(0, n.uid, n.send(0, m));
+        }
+    }
+    for (auto& d : nodes) {
+        typename combo<O>::node::message_t m;
+        nodes[0]->receive(0, d->uid, d->send(0, m));
+    }
+    nodes[0]->round_start(0);
+    EXPECT_EQ(12ULL, details::get_ids(nodes[0]->nbr_uid()).size());
+    EXPECT_EQ(12ULL, details::get_ids(nodes[0]->nbr_sensed()).size());
+    nodes[0]->round_end(0);
+    EXPECT_LE(common::arena::chunks(), c + 1);
+}
@@ -1,10 +1,16 @@
 // Copyright © 2021 Giorgio Audrito. All Rights Reserved.
 
+#include <chrono>
+#include <random>
+#include <thread>
+
 #include "gtest/gtest.h"
 
 #include "lib/component/base.hpp"
 #include "lib/component/identifier.hpp"
+#include "lib/component/randomizer.hpp"
 #include "lib/component/scheduler.hpp"
+#include "lib/data/vec.hpp"
 
 #include "test/helper.hpp"
 
@@ -34,6 +40,57 @@ struct worker {
     };
 };
 
+// Component losing much more time during rounds of the first nodes.
+struct loader {
+    template <typename F, typename P>
+    struct component : public P {
+        struct node : public P::node {
+            using P::node::node;
+
+            void round_main(times_t) {
+                result += workhard(P::node::uid < 10 ? 24 : 12);
+            }
+
+            int workhard(int n) {
+                if (n <= 1) return 1;
+                return (workhard(n-1) + workhard(n-2))/2;
+            }
+
+            int result = 0;
+        };
+        using net = typename P::net;
+    };
+};
+
+// Component losing time in an event following every round.
+struct napper {
+    template <typename F, typename P>
+    struct component : public P {
+        struct node : public P::node {
+            using P::node::node;
+
+            times_t next() const {
+                return std::min(m_nap, P::node::next());
+            }
+
+            void update() {
+                if (m_nap < P::node::next()) {
+                    m_nap = TIME_MAX;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                } else P::node::update();
+            }
+
+            void round_main(times_t t) {
+                P::node::round_main(t);
+                m_nap = t + 0.25f;
+            }
+
+            times_t m_nap = TIME_MAX;
+        };
+        using net = typename P::net;
+    };
+};
+
 // Component exposing the storage interface.
 struct exposer {
     template <typename F, typename P>
@@ -44,8 +101,102 @@ struct exposer {
             using P::net::node_begin;
             using P::net::node_end;
             using P::net::node_emplace;
+            using P::net::node_emplace_bulk;
             using P::net::node_erase;
+            using P::net::node_erase_bulk;
+        };
+    };
+};
+
+// Component exchanging messages with all other nodes, a fixed delay after rounds.
+template <bool par>
+struct messenger {
+    template <typename F, typename P>
+    struct component : public P {
+        struct node : public P::node {
+            using P::node::node;
+
+            using message_t = typename P::node::message_t::template push_back<uid, size_t>;
+
+            times_t send_time() const {
+                return m_send;
+            }
+
+            times_t next() const {
+                return std::min(m_send, P::node::next());
+            }
+
+            void update() {
+                if (m_send < P::node::next()) {
+                    times_t t = m_send;
+                    m_send = TIME_MAX;
+                    typename F::node::message_t m;
+                    common::get<uid>(m) = value;
+                    common::unlock_guard<par> u(P::node::mutex);
+                    for (device_t d = 0; d < 50; ++d) if (d != P::node::uid and P::node::net.node_count(d)) {
+                        typename F::net::lock_type l;
+                        P::node::net.node_at(d, l).deliver(t, P::node::uid, m);
+                    }
+                } else P::node::update();
+            }
+
+            void round_main(times_t t) {
+                P::node::round_main(t);
+                value = value * 31 + inbox;
+                inbox = 0;
+                m_send = t + 0.25f;
+            }
+
+            template <typename S, typename T>
+            void receive(times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
+                P::node::receive(t, d, m);
+                inbox += (d + 1) * common::get<uid>(m);
+            }
+
+            template <typename S>
+            S& serialize(S& s) {
+                return P::node::serialize(s) & value & inbox & m_send;
+            }
+
+            size_t value = 1;
+            size_t inbox = 0;
+            times_t m_send = TIME_MAX;
+        };
+        using net = typename P::net;
+    };
+};
+
+// Component recording the order in which messages are received.
+struct listener {
+    template <typename F, typename P>
+    struct component : public P {
+        struct node : public P::node {
+            using P::node::node;
+
+            template <typename S, typename T>
+            void receive(times_t t, device_t d, common::tagged_tuple<S,T> const& m) {
+                P::node::receive(t, d, m);
+                heard = heard * 1000003 + d;
+            }
+
+            size_t heard = 0;
         };
+        using net = typename P::net;
+    };
+};
+
+// Component placing nodes on a grid by identifier.
+struct placer {
+    template <typename F, typename P>
+    struct component : public P {
+        struct node : public P::node {
+            using P::node::node;
+
+            vec<2> position() const {
+                return make_vec(P::node::uid % 10, P::node::uid / 10);
+            }
+        };
+        using net = typename P::net;
     };
 };
 
@@ -56,7 +207,8 @@ using combo1 = component::combine_spec<
     exposer,
     component::identifier<
         parallel<(O & 1) == 1>,
-        synchronised<(O & 2) == 2>
+        synchronised<(O & 2) == 2>,
+        calendar_queue<(O & 4) == 4>
     >,
     component::base<parallel<(O & 1) == 1>>
 >;
@@ -66,15 +218,165 @@ using combo2 = component::combine_spec<
     exposer,
     worker,
     component::scheduler<round_schedule<seq_per>>,
+    component::identifier<
+        parallel<(O & 1) == 1>,
+        synchronised<(O & 2) == 2>,
+        calendar_queue<(O & 4) == 4>
+    >,
+    component::base<parallel<(O & 1) == 1>>
+>;
+
+
+template <int O>
+using combo5 = component::combine_spec<
+    exposer,
+    messenger<(O & 1) == 1>,
+    listener,
+    component::scheduler<round_schedule<seq_per>>,
+    component::identifier<
+        parallel<(O & 1) == 1>,
+        synchronised<true>,
+        deterministic<true>
+    >,
+    component::base<parallel<(O & 1) == 1>>
+>;
+
+template <int O>
+using combo4 = component::combine_spec<
+    exposer,
+    placer,
+    worker,
+    component::scheduler<round_schedule<seq_per>>,
+    component::identifier<
+        parallel<(O & 1) == 1>,
+        synchronised<(O & 2) == 2>,
+        calendar_queue<(O & 4) == 4>
+    >,
+    component::base<parallel<(O & 1) == 1>>
+>;
+
+template <int O>
+using combo7 = component::combine_spec<
+    exposer,
+    placer,
+    worker,
+    component::scheduler<round_schedule<seq_per>>,
     component::identifier<
         parallel<(O & 1) == 1>,
         synchronised<(O & 2) == 2>
     >,
+    component::randomizer<>,
     component::base<parallel<(O & 1) == 1>>
 >;
 
 
-MULTI_TEST(IdentifierTest, Sequential, O, 2) {
+template <int O>
+using combo6 = component::combine_spec<
+    exposer,
+    napper,
+    component::scheduler<round_schedule<seq_per>>,
+    component::identifier<
+        parallel<(O & 1) == 1>,
+        synchronised<(O & 2) == 2>,
+        calendar_queue<(O & 4) == 4>
+    >,
+    component::base<parallel<(O & 1) == 1>>
+>;
+
+template <int O>
+using combo8 = component::combine_spec<
+    exposer,
+    loader,
+    component::scheduler<round_schedule<seq_per>>,
+    component::identifier<
+        parallel<(O & 1) == 1>,
+        synchronised<(O & 2) == 2>
+    >,
+    component::base<parallel<(O & 1) == 1>>
+>;
+
+
+template <bool sync>
+void queue_compare(std::mt19937& rnd, double eps) {
+    component::details::times_queue<sync> tq;
+    component::details::calendar_queue<sync> cq;
+    std::uniform_real_distribution<double> delay(0, 2);
+    device_t uid = 0;
+    times_t now = 0;
+    for (int i=0; i<500; ++i, ++uid) {
+        times_t t = sync ? times_t(int(delay(rnd)*4))/4 : delay(rnd);
+        tq.push(t, uid);
+        cq.push(t, uid);
+    }
+    while (tq.next() < TIME_MAX) {
+        EXPECT_EQ(tq.next(), cq.next());
+        now = tq.next();
+        std::vector<device_t> tv = tq.pop(now + eps);
+        std::vector<device_t> cv = cq.pop(now + eps);
+        EXPECT_EQ(tv, cv);
+        for (size_t i=0; i<tv.size() and uid < 20000; ++i, ++uid) {
+            times_t t = now + (sync ? times_t(1 + int(delay(rnd)*2))/2 : delay(rnd));
+            tq.push(t, uid);
+            cq.push(t, uid);
+            if (uid % 7 == 0) {
+                tq.push(t*1000, uid);
+                cq.push(t*1000, uid);
+            }
+        }
+    }
+    EXPECT_EQ(TIME_MAX, cq.next());
+    EXPECT_EQ(std::vector<device_t>{}, cq.pop(TIME_MAX));
+}
+
+TEST(IdentifierTest, CalendarQueue) {
+    std::mt19937 rnd(42);
+    queue_compare<false>(rnd, 0);
+    queue_compare<false>(rnd, 0.01);
+    queue_compare<false>(rnd, 0.5);
+    queue_compare<true>(rnd, 0);
+    queue_compare<true>(rnd, 0.01);
+    component::details::calendar_queue<false> q;
+    q.push(TIME_MAX, 1);
+    q.push(5, 2);
+    q.push(1e30, 3);
+    EXPECT_EQ(5, q.next());
+    EXPECT_EQ(std::vector<device_t>{2}, q.pop(100));
+    EXPECT_EQ(1e30, q.next());
+    EXPECT_EQ(std::vector<device_t>{3}, q.pop(1e40));
+    EXPECT_EQ(TIME_MAX, q.next());
+}
+
+using seq_async = sequence::periodic<distribution::interval_n<times_t, 0, 1>, distribution::constant_n<times_t, 1>>;
+
+template <int O, bool opt = false>
+using combo3 = component::combine_spec<
+    exposer,
+    messenger<(O & 1) == 1>,
+    component::scheduler<round_schedule<seq_async>>,
+    component::identifier<
+        parallel<(O & 1) == 1>,
+        synchronised<false>,
+        calendar_queue<(O & 2) == 2>,
+        conservative<(O & 1) == 1 and not opt>,
+        optimistic<opt>
+    >,
+    component::base<parallel<(O & 1) == 1>>
+>;
+
+template <int O, bool det>
+using combo9 = component::combine_spec<
+    exposer,
+    messenger<(O & 1) == 1>,
+    component::scheduler<round_schedule<seq_async>>,
+    component::identifier<
+        parallel<(O & 1) == 1>,
+        synchronised<false>,
+        deterministic<det>
+    >,
+    component::base<parallel<(O & 1) == 1>>
+>;
+
+MULTI_TEST(IdentifierTest, Sequential, O, 3) {
     typename combo1<O>::net network{common::make_tagged_tuple<>()};
     EXPECT_EQ(0, (int)network.node_size());
     EXPECT_EQ(0, (int)network.node_count(0));
@@ -100,7 +402,7 @@ MULTI_TEST(IdentifierTest, Sequential, O, 2) {
     EXPECT_EQ(1, (int)network.node_at(1).uid);
 }
 
-MULTI_TEST(IdentifierTest, Customised, O, 2) {
+MULTI_TEST(IdentifierTest, Customised, O, 3) {
     typename combo1<O>::net network{common::make_tagged_tuple<>()};
     EXPECT_EQ(0, (int)network.node_size());
     EXPECT_EQ(0, (int)network.node_count(0));
@@ -127,7 +429,7 @@ MULTI_TEST(IdentifierTest, Customised, O, 2) {
     EXPECT_EQ(24, (int)network.node_at(24).uid);
 }
 
-MULTI_TEST(IdentifierTest, Parallel, O, 2) {
+MULTI_TEST(IdentifierTest, Parallel, O, 3) {
     typename combo2<O>::net network{common::make_tagged_tuple<>()};
     EXPECT_EQ(0, (int)network.node_size());
     EXPECT_EQ(0, (int)network.node_count(0));
@@ -146,3 +448,247 @@ MULTI_TEST(IdentifierTest, Parallel, O, 2) {
     EXPECT_EQ(1, (int)network.node_erase(42));
     EXPECT_EQ(99, (int)network.node_size());
 }
+
+MULTI_TEST(IdentifierTest, Bulk, O, 3) {
+    typename combo2<O>::net network{common::make_tagged_tuple<threads>(4)};
+    typename combo2<O>::net single{common::make_tagged_tuple<threads>(4)};
+    std::vector<common::tagged_tuple_t<>> v(100);
+    std::vector<device_t> ids = network.node_emplace_bulk(v);
+    for (int i=0; i<100; ++i) {
+        EXPECT_EQ(i, (int)ids[i]);
+        single.node_emplace(common::make_tagged_tuple<>());
+    }
+    EXPECT_EQ(100, (int)network.node_size());
+    EXPECT_EQ(single.next(), network.next());
+    network.update();
+    single.update();
+    for (int i=0; i<100; ++i)
+        EXPECT_EQ(single.node_at(i).result, network.node_at(i).result);
+    std::vector<common::tagged_tuple_t<uid, device_t>> w = {200, 300};
+    ids = network.node_emplace_bulk(w);
+    EXPECT_EQ(std::vector<device_t>({200, 300}), ids);
+    EXPECT_EQ(102, (int)network.node_size());
+    EXPECT_EQ(3, (int)network.node_erase_bulk({1, 200, 42, 1000}));
+    EXPECT_EQ(99, (int)network.node_size());
+    EXPECT_EQ(0, (int)network.node_count(42));
+    EXPECT_EQ(1, (int)network.node_count(300));
+}
+
+MULTI_TEST(IdentifierTest, BulkRepeated, O, 3) {
+    typename combo2<O>::net network{common::make_tagged_tuple<threads>(4)};
+    network.node_emplace(common::make_tagged_tuple<uid>(device_t(7)));
+    std::vector<common::tagged_tuple_t<uid, device_t>> w = {5, 7, 5, 6};
+    std::vector<device_t> ids = network.node_emplace_bulk(w);
+    EXPECT_EQ(std::vector<device_t>({5, 6}), ids);
+    EXPECT_EQ(3, (int)network.node_size());
+    // every node is scheduled once
+    network.update();
+    for (device_t i : {5, 6, 7})
+        EXPECT_EQ(1, network.node_at(i).result);
+}
+
+template <int O>
+std::vector<size_t> deterministic_run() {
+    typename combo5<O>::net network{common::make_tagged_tuple<threads>(4)};
+    for (int i=0; i<50; ++i)
+        network.node_emplace(common::make_tagged_tuple<>());
+    std::vector<size_t> heard(50);
+    while (network.node_size() == 50) {
+        for (int i=0; i<50; ++i)
+            heard[i] = network.node_at(i).heard;
+        network.update();
+    }
+    return heard;
+}
+
+MULTI_TEST(IdentifierTest, Deterministic, O, 1) {
+    std::vector<size_t> expected(50);
+    for (int i=0; i<50; ++i)
+        for (int r=0; r<2; ++r)
+            for (int d=0; d<50; ++d) if (d != i)
+                expected[i] = expected[i] * 1000003 + d;
+    for (int k=0; k<3; ++k)
+        EXPECT_EQ(expected, deterministic_run<O>());
+}
+
+template <int O, bool det>
+std::vector<size_t> interleaved_run() {
+    srand(42);
+    // rounds and message sendings of different nodes execute together
+    typename combo9<O, det>::net network{common::make_tagged_tuple<epsilon, threads, lookahead>(0.5f, 4, 0.25f)};
+    for (int i=0; i<50; ++i)
+        network.node_emplace(common::make_tagged_tuple<>());
+    while (network.next() < 10)
+        network.update();
+    std::vector<size_t> values;
+    for (int i=0; i<50; ++i)
+        values.push_back(network.node_at(i).value);
+    return values;
+}
+
+MULTI_TEST(IdentifierTest, DeterministicInterleaved, O, 1) {
+    std::vector<size_t> expected = interleaved_run<0, false>();
+    for (int k=0; k<3; ++k)
+        EXPECT_EQ(expected, (interleaved_run<O, true>()));
+}
+
+MULTI_TEST(IdentifierTest, Reorder, O, 3) {
+    typename combo4<O>::net network{common::make_tagged_tuple<reorder_period>(10)};
+    for (int i=0; i<100; ++i)
+        network.node_emplace(common::make_tagged_tuple<>());
+    network.update();
+    vec<2> lo = make_vec(0, 0), hi = make_vec(9, 9);
+    std::vector<uint64_t> codes;
+    for (auto it = network.node_begin(); it != network.node_end(); ++it)
+        codes.push_back(component::details::morton_code(it->second.position(), lo, hi));
+    EXPECT_EQ(100, (int)codes.size());
+    EXPECT_TRUE(std::is_sorted(codes.begin(), codes.end()));
+    EXPECT_EQ(0, (int)network.node_begin()->second.uid);
+    EXPECT_EQ(42, (int)network.node_at(42).uid);
+    for (int i=0; i<100; ++i)
+        EXPECT_EQ(1, network.node_at(i).result);
+    EXPECT_EQ(0ULL, component::details::morton_code(lo, lo, hi));
+    EXPECT_LT(component::details::morton_code(make_vec(0, 9), lo, hi), component::details::morton_code(make_vec(9, 0), lo, hi));
+    EXPECT_LT(component::details::morton_code(make_vec(4, 4), lo, hi), component::details::morton_code(make_vec(0, 9), lo, hi));
+}
+
+MULTI_TEST(IdentifierTest, Numa, O, 3) {
+    typename combo4<O>::net network{common::make_tagged_tuple<reorder_period, threads, numa_nodes>(10, 4, 2)};
+    for (int i=0; i<100; ++i)
+        network.node_emplace(common::make_tagged_tuple<>());
+    network.update();
+    for (int i=0; i<100; ++i)
+        EXPECT_EQ(1, network.node_at(i).result);
+    std::vector<size_t> const& events = network.numa_events();
+    EXPECT_EQ(2, (int)events.size());
+    if (O & 1) {
+        EXPECT_EQ(100, (int)(events[0] + events[1]));
+    } else {
+        EXPECT_EQ(0, (int)(events[0] + events[1]));
+    }
+}
+
+MULTI_TEST(IdentifierTest, NumaBulk, O, 2) {
+    typename combo7<O>::net network{common::make_tagged_tuple<reorder_period, threads, numa_nodes>(10, 4, 2)};
+    std::vector<common::tagged_tuple_t<>> v(70), w(30);
+    std::vector<device_t> ids = network.node_emplace_bulk(v);
+    EXPECT_EQ(70ULL, ids.size());
+    ids = network.node_emplace_bulk(w);
+    EXPECT_EQ(30ULL, ids.size());
+    EXPECT_EQ(100, (int)network.node_size());
+    network.update();
+    for (int i=0; i<100; ++i)
+        EXPECT_EQ(1, network.node_at(i).result);
+}
+
+MULTI_TEST(IdentifierTest, Balance, O, 3) {
+    typename combo4<O>::net network{common::make_tagged_tuple<threads, balance_threshold>(4, 1)};
+    typename combo4<O>::net plain{common::make_tagged_tuple<threads>(4)};
+    for (int i=0; i<100; ++i) {
+        network.node_emplace(common::make_tagged_tuple<>());
+        plain.node_emplace(common::make_tagged_tuple<>());
+    }
+    for (int k=0; k<2; ++k) {
+        network.update();
+        plain.update();
+    }
+    EXPECT_LE(1, network.load_imbalance());
+    for (int i=0; i<100; ++i) {
+        EXPECT_EQ(plain.node_at(i).result, network.node_at(i).result);
+        if (O & 1) {
+            EXPECT_LT(0, network.node_at(i).round_cost());
+        } else {
+            EXPECT_EQ(0, network.node_at(i).round_cost());
+        }
+    }
+}
+
+MULTI_TEST(IdentifierTest, BalanceRounds, O, 3) {
+    typename combo6<O>::net network{common::make_tagged_tuple<threads, balance_threshold>(4, 1)};
+    for (int i=0; i<8; ++i)
+        network.node_emplace(common::make_tagged_tuple<>());
+    for (int k=0; k<4; ++k)
+        network.update();
+    for (int i=0; i<8; ++i) {
+        EXPECT_EQ(TIME_MAX, network.node_at(i).m_nap);
+        if (O & 1) {
+            EXPECT_LT(0, network.node_at(i).round_cost());
+        }
+        // the nap following rounds is not measured
+        EXPECT_GT(0.05, network.node_at(i).round_cost());
+    }
+}
+
+MULTI_TEST(IdentifierTest, BalanceSkewed, O, 2) {
+    typename combo8<O>::net network{common::make_tagged_tuple<threads, balance_threshold>(4, 1)};
+    for (int i=0; i<100; ++i)
+        network.node_emplace(common::make_tagged_tuple<>());
+    network.update();
+    std::vector<size_t> const& cuts = network.load_cuts();
+    if (O & 1) {
+        // the first nodes all fall in the even chunk of the first thread
+        EXPECT_LT(1, network.load_imbalance());
+        ASSERT_EQ(4ULL, cuts.size());
+        EXPECT_EQ(0ULL, cuts[0]);
+        EXPECT_TRUE(std::is_sorted(cuts.begin(), cuts.end()));
+        std::vector<real_t> costs(4);
+        real_t total = 0, top = 0;
+        size_t i = 0;
+        for (auto it = network.node_begin(); it != network.node_end(); ++it, ++i) {
+            real_t c = it->second.round_cost();
+            costs[std::upper_bound(cuts.begin(), cuts.end(), i) - cuts.begin() - 1] += c;
+            total += c;
+            top = std::max(top, c);
+        }
+        // chunks exceed their share of the cost by less than a node
+        for (real_t c : costs)
+            EXPECT_GE(total / 4 + top, c);
+    } else {
+        EXPECT_EQ(1, network.load_imbalance());
+        EXPECT_EQ(0ULL, cuts.size());
+    }
+    network.update();
+    for (int i=0; i<100; ++i)
+        EXPECT_EQ(2, network.node_at(i).result);
+}
+
+template <int O, bool opt = false>
+std::vector<size_t> async_run(int& updates, typename combo3<O, opt>::net::speculation_stats_type* stats = nullptr) {
+    srand(42);
+    typename combo3<O, opt>::net network{common::make_tagged_tuple<epsilon, threads, lookahead, speculation_window>(0, 4, 0.25f, 16)};
+    for (int i=0; i<50; ++i)
+        network.node_emplace(common::make_tagged_tuple<>());
+    updates = 0;
+    if (opt) network.run(10);
+    else while (network.next() < 10) {
+        network.update();
+        ++updates;
+    }
+    std::vector<size_t> values;
+    for (int i=0; i<50; ++i)
+        values.push_back(network.node_at(i).value);
+    if (stats) *stats = network.speculation_stats();
+    return values;
+}
+
+MULTI_TEST(IdentifierTest, Conservative, O, 2) {
+    int seq_updates, updates;
+    std::vector<size_t> expected = async_run<0>(seq_updates);
+    EXPECT_EQ(expected, async_run<O>(updates));
+    if (O & 1) {
+        EXPECT_LT(updates, seq_updates);
+    } else {
+        EXPECT_EQ(seq_updates, updates);
+    }
+}
+
+MULTI_TEST(IdentifierTest, Optimistic, O, 2) {
+    int seq_updates, updates;
+    typename combo3<O, true>::net::speculation_stats_type stats;
+    std::vector<size_t> expected = async_run<0>(seq_updates);
+    std::vector<size_t> values = async_run<O, true>(updates, &stats);
+    EXPECT_EQ(expected, values);
+    EXPECT_LT(0, (int)stats.windows);
+    EXPECT_LT(0, (int)stats.rollbacks);
+    EXPECT_EQ(seq_updates, int(stats.events - stats.rolled_back));
+}
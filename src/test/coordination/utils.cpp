@@ -71,6 +71,25 @@ TEST(UtilsTest, BasicFunctions) {
     EXPECT_EQ(x,y);
 }
 
+TEST(UtilsTest, LazyFunctions) {
+    field<int> fi1 = details::make_field<int>({1,3},{2,1,-1});
+    field<int> fi2 = details::make_field<int>({1,2},{1,4,3});
+    field<int> x = mux(lazy(fi1) > fi2, fi1, fi2);
+    EXPECT_EQ(mux(fi1 > fi2, fi1, fi2), x);
+    x = max(lazy(fi1), fi2);
+    EXPECT_EQ(max(fi1, fi2), x);
+    x = min(lazy(fi1) * 2, 1) + max(3, lazy(fi2));
+    EXPECT_EQ(min(fi1 * 2, field<int>{1}) + max(field<int>{3}, fi2), x);
+    field<real_t> fr = details::make_field<real_t>({1,2},{4,INF,2.25});
+    field<real_t> r = sqrt(lazy(fr) + 0) * 2;
+    EXPECT_EQ(sqrt(fr) * 2, r);
+    field<real_t> fs = details::make_field<real_t>({1,3},{4,-1,2.25});
+    r = pow(lazy(fs), 2) - pow(2, lazy(fs) - fs);
+    EXPECT_EQ(pow(fs, 2) - real_t(1), r);
+    field<bool> b = isinf(lazy(fr)) or isnan(lazy(fr) - fr);
+    EXPECT_EQ(details::make_field<bool>({1,2},{false,true,false}), b);
+}
+
 MULTI_TEST(UtilsTest, IsInf, O, 3) {
     test_net<combo<O>, std::tuple<bool>(real_t)> n{
         [&](auto& node, real_t value){
@@ -142,3 +161,35 @@ MULTI_TEST(UtilsTest, ListHood, O, 3) {
                     {3,   7,   3},
                     {4,   10,  9});
 }
+
+MULTI_TEST(UtilsTest, LazyNbr, O, 3) {
+    test_net<combo<O>, std::tuple<int,int,int,int>(int)> n{
+        [&](auto& node, int value){
+            field<int> f = coordination::lazy_nbr(node, 3, value);
+            std::vector<int> v = coordination::list_hood(node, 0, std::vector<int>(), coordination::lazy_nbr(node, 4, value));
+            int s = 0;
+            for (int x : v) s += x;
+            return std::make_tuple(
+                coordination::sum_hood(node, 0, coordination::lazy_nbr(node, 1, value)),
+                coordination::min_hood(node, 0, coordination::lazy_nbr(node, 2, value), value),
+                coordination::sum_hood(node, 0, f),
+                s
+            );
+        }
+    };
+    EXPECT_ROUND(n, {1, 2, 4},
+                    {1, 2, 4},
+                    {1, 2, 4},
+                    {1, 2, 4},
+                    {1, 2, 4});
+    EXPECT_ROUND(n, {1, 2, 4},
+                    {3, 7, 6},
+                    {1, 1, 2},
+                    {3, 7, 6},
+                    {3, 7, 6});
+    EXPECT_ROUND(n, {1, 2, 4},
+                    {3, 7, 6},
+                    {1, 1, 2},
+                    {3, 7, 6},
+                    {3, 7, 6});
+}
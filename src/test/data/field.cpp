@@ -1,5 +1,7 @@
 // Copyright © 2023 Giorgio Audrito. All Rights Reserved.
 
+#include <cmath>
+#include <limits>
 #include <unordered_map>
 
 #include "lib/data/field.hpp"
@@ -429,3 +431,67 @@ TEST_F(FieldTest, InfixOperators) {
     EXPECT_EQ(make_tuple(2,1.0), details::self(z, 2));
     EXPECT_EQ(make_tuple(1,0.5), details::other(z));
 }
+
+TEST_F(FieldTest, Kernels) {
+    std::unordered_map<device_t, double> dx, dy;
+    for (device_t i = 0; i < 37; ++i) {
+        dx[i] = i % 7 - 2.5;
+        dy[i] = (i % 5) * 0.5;
+    }
+    field<double> x = build_field(1.5, dx), y = build_field(-1.0, dy);
+    auto plus = [](double a, double b){ return a + b; };
+    auto less = [](double a, double b){ return a < b; };
+    FIELD_EQ(map_hood(plus, x, y), x + y);
+    FIELD_EQ(map_hood([](double a, double b){ return a / b; }, 3.0, y), 3.0 / y);
+    FIELD_EQ(map_hood(less, x, y), x < y);
+    FIELD_EQ(map_hood(less, x, 0.0), x < 0.0);
+    FIELD_EQ(map_hood(plus, x, fd), x + fd);
+    FIELD_EQ(map_hood(less, fd, x), fd < x);
+    field<double> z = x;
+    z *= y;
+    FIELD_EQ(map_hood([](double a, double b){ return a * b; }, x, y), z);
+    z = fd;
+    z -= x;
+    FIELD_EQ(map_hood([](double a, double b){ return a - b; }, fd, x), z);
+    field<bool> b = x < y;
+    auto mux = [](bool c, double a, double d){ return c ? a : d; };
+    FIELD_EQ(map_hood(mux, b, x, y), details::kernel_select(mux, b, x, y));
+    FIELD_EQ(map_hood(mux, b, x, 0.0), details::kernel_select(mux, b, x, 0.0));
+    FIELD_EQ(map_hood(mux, fb1, x, y), details::kernel_select(mux, fb1, x, y));
+    details::self(x, 3) = std::numeric_limits<double>::infinity();
+    details::self(x, 20) = std::numeric_limits<double>::quiet_NaN();
+    FIELD_EQ(map_hood([](double a){ return std::isfinite(a); }, x), details::kernel_test(common::simd::finite{}, x));
+    details::self(x, 20) = 0;
+    auto min = [](double a, double b){ return std::min(a, b); };
+    details::field_vector<device_t> dom = details::get_ids(x);
+    EXPECT_EQ(details::fold_hood(min, x, dom), details::kernel_fold_hood<common::simd::min>(min, x, dom));
+    EXPECT_EQ(details::fold_hood(min, x, 9.0, dom, 5), details::kernel_fold_hood<common::simd::min>(min, x, 9.0, dom, 5));
+    EXPECT_EQ(details::fold_hood(min, y, -9.0, dom, 36), details::kernel_fold_hood<common::simd::min>(min, y, -9.0, dom, 36));
+    EXPECT_EQ(details::fold_hood(plus, y, 0.0, dom, 0), details::kernel_fold_hood<common::simd::add>(plus, y, 0.0, dom, 0));
+    dom = {1, 2, 40};
+    EXPECT_EQ(details::fold_hood(plus, y, dom), details::kernel_fold_hood<common::simd::add>(plus, y, dom));
+    EXPECT_EQ(details::fold_hood(plus, y, 7.0, dom, 2), details::kernel_fold_hood<common::simd::add>(plus, y, 7.0, dom, 2));
+}
+
+TEST_F(FieldTest, InlineStorage) {
+    field<double> f = 1.5;
+    EXPECT_TRUE(details::get_ids(f).is_inline());
+    EXPECT_TRUE(details::get_vals(f).is_inline());
+    for (device_t i = 0; i < FCPP_FIELD_INLINE; ++i) details::self(f, i) = i;
+    EXPECT_TRUE(details::get_ids(f).is_inline());
+    EXPECT_TRUE(details::get_vals(f).is_inline());
+    field<double> g = std::move(f);
+    EXPECT_TRUE(details::get_vals(g).is_inline());
+    EXPECT_EQ(1.5, details::other(g));
+    EXPECT_EQ(FCPP_FIELD_INLINE, (int)details::get_ids(g).size());
+    details::self(g, FCPP_FIELD_INLINE) = 2.5;
+    EXPECT_FALSE(details::get_vals(g).is_inline());
+    double const* p = details::get_vals(g).data();
+    f = std::move(g);
+    EXPECT_EQ(p, details::get_vals(f).data());
+    EXPECT_EQ(2.5, details::self(f, FCPP_FIELD_INLINE));
+    field<bool> b = f > 1.0;
+    EXPECT_EQ(FCPP_FIELD_INLINE, (int)details::get_ids(b).size() - 1);
+    EXPECT_TRUE(details::other(b));
+    EXPECT_TRUE(details::self(b, FCPP_FIELD_INLINE));
+}
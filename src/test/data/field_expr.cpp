@@ -0,0 +1,69 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/data/field_expr.hpp"
+
+#include "test/helper.hpp"
+
+using namespace fcpp;
+
+
+class FieldExprTest : public ::testing::Test {
+  protected:
+    virtual void SetUp() {
+        x = details::make_field({1,2,4}, std::vector<double>{0,1,2,3});
+        y = details::make_field({1,2,4}, std::vector<double>{10,20,30,40});
+        z = details::make_field({0,2,5}, std::vector<double>{-1,5,6,7});
+    }
+
+    field<double> x, y, z;
+};
+
+
+TEST_F(FieldExprTest, Traits) {
+    auto e = lazy(x) + y * 2;
+    EXPECT_TRUE((common::has_template<field, decltype(e)>));
+    EXPECT_SAME(to_local<decltype(e)>, double);
+    EXPECT_SAME(to_local<decltype(e) const&>, double);
+    EXPECT_SAME(to_field<decltype(e)>, field<double>);
+    EXPECT_SAME(to_local<decltype(lazy(x) < y)>, bool);
+    EXPECT_SAME(decltype(x + y), field<double>);
+}
+
+TEST_F(FieldExprTest, SameDomain) {
+    field<double> f = lazy(x) + y * 2 - 1;
+    EXPECT_EQ(details::make_field({1,2,4}, std::vector<double>{19,40,61,82}), f);
+    field<double> g = -(lazy(x) * x) + 1;
+    EXPECT_EQ(details::make_field({1,2,4}, std::vector<double>{1,0,-3,-8}), g);
+    field<bool> h = lazy(x) < 2 and y > 15;
+    EXPECT_EQ(details::make_field({1,2,4}, std::vector<bool>{false,true,false,false}), h);
+    EXPECT_EQ(x + y * 2 - 1, f);
+}
+
+TEST_F(FieldExprTest, MixedDomain) {
+    field<double> f = lazy(x) + z;
+    EXPECT_EQ(x + z, f);
+    EXPECT_EQ(details::make_field({0,1,2,4,5}, std::vector<double>{-1,5,0,8,2,7}), f);
+    field<double> g = 2 * lazy(z) + (lazy(y) - x);
+    EXPECT_EQ(2 * z + (y - x), g);
+    field<double> h = lazy(x) + field<double>(z);
+    EXPECT_EQ(f, h);
+}
+
+TEST_F(FieldExprTest, Hood) {
+    EXPECT_EQ(8.0, details::other(lazy(x) * 2 + y - 2));
+    EXPECT_EQ(44.0, details::self(lazy(x) * 2 + y - 2, 4));
+    EXPECT_EQ(5.0, details::self(lazy(x) + z, 0));
+    double s = details::fold_hood([](double a, double b){ return a+b; }, lazy(x) + y, {1,2,4});
+    EXPECT_EQ(96.0, s);
+    s = details::fold_hood([](double a, double b){ return a+b; }, lazy(x) + z, {0,1,4});
+    EXPECT_EQ(7.0, s);
+    field<double> m = map_hood([](double a, double b){ return a*b; }, lazy(x) + 1, z);
+    EXPECT_EQ(map_hood([](double a, double b){ return a*b; }, x + 1, z), m);
+    field<double> w = x;
+    w += lazy(y) * 2;
+    EXPECT_EQ(x + y * 2, w);
+}
@@ -0,0 +1,101 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#define FCPP_SIMD true
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "lib/data/field.hpp"
+
+#include "test/helper.hpp"
+
+#define FIELD_EQ(a, b)  EXPECT_EQ(a, b); EXPECT_EQ(details::get_ids(a), details::get_ids(b))
+
+
+using namespace fcpp;
+
+
+//! @brief Builds a field for testing purposes
+template <typename A>
+field<A> build_field(A def, std::unordered_map<device_t, A> data) {
+    std::vector<device_t> ids;
+    ids.reserve(data.size());
+    for (auto const& x : data)
+        ids.push_back(x.first);
+    std::sort(ids.begin(), ids.end());
+    std::vector<A> vals;
+    vals.resize(data.size()+1);
+    vals[0] = def;
+    for (size_t i = 0; i < data.size(); ++i)
+        vals[i+1] = data[ids[i]];
+    return details::make_field(std::move(ids), std::move(vals));
+}
+
+//! @brief Whether two reals are equal, or both NaN.
+bool same(double a, double b) {
+    return (std::isnan(a) and std::isnan(b)) or a == b;
+}
+
+
+TEST(FieldSimdTest, Map) {
+    std::unordered_map<device_t, double> dx, dy;
+    for (device_t i = 0; i < 37; ++i) {
+        dx[i] = i % 7 - 2.5;
+        dy[i] = (i % 5) * 0.5;
+    }
+    field<double> x = build_field(1.5, dx), y = build_field(-1.0, dy), d = build_field(0.5, {{2,3.25}});
+    field<bool> c = build_field(true, {{2,false},{3,true}});
+    auto plus = [](double a, double b){ return a + b; };
+    auto less = [](double a, double b){ return a < b; };
+    FIELD_EQ(map_hood(plus, x, y), x + y);
+    FIELD_EQ(map_hood([](double a, double b){ return a / b; }, 3.0, y), 3.0 / y);
+    FIELD_EQ(map_hood(less, x, y), x < y);
+    FIELD_EQ(map_hood(less, x, 0.0), x < 0.0);
+    FIELD_EQ(map_hood(plus, x, d), x + d);
+    FIELD_EQ(map_hood(less, d, x), d < x);
+    field<bool> b = x < y;
+    auto mux = [](bool k, double a, double e){ return k ? a : e; };
+    FIELD_EQ(map_hood(mux, b, x, y), details::kernel_select(mux, b, x, y));
+    FIELD_EQ(map_hood(mux, b, x, 0.0), details::kernel_select(mux, b, x, 0.0));
+    FIELD_EQ(map_hood(mux, c, x, y), details::kernel_select(mux, c, x, y));
+    details::self(x, 3) = std::numeric_limits<double>::infinity();
+    details::self(x, 20) = std::numeric_limits<double>::quiet_NaN();
+    FIELD_EQ(map_hood([](double a){ return std::isfinite(a); }, x), details::kernel_test(common::simd::finite{}, x));
+}
+
+TEST(FieldSimdTest, Fold) {
+    std::unordered_map<device_t, double> dx, dy;
+    for (device_t i = 0; i < 37; ++i) {
+        dx[i] = i % 7 - 2.5;
+        dy[i] = (i % 5) * 0.5;
+    }
+    field<double> x = build_field(1.5, dx), y = build_field(-1.0, dy);
+    auto plus = [](double a, double b){ return a + b; };
+    auto min = [](double a, double b){ return std::min(a, b); };
+    auto max = [](double a, double b){ return std::max(a, b); };
+    details::field_vector<device_t> dom = details::get_ids(x);
+    EXPECT_EQ(details::fold_hood(min, x, dom), details::kernel_fold_hood<common::simd::min>(min, x, dom));
+    EXPECT_EQ(details::fold_hood(min, x, 9.0, dom, 5), details::kernel_fold_hood<common::simd::min>(min, x, 9.0, dom, 5));
+    EXPECT_EQ(details::fold_hood(min, y, -9.0, dom, 36), details::kernel_fold_hood<common::simd::min>(min, y, -9.0, dom, 36));
+    EXPECT_EQ(details::fold_hood(plus, y, 0.0, dom, 0), details::kernel_fold_hood<common::simd::add>(plus, y, 0.0, dom, 0));
+    for (device_t i : {device_t(20), device_t(36), device_t(0)}) {
+        details::self(x, i) = std::numeric_limits<double>::quiet_NaN();
+        EXPECT_PRED2(same, details::fold_hood(min, x, dom), details::kernel_fold_hood<common::simd::min>(min, x, dom));
+        EXPECT_PRED2(same, details::fold_hood(max, x, dom), details::kernel_fold_hood<common::simd::max>(max, x, dom));
+        EXPECT_PRED2(same, details::fold_hood(plus, x, dom), details::kernel_fold_hood<common::simd::add>(plus, x, dom));
+        EXPECT_PRED2(same, details::fold_hood(min, x, 9.0, dom, 5), details::kernel_fold_hood<common::simd::min>(min, x, 9.0, dom, 5));
+        EXPECT_PRED2(same, details::fold_hood(max, x, -9.0, dom, 5), details::kernel_fold_hood<common::simd::max>(max, x, -9.0, dom, 5));
+        details::self(x, i) = 0;
+    }
+    details::self(x, 3) = std::numeric_limits<double>::infinity();
+    details::self(x, 30) = -std::numeric_limits<double>::infinity();
+    EXPECT_EQ(details::fold_hood(min, x, dom), details::kernel_fold_hood<common::simd::min>(min, x, dom));
+    EXPECT_EQ(details::fold_hood(max, x, dom), details::kernel_fold_hood<common::simd::max>(max, x, dom));
+    EXPECT_PRED2(same, details::fold_hood(plus, x, dom), details::kernel_fold_hood<common::simd::add>(plus, x, dom));
+    dom = {1, 2, 40};
+    EXPECT_EQ(details::fold_hood(plus, y, dom), details::kernel_fold_hood<common::simd::add>(plus, y, dom));
+    EXPECT_EQ(details::fold_hood(plus, y, 7.0, dom, 2), details::kernel_fold_hood<common::simd::add>(plus, y, 7.0, dom, 2));
+}
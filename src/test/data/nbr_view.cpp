@@ -0,0 +1,50 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/data/nbr_view.hpp"
+
+using namespace fcpp;
+
+
+class NbrViewTest : public ::testing::Test {
+  protected:
+    virtual void SetUp() {
+        ints = {3, 5, 7};
+        pairs = {details::make_field({2}, std::vector<int>{1, 10}), field<int>{2}};
+        int_entries = {{1, &ints[0]}, {2, &ints[1]}, {4, &ints[2]}};
+        pair_entries = {{0, &pairs[0]}, {3, &pairs[1]}};
+    }
+
+    std::vector<int> ints;
+    std::vector<field<int>> pairs;
+    std::vector<std::pair<device_t, void const*>> int_entries, pair_entries;
+};
+
+
+TEST_F(NbrViewTest, Convert) {
+    nbr_view<int> v(int_entries.data(), int_entries.data() + 3, 0, 2);
+    EXPECT_EQ(size_t(3), v.size());
+    field<int> f = v;
+    EXPECT_EQ(details::make_field({1,2,4}, std::vector<int>{0,3,5,7}), f);
+    nbr_view<field<int>> w(pair_entries.data(), pair_entries.data() + 2, field<int>{-1}, 2);
+    field<int> g = w;
+    EXPECT_EQ(details::make_field({0,3}, std::vector<int>{-1,10,2}), g);
+    EXPECT_EQ(10, details::self(w, 0));
+    EXPECT_EQ(-1, details::self(w, 1));
+}
+
+TEST_F(NbrViewTest, Fold) {
+    nbr_view<int> v(int_entries.data(), int_entries.data() + 3, 100, 2);
+    int sum = details::fold_hood([](int x, int y){ return x+y; }, v, {0,1,2,4});
+    EXPECT_EQ(115, sum);
+    sum = details::fold_hood([](int x, int y){ return x+y; }, v, 1000, {0,1,2,4}, 2);
+    EXPECT_EQ(1110, sum);
+    int ids = details::fold_hood([](device_t i, int, int y){ return int(i)+y; }, v, {1,4});
+    EXPECT_EQ(7, ids);
+    ids = details::fold_hood([](device_t i, int x, int y){ return int(i)*x+y; }, v, 0, {0,1,2}, 2);
+    EXPECT_EQ(3, ids);
+}
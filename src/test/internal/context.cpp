@@ -1,10 +1,15 @@
 // Copyright © 2021 Giorgio Audrito. All Rights Reserved.
 
+#include <algorithm>
+#include <map>
 #include <utility>
 
 #include "gtest/gtest.h"
 
+#include "lib/common/flat_multitype_map.hpp"
+#include "lib/common/layout_multitype_map.hpp"
 #include "lib/common/multitype_map.hpp"
+#include "lib/common/serialize.hpp"
 #include "lib/internal/context.hpp"
 
 #include "test/test_net.hpp"
@@ -83,6 +88,35 @@ MULTI_TEST_F(ContextTest, InsertErase, O, 1) {
     EXPECT_EQ(size_t(1), x.size(9));
 }
 
+MULTI_TEST_F(ContextTest, Heap, O, 1) {
+    context_type<O> x;
+    std::map<device_t, double> ref;
+    for (int i=0; i<200; ++i) {
+        device_t d = (i * 37) % 23;
+        double v = ((i * 53) % 15) / 10.0;
+        x.insert(d, m, v, 1.5, 12);
+        ref[d] = v;
+        if (ref.size() > 12) {
+            auto w = std::max_element(ref.begin(), ref.end(), [](auto const& a, auto const& b){
+                return std::make_pair(a.second, a.first) < std::make_pair(b.second, b.first);
+            });
+            ref.erase(w);
+        }
+        auto w = std::max_element(ref.begin(), ref.end(), [](auto const& a, auto const& b){
+            return std::make_pair(a.second, a.first) < std::make_pair(b.second, b.first);
+        });
+        EXPECT_EQ(w->first, x.top());
+        EXPECT_EQ(ref.size() + 1, x.size(100));
+    }
+    common::osstream os;
+    os << x;
+    common::isstream is(os.data());
+    context_type<O> y;
+    is >> y;
+    EXPECT_EQ(x, y);
+    EXPECT_EQ(x.top(), y.top());
+}
+
 MULTI_TEST_F(ContextTest, Align, O, 2) {
     context_type<O> data;
     data.insert(1, m, 0.5, 1.5, 9);
@@ -135,3 +169,104 @@ MULTI_TEST_F(ContextTest, Nbr, O, 2) {
     EXPECT_EQ(fie, fir);
     data.unfreeze(0, metric{}, 1.5);
 }
+
+MULTI_TEST_F(ContextTest, Index, O, 2) {
+    context_type<O> data;
+    m.insert(7, details::make_field({0}, std::vector<int>{5,6}));
+    m.insert(7);
+    for (int r = 0; r < 3; ++r) {
+        data.insert(2, m, 0.5, 1.5, 9);
+        data.insert(1, m, 0.5, 1.5, 9);
+        data.freeze(9, 2);
+        fcpp::field<char> fcr = data.nbr(7, '*', 2);
+        EXPECT_EQ(details::make_field({1,2}, std::vector<char>{'*', 'a', 'a'}), fcr);
+        fcpp::field<int> fir = data.nbr(7, field<int>{-1}, 2);
+        EXPECT_EQ(details::make_field({1,2}, std::vector<int>{-1,5,5}), fir);
+        fcpp::field<double> fdr = data.nbr(7, 0.5, 2);
+        EXPECT_EQ(fcpp::field<double>(0.5), fdr);
+        fcpp::details::field_vector<device_t> ex = {0,1,2}, res = data.align(7, 0);
+        EXPECT_EQ(ex, res);
+        ex = {1,2};
+        res = data.align(7, 1);
+        EXPECT_EQ(ex, res);
+        ex = {2};
+        res = data.align(42, 2);
+        EXPECT_EQ(ex, res);
+        data.unfreeze(2, metric{}, 1.5);
+    }
+}
+
+TEST(TraceIndexTest, Clear) {
+    using map_type = common::multitype_map<trace_t, int, char>;
+    internal::trace_index<map_type> index;
+    for (trace_t r = 0; r < 3; ++r) {
+        // traces shift every round, so that those of previous rounds are cleared
+        map_type m;
+        for (trace_t t = r; t < 100 + r; ++t) {
+            m.insert(t, int(t));
+            if (t % 2) m.insert(t, char(t));
+            else m.insert(t);
+        }
+        index.clear();
+        index.insert(1, m);
+        index.insert(4, m);
+        EXPECT_EQ(0ULL, index.column<int>(r + 100).size());
+        if (r > 0) {
+            EXPECT_EQ(0ULL, index.column<int>(r - 1).size());
+        }
+        for (trace_t t = r; t < 100 + r; ++t) {
+            auto const& c = index.column<int>(t);
+            ASSERT_EQ(2ULL, c.size());
+            EXPECT_EQ(1, (int)c[0].first);
+            EXPECT_EQ(4, (int)c[1].first);
+            EXPECT_EQ(int(t), *static_cast<int const*>(c[1].second));
+            EXPECT_EQ(t % 2 ? 2ULL : 0ULL, index.column<char>(t).size());
+            EXPECT_EQ(t % 2 ? 0ULL : 2ULL, index.keys(t).size());
+        }
+        EXPECT_EQ(0ULL, index.column<double>(r).size());
+    }
+}
+
+TEST(FlatContextTest, Nbr) {
+    using map_type = common::flat_multitype_map<trace_t, int, char>;
+    internal::context<false, false, double, internal::flat_exports<int, char>> data;
+    map_type x, y;
+    x.insert(3, 10);
+    x.insert(4, 'x');
+    y.insert(3, 20);
+    y.insert(4);
+    data.insert(5, y, 0.5, 1.5, 9);
+    data.insert(1, x, 0.5, 1.5, 9);
+    data.freeze(9, 1);
+    fcpp::field<int> fir = data.nbr(3, 0, 1);
+    EXPECT_EQ(details::make_field({1,5}, std::vector<int>{0,10,20}), fir);
+    fcpp::field<char> fcr = data.nbr(4, '*', 1);
+    EXPECT_EQ(details::make_field({1}, std::vector<char>{'*','x'}), fcr);
+    fcpp::details::field_vector<device_t> ex = {1,5}, res = data.align(4, 1);
+    EXPECT_EQ(ex, res);
+    data.unfreeze(1, metric{}, 1.5);
+}
+
+TEST(LayoutContextTest, Nbr) {
+    using context_type = internal::context<true, true, double, internal::layout_exports<int, char>>;
+    using map_type = common::layout_multitype_map<trace_t, int, char>;
+    context_type data;
+    map_type x;
+    x.insert(3, 10);
+    x.insert(4, 'x');
+    map_type y = *context_type::renew(x);
+    y.insert(3, 20);
+    y.insert(4);
+    EXPECT_EQ(20, y.at<int>(3));
+    EXPECT_FALSE(y.count<char>(4));
+    data.insert(5, y, 0.5, 1.5, 9);
+    data.insert(1, x, 0.5, 1.5, 9);
+    data.freeze(9, 1);
+    fcpp::field<int> fir = data.nbr(3, 0, 1);
+    EXPECT_EQ(details::make_field({1,5}, std::vector<int>{0,10,20}), fir);
+    fcpp::field<char> fcr = data.nbr(4, '*', 1);
+    EXPECT_EQ(details::make_field({1}, std::vector<char>{'*','x'}), fcr);
+    fcpp::details::field_vector<device_t> ex = {1,5}, res = data.align(4, 1);
+    EXPECT_EQ(ex, res);
+    data.unfreeze(1, metric{}, 1.5);
+}
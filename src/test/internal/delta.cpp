@@ -0,0 +1,182 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/flat_multitype_map.hpp"
+#include "lib/common/multitype_map.hpp"
+#include "lib/common/serialize.hpp"
+#include "lib/data/field.hpp"
+#include "lib/internal/delta.hpp"
+#include "lib/internal/flat_ptr.hpp"
+
+#include "test/helper.hpp"
+
+using namespace fcpp;
+
+
+template <int O>
+using map_type = std::conditional_t<(O & 1) == 1,
+    common::flat_multitype_map<trace_t, field<int>, char>,
+    common::multitype_map<trace_t, field<int>, char>
+>;
+
+template <int O>
+using export_type = internal::flat_ptr<map_type<O>, (O & 2) == 2>;
+
+template <int O>
+map_type<O> build(char c, int v) {
+    map_type<O> m;
+    m.insert(7, c);
+    m.insert(42, '+');
+    m.insert(3, details::make_field({0,6}, std::vector<int>{1,3,v}));
+    m.insert(8);
+    return m;
+}
+
+
+MULTI_TEST(DeltaTest, Diff, O, 1) {
+    map_type<O> prev = build<O>('a', 4);
+    map_type<O> next = build<O>('b', 4);
+    next.template erase<char>(42);
+    next.insert(9);
+    internal::export_delta<map_type<O>> d(prev, next, 5);
+    EXPECT_EQ(5ULL, d.generation());
+    EXPECT_FALSE(d.full());
+    EXPECT_FALSE(d.empty());
+    EXPECT_TRUE(d.values().template count<char>(7));
+    EXPECT_FALSE(d.values().template count<field<int>>(3));
+    EXPECT_TRUE(d.values().contains(9));
+    EXPECT_FALSE(d.values().contains(8));
+    ASSERT_EQ(1ULL, d.removed().size());
+    EXPECT_EQ(42ULL, d.removed()[0].first);
+    d.apply(prev);
+    EXPECT_EQ(next, prev);
+    internal::export_delta<map_type<O>> e(next, next, 6);
+    EXPECT_TRUE(e.empty());
+    e.apply(prev);
+    EXPECT_EQ(next, prev);
+    next.insert(3, details::make_field({0,6}, std::vector<int>{1,3,5}));
+    internal::export_delta<map_type<O>> f(prev, next, 7);
+    EXPECT_TRUE(f.values().template count<field<int>>(3));
+    EXPECT_FALSE(f.values().template count<char>(7));
+    f.apply(prev);
+    EXPECT_EQ(next, prev);
+}
+
+MULTI_TEST(DeltaTest, Serialize, O, 1) {
+    internal::export_delta<map_type<O>> full(build<O>('a', 4), 0);
+    internal::export_delta<map_type<O>> part(build<O>('a', 4), build<O>('a', 5), 1);
+    common::osstream os;
+    os << full << part;
+    common::isstream is(os);
+    internal::export_delta<map_type<O>> x, y;
+    is >> x >> y;
+    EXPECT_EQ(full, x);
+    EXPECT_EQ(part, y);
+    common::osstream fs, ps;
+    fs << full;
+    ps << part;
+    EXPECT_LT(ps.size(), fs.size());
+}
+
+MULTI_TEST(DeltaTest, Codec, O, 2) {
+    // exports held in pointers are shared through the messages
+    constexpr bool shared = (O & 2) == 0;
+    internal::delta_codec<export_type<O>, 4> sender, receiver;
+    export_type<O> e0 = build<O>('a', 4);
+    export_type<O> e1 = build<O>('b', 4);
+    export_type<O> e2 = build<O>('c', 4);
+    export_type<O> e3 = build<O>('d', 4);
+    export_type<O> const* r;
+    // full export
+    sender.renew();
+    EXPECT_TRUE(sender.message(e0).full());
+    r = receiver.decode(0, 1, 0, sender.message(e0));
+    ASSERT_NE(nullptr, r);
+    EXPECT_EQ(*e0, **r);
+    export_type<O> kept = *r;
+    // partial delta, also received twice
+    sender.renew();
+    EXPECT_FALSE(sender.message(e1).full());
+    r = receiver.decode(1, 1, 0, sender.message(e1));
+    ASSERT_NE(nullptr, r);
+    EXPECT_EQ(*e1, **r);
+    EXPECT_EQ(*e0, *kept);
+    r = receiver.decode(1, 1, 0, sender.message(e1));
+    ASSERT_NE(nullptr, r);
+    EXPECT_EQ(*e1, **r);
+    // lost message, recovered only from the export shared
+    sender.renew();
+    sender.message(e2);
+    sender.renew();
+    r = receiver.decode(3, 1, 0, sender.message(e3));
+    if (shared) {
+        ASSERT_NE(nullptr, r);
+        EXPECT_EQ(*e3, **r);
+    } else EXPECT_EQ(nullptr, r);
+    // messages to self are always decoded
+    r = sender.decode(3, 1, 1, sender.message(e3));
+    ASSERT_NE(nullptr, r);
+    EXPECT_EQ(*e3, **r);
+    // full export recovers
+    sender.renew();
+    EXPECT_TRUE(sender.message(e3).full());
+    r = receiver.decode(4, 1, 0, sender.message(e3));
+    ASSERT_NE(nullptr, r);
+    EXPECT_EQ(*e3, **r);
+    // rounds without messages sent are not lost messages
+    sender.renew();
+    sender.renew();
+    r = receiver.decode(5, 1, 0, sender.message(e0));
+    ASSERT_NE(nullptr, r);
+    EXPECT_EQ(*e0, **r);
+    // rounds without messages keep the export until the next full export is due
+    for (int t = 6; t <= 7; ++t) receiver.prune(t);
+    sender.renew();
+    r = receiver.decode(7, 1, 0, sender.message(e1));
+    ASSERT_NE(nullptr, r);
+    EXPECT_EQ(*e1, **r);
+    // expired export, recovered only from the export shared
+    receiver.prune(12);
+    sender.renew();
+    r = receiver.decode(12, 1, 0, sender.message(e2));
+    if (shared) {
+        ASSERT_NE(nullptr, r);
+        EXPECT_EQ(*e2, **r);
+    } else EXPECT_EQ(nullptr, r);
+}
+
+MULTI_TEST(DeltaTest, CodecIdle, O, 2) {
+    constexpr bool shared = (O & 2) == 0;
+    internal::delta_codec<export_type<O>, 4> sender, receiver;
+    export_type<O> e0 = build<O>('a', 4);
+    export_type<O> e1 = build<O>('b', 4);
+    // without an estimate of the time between generations, the export is kept for some rounds
+    sender.renew();
+    EXPECT_NE(nullptr, receiver.decode(0, 1, 0, sender.message(e0)));
+    for (int i = 0; i < 4; ++i) receiver.prune(0);
+    sender.renew();
+    EXPECT_NE(nullptr, receiver.decode(0, 1, 0, sender.message(e1)));
+    // and forgotten after too many rounds
+    internal::delta_codec<export_type<O>, 4> other;
+    for (export_type<O> const* e : {&e0, &e1}) {
+        sender.renew();
+        sender.message(*e);
+    }
+    sender.renew();
+    EXPECT_TRUE(sender.message(e0).full());
+    EXPECT_NE(nullptr, other.decode(0, 1, 0, sender.message(e0)));
+    for (int i = 0; i < 5; ++i) other.prune(0);
+    sender.renew();
+    EXPECT_EQ(shared, nullptr != other.decode(0, 1, 0, sender.message(e1)));
+}
+
+TEST(DeltaTest, Disabled) {
+    internal::delta_codec<export_type<0>, 0> codec;
+    export_type<0> e = build<0>('a', 4);
+    codec.renew();
+    EXPECT_EQ(&e, &codec.message(e));
+    EXPECT_EQ(&e, codec.decode(0, 1, 0, e));
+}
@@ -70,3 +70,18 @@ TEST(FlatPtrTest, Assignment) {
     EXPECT_EQ('z', *fdata);
     EXPECT_EQ('a', *tdata);
 }
+
+TEST(FlatPtrTest, Detach) {
+    internal::flat_ptr<char, false> fdata('a');
+    internal::flat_ptr<char, false> f1 = fdata;
+    f1.detach() = 'b';
+    EXPECT_EQ('a', *fdata);
+    EXPECT_EQ('b', *f1);
+    char* p = &*f1;
+    f1.detach() = 'c';
+    EXPECT_EQ(p, &*f1);
+    EXPECT_EQ('c', *f1);
+    internal::flat_ptr<char, true> tdata('a');
+    tdata.detach() = 'b';
+    EXPECT_EQ('b', *tdata);
+}
@@ -0,0 +1,111 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/multitype_map.hpp"
+#include "lib/common/serialize.hpp"
+#include "lib/common/shared_multitype_map.hpp"
+#include "lib/internal/flat_ptr.hpp"
+#include "lib/internal/intern.hpp"
+
+using namespace fcpp;
+
+
+using map_type = common::shared_multitype_map<trace_t, int, char>;
+
+map_type build(int v, char c = 'x') {
+    map_type m;
+    m.insert(3, v);
+    m.insert(7, c);
+    m.insert(8);
+    return m;
+}
+
+template <typename A, typename E>
+A const* address(E const& e, trace_t t) {
+    return &e->template at<A>(t);
+}
+
+
+TEST(InternTest, Share) {
+    std::shared_ptr<int> a = std::make_shared<int>(1), b = std::make_shared<int>(1), c = std::make_shared<int>(2);
+    internal::intern_stats s0 = internal::intern_table<int>::stats();
+    std::shared_ptr<int> x = internal::intern_table<int>::intern(a);
+    std::shared_ptr<int> y = internal::intern_table<int>::intern(b);
+    std::shared_ptr<int> z = internal::intern_table<int>::intern(c);
+    EXPECT_EQ(a, x);
+    EXPECT_EQ(a, y);
+    EXPECT_EQ(c, z);
+    internal::intern_stats s1 = internal::intern_table<int>::stats();
+    EXPECT_EQ(s0.lookups + 3, s1.lookups);
+    EXPECT_EQ(s0.hits + 1, s1.hits);
+    EXPECT_EQ(s0.entries + 2, s1.entries);
+    common::osstream os;
+    os << 1;
+    // a is referenced also by x and y, c also by z
+    EXPECT_EQ(s0.bytes_saved + intmax_t(s0.table_bytes + 3 * os.size()), s1.bytes_saved + intmax_t(s1.table_bytes));
+}
+
+TEST(InternTest, Entries) {
+    internal::flat_ptr<map_type, false> a(build(1)), b(build(1)), c(build(2));
+    internal::flat_ptr<map_type, false> x = internal::intern(a);
+    internal::flat_ptr<map_type, false> y = internal::intern(b);
+    internal::flat_ptr<map_type, false> z = internal::intern(c);
+    EXPECT_TRUE(x->shared());
+    EXPECT_EQ(a, x);
+    EXPECT_EQ(c, z);
+    // exports differing in some entries share the equal ones
+    EXPECT_EQ(address<int>(x, 3), address<int>(y, 3));
+    EXPECT_NE(address<int>(x, 3), address<int>(z, 3));
+    EXPECT_EQ(address<char>(x, 7), address<char>(y, 7));
+    EXPECT_EQ(address<char>(x, 7), address<char>(z, 7));
+    EXPECT_EQ(address<int>(a, 3), address<int>(x, 3));
+    EXPECT_EQ(address<int>(c, 3), address<int>(z, 3));
+    // exports already shared are not interned again
+    internal::intern_stats s = internal::intern_statistics(x);
+    EXPECT_EQ(x.shared(), internal::intern(x).shared());
+    EXPECT_EQ(s.lookups, internal::intern_statistics(x).lookups);
+    // only the values inserted since are interned again
+    z->insert(7, 'y');
+    EXPECT_FALSE(z->shared());
+    internal::intern_stats s0 = internal::intern_statistics(z);
+    internal::flat_ptr<map_type, false> w = internal::intern(z);
+    EXPECT_EQ(s0.lookups + 1, internal::intern_statistics(z).lookups);
+    EXPECT_EQ(address<int>(z, 3), address<int>(w, 3));
+    EXPECT_NE(address<char>(x, 7), address<char>(w, 7));
+}
+
+TEST(InternTest, NetSavings) {
+    std::vector<std::shared_ptr<std::string>> v;
+    for (int i = 0; i < 100; ++i) v.push_back(internal::intern_table<std::string>::intern(std::make_shared<std::string>(std::string(64, 'x') + std::to_string(1000 + i))));
+    internal::intern_stats s = internal::intern_table<std::string>::stats();
+    EXPECT_LT(s.bytes_saved, 0);
+    for (int i = 0; i < 1000; ++i) v.push_back(internal::intern_table<std::string>::intern(std::make_shared<std::string>(std::string(64, 'x') + "1000")));
+    s = internal::intern_table<std::string>::stats();
+    EXPECT_LT(0, s.bytes_saved);
+    EXPECT_LT(s.bytes_saved, intmax_t(s.bytes * 1000));
+}
+
+TEST(InternTest, Expire) {
+    internal::intern_stats s0 = internal::intern_table<int>::stats();
+    {
+        std::shared_ptr<int> a = std::make_shared<int>(5);
+        std::shared_ptr<int> x = internal::intern_table<int>::intern(a);
+        EXPECT_EQ(s0.entries + 1, internal::intern_table<int>::stats().entries);
+    }
+    internal::intern_stats s1 = internal::intern_table<int>::stats();
+    EXPECT_EQ(s0.entries, s1.entries);
+    std::shared_ptr<int> b = std::make_shared<int>(5);
+    EXPECT_EQ(b, internal::intern_table<int>::intern(b));
+    EXPECT_EQ(s1.hits, internal::intern_table<int>::stats().hits);
+}
+
+TEST(InternTest, Plain) {
+    internal::flat_ptr<common::multitype_map<trace_t, int, char>, false> a(common::multitype_map<trace_t, int, char>{});
+    EXPECT_EQ(&a, &internal::intern(a));
+    EXPECT_EQ(0ULL, internal::intern_statistics(a).lookups);
+}
@@ -0,0 +1,58 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/serialize.hpp"
+#include "lib/internal/nbr_sensor.hpp"
+
+using namespace fcpp;
+
+
+TEST(NbrSensorTest, Set) {
+    internal::nbr_sensor<int> s(-1);
+    EXPECT_EQ(field<int>(-1), s.get());
+    s.set(5, 50);
+    s.set(1, 10);
+    s.set(3, 30);
+    s.set(1, 11);
+    EXPECT_EQ(fcpp::details::make_field<int>({1, 3, 5}, {-1, 11, 30, 50}), s.get());
+    s.set(4, 40);
+    s.set(3, 31);
+    s.set(0, 0);
+    s.set(7, 70);
+    EXPECT_EQ(fcpp::details::make_field<int>({0, 1, 3, 4, 5, 7}, {-1, 0, 11, 31, 40, 50, 70}), s.get());
+    internal::nbr_sensor<int> const& c = s;
+    s.set(1, 12);
+    EXPECT_EQ(12, fcpp::details::self(c.get(), 1));
+    fcpp::details::align_inplace(s.get(), fcpp::details::field_vector<device_t>{1, 4});
+    s.set(2, 20);
+    EXPECT_EQ(fcpp::details::make_field<int>({1, 2, 4}, {-1, 12, 20, 40}), s.get());
+}
+
+TEST(NbrSensorTest, Equivalence) {
+    internal::nbr_sensor<std::string> s("x");
+    field<std::string> f("x");
+    for (int r = 0; r < 5; ++r) {
+        for (int i = 0; i < 40; ++i) {
+            device_t d = (i * 7 + r * 3) % 23;
+            std::string v = std::to_string(r) + "/" + std::to_string(i);
+            s.set(d, v);
+            fcpp::details::self(f, d) = v;
+        }
+        EXPECT_EQ(f, s.get());
+    }
+}
+
+TEST(NbrSensorTest, Serialize) {
+    internal::nbr_sensor<int> s(-1), t;
+    s.set(2, 20);
+    s.set(1, 10);
+    common::osstream os;
+    os << s;
+    t.set(3, 30);
+    common::isstream is(os);
+    is >> t;
+    EXPECT_EQ(fcpp::details::make_field<int>({1, 2}, {-1, 10, 20}), t.get());
+}
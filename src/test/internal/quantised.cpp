@@ -0,0 +1,94 @@
+// Copyright © 2023 Giorgio Audrito. All Rights Reserved.
+
+#include <cmath>
+#include <type_traits>
+
+#include "gtest/gtest.h"
+
+#include "lib/common/flat_multitype_map.hpp"
+#include "lib/common/multitype_map.hpp"
+#include "lib/common/serialize.hpp"
+#include "lib/internal/quantised.hpp"
+
+#include "test/helper.hpp"
+
+using namespace fcpp;
+
+
+template <int O>
+using map_type = std::conditional_t<(O & 1) == 1,
+    common::flat_multitype_map<trace_t, real_t, field<real_t>, int>,
+    common::multitype_map<trace_t, real_t, field<real_t>, int>
+>;
+
+template <int O>
+using export_type = internal::flat_ptr<map_type<O>, (O & 2) == 2>;
+
+using quantise_type = common::type_sequence<common::quantise<common::fixed<1, 1000>, real_t, field<real_t>>>;
+
+template <int O>
+map_type<O> build() {
+    map_type<O> m;
+    m.insert(1, real_t(3.14159));
+    m.insert(2, 42);
+    m.insert(3);
+    m.insert(4, fcpp::details::make_field<real_t>({5, 7}, {0.5, -1.2342, 27.0001}));
+    return m;
+}
+
+template <typename T>
+size_t wire_size(T const& x) {
+    common::osstream os;
+    os << x;
+    return os.size();
+}
+
+template <typename T>
+T roundtrip(T const& x) {
+    common::osstream os;
+    os << x;
+    common::isstream is(os);
+    T y;
+    is >> y;
+    return y;
+}
+
+template <typename M>
+void check(M const& m) {
+    EXPECT_NEAR(3.14159, m.template at<real_t>(1), 0.0005);
+    EXPECT_EQ(42, m.template at<int>(2));
+    EXPECT_TRUE(m.contains(3));
+    field<real_t> const& f = m.template at<field<real_t>>(4);
+    EXPECT_EQ(2ULL, fcpp::details::get_ids(f).size());
+    EXPECT_NEAR(0.5, fcpp::details::other(f), 0.0005);
+    EXPECT_NEAR(-1.2342, fcpp::details::self(f, 5), 0.0005);
+    EXPECT_NEAR(27.0001, fcpp::details::self(f, 7), 0.0005);
+}
+
+
+MULTI_TEST(QuantisedTest, Export, O, 2) {
+    using message_type = internal::quantised_t<export_type<O>, quantise_type>;
+    EXPECT_SAME(internal::quantised_t<export_type<O>, common::type_sequence<>>, export_type<O>);
+    message_type x(build<O>());
+    EXPECT_EQ(*x, build<O>());
+    message_type y = roundtrip(x);
+    check(*y);
+    EXPECT_LT(wire_size(x), wire_size(export_type<O>(build<O>())));
+}
+
+MULTI_TEST(QuantisedTest, Delta, O, 1) {
+    using message_type = internal::quantised_message<internal::export_delta<map_type<O>>, quantise_type>;
+    map_type<O> prev;
+    prev.insert(2, 42);
+    prev.insert(9, 7);
+    message_type x(internal::export_delta<map_type<O>>(prev, build<O>(), 5));
+    message_type y = roundtrip(x);
+    EXPECT_EQ(5ULL, y.generation());
+    EXPECT_FALSE(y.full());
+    EXPECT_EQ(1ULL, y.removed().size());
+    EXPECT_FALSE(y.values().contains(2));
+    map_type<O> e = prev;
+    y.apply(e);
+    check(e);
+    EXPECT_LT(wire_size(x), wire_size(static_cast<internal::export_delta<map_type<O>> const&>(x)));
+}
@@ -16,6 +16,7 @@ struct public_trace : public internal::trace {
     using internal::trace::clear;
     using internal::trace::push;
     using internal::trace::pop;
+    using internal::trace::replace;
 };
 
 public_trace test_trace;
@@ -61,6 +62,34 @@ TEST(TraceTest, PushPop) {
     EXPECT_EQ((trace_t)15, stack[1]);
 }
 
+TEST(TraceTest, DeepNesting) {
+    std::vector<trace_t> stack;
+    for (int i = 0; i < 4 * FCPP_TRACE_DEPTH; ++i) {
+        stack.push_back(test_trace.hash(0));
+        test_trace.push(i % 10);
+    }
+    for (int i = 4 * FCPP_TRACE_DEPTH - 1; i >= 0; --i) {
+        test_trace.pop();
+        EXPECT_EQ(stack[i], test_trace.hash(0));
+    }
+    EXPECT_TRUE(test_trace.empty());
+}
+
+TEST(TraceTest, Replace) {
+    test_trace.push(15);
+    test_trace.push(120);
+    test_trace.pop();
+    test_trace.push(48);
+    trace_t h = test_trace.hash(0);
+    test_trace.replace(20);
+    test_trace.replace(48);
+    EXPECT_EQ(h, test_trace.hash(0));
+    test_trace.pop();
+    EXPECT_EQ((trace_t)15, test_trace.hash(0));
+    test_trace.pop();
+    EXPECT_EQ(true, test_trace.empty());
+}
+
 TEST(TraceTest, TraceCall) {
     std::vector<trace_t> stack;
     stack.push_back(test_trace.hash(0));
@@ -111,4 +140,14 @@ TEST(TraceTest, TraceCycle) {
     for (internal::trace_cycle i{test_trace, 0}; i<10; ++i) {
         EXPECT_EQ(stack[i], test_trace.hash(0));
     }
+    {
+        internal::trace_cycle i{test_trace, 2};
+        i += 5;
+        EXPECT_EQ(stack[7], test_trace.hash(0));
+        i -= 3;
+        EXPECT_EQ(stack[4], test_trace.hash(0));
+        --i;
+        EXPECT_EQ(stack[3], test_trace.hash(0));
+    }
+    EXPECT_EQ(true, test_trace.empty());
 }
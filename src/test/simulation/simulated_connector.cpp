@@ -1,12 +1,21 @@
 // Copyright © 2021 Giorgio Audrito. All Rights Reserved.
 
 #include <algorithm>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
 
 #include "lib/component/base.hpp"
+#include "lib/component/calculus.hpp"
+#include "lib/component/identifier.hpp"
+#include "lib/component/randomizer.hpp"
 #include "lib/component/scheduler.hpp"
+#include "lib/component/storage.hpp"
+#include "lib/component/timer.hpp"
+#include "lib/coordination/spreading.hpp"
+#include "lib/coordination/utils.hpp"
 #include "lib/simulation/simulated_positioner.hpp"
 #include "lib/simulation/simulated_connector.hpp"
 
@@ -59,6 +68,104 @@ using combo = component::combine_spec<
     component::base<parallel<(O & 1) == 1>>
 >;
 
+// Component exposing the bulk insertion interface.
+struct bulker {
+    template <typename F, typename P>
+    struct component : public P {
+        using node = typename P::node;
+        struct net : public P::net {
+            using P::net::net;
+            using P::net::node_emplace_bulk;
+        };
+    };
+};
+
+template <int O>
+using combo_bulk = component::combine_spec<
+    exposer,
+    bulker,
+    component::simulated_connector<parallel<(O & 1) == 1>, connector<connect::fixed<1>>, delay<distribution::constant_n<times_t, 1, 4>>>,
+    component::simulated_positioner<>,
+    mytimer,
+    component::scheduler<round_schedule<seq_per>>,
+    component::identifier<parallel<(O & 1) == 1>>,
+    component::base<parallel<(O & 1) == 1>>
+>;
+
+namespace fcpp {
+namespace coordination {
+    struct dist {};
+    struct cnt {};
+
+    //! @brief Distance from node zero and number of neighbours.
+    template <typename node_t>
+    void optimistic_prog(node_t& node, trace_t call_point) {
+        internal::trace_call trace_caller(node.stack_trace, call_point);
+        node.storage(dist{}) = abf_distance(node, 0, node.uid == 0);
+        node.storage(cnt{}) = sum_hood(node, 1, nbr(node, 2, 1), 0);
+    }
+    using optimistic_prog_t = common::export_list<abf_distance_t, int>;
+
+    struct main {
+        template <typename node_t>
+        void operator()(node_t& node, times_t) {
+            optimistic_prog(node, 0);
+        }
+    };
+}
+}
+
+// Component exposing the single insertion interface.
+struct emplacer {
+    template <typename F, typename P>
+    struct component : public P {
+        using node = typename P::node;
+        struct net : public P::net {
+            using P::net::net;
+            using P::net::node_emplace;
+        };
+    };
+};
+
+using rand_per = sequence::periodic<distribution::interval_n<times_t, 0, 1>, distribution::interval_n<times_t, 1, 2>>;
+
+template <bool cons, bool opt>
+using combo_calc = component::combine_spec<
+    emplacer,
+    component::simulated_connector<parallel<cons or opt>, connector<connect::fixed<100>>, delay<distribution::constant_n<times_t, 1, 4>>>,
+    component::simulated_positioner<>,
+    component::timer<>,
+    component::scheduler<round_schedule<rand_per>>,
+    component::storage<tuple_store<coordination::dist, real_t, coordination::cnt, int>>,
+    component::identifier<parallel<cons or opt>, synchronised<false>, conservative<cons>, optimistic<opt>>,
+    component::randomizer<>,
+    component::calculus<program<coordination::main>, exports<coordination::optimistic_prog_t>>,
+    component::base<parallel<cons or opt>>
+>;
+
+template <typename N>
+size_t speculation_rollbacks(N const& network, std::true_type) {
+    return network.speculation_stats().rollbacks;
+}
+
+template <typename N>
+size_t speculation_rollbacks(N const&, std::false_type) {
+    return 0;
+}
+
+template <bool cons, bool opt>
+std::vector<std::pair<real_t, int>> calc_run(size_t* rollbacks = nullptr) {
+    typename combo_calc<cons, opt>::net network{common::make_tagged_tuple<epsilon, threads>(0, 4)};
+    for (int i=0; i<50; ++i)
+        network.node_emplace(common::make_tagged_tuple<x, v>(make_vec((i*37 % 101) * 2, (i*53 % 97) * 2), make_vec((i%7)-3.0, (i%5)-2.0)));
+    network.run(20);
+    std::vector<std::pair<real_t, int>> r;
+    for (int i=0; i<50; ++i)
+        r.emplace_back(network.node_at(i).storage(coordination::dist{}), network.node_at(i).storage(coordination::cnt{}));
+    if (rollbacks) *rollbacks = speculation_rollbacks(network, std::integral_constant<bool, opt>{});
+    return r;
+}
+
 
 MULTI_TEST(SimulatedConnectorTest, Cell, O, 2) {
     int n[4]; // 4 nodes
@@ -142,6 +249,23 @@ MULTI_TEST(SimulatedConnectorTest, EnterLeave, O, 2) {
     EXPECT_EQ(target, close);
 }
 
+MULTI_TEST(SimulatedConnectorTest, Bulk, O, 1) {
+    typename combo_bulk<O>::net network{common::make_tagged_tuple<oth, threads>("foo", 4)};
+    std::vector<common::tagged_tuple_t<x, vec<2>>> v;
+    for (int i=0; i<50; ++i) v.push_back(make_vec(i % 5 + 0.5, i / 5 + 0.5));
+    v.push_back(make_vec(30.0, 30.0));
+    std::vector<device_t> ids = network.node_emplace_bulk(v);
+    EXPECT_EQ(51ULL, ids.size());
+    std::vector<device_t> close, target;
+    for (auto c : network.cell_of(network.node_at(ids[12])).linked()) for (auto n : c->content()) close.push_back(n->uid);
+    std::sort(close.begin(), close.end());
+    target = {ids[6], ids[7], ids[8], ids[11], ids[12], ids[13], ids[16], ids[17], ids[18]};
+    EXPECT_EQ(target, close);
+    close.clear();
+    for (auto c : network.cell_of(network.node_at(ids[50])).linked()) for (auto n : c->content()) close.push_back(n->uid);
+    EXPECT_EQ(std::vector<device_t>{ids[50]}, close);
+}
+
 MULTI_TEST(SimulatedConnectorTest, Messages, O, 2) {
     auto update = [](auto& node) {
         common::lock_guard<(O & 1) == 1> l(node.mutex);
@@ -222,3 +346,12 @@ MULTI_TEST(SimulatedConnectorTest, Messages, O, 2) {
     d = fcpp::details::self(d0.nbr_dist(), 5);
     EXPECT_EQ(INF, d);
 }
+
+TEST(SimulatedConnectorTest, Optimistic) {
+    size_t rollbacks = 0;
+    std::vector<std::pair<real_t, int>> expected = calc_run<false, false>();
+    EXPECT_EQ(expected, (calc_run<true, false>()));
+    // rolled back events restore cells, contexts, exports and codecs
+    EXPECT_EQ(expected, (calc_run<false, true>(&rollbacks)));
+    EXPECT_LT(0ULL, rollbacks);
+}